@@ -33,6 +33,13 @@ sshsNode caerMainloopGetSourceNode(int16_t sourceID); // Can be NULL.
 void *caerMainloopGetSourceState(int16_t sourceID);   // Can be NULL.
 sshsNode caerMainloopGetSourceInfo(int16_t sourceID); // Can be NULL.
 
+// State shared between modules, identified by name. The first module to acquire
+// it gets it allocated (zeroed) and initialized by init(), later ones get a new
+// reference to the same memory. The last one to release it has it cleaned up by
+// destroy() and freed. Both callbacks are optional. Acquire returns NULL on failure.
+void *caerMainloopSharedStateAcquire(const char *name, size_t size, bool (*init)(void *state));
+void caerMainloopSharedStateRelease(const char *name, void (*destroy)(void *state));
+
 #ifdef __cplusplus
 }
 #endif
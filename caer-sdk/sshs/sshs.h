@@ -36,6 +36,9 @@ extern "C" {
 // SSHS node
 typedef struct sshs_node *sshsNode;
 
+// SSHS attribute handle
+typedef struct sshs_attribute *sshsAttribute;
+
 enum sshs_node_attr_value_type {
 	SSHS_UNKNOWN = -1,
 	SSHS_BOOL    = 0,
@@ -172,6 +175,36 @@ struct sshs_node_attr_ranges sshsNodeGetAttributeRanges(
 int sshsNodeGetAttributeFlags(sshsNode node, const char *key, enum sshs_node_attr_value_type type);
 char *sshsNodeGetAttributeDescription(sshsNode node, const char *key, enum sshs_node_attr_value_type type);
 
+/**
+ * Get a handle to an existing attribute, to then get and put its value
+ * without looking up its key each time, for example in the main loop of a
+ * module. Each key has exactly one handle per node, valid for as long as the
+ * node exists. If the attribute is removed, accessing it through the handle
+ * fails just like accessing it by key; if it is created again, the same
+ * handle refers to it again.
+ * The changeKey passed to attribute listeners is always the same pointer as
+ * returned by sshsAttributeGetKey() for that attribute's handle, so listeners
+ * can identify attributes by comparing the two pointers, no string compare.
+ */
+sshsAttribute sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type);
+sshsNode sshsAttributeGetNode(sshsAttribute attr);
+const char *sshsAttributeGetKey(sshsAttribute attr);
+bool sshsAttributePut(sshsAttribute attr, enum sshs_node_attr_value_type type, union sshs_node_attr_value value);
+union sshs_node_attr_value sshsAttributeGet(sshsAttribute attr, enum sshs_node_attr_value_type type);
+
+bool sshsAttributePutBool(sshsAttribute attr, bool value);
+bool sshsAttributeGetBool(sshsAttribute attr);
+bool sshsAttributePutInt(sshsAttribute attr, int32_t value);
+int32_t sshsAttributeGetInt(sshsAttribute attr);
+bool sshsAttributePutLong(sshsAttribute attr, int64_t value);
+int64_t sshsAttributeGetLong(sshsAttribute attr);
+bool sshsAttributePutFloat(sshsAttribute attr, float value);
+float sshsAttributeGetFloat(sshsAttribute attr);
+bool sshsAttributePutDouble(sshsAttribute attr, double value);
+double sshsAttributeGetDouble(sshsAttribute attr);
+bool sshsAttributePutString(sshsAttribute attr, const char *value);
+char *sshsAttributeGetString(sshsAttribute attr);
+
 // Helper functions
 const char *sshsHelperTypeToStringConverter(enum sshs_node_attr_value_type type);
 enum sshs_node_attr_value_type sshsHelperStringToTypeConverter(const char *typeString);
@@ -75,6 +75,46 @@ inline std::string sshsNodeGetStdString(sshsNode node, const char *key) {
 	return (cppStr);
 }
 
+inline bool sshsAttributePut(sshsAttribute attr, bool value) {
+	return (sshsAttributePutBool(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, int32_t value) {
+	return (sshsAttributePutInt(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, int64_t value) {
+	return (sshsAttributePutLong(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, float value) {
+	return (sshsAttributePutFloat(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, double value) {
+	return (sshsAttributePutDouble(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, const char *value) {
+	return (sshsAttributePutString(attr, value));
+}
+
+inline bool sshsAttributePut(sshsAttribute attr, const std::string &value) {
+	return (sshsAttributePutString(attr, value.c_str()));
+}
+
+inline std::string sshsAttributeGetStdString(sshsAttribute attr) {
+	char *str = sshsAttributeGetString(attr);
+	std::string cppStr(str);
+	free(str);
+	return (cppStr);
+}
+
+inline sshsAttribute sshsNodeGetAttributeHandle(
+	sshsNode node, const std::string &key, enum sshs_node_attr_value_type type) {
+	return (sshsNodeGetAttributeHandle(node, key.c_str(), type));
+}
+
 // Additional updater for std::string.
 inline bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, const std::string &value) {
 	union sshs_node_attr_value newValue;
@@ -1,17 +1,72 @@
 #include "caer-sdk/cross/portable_io.h"
 #include "caer-sdk/mainloop.h"
 
+#include "caer-sdk/cross/portable_threads.h"
+
 #include "input_common.h"
+#include "ext/net_rw.h"
+#include "ext/uthash/utlist.h"
 
 #include <fcntl.h>
 #include <sys/types.h>
 
+#if !defined(OS_WINDOWS)
+#	include <glob.h>
+#endif
+
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+#	include <zlib.h>
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+#	include <zstd.h>
+#endif
+
+#define DECOMPRESSOR_BUFFER_SIZE (256 * 1024)
+#define DECOMPRESSOR_PIPE_SIZE (1024 * 1024)
+
+enum input_file_compression {
+	INPUT_FILE_UNCOMPRESSED,
+	INPUT_FILE_GZIP,
+	INPUT_FILE_ZSTD,
+};
+
+struct input_file_decompressor {
+	/// Module the decompressed stream belongs to.
+	caerModuleData moduleData;
+	/// Compression format of the input file.
+	enum input_file_compression compression;
+	/// Compressed input file.
+	int compressedFd;
+	/// Write end of the pipe, its read end is handed to the parser.
+	int pipeWriteFd;
+	/// Decompression thread, writes the uncompressed AEDAT stream to the pipe.
+	thrd_t thread;
+	/// Decompression thread has finished and can be joined.
+	atomic_bool done;
+	/// Linked list of all started decompressors.
+	struct input_file_decompressor *next;
+};
+
+typedef struct input_file_decompressor *fileDecompressor;
+
+/// All started decompressors, of all file input modules.
+static fileDecompressor decompressors = NULL;
+static mtx_t decompressorsLock;
+static once_flag decompressorsLockIsInitialized = ONCE_FLAG_INIT;
+
 static bool caerInputFileInit(caerModuleData moduleData);
+static void caerInputFileExit(caerModuleData moduleData);
+static void decompressorsLockInitialize(void);
+static enum input_file_compression detectCompression(int fileFd);
+static int decompressorThread(void *decompressorArg);
+static void joinDecompressors(caerModuleData moduleData, bool onlyDone);
+static int openInputFile(caerModuleData moduleData, const char *filePath);
 
 static const struct caer_module_functions InputFileFunctions = {.moduleInit = &caerInputFileInit,
 	.moduleRun                                                              = &caerInputCommonRun,
 	.moduleConfig                                                           = NULL,
-	.moduleExit                                                             = &caerInputCommonExit};
+	.moduleExit                                                             = &caerInputFileExit};
 
 static const struct caer_event_stream_out InputFileOutputs[] = {{.type = -1}};
 
@@ -32,37 +87,533 @@ caerModuleInfo caerModuleGetInfo(void) {
 	return (&InputFileInfo);
 }
 
+static void decompressorsLockInitialize(void) {
+	mtx_init(&decompressorsLock, mtx_plain);
+}
+
+/**
+ * Detect compressed input files by their magic number, so that any
+ * file name works. AEDAT files always start with '#!AER-', which can
+ * never be mistaken for a gzip or zstd header.
+ *
+ * @param fileFd open input file, its offset is not changed.
+ *
+ * @return detected compression format.
+ */
+static enum input_file_compression detectCompression(int fileFd) {
+	uint8_t magic[4];
+
+	if (pread(fileFd, magic, 4, 0) != 4) {
+		return (INPUT_FILE_UNCOMPRESSED);
+	}
+
+	if (magic[0] == 0x1F && magic[1] == 0x8B) {
+		return (INPUT_FILE_GZIP);
+	}
+
+	if (magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+		return (INPUT_FILE_ZSTD);
+	}
+
+	return (INPUT_FILE_UNCOMPRESSED);
+}
+
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+static bool decompressGzip(fileDecompressor decompressor, uint8_t *outBuffer) {
+	// zlib takes ownership of the file descriptor, closed by gzclose().
+	gzFile gzInput             = gzdopen(decompressor->compressedFd, "rb");
+	decompressor->compressedFd = -1;
+
+	if (gzInput == NULL) {
+		caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to initialize gzip decompression.");
+		return (false);
+	}
+
+	gzbuffer(gzInput, DECOMPRESSOR_BUFFER_SIZE);
+
+	bool retVal = true;
+
+	while (true) {
+		int readBytes = gzread(gzInput, outBuffer, DECOMPRESSOR_BUFFER_SIZE);
+		if (readBytes < 0) {
+			int errorCode;
+			caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to decompress gzip input. Error: %s.",
+				gzerror(gzInput, &errorCode));
+			retVal = false;
+			break;
+		}
+
+		if (readBytes == 0) {
+			// End of file.
+			break;
+		}
+
+		if (!writeUntilDone(decompressor->pipeWriteFd, outBuffer, (size_t) readBytes)) {
+			// Reader went away (end of playback or module shutdown).
+			break;
+		}
+	}
+
+	gzclose(gzInput);
+
+	return (retVal);
+}
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+static bool decompressZstd(fileDecompressor decompressor, uint8_t *outBuffer) {
+	ZSTD_DStream *zstdStream = ZSTD_createDStream();
+	if (zstdStream == NULL) {
+		caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to initialize zstd decompression.");
+		return (false);
+	}
+
+	ZSTD_initDStream(zstdStream);
+
+	size_t inBufferSize = ZSTD_DStreamInSize();
+
+	uint8_t *inBuffer = malloc(inBufferSize);
+	if (inBuffer == NULL) {
+		ZSTD_freeDStream(zstdStream);
+
+		caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to allocate zstd input buffer.");
+		return (false);
+	}
+
+	bool retVal = true;
+
+	// Concatenated frames are supported, the stream simply continues.
+	ssize_t readBytes;
+	while ((readBytes = readUntilDone(decompressor->compressedFd, inBuffer, inBufferSize)) > 0) {
+		ZSTD_inBuffer input = {.src = inBuffer, .size = (size_t) readBytes, .pos = 0};
+
+		while (input.pos < input.size) {
+			ZSTD_outBuffer output = {.dst = outBuffer, .size = DECOMPRESSOR_BUFFER_SIZE, .pos = 0};
+
+			size_t zstdRes = ZSTD_decompressStream(zstdStream, &output, &input);
+			if (ZSTD_isError(zstdRes)) {
+				caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to decompress zstd input. Error: %s.",
+					ZSTD_getErrorName(zstdRes));
+				retVal = false;
+				goto zstdEnd;
+			}
+
+			if (!writeUntilDone(decompressor->pipeWriteFd, outBuffer, output.pos)) {
+				// Reader went away (end of playback or module shutdown).
+				goto zstdEnd;
+			}
+		}
+	}
+
+	if (readBytes < 0) {
+		caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to read zstd input. Error: %d.", errno);
+		retVal = false;
+	}
+
+zstdEnd:
+	free(inBuffer);
+	ZSTD_freeDStream(zstdStream);
+
+	return (retVal);
+}
+#endif
+
+static int decompressorThread(void *decompressorArg) {
+	fileDecompressor decompressor = decompressorArg;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(decompressor->moduleData->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 12]; // +1 for NUL character.
+	strcpy(threadName, decompressor->moduleData->moduleSubSystemString);
+	strcat(threadName, "[Decompress]");
+	portable_thread_set_name(threadName);
+
+	uint8_t *outBuffer = malloc(DECOMPRESSOR_BUFFER_SIZE);
+	if (outBuffer == NULL) {
+		caerModuleLog(decompressor->moduleData, CAER_LOG_ERROR, "Failed to allocate decompression buffer.");
+	}
+	else {
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+		if (decompressor->compression == INPUT_FILE_GZIP) {
+			decompressGzip(decompressor, outBuffer);
+		}
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+		if (decompressor->compression == INPUT_FILE_ZSTD) {
+			decompressZstd(decompressor, outBuffer);
+		}
+#endif
+
+		free(outBuffer);
+	}
+
+	if (decompressor->compressedFd >= 0) {
+		close(decompressor->compressedFd);
+		decompressor->compressedFd = -1;
+	}
+
+	// Closing the write end signals EOF to the parser.
+	close(decompressor->pipeWriteFd);
+	decompressor->pipeWriteFd = -1;
+
+	atomic_store(&decompressor->done, true);
+
+	return (thrd_success);
+}
+
+/**
+ * Join and free the decompressors started by a module.
+ *
+ * @param moduleData file input module data.
+ * @param onlyDone only reap decompressors whose thread has already finished,
+ * otherwise wait for all of them (the parser side must be closed already).
+ */
+static void joinDecompressors(caerModuleData moduleData, bool onlyDone) {
+	call_once(&decompressorsLockIsInitialized, &decompressorsLockInitialize);
+
+	mtx_lock(&decompressorsLock);
+
+	fileDecompressor decompressor, tmp;
+	LL_FOREACH_SAFE(decompressors, decompressor, tmp) {
+		if (decompressor->moduleData != moduleData) {
+			continue;
+		}
+
+		if (onlyDone && !atomic_load(&decompressor->done)) {
+			continue;
+		}
+
+		LL_DELETE(decompressors, decompressor);
+
+		thrd_join(decompressor->thread, NULL);
+		free(decompressor);
+	}
+
+	mtx_unlock(&decompressorsLock);
+}
+
+/**
+ * Open an input file for reading. Compressed files (gzip, zstd) are
+ * decompressed on a dedicated thread, which writes the AEDAT stream
+ * into a pipe: the returned descriptor is its read end, so the parser
+ * doesn't need to know about compression at all.
+ *
+ * @param moduleData file input module data.
+ * @param filePath file to open.
+ *
+ * @return file descriptor to read the uncompressed stream from, -1 on failure.
+ */
+static int openInputFile(caerModuleData moduleData, const char *filePath) {
+	int fileFd = open(filePath, O_RDONLY);
+	if (fileFd < 0) {
+		return (-1);
+	}
+
+	enum input_file_compression compression = detectCompression(fileFd);
+	if (compression == INPUT_FILE_UNCOMPRESSED) {
+		return (fileFd);
+	}
+
+#ifndef ENABLE_INOUT_GZIP_DECOMPRESSION
+	if (compression == INPUT_FILE_GZIP) {
+		close(fileFd);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Input file '%s' is gzip compressed, but gzip support is not "
+			"available. Please recompile with zlib.", filePath);
+		errno = ENOTSUP;
+		return (-1);
+	}
+#endif
+
+#ifndef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (compression == INPUT_FILE_ZSTD) {
+		close(fileFd);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Input file '%s' is zstd compressed, but zstd support is not "
+			"available. Please recompile with libzstd.", filePath);
+		errno = ENOTSUP;
+		return (-1);
+	}
+#endif
+
+	// Clean up after files that have already been played back.
+	joinDecompressors(moduleData, true);
+
+	int pipeFds[2];
+	if (pipe(pipeFds) != 0) {
+		int pipeErrno = errno;
+		close(fileFd);
+		errno = pipeErrno;
+		return (-1);
+	}
+
+#if defined(F_SETPIPE_SZ)
+	// Bigger pipe means fewer context switches between decompressor and parser.
+	// Failure is not an error, the default size still works.
+	fcntl(pipeFds[1], F_SETPIPE_SZ, DECOMPRESSOR_PIPE_SIZE);
+#endif
+
+	fileDecompressor decompressor = calloc(1, sizeof(*decompressor));
+	if (decompressor == NULL) {
+		close(pipeFds[0]);
+		close(pipeFds[1]);
+		close(fileFd);
+		errno = ENOMEM;
+		return (-1);
+	}
+
+	decompressor->moduleData   = moduleData;
+	decompressor->compression  = compression;
+	decompressor->compressedFd = fileFd;
+	decompressor->pipeWriteFd  = pipeFds[1];
+	atomic_store(&decompressor->done, false);
+
+	call_once(&decompressorsLockIsInitialized, &decompressorsLockInitialize);
+
+	mtx_lock(&decompressorsLock);
+
+	if (thrd_create(&decompressor->thread, &decompressorThread, decompressor) != thrd_success) {
+		mtx_unlock(&decompressorsLock);
+
+		free(decompressor);
+		close(pipeFds[0]);
+		close(pipeFds[1]);
+		close(fileFd);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start decompression thread for '%s'.", filePath);
+		errno = EAGAIN;
+		return (-1);
+	}
+
+	LL_PREPEND(decompressors, decompressor);
+
+	mtx_unlock(&decompressorsLock);
+
+	caerModuleLog(moduleData, CAER_LOG_DEBUG, "Decompressing %s input file '%s' on the fly.",
+		(compression == INPUT_FILE_GZIP) ? ("gzip") : ("zstd"), filePath);
+
+	return (pipeFds[0]);
+}
+
+static bool addPlaylistFile(inputCommonState state, const char *filePath) {
+	char **newFiles = realloc(state->playlist.files, (state->playlist.filesSize + 1) * sizeof(char *));
+	if (newFiles == NULL) {
+		return (false);
+	}
+
+	state->playlist.files = newFiles;
+
+	size_t filePathLength = strlen(filePath);
+
+	char *filePathCopy = malloc(filePathLength + 1);
+	if (filePathCopy == NULL) {
+		return (false);
+	}
+
+	memcpy(filePathCopy, filePath, filePathLength + 1);
+
+	state->playlist.files[state->playlist.filesSize++] = filePathCopy;
+
+	return (true);
+}
+
+static void freeFileInputState(inputCommonState state) {
+	for (size_t i = 0; i < state->playlist.filesSize; i++) {
+		free(state->playlist.files[i]);
+	}
+
+	free(state->playlist.files);
+
+	state->playlist.files     = NULL;
+	state->playlist.filesSize = 0;
+
+	free(state->demux.groupName);
+	state->demux.groupName = NULL;
+}
+
+/**
+ * Build the ordered list of files to play back from a '|' separated
+ * playlist string. Each entry may be a glob pattern, its matches are
+ * added in sorted order (no glob support on Windows, entries are
+ * taken literally there).
+ *
+ * @param moduleData file input module data.
+ * @param playlist '|' separated list of files, modified during parsing.
+ *
+ * @return true on success, false on failure (invalid pattern, memory).
+ */
+static bool buildPlaylist(caerModuleData moduleData, char *playlist) {
+	inputCommonState state = moduleData->moduleState;
+
+	char *entry = playlist;
+
+	while (entry != NULL) {
+		char *separator = strchr(entry, '|');
+		if (separator != NULL) {
+			*separator = '\0';
+		}
+
+		if (!caerStrEquals(entry, "")) {
+#if defined(OS_WINDOWS)
+			if (!addPlaylistFile(state, entry)) {
+				caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for playlist.");
+				return (false);
+			}
+#else
+			glob_t globResults;
+
+			int globRes = glob(entry, GLOB_ERR, NULL, &globResults);
+			if (globRes == GLOB_NOMATCH) {
+				caerModuleLog(moduleData, CAER_LOG_WARNING, "No input file matches '%s', skipping it.", entry);
+			}
+			else if (globRes != 0) {
+				globfree(&globResults);
+
+				caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to expand playlist entry '%s'.", entry);
+				return (false);
+			}
+			else {
+				for (size_t i = 0; i < globResults.gl_pathc; i++) {
+					if (!addPlaylistFile(state, globResults.gl_pathv[i])) {
+						globfree(&globResults);
+
+						caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for playlist.");
+						return (false);
+					}
+				}
+
+				globfree(&globResults);
+			}
+#endif
+		}
+
+		entry = (separator != NULL) ? (separator + 1) : (NULL);
+	}
+
+	return (true);
+}
+
 static bool caerInputFileInit(caerModuleData moduleData) {
+	inputCommonState state = moduleData->moduleState;
+
 	sshsNodeCreateString(
 		moduleData->moduleNode, "filePath", "", 0, PATH_MAX, SSHS_FLAGS_NORMAL, "File path for reading input data.");
 	sshsNodeCreateAttributeFileChooser(moduleData->moduleNode, "filePath", "LOAD:aedat");
+	sshsNodeCreateString(moduleData->moduleNode, "filePlaylist", "", 0, 16 * PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Ordered list of files to play back as one continuous stream, separated by '|'. Glob patterns are "
+		"expanded in sorted order. Takes precedence over 'filePath' if set.");
+
+	sshsNodeCreateString(moduleData->moduleNode, "demuxGroup", "", 0, 128, SSHS_FLAGS_NORMAL,
+		"Name of the demultiplexing group, to read a file with multiple sources only once. The input reading the "
+		"file outputs its first source, companion inputs in the same group output the others. Empty to disable.");
+	sshsNodeCreateInt(moduleData->moduleNode, "demuxSourceID", -1, -1, INT16_MAX, SSHS_FLAGS_NORMAL,
+		"Source ID to output as demultiplexing companion (no file is read), -1 to read the file.");
+
+	char *demuxGroup = sshsNodeGetString(moduleData->moduleNode, "demuxGroup");
+
+	if (!caerStrEquals(demuxGroup, "")) {
+		// Ownership passes to common input state, freed on exit.
+		state->demux.groupName = demuxGroup;
+		state->demux.sourceID  = I16T(sshsNodeGetInt(moduleData->moduleNode, "demuxSourceID"));
 
-	char *filePath = sshsNodeGetString(moduleData->moduleNode, "filePath");
+		if (state->demux.sourceID >= 0) {
+			// Companion: gets its packets from the input reading the file.
+			state->demux.isCompanion = true;
+
+			if (!caerInputCommonInit(moduleData, -1, false, false)) {
+				freeFileInputState(state);
+
+				return (false);
+			}
+
+			return (true);
+		}
+	}
+	else {
+		free(demuxGroup);
+	}
 
-	if (caerStrEquals(filePath, "")) {
+	char *filePlaylist = sshsNodeGetString(moduleData->moduleNode, "filePlaylist");
+
+	if (!caerStrEquals(filePlaylist, "")) {
+		if (!buildPlaylist(moduleData, filePlaylist)) {
+			free(filePlaylist);
+			freeFileInputState(state);
+
+			return (false);
+		}
+
+		free(filePlaylist);
+
+		if (state->playlist.filesSize == 0) {
+			freeFileInputState(state);
+
+			caerModuleLog(
+				moduleData, CAER_LOG_ERROR, "No input files found, please check the 'filePlaylist' parameter.");
+			return (false);
+		}
+	}
+	else {
+		free(filePlaylist);
+
+		char *filePath = sshsNodeGetString(moduleData->moduleNode, "filePath");
+
+		if (caerStrEquals(filePath, "")) {
+			free(filePath);
+			freeFileInputState(state);
+
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "No input file given, please specify the 'filePath' parameter.");
+			return (false);
+		}
+
+		bool added = addPlaylistFile(state, filePath);
 		free(filePath);
 
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "No input file given, please specify the 'filePath' parameter.");
-		return (false);
+		if (!added) {
+			freeFileInputState(state);
+
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for playlist.");
+			return (false);
+		}
 	}
 
-	int fileFd = open(filePath, O_RDONLY);
+	// Open the first file, the others are opened in the background during playback.
+	const char *filePath = state->playlist.files[0];
+
+	int fileFd = openInputFile(moduleData, filePath);
 	if (fileFd < 0) {
 		caerModuleLog(
 			moduleData, CAER_LOG_CRITICAL, "Could not open input file '%s' for reading. Error: %d.", filePath, errno);
-		free(filePath);
+		freeFileInputState(state);
 
 		return (false);
 	}
 
 	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened input file '%s' successfully for reading.", filePath);
-	free(filePath);
+
+	if (state->playlist.filesSize > 1) {
+		caerModuleLog(moduleData, CAER_LOG_INFO, "Playing back %zu files as one continuous stream.",
+			state->playlist.filesSize);
+	}
+
+	// Playlist files are opened the same way, so they can be compressed too.
+	state->playlist.openFile = &openInputFile;
 
 	if (!caerInputCommonInit(moduleData, fileFd, false, false)) {
 		close(fileFd);
+		freeFileInputState(state);
+		joinDecompressors(moduleData, false);
 
 		return (false);
 	}
 
 	return (true);
 }
+
+static void caerInputFileExit(caerModuleData moduleData) {
+	// Closes all file descriptors, so any decompressor still running stops.
+	caerInputCommonExit(moduleData);
+
+	joinDecompressors(moduleData, false);
+}
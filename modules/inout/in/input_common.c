@@ -1,4 +1,8 @@
 #include "input_common.h"
+#include "../inout_polarity_delta.h"
+#include "../inout_packet_compression.h"
+#include "../inout_packet_order.h"
+#include "../inout_serialized_ts.h"
 
 #include "caer-sdk/cross/portable_threads.h"
 #include "caer-sdk/cross/portable_time.h"
@@ -19,6 +23,8 @@
 
 #include <libcaer/devices/dynapse.h> // CONSTANTS only.
 
+#include <fcntl.h>
+#include <limits.h>
 #include <stdatomic.h>
 
 #define MAX_HEADER_LINE_SIZE 1024
@@ -31,24 +37,118 @@ enum input_reader_state {
 	ERROR_DATA   = -3,
 };
 
+struct input_common_sync_group {
+	/// Protects all fields below.
+	mtx_t lock;
+	/// Number of inputs that joined this clock.
+	size_t members;
+	/// Clock has been started by the first packet container commit.
+	bool started;
+	/// Playback timestamp at which the clock was started.
+	int64_t startTimestamp;
+	/// Real time at which the clock was started, moved forward on pause.
+	struct timespec startTime;
+	/// Number of inputs currently holding the clock paused.
+	size_t pausedMembers;
+	/// Real time at which the clock was paused.
+	struct timespec pauseTime;
+};
+
+typedef struct input_common_sync_group *inputSyncGroup;
+
+// Shared clocks and demultiplexing groups are registered with the mainloop as
+// shared state, so inputs can join them from any module library.
+#define SYNC_GROUP_STATE_PREFIX "inputSyncGroup/"
+#define DEMUX_GROUP_STATE_PREFIX "inputDemuxGroup/"
+
+#define DEMUX_MAX_SOURCES 32
+
+struct input_common_demux_source {
+	/// Source ID as found in the file.
+	int16_t sourceID;
+	/// Source string from the file header, used to setup sourceInfo.
+	char sourceString[MAX_HEADER_LINE_SIZE + 1];
+};
+
+struct input_common_demux_group {
+	/// Protects all fields below.
+	mtx_t lock;
+	/// Number of inputs that joined this group (reader and companions).
+	size_t members;
+	/// The input actually reading the file (NULL if gone).
+	inputCommonState reader;
+	/// The reader's header was parsed, companions can join now.
+	bool headerReady;
+	/// Header parsing results of the reader, companions use the same.
+	bool isAEDAT3;
+	int16_t majorVersion;
+	int8_t minorVersion;
+	int8_t formatID;
+	/// All sources declared in the file header.
+	struct input_common_demux_source sources[DEMUX_MAX_SOURCES];
+	size_t sourcesSize;
+	/// Companion inputs, each taking the packets of one source.
+	inputCommonState companions[DEMUX_MAX_SOURCES];
+	size_t companionsSize;
+};
+
+typedef struct input_common_demux_group *inputDemuxGroup;
+
+static char *groupStateName(const char *prefix, const char *groupName);
 static bool newInputBuffer(inputCommonState state);
 static bool parseNetworkHeader(inputCommonState state);
-static char *getFileHeaderLine(inputCommonState state);
+static char *getFileHeaderLine(simpleBuffer buf);
 static void parseSourceString(char *sourceString, inputCommonState state);
-static bool parseFileHeader(inputCommonState state);
+static bool parseFileHeader(
+	inputCommonState state, simpleBuffer buf, struct input_common_header_info *header, bool updateSourceInfo);
 static bool parseHeader(inputCommonState state);
+static bool demuxGroupInit(void *groupArg);
+static void demuxGroupDestroy(void *groupArg);
+static bool demuxGroupJoinCompanion(inputCommonState state, inputDemuxGroup group);
+static bool demuxGroupJoinReader(inputCommonState state, inputDemuxGroup group);
+static bool demuxGroupJoin(inputCommonState state);
+static void demuxGroupLeave(inputCommonState state);
+static void demuxGroupAddSource(inputCommonState state, int16_t sourceID, const char *sourceString);
+static void demuxGroupPublishHeader(inputCommonState state);
+static void demuxGroupWaitForCompanions(inputCommonState state);
+static bool demuxGroupHasSource(inputCommonState state, int16_t sourceID);
+static bool demuxGroupSendPacket(inputCommonState state, caerEventPacketHeader packet, int16_t sourceID);
+static caerEventPacketHeader allocateTSResetPacket(int16_t sourceID, int32_t tsOverflow);
+static bool sendPacketToAssembler(inputCommonState state, caerEventPacketHeader packet);
+static bool sendTSResetPacket(inputCommonState state);
+static int64_t streamTimestampGet(inputCommonState state, int16_t sourceID, int16_t eventType, int64_t notFound);
+static void streamTimestampUpdate(inputCommonState state, int16_t sourceID, int16_t eventType, int64_t timestamp);
 static bool parseData(inputCommonState state);
 static int aedat2GetPacket(inputCommonState state, int16_t chipID);
 static int aedat3GetPacket(inputCommonState state, bool isAEDAT30);
 static void aedat30ChangeOrigin(inputCommonState state, caerEventPacketHeader packet);
 static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static bool decompressPolarityDelta(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static bool decompressFramesFast(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+static bool decompressPacketLZ4(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+#endif
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+static bool decompressPacketZstd(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+#endif
+static bool prefetchFile(inputCommonState state, size_t fileIndex);
+static int inputPrefetchThread(void *stateArg);
+static void discardPartialPacket(inputCommonState state);
+static bool reconnectStream(inputCommonState state);
+static bool switchToNextFile(inputCommonState state);
 static int inputReaderThread(void *stateArg);
 
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData);
 static caerEventPacketContainer generatePacketContainer(inputCommonState state, bool forceFlush);
 static void commitPacketContainer(inputCommonState state, bool forceFlush);
-static void doTimeDelay(inputCommonState state);
+static void doTimeDelay(inputCommonState state, int64_t timestamp);
+static bool syncGroupInit(void *groupArg);
+static void syncGroupDestroy(void *groupArg);
+static bool syncGroupJoin(inputCommonState state, const char *groupName);
+static void syncGroupLeave(inputCommonState state);
+static void syncGroupPause(inputCommonState state, bool pause);
+static void doSyncTimeDelay(inputCommonState state, int64_t timestamp);
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force);
 static bool handleTSReset(inputCommonState state);
 static void getPacketInfo(caerEventPacketHeader packet, packetData packetInfoData);
@@ -56,7 +156,6 @@ static int inputAssemblerThread(void *stateArg);
 
 static void caerInputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static int packetsFirstTypeThenSizeCmp(const void *a, const void *b);
 
 static bool newInputBuffer(inputCommonState state) {
 	// First check if the size really changed.
@@ -110,8 +209,21 @@ static bool parseNetworkHeader(inputCommonState state) {
 	state->header.majorVersion = 3;
 
 	if (state->isNetworkMessageBased) {
-		// For message based streams, use the sequence number.
-		// TODO: Network: check this for missing packets in message mode!
+		// For message based streams, use the sequence number to detect missing messages.
+		if (atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed)
+			&& (networkHeader.sequenceNumber != (state->header.networkSequenceNumber + 1))) {
+			if (networkHeader.sequenceNumber > (state->header.networkSequenceNumber + 1)) {
+				state->statistics.lostMessages
+					+= U64T(networkHeader.sequenceNumber - (state->header.networkSequenceNumber + 1));
+				sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "lostMessages", SSHS_LONG,
+					(union sshs_node_attr_value){.ilong = I64T(state->statistics.lostMessages)});
+			}
+
+			caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
+				"Network sequence discontinuity: expected %" PRIi64 ", got %" PRIi64 ".",
+				state->header.networkSequenceNumber + 1, networkHeader.sequenceNumber);
+		}
+
 		state->header.networkSequenceNumber = networkHeader.sequenceNumber;
 	}
 	else {
@@ -132,6 +244,14 @@ static bool parseNetworkHeader(inputCommonState state) {
 	// All formats are supported.
 	state->header.formatID = networkHeader.formatNumber;
 
+	// On reconnection, the other side could have changed.
+	if (atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed)
+		&& (state->header.sourceID != networkHeader.sourceID)) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Source ID changed from %" PRIi16 " to %" PRIi16 " on reconnection.", state->header.sourceID,
+			networkHeader.sourceID);
+	}
+
 	// TODO: Network: get sourceInfo node info via config-server side-channel.
 	state->header.sourceID = networkHeader.sourceID;
 
@@ -160,9 +280,7 @@ static bool parseNetworkHeader(inputCommonState state) {
 	return (true);
 }
 
-static char *getFileHeaderLine(inputCommonState state) {
-	simpleBuffer buf = state->dataBuffer;
-
+static char *getFileHeaderLine(simpleBuffer buf) {
 	if (buf->buffer[buf->bufferPosition] == '#') {
 		size_t headerLinePos = 0;
 		char *headerLine     = malloc(MAX_HEADER_LINE_SIZE);
@@ -335,7 +453,8 @@ static void parseSourceString(char *sourceString, inputCommonState state) {
 		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Device source information.");
 }
 
-static bool parseFileHeader(inputCommonState state) {
+static bool parseFileHeader(
+	inputCommonState state, simpleBuffer buf, struct input_common_header_info *header, bool updateSourceInfo) {
 	// We expect that the full header part is contained within
 	// this one data buffer.
 	// File headers are part of the AEDAT 3.X specification.
@@ -348,23 +467,23 @@ static bool parseFileHeader(inputCommonState state) {
 	bool endHeader     = false;
 
 	while (!endHeader) {
-		char *headerLine = getFileHeaderLine(state);
+		char *headerLine = getFileHeaderLine(buf);
 		if (headerLine == NULL) {
 			// Failed to parse header line; this is an invalid header for AEDAT 3.1!
 			// For AEDAT 2.0 and 3.0, since there is no END-HEADER, this might be
 			// the right way for headers to stop, so we consider this valid IFF we
 			// already got the version header for AEDAT 2.0, and for AEDAT 3.0 if we
 			// also got the required headers Format and Source at least.
-			if ((state->header.majorVersion == 2 && state->header.minorVersion == 0) && versionHeader) {
+			if ((header->majorVersion == 2 && header->minorVersion == 0) && versionHeader) {
 				// Parsed AEDAT 2.0 header successfully (version).
-				atomic_store(&state->header.isValidHeader, true);
+				atomic_store(&header->isValidHeader, true);
 				return (true);
 			}
 
-			if ((state->header.majorVersion == 3 && state->header.minorVersion == 0) && versionHeader && formatHeader
+			if ((header->majorVersion == 3 && header->minorVersion == 0) && versionHeader && formatHeader
 				&& sourceHeader) {
 				// Parsed AEDAT 3.0 header successfully (version, format, source).
-				atomic_store(&state->header.isValidHeader, true);
+				atomic_store(&header->isValidHeader, true);
 				return (true);
 			}
 
@@ -373,25 +492,25 @@ static bool parseFileHeader(inputCommonState state) {
 
 		if (!versionHeader) {
 			// First thing we expect is the version header. We don't support files not having it.
-			if (sscanf(headerLine, "#!AER-DAT%" SCNi16 ".%" SCNi8 "\r\n", &state->header.majorVersion,
-					&state->header.minorVersion)
+			if (sscanf(headerLine, "#!AER-DAT%" SCNi16 ".%" SCNi8 "\r\n", &header->majorVersion,
+					&header->minorVersion)
 				== 2) {
 				versionHeader = true;
 
 				// Check valid versions.
-				switch (state->header.majorVersion) {
+				switch (header->majorVersion) {
 					case 2:
 						// AEDAT 2.0 is supported. No revisions exist.
-						if (state->header.minorVersion != 0) {
+						if (header->minorVersion != 0) {
 							goto noValidVersionHeader;
 						}
 						break;
 
 					case 3:
-						state->header.isAEDAT3 = true;
+						header->isAEDAT3 = true;
 
 						// AEDAT 3.0 and 3.1 are supported.
-						if (state->header.minorVersion != 0 && state->header.minorVersion != 1) {
+						if (header->minorVersion != 0 && header->minorVersion != 1) {
 							goto noValidVersionHeader;
 						}
 						break;
@@ -403,7 +522,7 @@ static bool parseFileHeader(inputCommonState state) {
 				}
 
 				caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Found AEDAT%" PRIi16 ".%" PRIi8 " version header.",
-					state->header.majorVersion, state->header.minorVersion);
+					header->majorVersion, header->minorVersion);
 			}
 			else {
 			noValidVersionHeader:
@@ -414,7 +533,7 @@ static bool parseFileHeader(inputCommonState state) {
 				return (false);
 			}
 		}
-		else if (state->header.isAEDAT3 && !formatHeader) {
+		else if (header->isAEDAT3 && !formatHeader) {
 			// Then the format header. Only with AEDAT 3.X.
 			char formatString[1024 + 1];
 
@@ -424,20 +543,36 @@ static bool parseFileHeader(inputCommonState state) {
 				// Parse format string to format ID.
 				// We support either only RAW, or a mixture of the various compression modes.
 				if (caerStrEquals(formatString, "RAW")) {
-					state->header.formatID = 0x00;
+					header->formatID = 0x00;
 				}
 				else {
-					state->header.formatID = 0x00;
+					header->formatID = 0x00;
 
 					if (strstr(formatString, "SerializedTS") != NULL) {
-						state->header.formatID |= 0x01;
+						header->formatID |= 0x01;
 					}
 
 					if (strstr(formatString, "PNGFrames") != NULL) {
-						state->header.formatID |= 0x02;
+						header->formatID |= 0x02;
+					}
+
+					if (strstr(formatString, "PolarityDelta") != NULL) {
+						header->formatID |= 0x04;
 					}
 
-					if (!state->header.formatID) {
+					if (strstr(formatString, "LZ4Packets") != NULL) {
+						header->formatID |= 0x08;
+					}
+
+					if (strstr(formatString, "ZstdPackets") != NULL) {
+						header->formatID |= 0x10;
+					}
+
+					if (strstr(formatString, "FastFrames") != NULL) {
+						header->formatID |= 0x20;
+					}
+
+					if (!header->formatID) {
 						// No valid format found.
 						free(headerLine);
 
@@ -449,7 +584,7 @@ static bool parseFileHeader(inputCommonState state) {
 				}
 
 				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
-					"Found Format header with value '%s', Format ID %" PRIi8 ".", formatString, state->header.formatID);
+					"Found Format header with value '%s', Format ID %" PRIi8 ".", formatString, header->formatID);
 			}
 			else {
 				free(headerLine);
@@ -458,19 +593,23 @@ static bool parseFileHeader(inputCommonState state) {
 				return (false);
 			}
 		}
-		else if (state->header.isAEDAT3 && !sourceHeader) {
+		else if (header->isAEDAT3 && !sourceHeader) {
 			// Then the source header. Only with AEDAT 3.X. We only support one active source.
 			char sourceString[1024 + 1];
 
-			if (sscanf(headerLine, "#Source %" SCNi16 ": %1024[^\r]s\n", &state->header.sourceID, sourceString) == 2) {
+			if (sscanf(headerLine, "#Source %" SCNi16 ": %1024[^\r]s\n", &header->sourceID, sourceString) == 2) {
 				sourceHeader = true;
 
 				// Parse source string to get needed sourceInfo parameters.
-				parseSourceString(sourceString, state);
+				// Prefetched playlist files don't touch sourceInfo, the first file defines it.
+				if (updateSourceInfo) {
+					parseSourceString(sourceString, state);
+					demuxGroupAddSource(state, header->sourceID, sourceString);
+				}
 
 				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
 					"Found Source header with value '%s', Source ID %" PRIi16 ".", sourceString,
-					state->header.sourceID);
+					header->sourceID);
 			}
 			else {
 				free(headerLine);
@@ -498,7 +637,21 @@ static bool parseFileHeader(inputCommonState state) {
 							state->parentModule, CAER_LOG_INFO, "Recording was taken on %s.", startTimeString);
 					}
 				}
-				else if (caerStrEqualsUpTo(headerLine, "#-Source ", 9)) {
+				else if (updateSourceInfo && (state->demux.group != NULL)
+						 && caerStrEqualsUpTo(headerLine, "#Source ", 8)) {
+					// Further sources in the same file, only of interest for demultiplexing.
+					int16_t sourceID;
+					char sourceString[1024 + 1];
+
+					if (sscanf(headerLine, "#Source %" SCNi16 ": %1024[^\r]s\n", &sourceID, sourceString) == 2) {
+						demuxGroupAddSource(state, sourceID, sourceString);
+
+						caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+							"Found additional Source header with value '%s', Source ID %" PRIi16 ".", sourceString,
+							sourceID);
+					}
+				}
+				else if (updateSourceInfo && caerStrEqualsUpTo(headerLine, "#-Source ", 9)) {
 					// Detect negative source strings (#-Source) and add them to sourceInfo.
 					// Previous sources are simply appended to the sourceString string in order.
 					char *currSourceString        = sshsNodeGetString(state->sourceInfoNode, "sourceString");
@@ -534,7 +687,7 @@ static bool parseFileHeader(inputCommonState state) {
 	}
 
 	// Parsed AEDAT 3.1 header successfully.
-	atomic_store(&state->header.isValidHeader, true);
+	atomic_store(&header->isValidHeader, true);
 	return (true);
 }
 
@@ -543,217 +696,728 @@ static bool parseHeader(inputCommonState state) {
 		return (parseNetworkHeader(state));
 	}
 	else {
-		return (parseFileHeader(state));
+		return (parseFileHeader(state, state->dataBuffer, &state->header, true));
 	}
 }
 
-static bool parseData(inputCommonState state) {
-	while (state->dataBuffer->bufferPosition < state->dataBuffer->bufferUsedSize) {
-		int pRes = -1;
+/**
+ * Name of the shared state of a group in the mainloop registry: the prefix
+ * for the kind of group, followed by the name the inputs use to join it.
+ *
+ * @return the name (to be freed), NULL on allocation failure.
+ */
+static char *groupStateName(const char *prefix, const char *groupName) {
+	size_t nameLength = strlen(prefix) + strlen(groupName);
 
-		// Try getting packet and packetData from buffer.
-		if (state->header.majorVersion == 2 && state->header.minorVersion == 0) {
-			pRes = aedat2GetPacket(state, 0);
-		}
-		else if (state->header.majorVersion == 3) {
-			pRes = aedat3GetPacket(state, (state->header.minorVersion == 0));
-		}
-		else {
-			// No parseable format found!
-			return (false);
-		}
+	char *stateName = malloc(nameLength + 1);
+	if (stateName == NULL) {
+		return (NULL);
+	}
 
-		// Check packet parser return value.
-		if (pRes < 0) {
-			// Error in parsing buffer to get packet.
+	snprintf(stateName, nameLength + 1, "%s%s", prefix, groupName);
+
+	return (stateName);
+}
+
+static bool demuxGroupInit(void *groupArg) {
+	inputDemuxGroup group = groupArg;
+
+	return (mtx_init(&group->lock, mtx_plain) == thrd_success);
+}
+
+static void demuxGroupDestroy(void *groupArg) {
+	inputDemuxGroup group = groupArg;
+
+	mtx_destroy(&group->lock);
+}
+
+/**
+ * Join a demultiplexing group as companion, taking the packets of one source.
+ * Must be called with the group lock held.
+ */
+static bool demuxGroupJoinCompanion(inputCommonState state, inputDemuxGroup group) {
+	// Companions can only join a group whose reader already parsed the file header.
+	// Failing Init here is fine, the mainloop will retry to start the module.
+	if (group->reader == NULL || !group->headerReady) {
+		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
+			"Demultiplexing group '%s' has no reader ready yet, waiting for it.", state->demux.groupName);
+		return (false);
+	}
+
+	if (state->demux.sourceID == group->reader->header.sourceID) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Source %" PRIi16 " is already handled by the reader of demultiplexing group '%s'.",
+			state->demux.sourceID, state->demux.groupName);
+		return (false);
+	}
+
+	for (size_t i = 0; i < group->companionsSize; i++) {
+		if (group->companions[i]->demux.sourceID == state->demux.sourceID) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Source %" PRIi16 " is already handled by another input of demultiplexing group '%s'.",
+				state->demux.sourceID, state->demux.groupName);
 			return (false);
 		}
-		else if (pRes == 1) {
-			// Finished parsing this buffer with no new packet.
-			// Exit to get next buffer.
-			break;
-		}
-		else if (pRes == 2) {
-			// Skip requested, run again.
-			continue;
-		}
+	}
 
-		caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
-			"New packet read - ID: %zu, Offset: %zu, Size: %zu, Events: %" PRIi32 ", Type: %" PRIi16
-			", StartTS: %" PRIi64 ", EndTS: %" PRIi64 ".",
-			state->packets.currPacketData->id, state->packets.currPacketData->offset,
-			state->packets.currPacketData->size, state->packets.currPacketData->eventNumber,
-			state->packets.currPacketData->eventType, state->packets.currPacketData->startTimestamp,
-			state->packets.currPacketData->endTimestamp);
+	if (group->companionsSize == DEMUX_MAX_SOURCES) {
+		caerModuleLog(
+			state->parentModule, CAER_LOG_ERROR, "Demultiplexing group '%s' is full.", state->demux.groupName);
+		return (false);
+	}
 
-		// New packet information, add it to the global packet info list.
-		// This is done here to prevent ambiguity about the ownership of the involved memory block:
-		// it either is inside the global list with state->packets.currPacketData NULL, or it is not
-		// in the list, but in state->packets.currPacketData itself. So if, on exit, we clear both,
-		// we'll free all the memory and have no fear of a double-free happening.
-		DL_APPEND(state->packets.packetsList, state->packets.currPacketData);
-		state->packets.currPacketData = NULL;
+	// Same file, same header, only the source differs.
+	state->header.isAEDAT3     = group->isAEDAT3;
+	state->header.majorVersion = group->majorVersion;
+	state->header.minorVersion = group->minorVersion;
+	state->header.formatID     = group->formatID;
+	state->header.sourceID     = state->demux.sourceID;
 
-		// New packet from stream, send it off to the input assembler thread. Same memory
-		// related considerations as above for state->packets.currPacketData apply here too!
-		while (!caerRingBufferPut(state->transferRingPackets, state->packets.currPacket)) {
-			// We ensure all read packets are sent to the Assembler stage.
-			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
-				// On normal termination, just return without errors. The Reader thread
-				// will then also exit without errors and clean up in Exit().
-				return (true);
-			}
+	// Find the source string declared in the header. If the file doesn't declare
+	// this source, fall back to the reader's one (usually same kind of device).
+	const char *sourceString = NULL;
 
-			// Delay by 10 µs if no change, to avoid a wasteful busy loop.
-			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 10000};
-			thrd_sleep(&retrySleep, NULL);
+	for (size_t i = 0; i < group->sourcesSize; i++) {
+		if (group->sources[i].sourceID == state->demux.sourceID) {
+			sourceString = group->sources[i].sourceString;
+			break;
 		}
+	}
 
-		state->packets.currPacket = NULL;
+	if (sourceString == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Source %" PRIi16 " not declared in file header, using the reader's source information.",
+			state->demux.sourceID);
+
+		sourceString = group->sources[0].sourceString;
 	}
 
-	// All good, get next buffer.
-	return (true);
-}
+	parseSourceString((char *) sourceString, state);
 
-/**
- * Parse the current buffer and try to extract the AEDAT 2.0
- * data contained within, to form a compliant AEDAT 3.1 packet,
- * and then update the packet meta-data list with it.
- *
- * @param state common input data structure.
- * @param chipID chip identifier to decide sizes, ordering and
- * features of the data stream for conversion to AEDAT 3.1.
- *
- * @return 0 on successful packet extraction.
- * Positive numbers for special conditions:
- * 1 if more data needed.
- * Negative numbers on error conditions:
- * -1 on memory allocation failure.
- */
-static int aedat2GetPacket(inputCommonState state, int16_t chipID) {
-	UNUSED_ARGUMENT(chipID);
+	group->companions[group->companionsSize++] = state;
 
-	// TODO: AEDAT 2.0 not yet supported.
-	caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Reading AEDAT 2.0 data not yet supported.");
-	return (-1);
+	atomic_store(&state->header.isValidHeader, true);
+
+	return (true);
 }
 
 /**
- * Parse the current buffer and try to extract the AEDAT 3.X
- * packet contained within, as well as updating the packet
- * meta-data list.
- *
- * @param state common input data structure.
- * @param isAEDAT30 change the X/Y coordinate origin for Frames and Polarity
- * events, as this changed from 3.0 (lower left) to 3.1 (upper left).
- *
- * @return 0 on successful packet extraction.
- * Positive numbers for special conditions:
- * 1 if more data needed.
- * 2 if skip requested (call again).
- * Negative numbers on error conditions:
- * -1 on memory allocation failure.
- * -2 on decompression failure.
+ * Join a demultiplexing group as its reader, the input actually reading the file.
+ * Must be called with the group lock held.
  */
-static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
-	simpleBuffer buf = state->dataBuffer;
+static bool demuxGroupJoinReader(inputCommonState state, inputDemuxGroup group) {
+	if (group->reader != NULL || group->members != 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Demultiplexing group '%s' already has a reader, or companions of a previous one.",
+			state->demux.groupName);
+		return (false);
+	}
 
-	// So now we're somewhere inside the buffer (usually at start), and want to
-	// read in a very long sequence of event packets.
-	// An event packet is made up of header + data, and the header contains the
-	// information needed to decode the data and its length, to know then where
-	// the next event packet boundary is. So we get the full header first, then
-	// the data, but careful, it can all be split across two (header+data) or
-	// more (data) buffers, so we need to reassemble!
-	size_t remainingData = buf->bufferUsedSize - buf->bufferPosition;
+	group->reader = state;
 
-	// First thing, handle skip packet requests. This can happen if packets
-	// from another source are mixed in, or we forbid some packet types.
-	// In that case, we just skip over all their bytes and try to get the next
-	// good packet (header).
-	if (state->packets.skipSize != 0) {
-		if (state->packets.skipSize >= remainingData) {
-			state->packets.skipSize -= remainingData;
+	return (true);
+}
 
-			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
-			return (1);
-		}
-		else {
-			buf->bufferPosition += state->packets.skipSize;
-			remainingData -= state->packets.skipSize;
-			state->packets.skipSize = 0; // Don't skip anymore, continue as usual.
-		}
+static bool demuxGroupJoin(inputCommonState state) {
+	char *stateName = groupStateName(DEMUX_GROUP_STATE_PREFIX, state->demux.groupName);
+	if (stateName == NULL) {
+		return (false);
 	}
 
-	// Get 28 bytes common packet header.
-	if (state->packets.currPacketHeaderSize != CAER_EVENT_PACKET_HEADER_SIZE) {
-		if (remainingData < CAER_EVENT_PACKET_HEADER_SIZE) {
-			// Reaching end of buffer, the header is split across two buffers!
-			memcpy(state->packets.currPacketHeader, buf->buffer + buf->bufferPosition, remainingData);
+	// The first input to use this name creates the group.
+	inputDemuxGroup group
+		= caerMainloopSharedStateAcquire(stateName, sizeof(struct input_common_demux_group), &demuxGroupInit);
+	if (group == NULL) {
+		free(stateName);
+		return (false);
+	}
 
-			state->packets.currPacketHeaderSize = remainingData;
+	mtx_lock(&group->lock);
 
-			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
-			return (1);
-		}
-		else {
-			// Either a full header, or the second part of one.
-			size_t dataToRead = CAER_EVENT_PACKET_HEADER_SIZE - state->packets.currPacketHeaderSize;
+	bool joined = (state->demux.isCompanion) ? (demuxGroupJoinCompanion(state, group))
+											 : (demuxGroupJoinReader(state, group));
+	if (joined) {
+		group->members++;
+	}
 
-			memcpy(state->packets.currPacketHeader + state->packets.currPacketHeaderSize,
-				buf->buffer + buf->bufferPosition, dataToRead);
+	mtx_unlock(&group->lock);
 
-			state->packets.currPacketHeaderSize += dataToRead;
-			buf->bufferPosition += dataToRead;
-			remainingData -= dataToRead;
-		}
+	if (!joined) {
+		caerMainloopSharedStateRelease(stateName, &demuxGroupDestroy);
+		free(stateName);
+		return (false);
+	}
 
-		// So now that we have a full header, let's look at it.
-		caerEventPacketHeader packet = (caerEventPacketHeader) state->packets.currPacketHeader;
+	state->demux.group     = group;
+	state->demux.stateName = stateName;
 
-		int16_t eventType     = caerEventPacketHeaderGetEventType(packet);
-		bool isCompressed     = (eventType & 0x8000);
-		int16_t eventSource   = caerEventPacketHeaderGetEventSource(packet);
-		int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(packet);
-		int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
-		int32_t eventValid    = caerEventPacketHeaderGetEventValid(packet);
-		int32_t eventSize     = caerEventPacketHeaderGetEventSize(packet);
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Joined demultiplexing group '%s' as %s.",
+		state->demux.groupName, (state->demux.isCompanion) ? ("companion") : ("reader"));
 
-		// First we verify that the source ID remained unique (only one source per I/O module supported!).
-		if (state->header.sourceID != eventSource) {
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-				"An input module can only handle packets from the same source! "
-				"A packet with source %" PRIi16
-				" was read, but this input module expects only packets from source %" PRIi16 ". "
-				"Discarding event packet.",
-				eventSource, state->header.sourceID);
+	return (true);
+}
 
-			// Skip packet. If packet is compressed, eventCapacity carries the size.
-			state->packets.skipSize = (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
-			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+static void demuxGroupLeave(inputCommonState state) {
+	inputDemuxGroup group = state->demux.group;
+	if (group == NULL) {
+		return;
+	}
 
-			// Run function again to skip data. bufferPosition is already up-to-date.
-			return (2);
+	// Taking the group lock guarantees the reader is not handing over a packet right now.
+	mtx_lock(&group->lock);
+
+	if (state->demux.isCompanion) {
+		for (size_t i = 0; i < group->companionsSize; i++) {
+			if (group->companions[i] == state) {
+				group->companions[i] = group->companions[--group->companionsSize];
+				break;
+			}
+		}
+	}
+	else {
+		// No more data will come, let companions finish up like on EOF.
+		for (size_t i = 0; i < group->companionsSize; i++) {
+			int_fast32_t readerOK = READER_OK;
+			atomic_compare_exchange_strong(&group->companions[i]->inputReaderThreadState, &readerOK, EOF_REACHED);
 		}
 
-		// If packet is compressed, eventCapacity carries the size in bytes to read.
-		state->packets.currPacketDataSize
-			= (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+		group->reader      = NULL;
+		group->headerReady = false;
+	}
 
-		// Allocate space for the full packet, so we can reassemble it (and decompress it later).
-		state->packets.currPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventNumber * eventSize));
-		if (state->packets.currPacket == NULL) {
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet.");
-			return (-1);
-		}
+	group->members--;
 
-		// First we copy the header in.
-		memcpy(state->packets.currPacket, state->packets.currPacketHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+	mtx_unlock(&group->lock);
 
-		state->packets.currPacketDataOffset = CAER_EVENT_PACKET_HEADER_SIZE;
+	// Last one out destroys the group.
+	caerMainloopSharedStateRelease(state->demux.stateName, &demuxGroupDestroy);
+
+	free(state->demux.stateName);
+	state->demux.stateName = NULL;
+
+	state->demux.group = NULL;
+}
+
+static void demuxGroupAddSource(inputCommonState state, int16_t sourceID, const char *sourceString) {
+	inputDemuxGroup group = state->demux.group;
+	if (group == NULL) {
+		return;
+	}
+
+	mtx_lock(&group->lock);
+
+	if (group->sourcesSize < DEMUX_MAX_SOURCES) {
+		struct input_common_demux_source *source = &group->sources[group->sourcesSize++];
+
+		source->sourceID = sourceID;
+		strncpy(source->sourceString, sourceString, MAX_HEADER_LINE_SIZE);
+		source->sourceString[MAX_HEADER_LINE_SIZE] = '\0';
+	}
+
+	mtx_unlock(&group->lock);
+}
+
+static void demuxGroupPublishHeader(inputCommonState state) {
+	inputDemuxGroup group = state->demux.group;
+	if (group == NULL) {
+		return;
+	}
+
+	mtx_lock(&group->lock);
+
+	group->isAEDAT3     = state->header.isAEDAT3;
+	group->majorVersion = state->header.majorVersion;
+	group->minorVersion = state->header.minorVersion;
+	group->formatID     = state->header.formatID;
+	group->headerReady  = true;
+
+	mtx_unlock(&group->lock);
+}
+
+static void demuxGroupWaitForCompanions(inputCommonState state) {
+	inputDemuxGroup group = state->demux.group;
+	if (group == NULL) {
+		return;
+	}
+
+	// Give companions, which can only join after the header is known, a moment to do so,
+	// before data starts flowing. Else they'd miss the start of the file. Wait until every
+	// other source declared in the header has one, or at most one second.
+	for (size_t i = 0; i < 1000 && atomic_load_explicit(&state->running, memory_order_relaxed); i++) {
+		mtx_lock(&group->lock);
+		bool allJoined = (group->companionsSize > 0) && ((group->companionsSize + 1) >= group->sourcesSize);
+		mtx_unlock(&group->lock);
+
+		if (allJoined) {
+			break;
+		}
+
+		// Delay by 1 ms if no change, to avoid a wasteful busy loop.
+		struct timespec waitSleep = {.tv_sec = 0, .tv_nsec = 1000000};
+		thrd_sleep(&waitSleep, NULL);
+	}
+}
+
+static bool demuxGroupHasSource(inputCommonState state, int16_t sourceID) {
+	inputDemuxGroup group = state->demux.group;
+	if (group == NULL) {
+		return (false);
+	}
+
+	bool found = false;
+
+	mtx_lock(&group->lock);
+
+	for (size_t i = 0; i < group->companionsSize; i++) {
+		if (group->companions[i]->demux.sourceID == sourceID) {
+			found = true;
+			break;
+		}
+	}
+
+	mtx_unlock(&group->lock);
+
+	return (found);
+}
+
+/**
+ * Hand over a packet from another source to the companion input
+ * handling that source, which then assembles and outputs it.
+ * Packet ownership is always transferred, it is freed if no
+ * companion can take it (anymore).
+ *
+ * @param state common input data structure of the reader.
+ * @param packet event packet to hand over.
+ * @param sourceID original source ID of the packet.
+ *
+ * @return false if the reader was stopped, true otherwise.
+ */
+static bool demuxGroupSendPacket(inputCommonState state, caerEventPacketHeader packet, int16_t sourceID) {
+	inputDemuxGroup group = state->demux.group;
+
+	mtx_lock(&group->lock);
+
+	inputCommonState companion = NULL;
+
+	for (size_t i = 0; i < group->companionsSize; i++) {
+		if (group->companions[i]->demux.sourceID == sourceID) {
+			companion = group->companions[i];
+			break;
+		}
+	}
+
+	bool delivered = false;
+
+	if (companion != NULL) {
+		// Rewrite event source to reflect the companion module.
+		caerEventPacketHeaderSetEventSource(packet, I16T(companion->parentModule->moduleID));
+
+		// Same as sendPacketToAssembler(), but either side may go away.
+		while (atomic_load_explicit(&state->running, memory_order_relaxed)
+			   && atomic_load_explicit(&companion->running, memory_order_relaxed)) {
+			if (caerRingBufferPut(companion->transferRingPackets, packet)) {
+				delivered = true;
+				break;
+			}
+
+			// Delay by 10 µs if no change, to avoid a wasteful busy loop.
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 10000};
+			thrd_sleep(&retrySleep, NULL);
+		}
+	}
+
+	mtx_unlock(&group->lock);
+
+	if (!delivered) {
+		free(packet);
+	}
+
+	return (atomic_load_explicit(&state->running, memory_order_relaxed));
+}
+
+static caerEventPacketHeader allocateTSResetPacket(int16_t sourceID, int32_t tsOverflow) {
+	caerSpecialEventPacket tsResetPacket = caerSpecialEventPacketAllocate(1, sourceID, tsOverflow);
+	if (tsResetPacket == NULL) {
+		return (NULL);
+	}
+
+	caerSpecialEvent tsResetEvent = caerSpecialEventPacketGetEvent(tsResetPacket, 0);
+	caerSpecialEventSetTimestamp(tsResetEvent, INT32_MAX);
+	caerSpecialEventSetType(tsResetEvent, TIMESTAMP_RESET);
+	caerSpecialEventValidate(tsResetEvent, tsResetPacket);
+
+	return ((caerEventPacketHeader) tsResetPacket);
+}
+
+static bool sendPacketToAssembler(inputCommonState state, caerEventPacketHeader packet) {
+	while (!caerRingBufferPut(state->transferRingPackets, packet)) {
+		// We ensure all read packets are sent to the Assembler stage.
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			return (false);
+		}
+
+		// Delay by 10 µs if no change, to avoid a wasteful busy loop.
+		struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 10000};
+		thrd_sleep(&retrySleep, NULL);
+	}
+
+	return (true);
+}
+
+static bool sendTSResetPacket(inputCommonState state) {
+	// Same tsOverflow as the last packet, so that the Assembler doesn't see this
+	// as going back in time, and handles it via its usual timestamp reset logic.
+	int32_t tsOverflow = I32T(state->packets.lastTimestamp >> TS_OVERFLOW_SHIFT);
+
+	state->packets.lastTimestamp        = 0;
+	state->packets.streamTimestampsSize = 0;
+
+	// Demultiplexed sources restart their timeline too.
+	if (state->demux.group != NULL) {
+		int16_t companionSources[DEMUX_MAX_SOURCES];
+		size_t companionsSize = 0;
+
+		mtx_lock(&state->demux.group->lock);
+
+		for (size_t i = 0; i < state->demux.group->companionsSize; i++) {
+			companionSources[companionsSize++] = state->demux.group->companions[i]->demux.sourceID;
+		}
+
+		mtx_unlock(&state->demux.group->lock);
+
+		// Event source is set to the right companion on hand-over.
+		for (size_t i = 0; i < companionsSize; i++) {
+			caerEventPacketHeader tsResetPacket = allocateTSResetPacket(0, tsOverflow);
+
+			if (tsResetPacket != NULL && !demuxGroupSendPacket(state, tsResetPacket, companionSources[i])) {
+				return (false);
+			}
+		}
+	}
+
+	caerEventPacketHeader tsResetPacket = allocateTSResetPacket(I16T(state->parentModule->moduleID), tsOverflow);
+	if (tsResetPacket == NULL) {
+		// Not fatal, the Assembler will drop the out-of-order packets instead.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate file boundary tsReset packet.");
+		return (true);
+	}
+
+	if (!sendPacketToAssembler(state, tsResetPacket)) {
+		free(tsResetPacket);
+		return (false);
+	}
+
+	return (true);
+}
+
+/**
+ * Get the highest first timestamp seen so far for packets of the given
+ * source and event type. Packets of different types are only loosely
+ * ordered, so for one not seen yet, the oldest of the timestamps of all
+ * other types and sources is returned instead, or 'notFound' if there
+ * are none at all.
+ */
+static int64_t streamTimestampGet(inputCommonState state, int16_t sourceID, int16_t eventType, int64_t notFound) {
+	int64_t oldestTimestamp = notFound;
+
+	for (size_t i = 0; i < state->packets.streamTimestampsSize; i++) {
+		struct input_common_stream_timestamp *streamTS = &state->packets.streamTimestamps[i];
+
+		if (streamTS->sourceID == sourceID && streamTS->eventType == eventType) {
+			return (streamTS->timestamp);
+		}
+
+		if (i == 0 || streamTS->timestamp < oldestTimestamp) {
+			oldestTimestamp = streamTS->timestamp;
+		}
+	}
+
+	return (oldestTimestamp);
+}
+
+static void streamTimestampUpdate(inputCommonState state, int16_t sourceID, int16_t eventType, int64_t timestamp) {
+	for (size_t i = 0; i < state->packets.streamTimestampsSize; i++) {
+		struct input_common_stream_timestamp *streamTS = &state->packets.streamTimestamps[i];
+
+		if (streamTS->sourceID == sourceID && streamTS->eventType == eventType) {
+			if (timestamp > streamTS->timestamp) {
+				streamTS->timestamp = timestamp;
+			}
+
+			return;
+		}
+	}
+
+	// New source and type combination. If there are too many, the
+	// ones not tracked fall back to the oldest timestamp of the others.
+	if (state->packets.streamTimestampsSize < INPUT_MAX_STREAM_TIMESTAMPS) {
+		struct input_common_stream_timestamp *streamTS
+			= &state->packets.streamTimestamps[state->packets.streamTimestampsSize++];
+
+		streamTS->sourceID  = sourceID;
+		streamTS->eventType = eventType;
+		streamTS->timestamp = timestamp;
+	}
+}
+
+static bool parseData(inputCommonState state) {
+	while (state->dataBuffer->bufferPosition < state->dataBuffer->bufferUsedSize) {
+		int pRes = -1;
+
+		// Try getting packet and packetData from buffer.
+		if (state->header.majorVersion == 2 && state->header.minorVersion == 0) {
+			pRes = aedat2GetPacket(state, 0);
+		}
+		else if (state->header.majorVersion == 3) {
+			pRes = aedat3GetPacket(state, (state->header.minorVersion == 0));
+		}
+		else {
+			// No parseable format found!
+			return (false);
+		}
+
+		// Check packet parser return value.
+		if (pRes < 0) {
+			// Error in parsing buffer to get packet.
+			return (false);
+		}
+		else if (pRes == 1) {
+			// Finished parsing this buffer with no new packet.
+			// Exit to get next buffer.
+			break;
+		}
+		else if (pRes == 2) {
+			// Skip requested, run again.
+			continue;
+		}
+
+		caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+			"New packet read - ID: %zu, Offset: %zu, Size: %zu, Events: %" PRIi32 ", Type: %" PRIi16
+			", StartTS: %" PRIi64 ", EndTS: %" PRIi64 ".",
+			state->packets.currPacketData->id, state->packets.currPacketData->offset,
+			state->packets.currPacketData->size, state->packets.currPacketData->eventNumber,
+			state->packets.currPacketData->eventType, state->packets.currPacketData->startTimestamp,
+			state->packets.currPacketData->endTimestamp);
+
+		// New packet information, add it to the global packet info list.
+		// This is done here to prevent ambiguity about the ownership of the involved memory block:
+		// it either is inside the global list with state->packets.currPacketData NULL, or it is not
+		// in the list, but in state->packets.currPacketData itself. So if, on exit, we clear both,
+		// we'll free all the memory and have no fear of a double-free happening.
+		DL_APPEND(state->packets.packetsList, state->packets.currPacketData);
+		state->packets.currPacketData = NULL;
+
+		// Crossing into the next file of a playlist, or reconnecting: if time goes backwards,
+		// the new stream restarted its timestamps, so we signal that to the Assembler via a reset.
+		// Compare with the last packet of the same source and type: the first timestamps of
+		// packets of different types can legitimately be out of order at the boundary.
+		int64_t packetTimestamp = caerGenericEventGetTimestamp64(
+			caerGenericEventGetEvent(state->packets.currPacket, 0), state->packets.currPacket);
+		int16_t packetType = caerEventPacketHeaderGetEventType(state->packets.currPacket);
+
+		if (state->packets.streamRestart) {
+			state->packets.streamRestart = false;
+
+			int64_t previousTimestamp
+				= streamTimestampGet(state, state->demux.currPacketSourceID, packetType, packetTimestamp);
+
+			if (packetTimestamp < previousTimestamp) {
+				state->statistics.timestampResets++;
+
+				if (!sendTSResetPacket(state)) {
+					// On normal termination, just return without errors.
+					return (true);
+				}
+			}
+			else {
+				state->statistics.gapTime += U64T(packetTimestamp - previousTimestamp);
+			}
+		}
+
+		if (packetTimestamp > state->packets.lastTimestamp) {
+			state->packets.lastTimestamp = packetTimestamp;
+		}
+
+		streamTimestampUpdate(state, state->demux.currPacketSourceID, packetType, packetTimestamp);
+
+		// Packets from other sources go to the companion input handling them.
+		if (state->demux.currPacketSourceID != state->header.sourceID) {
+			caerEventPacketHeader demuxPacket = state->packets.currPacket;
+			state->packets.currPacket         = NULL;
+
+			if (!demuxGroupSendPacket(state, demuxPacket, state->demux.currPacketSourceID)) {
+				// On normal termination, just return without errors.
+				return (true);
+			}
+
+			continue;
+		}
+
+		// New packet from stream, send it off to the input assembler thread. Same memory
+		// related considerations as above for state->packets.currPacketData apply here too!
+		if (!sendPacketToAssembler(state, state->packets.currPacket)) {
+			// On normal termination, just return without errors. The Reader thread
+			// will then also exit without errors and clean up in Exit().
+			return (true);
+		}
+
+		state->packets.currPacket = NULL;
+	}
+
+	// All good, get next buffer.
+	return (true);
+}
+
+/**
+ * Parse the current buffer and try to extract the AEDAT 2.0
+ * data contained within, to form a compliant AEDAT 3.1 packet,
+ * and then update the packet meta-data list with it.
+ *
+ * @param state common input data structure.
+ * @param chipID chip identifier to decide sizes, ordering and
+ * features of the data stream for conversion to AEDAT 3.1.
+ *
+ * @return 0 on successful packet extraction.
+ * Positive numbers for special conditions:
+ * 1 if more data needed.
+ * Negative numbers on error conditions:
+ * -1 on memory allocation failure.
+ */
+static int aedat2GetPacket(inputCommonState state, int16_t chipID) {
+	UNUSED_ARGUMENT(chipID);
+
+	// TODO: AEDAT 2.0 not yet supported.
+	caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Reading AEDAT 2.0 data not yet supported.");
+	return (-1);
+}
+
+/**
+ * Parse the current buffer and try to extract the AEDAT 3.X
+ * packet contained within, as well as updating the packet
+ * meta-data list.
+ *
+ * @param state common input data structure.
+ * @param isAEDAT30 change the X/Y coordinate origin for Frames and Polarity
+ * events, as this changed from 3.0 (lower left) to 3.1 (upper left).
+ *
+ * @return 0 on successful packet extraction.
+ * Positive numbers for special conditions:
+ * 1 if more data needed.
+ * 2 if skip requested (call again).
+ * Negative numbers on error conditions:
+ * -1 on memory allocation failure.
+ * -2 on decompression failure.
+ */
+static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
+	simpleBuffer buf = state->dataBuffer;
+
+	// So now we're somewhere inside the buffer (usually at start), and want to
+	// read in a very long sequence of event packets.
+	// An event packet is made up of header + data, and the header contains the
+	// information needed to decode the data and its length, to know then where
+	// the next event packet boundary is. So we get the full header first, then
+	// the data, but careful, it can all be split across two (header+data) or
+	// more (data) buffers, so we need to reassemble!
+	size_t remainingData = buf->bufferUsedSize - buf->bufferPosition;
+
+	// First thing, handle skip packet requests. This can happen if packets
+	// from another source are mixed in, or we forbid some packet types.
+	// In that case, we just skip over all their bytes and try to get the next
+	// good packet (header).
+	if (state->packets.skipSize != 0) {
+		if (state->packets.skipSize >= remainingData) {
+			state->packets.skipSize -= remainingData;
+
+			// Go and get next buffer. bufferPosition is at end of buffer.
+			buf->bufferPosition += remainingData;
+			return (1);
+		}
+		else {
+			buf->bufferPosition += state->packets.skipSize;
+			remainingData -= state->packets.skipSize;
+			state->packets.skipSize = 0; // Don't skip anymore, continue as usual.
+		}
+	}
+
+	// Get 28 bytes common packet header.
+	if (state->packets.currPacketHeaderSize != CAER_EVENT_PACKET_HEADER_SIZE) {
+		if (remainingData < CAER_EVENT_PACKET_HEADER_SIZE) {
+			// Reaching end of buffer, the header is split across two buffers!
+			memcpy(state->packets.currPacketHeader, buf->buffer + buf->bufferPosition, remainingData);
+
+			state->packets.currPacketHeaderSize = remainingData;
+
+			// Go and get next buffer. bufferPosition is at end of buffer.
+			buf->bufferPosition += remainingData;
+			return (1);
+		}
+		else {
+			// Either a full header, or the second part of one.
+			size_t dataToRead = CAER_EVENT_PACKET_HEADER_SIZE - state->packets.currPacketHeaderSize;
+
+			memcpy(state->packets.currPacketHeader + state->packets.currPacketHeaderSize,
+				buf->buffer + buf->bufferPosition, dataToRead);
+
+			state->packets.currPacketHeaderSize += dataToRead;
+			buf->bufferPosition += dataToRead;
+			remainingData -= dataToRead;
+		}
+
+		// So now that we have a full header, let's look at it.
+		caerEventPacketHeader packet = (caerEventPacketHeader) state->packets.currPacketHeader;
+
+		int16_t eventType     = caerEventPacketHeaderGetEventType(packet);
+		bool isCompressed     = (eventType & 0x8000);
+		int16_t eventSource   = caerEventPacketHeaderGetEventSource(packet);
+		int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(packet);
+		int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
+		int32_t eventValid    = caerEventPacketHeaderGetEventValid(packet);
+		int32_t eventSize     = caerEventPacketHeaderGetEventSize(packet);
+
+		// Segmented recordings end with an index, only useful for seeking. Skip it quietly.
+		if ((eventSource == INOUT_INDEX_PACKET_SOURCE) && (eventType == INOUT_INDEX_PACKET_TYPE)) {
+			state->packets.skipSize             = (size_t)(eventNumber * eventSize);
+			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+
+			// Run function again to skip data. bufferPosition is already up-to-date.
+			return (2);
+		}
+
+		// First we verify that the source ID remained unique (only one source per I/O module supported!).
+		// Packets from other sources are only kept when demultiplexing, for the companion handling them.
+		if ((state->header.sourceID != eventSource) && !demuxGroupHasSource(state, eventSource)) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"An input module can only handle packets from the same source! "
+				"A packet with source %" PRIi16
+				" was read, but this input module expects only packets from source %" PRIi16 ". "
+				"Discarding event packet.",
+				eventSource, state->header.sourceID);
+
+			// Skip packet. If packet is compressed, eventCapacity carries the size.
+			state->packets.skipSize = (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+
+			// Run function again to skip data. bufferPosition is already up-to-date.
+			return (2);
+		}
+
+		state->demux.currPacketSourceID = eventSource;
+
+		// If packet is compressed, eventCapacity carries the size in bytes to read.
+		state->packets.currPacketDataSize
+			= (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+
+		// Allocate space for the full packet, so we can reassemble it (and decompress it later).
+		state->packets.currPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventNumber * eventSize));
+		if (state->packets.currPacket == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet.");
+			return (-1);
+		}
+
+		// First we copy the header in.
+		memcpy(state->packets.currPacket, state->packets.currPacketHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+
+		state->packets.currPacketDataOffset = CAER_EVENT_PACKET_HEADER_SIZE;
 
 		// Rewrite event source to reflect this module, not the original one.
 		caerEventPacketHeaderSetEventSource(state->packets.currPacket, I16T(state->parentModule->moduleID));
@@ -1053,7 +1717,7 @@ static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader pac
 	}
 
 	// Now move memory and decompress in reverse order.
-	for (int32_t i = eventNumber; i >= 0; i--) {
+	for (int32_t i = eventNumber - 1; i >= 0; i--) {
 		// Move memory from compressed position to uncompressed, in-memory position.
 		memmove(((uint8_t *) packet) + eventMemory[i].offsetDestination, ((uint8_t *) packet) + eventMemory[i].offset,
 			eventMemory[i].size);
@@ -1103,126 +1767,598 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 	int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
 	int32_t eventTSOffset = caerEventPacketHeaderGetEventTSOffset(packet);
 
-	uint8_t *events = malloc((size_t)(eventNumber * eventSize));
-	if (events == NULL) {
-		// Memory allocation failure.
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-			"Failed to decode serialized timestamp. "
-			"Memory allocation failure.");
-		return (false);
+	uint8_t *events = malloc((size_t)(eventNumber * eventSize));
+	if (events == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode serialized timestamp. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	// Start after the header, no change to it. See inout_serialized_ts.h for the decoder.
+	if (!caerSerializedTSDecode(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE,
+			packetSize - CAER_EVENT_PACKET_HEADER_SIZE, events, (size_t) eventNumber, (size_t) eventSize,
+			(size_t) eventTSOffset)) {
+		free(events);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode serialized timestamp. "
+			"Length of compressed data and number of recovered events don't match.");
+		return (false);
+	}
+
+	// Copy recovered event packet into original.
+	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, events, (size_t)(eventNumber * eventSize));
+
+	free(events);
+
+	return (true);
+}
+
+static bool decompressPolarityDelta(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	int32_t eventSize   = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	if (eventSize != (int32_t) sizeof(struct caer_polarity_event)) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode polarity delta. Unexpected event size %" PRIi32 ".", eventSize);
+		return (false);
+	}
+
+	// The encoded data is smaller than the events, so it has to be moved out of the
+	// way first; the packet itself has already been allocated for all events.
+	size_t encodedSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	uint8_t *encodedData = malloc(encodedSize);
+	if (encodedData == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode polarity delta. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	memcpy(encodedData, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, encodedSize);
+
+	// Start after the header, no change to it. See inout_polarity_delta.h for the decoder.
+	bool decoded = caerPolarityDeltaDecode(
+		((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, (size_t) eventNumber, encodedData, encodedSize);
+
+	free(encodedData);
+
+	if (!decoded) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode polarity delta. "
+			"Length of compressed data and number of recovered events don't match.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static bool decompressFramesFast(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	// Delta frames need the previous frame with the same source and ROI decoded first,
+	// so unlike PNG frames, decoding has to go forward. The compressed data is moved out
+	// of the way first, and frames are then decoded directly to their in-memory position.
+	int32_t eventSize   = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	// When demultiplexing, packets of all sources are decoded here, and each
+	// source numbers the frames of its ROIs on its own.
+	struct caer_frame_codec_reference *references = caerFrameCodecSourceReferences(
+		&state->frameReferences, &state->frameReferencesSize, caerEventPacketHeaderGetEventSource(packet));
+	if (references == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress frame event. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	size_t compressedSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	uint8_t *compressedData = malloc(compressedSize);
+	if (compressedData == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress frame event. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	memcpy(compressedData, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, compressedSize);
+
+	size_t currOffset = 0;
+	// '- sizeof(uint16_t)' to compensate for pixels[1] at end of struct for C++ compatibility.
+	size_t frameEventHeaderSize = (sizeof(struct caer_frame_event) - sizeof(uint16_t));
+
+	for (int32_t i = 0; i < eventNumber; i++) {
+		if ((compressedSize - currOffset) < frameEventHeaderSize) {
+			free(compressedData);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to decompress frame event. "
+				"Size after event parsing and packet size don't match.");
+			return (false);
+		}
+
+		caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE
+													 + (size_t)(i * eventSize));
+
+		memcpy(frameEvent, compressedData + currOffset, frameEventHeaderSize);
+		currOffset += frameEventHeaderSize;
+
+		size_t pixelSize = caerFrameEventGetPixelsSize(frameEvent);
+
+		if ((frameEventHeaderSize + pixelSize) > (size_t) eventSize) {
+			free(compressedData);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to decompress frame event. "
+				"Frame size exceeds event size.");
+			return (false);
+		}
+
+		// Bit 31 of info signals if event is compressed or not.
+		if (GET_NUMBITS32(frameEvent->info, 31, 0x01)) {
+			// Clear compression enabled bit.
+			CLEAR_NUMBITS32(frameEvent->info, 31, 0x01);
+
+			// Compressed block size is held in an integer right after the header.
+			int32_t encodedSize = 0;
+			if ((compressedSize - currOffset) >= sizeof(int32_t)) {
+				memcpy(&encodedSize, compressedData + currOffset, sizeof(int32_t));
+				encodedSize = le32toh(encodedSize);
+				currOffset += sizeof(int32_t);
+			}
+
+			if (encodedSize <= 0 || (compressedSize - currOffset) < (size_t) encodedSize) {
+				free(compressedData);
+
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to decompress frame event. "
+					"Size after event parsing and packet size don't match.");
+				return (false);
+			}
+
+			enum caer_frame_codec_result result = caerFrameCodecDecode(caerFrameEventGetPixelArrayUnsafe(frameEvent),
+				caerFrameEventGetLengthX(frameEvent), caerFrameEventGetLengthY(frameEvent),
+				(int32_t) caerFrameEventGetChannelNumber(frameEvent), compressedData + currOffset,
+				(size_t) encodedSize, &references[caerFrameEventGetROIIdentifier(frameEvent)]);
+
+			if (result == FRAME_CODEC_MALFORMED) {
+				free(compressedData);
+
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to decompress frame event. "
+					"Malformed compressed frame.");
+				return (false);
+			}
+
+			if (result == FRAME_CODEC_NO_REFERENCE) {
+				// Joined the stream late or lost data: can't recover this frame until
+				// the next key frame. Not fatal, blank and invalidate it.
+				memset(caerFrameEventGetPixelArrayUnsafe(frameEvent), 0, pixelSize);
+
+				if (caerGenericEventIsValid(frameEvent)) {
+					caerFrameEventInvalidate(frameEvent, (caerFrameEventPacket) packet);
+				}
+
+				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+					"Delta frame without reference frame, invalidated until next key frame.");
+			}
+
+			currOffset += (size_t) encodedSize;
+		}
+		else {
+			// Normal size is uncompressed pixels.
+			if ((compressedSize - currOffset) < pixelSize) {
+				free(compressedData);
+
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to decompress frame event. "
+					"Size after event parsing and packet size don't match.");
+				return (false);
+			}
+
+			memcpy(caerFrameEventGetPixelArrayUnsafe(frameEvent), compressedData + currOffset, pixelSize);
+			currOffset += pixelSize;
+		}
+
+		// Initialize the rest of the memory of the event to zeros, to comply with spec
+		// that says non-pixels at the end, if they exist, are always zero.
+		memset(((uint8_t *) frameEvent) + frameEventHeaderSize + pixelSize, 0,
+			(size_t) eventSize - frameEventHeaderSize - pixelSize);
+	}
+
+	free(compressedData);
+
+	// Check that we indeed parsed everything correctly.
+	if (currOffset != compressedSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress frame event. "
+			"Size after event parsing and packet size don't match.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	bool retVal = false;
+
+	// Data compression technique 1: serialized timestamps.
+	// Data compression technique 3: polarity delta coding. Takes precedence over technique 1.
+	if ((state->header.formatID & 0x04) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+		retVal = decompressPolarityDelta(state, packet, packetSize);
+	}
+	else if ((state->header.formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+		retVal = decompressTimestampSerialize(state, packet, packetSize);
+	}
+	// Data compression technique 5: fast frame codec. Takes precedence over technique 2.
+	else if ((state->header.formatID & 0x20) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+		retVal = decompressFramesFast(state, packet, packetSize);
+	}
+	// Data compression technique 2: frame PNG compression.
+	else if ((state->header.formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+		retVal = decompressFramePNG(state, packet, packetSize);
+#endif
+	}
+	// Data compression technique 4: general-purpose compression, all other packets.
+	else if (state->header.formatID & 0x08) {
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+		retVal = decompressPacketLZ4(state, packet, packetSize);
+#else
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "LZ4 packet decompression not supported by this build.");
+#endif
+	}
+	else if (state->header.formatID & 0x10) {
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+		retVal = decompressPacketZstd(state, packet, packetSize);
+#else
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Zstd packet decompression not supported by this build.");
+#endif
+	}
+
+	return (retVal);
+}
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+
+static bool decompressPacketLZ4(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	size_t dataSize
+		= (size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet));
+	size_t compressedSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	// The packet has been allocated for all events, but the compressed data
+	// is at its start, so it has to be moved out of the way first.
+	uint8_t *compressedData = malloc(compressedSize);
+	if (compressedData == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress LZ4 packet. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	memcpy(compressedData, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, compressedSize);
+
+	bool decompressed = caerPacketDecompressLZ4(
+		((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, dataSize, compressedData, compressedSize);
+
+	free(compressedData);
+
+	if (!decompressed) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress LZ4 packet. "
+			"Length of decompressed data and number of events don't match.");
+		return (false);
+	}
+
+	return (true);
+}
+
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+
+static bool decompressPacketZstd(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	if (state->zstdContext == NULL) {
+		state->zstdContext = ZSTD_createDCtx();
+		if (state->zstdContext == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to decompress Zstd packet. "
+				"Failed to create decompression context.");
+			return (false);
+		}
+
+		// Load the dictionary the output used, if any. Only done once.
+		char *dictionaryPath = sshsNodeGetString(state->parentModule->moduleNode, "compressPacketsDictionary");
+
+		if (!caerStrEquals(dictionaryPath, "")) {
+			size_t dictionarySize;
+			uint8_t *dictionary = caerInOutReadFile(dictionaryPath, &dictionarySize);
+
+			if (dictionary != NULL) {
+				// The dictionary content is copied, so it can be freed right away.
+				state->zstdDictionary = ZSTD_createDDict(dictionary, dictionarySize);
+				free(dictionary);
+			}
+
+			if (state->zstdDictionary == NULL) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to load Zstd dictionary '%s', decompressing without it.", dictionaryPath);
+			}
+		}
+
+		free(dictionaryPath);
+	}
+
+	size_t dataSize
+		= (size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet));
+	size_t compressedSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	// The packet has been allocated for all events, but the compressed data
+	// is at its start, so it has to be moved out of the way first.
+	uint8_t *compressedData = malloc(compressedSize);
+	if (compressedData == NULL) {
+		// Memory allocation failure.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress Zstd packet. "
+			"Memory allocation failure.");
+		return (false);
+	}
+
+	memcpy(compressedData, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, compressedSize);
+
+	const char *errorName = NULL;
+	bool decompressed = caerPacketDecompressZstd(state->zstdContext, state->zstdDictionary,
+		((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, dataSize, compressedData, compressedSize, &errorName);
+
+	free(compressedData);
+
+	if (errorName != NULL) {
+		caerModuleLog(
+			state->parentModule, CAER_LOG_ERROR, "Failed to decompress Zstd packet. Error: %s.", errorName);
+		return (false);
+	}
+
+	if (!decompressed) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress Zstd packet. "
+			"Length of decompressed data and number of events don't match.");
+		return (false);
+	}
+
+	return (true);
+}
+
+#endif
+
+static bool prefetchFile(inputCommonState state, size_t fileIndex) {
+	const char *filePath = state->playlist.files[fileIndex];
+
+	int fileFd = (state->playlist.openFile != NULL) ? (state->playlist.openFile(state->parentModule, filePath))
+													  : (open(filePath, O_RDONLY));
+	if (fileFd < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Could not open playlist file '%s' for reading, skipping it. Error: %d.", filePath, errno);
+		return (false);
+	}
+
+	// Same sizing rules as newInputBuffer().
+	size_t bufferSize = (size_t) sshsNodeGetInt(state->parentModule->moduleNode, "bufferSize");
+	if (bufferSize < 512) {
+		bufferSize = 512;
+	}
+
+	simpleBuffer buffer = simpleBufferInit(bufferSize);
+	if (buffer == NULL) {
+		close(fileFd);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate data buffer for playlist file '%s', skipping it.", filePath);
+		return (false);
+	}
+
+	ssize_t result = readUntilDone(fileFd, buffer->buffer, buffer->bufferSize);
+	if (result <= 0) {
+		close(fileFd);
+		free(buffer);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Playlist file '%s' is empty or unreadable, skipping it.", filePath);
+		return (false);
+	}
+	buffer->bufferUsedSize = (size_t) result;
+
+	struct input_common_header_info *header = &state->playlist.nextHeader;
+	atomic_store(&header->isValidHeader, false);
+	header->isAEDAT3     = false;
+	header->majorVersion = 0;
+	header->minorVersion = 0;
+	header->formatID     = 0;
+	header->sourceID     = 0;
+
+	if (!parseFileHeader(state, buffer, header, false)) {
+		close(fileFd);
+		free(buffer);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to parse header of playlist file '%s', skipping it.", filePath);
+		return (false);
+	}
+
+	state->playlist.nextFileDescriptor = fileFd;
+	state->playlist.nextDataBuffer     = buffer;
+	state->playlist.nextFileIndex      = fileIndex;
+
+	caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Prefetched playlist file '%s'.", filePath);
+
+	return (true);
+}
+
+static int inputPrefetchThread(void *stateArg) {
+	inputCommonState state = stateArg;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 10]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Prefetch]");
+	portable_thread_set_name(threadName);
+
+	mtx_lock(&state->playlist.lock);
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		// Wait for the reader to pick up the already prefetched file.
+		if (state->playlist.nextReady) {
+			cnd_wait(&state->playlist.changed, &state->playlist.lock);
+			continue;
+		}
+
+		if (state->playlist.prefetchIndex >= state->playlist.filesSize) {
+			// Nothing left to prefetch.
+			state->playlist.prefetchDone = true;
+			cnd_broadcast(&state->playlist.changed);
+			break;
+		}
+
+		mtx_unlock(&state->playlist.lock);
+
+		// Files that can't be opened or parsed are skipped.
+		bool prefetched = prefetchFile(state, state->playlist.prefetchIndex++);
+
+		mtx_lock(&state->playlist.lock);
+
+		if (prefetched) {
+			state->playlist.nextReady = true;
+			cnd_broadcast(&state->playlist.changed);
+		}
 	}
 
-	size_t currPacketOffset        = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
-	size_t recoveredEventsPosition = 0;
-	size_t recoveredEventsNumber   = 0;
+	mtx_unlock(&state->playlist.lock);
+
+	return (thrd_success);
+}
+
+static void discardPartialPacket(inputCommonState state) {
+	// Discard any packet left incomplete at the end of the previous file or connection.
+	if (state->packets.currPacketHeaderSize != 0 || state->packets.currPacket != NULL
+		|| state->packets.skipSize != 0) {
+		caerModuleLog(
+			state->parentModule, CAER_LOG_WARNING, "Stream ended with an incomplete event packet, discarding it.");
+	}
 
-	while (currPacketOffset < packetSize) {
-		void *firstEvent = ((uint8_t *) packet) + currPacketOffset;
-		int32_t currTS   = caerGenericEventGetTimestamp(firstEvent, packet);
+	free(state->packets.currPacket);
+	state->packets.currPacket = NULL;
+	free(state->packets.currPacketData);
+	state->packets.currPacketData = NULL;
 
-		if (currTS & I32T(0x80000000)) {
-			// Compressed run starts here! Must clear the compression bit from
-			// this first timestamp and restore the timestamp to the others.
-			// So first we clean the timestamp.
-			currTS &= I32T(0x7FFFFFFF);
+	state->packets.currPacketHeaderSize = 0;
+	state->packets.skipSize             = 0;
+}
 
-			// Then we fix the first event timestamp and copy it over.
-			caerGenericEventSetTimestamp(firstEvent, packet, currTS);
-			memcpy(events + recoveredEventsPosition, firstEvent, (size_t) eventSize);
+static bool reconnectStream(inputCommonState state) {
+	if (state->reconnect.connect == NULL
+		|| !atomic_load_explicit(&state->reconnect.autoReconnect, memory_order_relaxed)) {
+		return (false);
+	}
 
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
+	caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Lost connection, trying to reconnect.");
 
-			// Then we get the second event, and get its timestamp, which is
-			// actually the size of the following compressed run.
-			void *secondEvent = ((uint8_t *) packet) + currPacketOffset;
-			int32_t tsRun     = caerGenericEventGetTimestamp(secondEvent, packet);
+	discardPartialPacket(state);
 
-			// And fix its own timestamp back to what it should be, and copy it.
-			caerGenericEventSetTimestamp(secondEvent, packet, currTS);
-			memcpy(events + recoveredEventsPosition, secondEvent, (size_t) eventSize);
+	int64_t retryDelay = atomic_load_explicit(&state->reconnect.minDelay, memory_order_relaxed);
 
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		// Wait for retryDelay ms, but in small steps to quickly notice shutdown.
+		for (int64_t waited = 0; waited < retryDelay; waited += 10) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				return (false);
+			}
 
-			// Now go through the compressed, data-only events, and restore their
-			// timestamp. We do this by copying the data and then adding the timestamp,
-			// which is always the last in an event.
-			while (tsRun > 0) {
-				void *thirdEvent = ((uint8_t *) packet) + currPacketOffset;
-				memcpy(events + recoveredEventsPosition, thirdEvent, (size_t) eventTSOffset);
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 10000000};
+			thrd_sleep(&retrySleep, NULL);
+		}
 
-				currPacketOffset += (size_t) eventTSOffset;
-				recoveredEventsPosition += (size_t) eventTSOffset;
+		int newFd = state->reconnect.connect(state->parentModule);
+		if (newFd >= 0) {
+			state->fileDescriptor = newFd;
 
-				int32_t *newTS = (int32_t *) (events + recoveredEventsPosition);
-				*newTS         = currTS;
+			// New connection, new network header, possibly new timeline.
+			state->reconnect.headerPending = true;
+			state->packets.streamRestart   = true;
 
-				recoveredEventsPosition += sizeof(int32_t);
+			state->statistics.reconnects++;
+			sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "reconnects", SSHS_LONG,
+				(union sshs_node_attr_value){.ilong = I64T(state->statistics.reconnects)});
 
-				recoveredEventsNumber++;
-				tsRun--;
-			}
+			caerModuleLog(state->parentModule, CAER_LOG_INFO, "Reconnected successfully, resuming stream.");
+			return (true);
 		}
-		else {
-			// Normal event, nothing compressed.
-			// Just copy and advance.
-			memcpy(events + recoveredEventsPosition, firstEvent, (size_t) eventSize);
 
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
+		// Exponential backoff.
+		retryDelay *= 2;
+
+		int64_t maxDelay = atomic_load_explicit(&state->reconnect.maxDelay, memory_order_relaxed);
+		if (retryDelay > maxDelay) {
+			retryDelay = maxDelay;
 		}
 	}
 
-	// Check we really recovered all events from compression.
-	if (currPacketOffset != packetSize) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-			"Failed to decode serialized timestamp. "
-			"Length of compressed packet and read data don't match.");
-		return (false);
-	}
+	return (false);
+}
 
-	if ((size_t)(eventNumber * eventSize) != recoveredEventsPosition) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-			"Failed to decode serialized timestamp. "
-			"Length of uncompressed packet and uncompressed data don't match.");
+static bool switchToNextFile(inputCommonState state) {
+	if (state->playlist.filesSize <= 1) {
 		return (false);
 	}
 
-	if ((size_t) eventNumber != recoveredEventsNumber) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-			"Failed to decode serialized timestamp. "
-			"Number of expected and recovered events don't match.");
-		return (false);
+	// Normally the next file was prefetched long ago, only wait if it was not.
+	mtx_lock(&state->playlist.lock);
+
+	while (!state->playlist.nextReady) {
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed) || state->playlist.prefetchDone) {
+			mtx_unlock(&state->playlist.lock);
+			return (false);
+		}
+
+		cnd_wait(&state->playlist.changed, &state->playlist.lock);
 	}
 
-	// Copy recovered event packet into original.
-	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, events, recoveredEventsPosition);
+	mtx_unlock(&state->playlist.lock);
 
-	free(events);
+	discardPartialPacket(state);
 
-	return (true);
-}
+	// Switch over to the prefetched file, buffer and header.
+	free(state->dataBuffer);
+	state->dataBuffer                  = state->playlist.nextDataBuffer;
+	state->playlist.nextDataBuffer     = NULL;
+	state->fileDescriptor              = state->playlist.nextFileDescriptor;
+	state->playlist.nextFileDescriptor = -1;
+	state->dataBufferOffset            = 0;
 
-static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
-	bool retVal = false;
+	state->header.isAEDAT3     = state->playlist.nextHeader.isAEDAT3;
+	state->header.majorVersion = state->playlist.nextHeader.majorVersion;
+	state->header.minorVersion = state->playlist.nextHeader.minorVersion;
+	state->header.formatID     = state->playlist.nextHeader.formatID;
+	state->header.sourceID     = state->playlist.nextHeader.sourceID;
 
-	// Data compression technique 1: serialized timestamps.
-	if ((state->header.formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
-		retVal = decompressTimestampSerialize(state, packet, packetSize);
-	}
+	state->packets.streamRestart = true;
 
-#ifdef ENABLE_INOUT_PNG_COMPRESSION
-	// Data compression technique 2: frame PNG compression.
-	if ((state->header.formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
-		retVal = decompressFramePNG(state, packet, packetSize);
-	}
-#endif
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Continuing with playlist file '%s'.",
+		state->playlist.files[state->playlist.nextFileIndex]);
 
-	return (retVal);
+	// Let the prefetch thread go for the one after.
+	mtx_lock(&state->playlist.lock);
+	state->playlist.nextReady = false;
+	cnd_broadcast(&state->playlist.changed);
+	mtx_unlock(&state->playlist.lock);
+
+	return (true);
 }
 
 static int inputReaderThread(void *stateArg) {
@@ -1260,7 +2396,16 @@ static int inputReaderThread(void *stateArg) {
 			state->fileDescriptor = -1;
 
 			// Distinguish EOF from errors based upon errno value.
-			if (result == 0) {
+			if (result == 0 && switchToNextFile(state)) {
+				// Playlist continues with the next file. Its first buffer was already
+				// read and its header parsed by the prefetch thread.
+				result = (ssize_t) state->dataBuffer->bufferUsedSize;
+			}
+			else if (reconnectStream(state)) {
+				// Network stream continues on the new connection, starting with its header.
+				continue;
+			}
+			else if (result == 0) {
 				caerModuleLog(state->parentModule, CAER_LOG_INFO, "Reached End of File.");
 				atomic_store(&state->inputReaderThreadState, EOF_REACHED); // EOF
 			}
@@ -1268,17 +2413,30 @@ static int inputReaderThread(void *stateArg) {
 				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Error while reading data, error: %d.", errno);
 				atomic_store(&state->inputReaderThreadState, ERROR_READ); // Error
 			}
-			break;
+
+			if (state->fileDescriptor < 0) {
+				break;
+			}
 		}
 		state->dataBuffer->bufferUsedSize = (size_t) result;
 
-		// Parse header and setup header info structure.
-		if (!atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed) && !parseHeader(state)) {
-			// Header invalid, exit.
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-				"Failed to parse header. Only AEDAT 2.X and 3.x compliant files are supported.");
-			atomic_store(&state->inputReaderThreadState, ERROR_HEADER); // Error in Header
-			break;
+		// Parse header and setup header info structure. After reconnecting, the new
+		// connection starts with its own network header again.
+		if (!atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed)
+			|| state->reconnect.headerPending) {
+			state->reconnect.headerPending = false;
+
+			if (!parseHeader(state)) {
+				// Header invalid, exit.
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to parse header. Only AEDAT 2.X and 3.x compliant files are supported.");
+				atomic_store(&state->inputReaderThreadState, ERROR_HEADER); // Error in Header
+				break;
+			}
+
+			// Let demultiplexing companions join before any data is handed out.
+			demuxGroupPublishHeader(state);
+			demuxGroupWaitForCompanions(state);
 		}
 
 		// Parse event data now.
@@ -1335,24 +2493,22 @@ static inline void updateSizeCommitCriteria(inputCommonState state, caerEventPac
  * @return true on successful packet merge, false on failure (memory allocation).
  */
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData) {
-	bool packetAlreadyExists      = false;
-	caerEventPacketHeader *packet = NULL;
-	while ((packet = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, packet)) != NULL) {
-		int16_t packetEventType = caerEventPacketHeaderGetEventType(*packet);
-		int32_t packetEventSize = caerEventPacketHeaderGetEventSize(*packet);
-
-		if (packetEventType == newPacketData->eventType && packetEventSize == newPacketData->eventSize) {
-			// Packet with this type and event size already present.
-			packetAlreadyExists = true;
-			break;
-		}
-	}
+	// Packets are kept ordered by type and event size, so the search can stop at the
+	// first bigger one, which is also where a new packet has to go.
+	size_t packetIndex;
+	bool packetAlreadyExists = caerPacketFindTypeSize(
+		(caerEventPacketHeader *) utarray_front(state->packetContainer.eventPackets),
+		utarray_len(state->packetContainer.eventPackets), newPacketData->eventType, newPacketData->eventSize,
+		&packetIndex);
 
 	// Packet with same type and event size as newPacket found, do merge operation.
 	if (packetAlreadyExists) {
 		// Merge newPacket with '*packet'. Since packets from the same source,
 		// and having the same time, are guaranteed to have monotonic timestamps,
 		// the merge operation becomes a simple append operation.
+		caerEventPacketHeader *packet
+			= (caerEventPacketHeader *) utarray_eltptr(state->packetContainer.eventPackets, packetIndex);
+
 		caerEventPacketHeader mergedPacket = caerEventPacketAppend(*packet, newPacket);
 		if (mergedPacket == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
@@ -1368,9 +2524,8 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 	}
 	else {
 		// No previous packet of this type and event size found, use this one directly.
-		utarray_push_back(state->packetContainer.eventPackets, &newPacket);
-
-		utarray_sort(state->packetContainer.eventPackets, &packetsFirstTypeThenSizeCmp);
+		// Inserted in order, so the packets never need sorting.
+		utarray_insert(state->packetContainer.eventPackets, &newPacket, packetIndex);
 	}
 
 	// Update size commit criteria, if size limit is enabled and not already hit by a previous packet.
@@ -1536,13 +2691,15 @@ redo:
 	// having to again comb through the same time window for any of the size or time
 	// limits to hit again (on TS Overflow, on TS Reset everything just resets anyway).
 	if (!sizeCommit && !forceFlush) {
+		int64_t committedTimestampEnd = state->packetContainer.newContainerTimestampEnd;
+
 		state->packetContainer.newContainerTimestampEnd
 			+= I32T(atomic_load_explicit(&state->packetContainer.timeSlice, memory_order_relaxed));
 
 		// Only do time delay operation if time is actually changing. On size hits or
 		// full flushes, this would slow down everything incorrectly as it would be an
 		// extra delay operation inside the same time window.
-		doTimeDelay(state);
+		doTimeDelay(state, committedTimestampEnd);
 	}
 
 	doPacketContainerCommit(state, packetContainer, atomic_load_explicit(&state->keepPackets, memory_order_relaxed));
@@ -1568,7 +2725,13 @@ redo:
 	}
 }
 
-static void doTimeDelay(inputCommonState state) {
+static void doTimeDelay(inputCommonState state, int64_t timestamp) {
+	// Synchronized inputs follow the shared clock instead.
+	if (state->sync.group != NULL) {
+		doSyncTimeDelay(state, timestamp);
+		return;
+	}
+
 	// Got packet container, delay it until user-defined time.
 	uint64_t timeDelay = U64T(atomic_load_explicit(&state->packetContainer.timeDelay, memory_order_relaxed));
 
@@ -1608,6 +2771,176 @@ static void doTimeDelay(inputCommonState state) {
 	}
 }
 
+static bool syncGroupInit(void *groupArg) {
+	inputSyncGroup group = groupArg;
+
+	return (mtx_init(&group->lock, mtx_plain) == thrd_success);
+}
+
+static void syncGroupDestroy(void *groupArg) {
+	inputSyncGroup group = groupArg;
+
+	mtx_destroy(&group->lock);
+}
+
+static bool syncGroupJoin(inputCommonState state, const char *groupName) {
+	char *stateName = groupStateName(SYNC_GROUP_STATE_PREFIX, groupName);
+	if (stateName == NULL) {
+		return (false);
+	}
+
+	// The first input to use this name creates the clock.
+	inputSyncGroup group
+		= caerMainloopSharedStateAcquire(stateName, sizeof(struct input_common_sync_group), &syncGroupInit);
+	if (group == NULL) {
+		free(stateName);
+		return (false);
+	}
+
+	mtx_lock(&group->lock);
+
+	size_t members = ++group->members;
+
+	mtx_unlock(&group->lock);
+
+	state->sync.group     = group;
+	state->sync.stateName = stateName;
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Joined synchronized playback clock '%s' (%zu inputs).",
+		groupName, members);
+
+	return (true);
+}
+
+static void syncGroupLeave(inputCommonState state) {
+	inputSyncGroup group = state->sync.group;
+	if (group == NULL) {
+		return;
+	}
+
+	// Don't keep the other inputs waiting on us.
+	syncGroupPause(state, false);
+
+	mtx_lock(&group->lock);
+	group->members--;
+	mtx_unlock(&group->lock);
+
+	// Last one out destroys the clock.
+	caerMainloopSharedStateRelease(state->sync.stateName, &syncGroupDestroy);
+
+	free(state->sync.stateName);
+	state->sync.stateName = NULL;
+
+	state->sync.group = NULL;
+}
+
+static void syncGroupPause(inputCommonState state, bool pause) {
+	inputSyncGroup group = state->sync.group;
+	if (group == NULL || state->sync.paused == pause) {
+		return;
+	}
+
+	state->sync.paused = pause;
+
+	mtx_lock(&group->lock);
+
+	if (pause) {
+		if (group->pausedMembers++ == 0) {
+			portable_clock_gettime_monotonic(&group->pauseTime);
+		}
+	}
+	else {
+		if (--group->pausedMembers == 0) {
+			// Move clock start forward by the pause duration, so playback
+			// resumes where it was stopped.
+			struct timespec currentTime;
+			portable_clock_gettime_monotonic(&currentTime);
+
+			int64_t pauseNanoTime = ((int64_t)(currentTime.tv_sec - group->pauseTime.tv_sec) * 1000000000LL)
+									+ (int64_t)(currentTime.tv_nsec - group->pauseTime.tv_nsec);
+			int64_t startNanoTime = ((int64_t) group->startTime.tv_sec * 1000000000LL)
+									+ (int64_t) group->startTime.tv_nsec + pauseNanoTime;
+
+			group->startTime.tv_sec  = startNanoTime / 1000000000LL;
+			group->startTime.tv_nsec = startNanoTime % 1000000000LL;
+		}
+	}
+
+	mtx_unlock(&group->lock);
+}
+
+/**
+ * Delay the commit of the packet container ending at the given timestamp,
+ * until the shared playback clock reaches it. All inputs joined to the same
+ * clock map event time to real time the same way, so their containers are
+ * released aligned on event timestamps instead of drifting apart.
+ * Speed is given by each input's PacketContainerDelay/PacketContainerInterval
+ * ratio, so it should be the same for all inputs in a group.
+ *
+ * @param state common input data structure.
+ * @param timestamp highest timestamp of the packet container to commit.
+ */
+static void doSyncTimeDelay(inputCommonState state, int64_t timestamp) {
+	inputSyncGroup group = state->sync.group;
+
+	int64_t playbackTimestamp = state->sync.timestampOffset + timestamp;
+	state->sync.lastTimestamp = playbackTimestamp;
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		mtx_lock(&group->lock);
+
+		if (!group->started) {
+			// First commit of any input starts the clock.
+			group->started        = true;
+			group->startTimestamp = playbackTimestamp;
+			portable_clock_gettime_monotonic(&group->startTime);
+		}
+
+		bool paused               = (group->pausedMembers != 0);
+		int64_t startTimestamp    = group->startTimestamp;
+		struct timespec startTime = group->startTime;
+
+		mtx_unlock(&group->lock);
+
+		// Wait for 1 ms while any input holds the clock paused, to avoid a wasteful busy loop.
+		if (paused) {
+			struct timespec pauseSleep = {.tv_sec = 0, .tv_nsec = 1000000};
+			thrd_sleep(&pauseSleep, NULL);
+
+			continue;
+		}
+
+		int64_t timeSlice = atomic_load_explicit(&state->packetContainer.timeSlice, memory_order_relaxed);
+		int64_t timeDelay = atomic_load_explicit(&state->packetContainer.timeDelay, memory_order_relaxed);
+
+		// Real time (in µs since clock start) at which this timestamp is due.
+		int64_t dueMicroTime
+			= (int64_t)((double) (playbackTimestamp - startTimestamp) * ((double) timeDelay / (double) timeSlice));
+
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		int64_t elapsedMicroTime = (((int64_t)(currentTime.tv_sec - startTime.tv_sec) * 1000000000LL)
+									   + (int64_t)(currentTime.tv_nsec - startTime.tv_nsec))
+								   / 1000;
+
+		if (dueMicroTime <= elapsedMicroTime) {
+			break;
+		}
+
+		// Sleep for the remaining time, but at most 10 ms at once, to notice pauses.
+		int64_t sleepMicroTime = dueMicroTime - elapsedMicroTime;
+		if (sleepMicroTime > 10000) {
+			sleepMicroTime = 10000;
+		}
+
+		struct timespec delaySleep = {.tv_sec = 0, .tv_nsec = sleepMicroTime * 1000};
+		thrd_sleep(&delaySleep, NULL);
+	}
+
+	portable_clock_gettime_monotonic(&state->packetContainer.lastCommitTime);
+}
+
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force) {
 	// Could be that the packet container is empty of events. Don't commit empty containers.
 	if (caerEventPacketContainerGetEventsNumber(packetContainer) == 0) {
@@ -1667,6 +3000,9 @@ static bool handleTSReset(inputCommonState state) {
 	// Guaranteed commit of timestamp reset container.
 	doPacketContainerCommit(state, tsResetContainer, true);
 
+	// Synchronized playback continues from where the old timeline ended.
+	state->sync.timestampOffset = state->sync.lastTimestamp;
+
 	// Prepare for the new event timeline coming with the next packet.
 	// Reset all time related counters to initial state.
 	state->packetContainer.lastPacketTimestamp      = 0;
@@ -1711,7 +3047,12 @@ static int inputAssemblerThread(void *stateArg) {
 
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 		// Support pause: don't get and send out new data while in pause mode.
-		if (atomic_load_explicit(&state->pause, memory_order_relaxed)) {
+		// A synchronized input also pauses the shared clock, so the others wait for it.
+		bool pause = atomic_load_explicit(&state->pause, memory_order_relaxed);
+
+		syncGroupPause(state, pause);
+
+		if (pause) {
 			// Wait for 1 ms in pause mode, to avoid a wasteful busy loop.
 			struct timespec pauseSleep = {.tv_sec = 0, .tv_nsec = 1000000};
 			thrd_sleep(&pauseSleep, NULL);
@@ -1879,6 +3220,10 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 
 	state->fileDescriptor = readFd;
 
+	// The first playlist file (if any) is the one already opened and passed in.
+	state->playlist.prefetchIndex      = 1;
+	state->playlist.nextFileDescriptor = -1;
+
 	// Store network/file, message-based or not information.
 	state->isNetworkStream       = isNetworkStream;
 	state->isNetworkMessageBased = isNetworkMessageBased;
@@ -1904,6 +3249,32 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 		"Time interval in µs, each sent EventPacketContainer will span this interval.");
 	sshsNodeCreateInt(moduleData->moduleNode, "PacketContainerDelay", 10000, 1, 120 * 1000 * 1000, SSHS_FLAGS_NORMAL,
 		"Time delay in µs between consecutive EventPacketContainers sent for processing.");
+	sshsNodeCreateString(moduleData->moduleNode, "syncGroup", "", 0, 128, SSHS_FLAGS_NORMAL,
+		"Name of the shared playback clock to join. Inputs with the same name play back aligned on event "
+		"timestamps. Empty to disable. Only changes at init time.");
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	sshsNodeCreateString(moduleData->moduleNode, "compressPacketsDictionary", "", 0, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Zstd dictionary file, must be the same the output used to compress packets (ZstdPackets format). "
+		"Empty to disable.");
+#endif
+
+	if (isNetworkStream) {
+		sshsNodeCreateBool(moduleData->moduleNode, "autoReconnect", true, SSHS_FLAGS_NORMAL,
+			"Automatically reconnect when the network stream is lost, without restarting the module.");
+		sshsNodeCreateInt(moduleData->moduleNode, "reconnectMinDelay", 100, 1, 60 * 1000, SSHS_FLAGS_NORMAL,
+			"Initial delay in ms between reconnection attempts, doubled after each failed attempt.");
+		sshsNodeCreateInt(moduleData->moduleNode, "reconnectMaxDelay", 10 * 1000, 1, 60 * 1000, SSHS_FLAGS_NORMAL,
+			"Maximum delay in ms between reconnection attempts.");
+
+		sshsNodeCreateLong(moduleData->moduleNode, "reconnects", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of successful reconnections.");
+		sshsNodeCreateLong(moduleData->moduleNode, "lostMessages", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of network messages detected as missing.");
+
+		atomic_store(&state->reconnect.autoReconnect, sshsNodeGetBool(moduleData->moduleNode, "autoReconnect"));
+		atomic_store(&state->reconnect.minDelay, sshsNodeGetInt(moduleData->moduleNode, "reconnectMinDelay"));
+		atomic_store(&state->reconnect.maxDelay, sshsNodeGetInt(moduleData->moduleNode, "reconnectMaxDelay"));
+	}
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
@@ -1946,6 +3317,66 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 		= I32T(atomic_load_explicit(&state->packetContainer.sizeSlice, memory_order_relaxed));
 	state->packetContainer.sizeLimitTimestamp = INT32_MAX;
 
+	// Join demultiplexing group, companions get their header and sourceInfo from it.
+	if ((state->demux.groupName != NULL) && !demuxGroupJoin(state)) {
+		caerRingBufferFree(state->transferRingPackets);
+		caerRingBufferFree(state->transferRingPacketContainers);
+		free(state->dataBuffer);
+		utarray_free(state->packetContainer.eventPackets);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to join demultiplexing group '%s'.",
+			state->demux.groupName);
+		return (false);
+	}
+
+	// Join shared playback clock. syncGroup only changes here at init time!
+	// Demultiplexed sources play back synchronized by default.
+	char *syncGroup = sshsNodeGetString(moduleData->moduleNode, "syncGroup");
+
+	if (caerStrEquals(syncGroup, "") && (state->demux.groupName != NULL)) {
+		size_t syncGroupLength = strlen(state->demux.groupName) + 6; // "demux/" prefix.
+
+		char *demuxSyncGroup = realloc(syncGroup, syncGroupLength + 1);
+		if (demuxSyncGroup != NULL) {
+			snprintf(demuxSyncGroup, syncGroupLength + 1, "demux/%s", state->demux.groupName);
+			syncGroup = demuxSyncGroup;
+		}
+	}
+
+	if (!caerStrEquals(syncGroup, "") && !syncGroupJoin(state, syncGroup)) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to join synchronized playback clock '%s'. Playing back unsynchronized.", syncGroup);
+	}
+
+	free(syncGroup);
+
+	// Hand-over of prefetched playlist files between prefetch and reader threads.
+	if (mtx_init(&state->playlist.lock, mtx_plain) != thrd_success) {
+		caerRingBufferFree(state->transferRingPackets);
+		caerRingBufferFree(state->transferRingPacketContainers);
+		free(state->dataBuffer);
+
+		syncGroupLeave(state);
+		demuxGroupLeave(state);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize playlist lock.");
+		return (false);
+	}
+
+	if (cnd_init(&state->playlist.changed) != thrd_success) {
+		mtx_destroy(&state->playlist.lock);
+
+		caerRingBufferFree(state->transferRingPackets);
+		caerRingBufferFree(state->transferRingPacketContainers);
+		free(state->dataBuffer);
+
+		syncGroupLeave(state);
+		demuxGroupLeave(state);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize playlist condition.");
+		return (false);
+	}
+
 	// Start input handling threads.
 	atomic_store(&state->running, true);
 
@@ -1954,11 +3385,19 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
 
+		syncGroupLeave(state);
+		demuxGroupLeave(state);
+
+		cnd_destroy(&state->playlist.changed);
+		mtx_destroy(&state->playlist.lock);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input assembler thread.");
 		return (false);
 	}
 
-	if (thrd_create(&state->inputReaderThread, &inputReaderThread, state) != thrd_success) {
+	// Companions don't read anything, their packets come from the group's reader.
+	if (!state->demux.isCompanion
+		&& thrd_create(&state->inputReaderThread, &inputReaderThread, state) != thrd_success) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
@@ -1972,6 +3411,12 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 				state->parentModule, CAER_LOG_CRITICAL, "Failed to join input assembler thread. Error: %d.", errno);
 		}
 
+		syncGroupLeave(state);
+		demuxGroupLeave(state);
+
+		cnd_destroy(&state->playlist.changed);
+		mtx_destroy(&state->playlist.lock);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input reader thread.");
 		return (false);
 	}
@@ -1998,11 +3443,34 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 					state->parentModule, CAER_LOG_CRITICAL, "Failed to join input reader thread. Error: %d.", errno);
 			}
 
+			syncGroupLeave(state);
+			demuxGroupLeave(state);
+
+			cnd_destroy(&state->playlist.changed);
+			mtx_destroy(&state->playlist.lock);
+
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input reader thread.");
 			return (false);
 		}
 	}
 
+	// Start prefetching the next files, if there are any.
+	if (state->playlist.filesSize > 1) {
+		if (thrd_create(&state->playlist.prefetchThread, &inputPrefetchThread, state) == thrd_success) {
+			state->playlist.prefetchThreadStarted = true;
+		}
+		else {
+			// Not fatal, the first file can still be played back.
+			mtx_lock(&state->playlist.lock);
+			state->playlist.prefetchDone = true;
+			cnd_broadcast(&state->playlist.changed);
+			mtx_unlock(&state->playlist.lock);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to start input prefetch thread. Only the first file will be played back.");
+		}
+	}
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerInputCommonConfigListener);
 
@@ -2018,9 +3486,17 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	// Stop input threads and wait on them.
 	atomic_store(&state->running, false);
 
-	if ((errno = thrd_join(state->inputReaderThread, NULL)) != thrd_success) {
-		// This should never happen!
-		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join input reader thread. Error: %d.", errno);
+	// Wake up reader and prefetch threads waiting on each other.
+	mtx_lock(&state->playlist.lock);
+	cnd_broadcast(&state->playlist.changed);
+	mtx_unlock(&state->playlist.lock);
+
+	if (!state->demux.isCompanion) {
+		if ((errno = thrd_join(state->inputReaderThread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(
+				state->parentModule, CAER_LOG_CRITICAL, "Failed to join input reader thread. Error: %d.", errno);
+		}
 	}
 
 	if ((errno = thrd_join(state->inputAssemblerThread, NULL)) != thrd_success) {
@@ -2029,6 +3505,25 @@ void caerInputCommonExit(caerModuleData moduleData) {
 			state->parentModule, CAER_LOG_CRITICAL, "Failed to join input assembler thread. Error: %d.", errno);
 	}
 
+	if (state->playlist.prefetchThreadStarted) {
+		if ((errno = thrd_join(state->playlist.prefetchThread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(
+				state->parentModule, CAER_LOG_CRITICAL, "Failed to join input prefetch thread. Error: %d.", errno);
+		}
+	}
+
+	// Leave shared playback clock and demultiplexing group, now that nothing uses them anymore.
+	syncGroupLeave(state);
+	demuxGroupLeave(state);
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_freeDCtx(state->zstdContext);
+	ZSTD_freeDDict(state->zstdDictionary);
+#endif
+
+	caerFrameCodecSourceReferencesFree(&state->frameReferences, &state->frameReferencesSize);
+
 	// Now clean up the transfer ring-buffers and its contents.
 	caerEventPacketContainer packetContainer;
 	while ((packetContainer = caerRingBufferGet(state->transferRingPacketContainers)) != NULL) {
@@ -2074,6 +3569,24 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	// Free allocated memory.
 	free(state->dataBuffer);
 
+	// Clean up playlist and any prefetched file.
+	cnd_destroy(&state->playlist.changed);
+	mtx_destroy(&state->playlist.lock);
+
+	if (state->playlist.nextFileDescriptor >= 0) {
+		close(state->playlist.nextFileDescriptor);
+	}
+
+	free(state->playlist.nextDataBuffer);
+
+	for (size_t i = 0; i < state->playlist.filesSize; i++) {
+		free(state->playlist.files[i]);
+	}
+
+	free(state->playlist.files);
+
+	free(state->demux.groupName);
+
 	// Remove lingering packet parsing data.
 	packetData curr, curr_tmp;
 	DL_FOREACH_SAFE(state->packets.packetsList, curr, curr_tmp) {
@@ -2084,6 +3597,15 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	free(state->packets.currPacketData);
 	free(state->packets.currPacket);
 
+	// Print final statistics results.
+	if (state->isNetworkStream) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Statistics: reconnected %" PRIu64 " times, %" PRIu64 " messages lost, skipped %" PRIu64
+			" µs of event time and restarted timestamps %" PRIu64 " times across reconnections.",
+			state->statistics.reconnects, state->statistics.lostMessages, state->statistics.gapTime,
+			state->statistics.timestampResets);
+	}
+
 	// Clear sourceInfo node.
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 	sshsNodeRemoveAllAttributes(sourceInfoNode);
@@ -2150,36 +3672,14 @@ static void caerInputCommonConfigListener(sshsNode node, void *userData, enum ss
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "PacketContainerDelay")) {
 			atomic_store(&state->packetContainer.timeDelay, changeValue.iint);
 		}
-	}
-}
-
-static int packetsFirstTypeThenSizeCmp(const void *a, const void *b) {
-	const caerEventPacketHeader *aa = a;
-	const caerEventPacketHeader *bb = b;
-
-	// Sort first by type ID.
-	int16_t eventTypeA = caerEventPacketHeaderGetEventType(*aa);
-	int16_t eventTypeB = caerEventPacketHeaderGetEventType(*bb);
-
-	if (eventTypeA < eventTypeB) {
-		return (-1);
-	}
-	else if (eventTypeA > eventTypeB) {
-		return (1);
-	}
-	else {
-		// If equal, further sort by event size.
-		int32_t eventSizeA = caerEventPacketHeaderGetEventSize(*aa);
-		int32_t eventSizeB = caerEventPacketHeaderGetEventSize(*bb);
-
-		if (eventSizeA < eventSizeB) {
-			return (-1);
+		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "autoReconnect")) {
+			atomic_store(&state->reconnect.autoReconnect, changeValue.boolean);
 		}
-		else if (eventSizeA > eventSizeB) {
-			return (1);
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "reconnectMinDelay")) {
+			atomic_store(&state->reconnect.minDelay, changeValue.iint);
 		}
-		else {
-			return (0);
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "reconnectMaxDelay")) {
+			atomic_store(&state->reconnect.maxDelay, changeValue.iint);
 		}
 	}
 }
@@ -5,6 +5,7 @@
 #include "caer-sdk/buffers.h"
 #include "caer-sdk/module.h"
 #include "../inout_common.h"
+#include "../inout_frame_codec.h"
 #include "ext/uthash/utarray.h"
 #include <unistd.h>
 
@@ -12,6 +13,10 @@
 #include "caer-sdk/cross/c11threads_posix.h"
 #endif
 
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+#include <zstd.h>
+#endif
+
 struct input_common_header_info {
 	/// Header has been completely read and is valid.
 	atomic_bool isValidHeader;
@@ -56,6 +61,14 @@ struct input_packet_data {
 
 typedef struct input_packet_data *packetData;
 
+#define INPUT_MAX_STREAM_TIMESTAMPS 64
+
+struct input_common_stream_timestamp {
+	int16_t sourceID;
+	int16_t eventType;
+	int64_t timestamp;
+};
+
 struct input_common_packet_data {
 	/// Current packet header, to support headers being split across buffers.
 	uint8_t currPacketHeader[CAER_EVENT_PACKET_HEADER_SIZE];
@@ -75,6 +88,38 @@ struct input_common_packet_data {
 	packetData packetsList;
 	/// Global packet counter.
 	size_t packetCount;
+	/// Stream restarted (next playlist file, reconnection), check timestamps of the next packet.
+	bool streamRestart;
+	/// Highest order-relevant (first) timestamp seen so far by the reader.
+	int64_t lastTimestamp;
+	/// Highest first timestamp seen so far per source and event type, to compare
+	/// the first packet after a stream restart with its own predecessor.
+	struct input_common_stream_timestamp streamTimestamps[INPUT_MAX_STREAM_TIMESTAMPS];
+	size_t streamTimestampsSize;
+};
+
+struct input_common_statistics {
+	/// Successful reconnections after losing the network stream.
+	uint64_t reconnects;
+	/// Network messages detected as missing via their sequence number.
+	uint64_t lostMessages;
+	/// Event time (in µs) skipped over across stream restarts.
+	uint64_t gapTime;
+	/// Stream restarts where timestamps went backwards (handled as resets).
+	uint64_t timestampResets;
+};
+
+struct input_common_reconnect {
+	/// Re-establish the connection, returns the new file descriptor or -1.
+	/// Set by network input modules supporting reconnection, NULL otherwise.
+	int (*connect)(caerModuleData moduleData);
+	/// Reconnect automatically when the stream is lost.
+	atomic_bool autoReconnect;
+	/// Initial and maximum delay (in ms) between reconnection attempts.
+	atomic_int_fast32_t minDelay;
+	atomic_int_fast32_t maxDelay;
+	/// The network header of the new connection has to be parsed.
+	bool headerPending;
 };
 
 struct input_common_packet_container_data {
@@ -108,6 +153,79 @@ struct input_common_packet_container_data {
 	struct timespec lastCommitTime;
 };
 
+struct input_common_playlist {
+	/// Ordered list of files to play back as one continuous stream.
+	/// Filled in by the file input module before common initialization.
+	char **files;
+	/// Number of files in the list.
+	size_t filesSize;
+	/// Open a playlist file for reading, returns a file descriptor delivering
+	/// the uncompressed AEDAT stream, or -1 on failure.
+	/// Set by the file input module, NULL to open() files directly.
+	int (*openFile)(caerModuleData moduleData, const char *filePath);
+	/// Index of the next file the prefetch thread will try to open.
+	size_t prefetchIndex;
+	/// The prefetch thread: opens the next file, reads its first buffer and
+	/// parses its header in the background, so there is no stall at file
+	/// boundaries.
+	thrd_t prefetchThread;
+	/// Prefetch thread was started and has to be joined on exit.
+	bool prefetchThreadStarted;
+	/// Protects nextReady and prefetchDone, which are signaled on change
+	/// (and on shutdown) through 'changed'.
+	mtx_t lock;
+	cnd_t changed;
+	/// Next file is prefetched and ready to be switched to by the reader.
+	bool nextReady;
+	/// No more files to prefetch, playlist is done after the current file.
+	bool prefetchDone;
+	/// File descriptor of the prefetched next file.
+	int nextFileDescriptor;
+	/// First data buffer of the prefetched next file (header already parsed).
+	simpleBuffer nextDataBuffer;
+	/// Header parsing results of the prefetched next file.
+	struct input_common_header_info nextHeader;
+	/// Index into files of the prefetched next file.
+	size_t nextFileIndex;
+};
+
+/// Shared playback clock, defined in input_common.c, shared through the mainloop.
+struct input_common_sync_group;
+
+struct input_common_sync {
+	/// Shared playback clock this input is synchronized to (NULL if none).
+	struct input_common_sync_group *group;
+	/// Name of the shared playback clock in the mainloop's shared state registry.
+	char *stateName;
+	/// Offset added to timestamps, so that the playback timeline stays
+	/// monotonic across timestamp resets.
+	int64_t timestampOffset;
+	/// Last playback timestamp (offset applied) that was waited for.
+	int64_t lastTimestamp;
+	/// This input currently holds the shared clock paused.
+	bool paused;
+};
+
+/// Demultiplexing group, defined in input_common.c, shared through the mainloop.
+struct input_common_demux_group;
+
+struct input_common_demux {
+	/// Name of the demultiplexing group to join ('demuxGroup' setting), NULL if none.
+	/// Filled in by the file input module before common initialization.
+	char *groupName;
+	/// This input doesn't read by itself, but gets the packets of one source
+	/// handed over from the group's reader.
+	bool isCompanion;
+	/// Source ID to take from the group's reader (companions only).
+	int16_t sourceID;
+	/// Demultiplexing group this input is part of (NULL if none).
+	struct input_common_demux_group *group;
+	/// Name of the demultiplexing group in the mainloop's shared state registry.
+	char *stateName;
+	/// Original source ID of the packet currently being parsed.
+	int16_t currPacketSourceID;
+};
+
 struct input_common_state {
 	/// Control flag for input handling threads.
 	atomic_bool running;
@@ -156,12 +274,32 @@ struct input_common_state {
 	struct input_common_packet_data packets;
 	/// Packet container data structure, to generate from packets.
 	struct input_common_packet_container_data packetContainer;
+	/// Synchronized playback with other inputs (shared clock).
+	struct input_common_sync sync;
+	/// Multi-source demultiplexing support (files only).
+	struct input_common_demux demux;
 	/// The file descriptor for reading.
 	int fileDescriptor;
 	/// Data buffer for reading from file descriptor (buffered I/O).
 	simpleBuffer dataBuffer;
 	/// Offset for current data buffer.
 	size_t dataBufferOffset;
+	/// Multi-file playback support (files only).
+	struct input_common_playlist playlist;
+	/// Reconnection support (network only).
+	struct input_common_reconnect reconnect;
+	/// Input module statistics collection.
+	struct input_common_statistics statistics;
+	/// Last decoded frame per event source and ROI identifier, for FastFrames delta
+	/// frames. Sources are added as they are seen (demultiplexed files have several).
+	struct caer_frame_codec_source_references *frameReferences;
+	size_t frameReferencesSize;
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	/// Zstd decompression context and optional dictionary ('compressPacketsDictionary'
+	/// setting), created on first use by the reader thread.
+	ZSTD_DCtx *zstdContext;
+	ZSTD_DDict *zstdDictionary;
+#endif
 	/// Flag to signal update to buffer configuration asynchronously.
 	atomic_bool bufferUpdate;
 	/// Reference to parent module's original data.
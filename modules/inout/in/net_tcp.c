@@ -30,19 +30,12 @@ caerModuleInfo caerModuleGetInfo(void) {
 	return (&InputNetTCPInfo);
 }
 
-static bool caerInputNetTCPInit(caerModuleData moduleData) {
-	// First, always create all needed setting nodes, set their default values
-	// and add their listeners.
-	sshsNodeCreateString(
-		moduleData->moduleNode, "ipAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL, "IPv4 address to connect to.");
-	sshsNodeCreateInt(
-		moduleData->moduleNode, "portNumber", 7777, 1, UINT16_MAX, SSHS_FLAGS_NORMAL, "Port number to connect to.");
-
-	// Open a TCP socket to the remote client, to which we'll send data packets.
+static int caerInputNetTCPConnect(caerModuleData moduleData) {
+	// Open a TCP socket to the remote server, from which we'll read data packets.
 	int sockFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 	if (sockFd < 0) {
 		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create TCP socket. Error: %d.", errno);
-		return (false);
+		return (-1);
 	}
 
 	struct sockaddr_in tcpClient;
@@ -58,7 +51,7 @@ static bool caerInputNetTCPInit(caerModuleData moduleData) {
 		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "No valid IP address found. '%s' is invalid!", ipAddress);
 
 		free(ipAddress);
-		return (false);
+		return (-1);
 	}
 	free(ipAddress);
 
@@ -69,17 +62,38 @@ static bool caerInputNetTCPInit(caerModuleData moduleData) {
 			"Could not connect to remote TCP server %s:%" PRIu16 ". Error: %d.",
 			inet_ntop(AF_INET, &tcpClient.sin_addr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN),
 			ntohs(tcpClient.sin_port), errno);
+		return (-1);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "TCP socket connected to %s:%" PRIu16 ".",
+		inet_ntop(AF_INET, &tcpClient.sin_addr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN),
+		ntohs(tcpClient.sin_port));
+
+	return (sockFd);
+}
+
+static bool caerInputNetTCPInit(caerModuleData moduleData) {
+	inputCommonState state = moduleData->moduleState;
+
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(
+		moduleData->moduleNode, "ipAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL, "IPv4 address to connect to.");
+	sshsNodeCreateInt(
+		moduleData->moduleNode, "portNumber", 7777, 1, UINT16_MAX, SSHS_FLAGS_NORMAL, "Port number to connect to.");
+
+	int sockFd = caerInputNetTCPConnect(moduleData);
+	if (sockFd < 0) {
 		return (false);
 	}
 
+	// Same connection procedure is used to reconnect, if the stream is lost.
+	state->reconnect.connect = &caerInputNetTCPConnect;
+
 	if (!caerInputCommonInit(moduleData, sockFd, true, false)) {
 		close(sockFd);
 		return (false);
 	}
 
-	caerModuleLog(moduleData, CAER_LOG_INFO, "TCP socket connected to %s:%" PRIu16 ".",
-		inet_ntop(AF_INET, &tcpClient.sin_addr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN),
-		ntohs(tcpClient.sin_port));
-
 	return (true);
 }
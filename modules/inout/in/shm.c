@@ -0,0 +1,511 @@
+#include "caer-sdk/cross/portable_io.h"
+#include "caer-sdk/cross/portable_threads.h"
+#include "caer-sdk/mainloop.h"
+
+#include "../inout_shm.h"
+
+#include <libcaer/events/packetContainer.h>
+#include <libcaer/events/special.h>
+#include <libcaer/ringbuffer.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_PTHREADS
+#include "caer-sdk/cross/c11threads_posix.h"
+#endif
+
+#define SHM_READER_RETRY_DELAY 1 // s between attempts to open the shared memory again.
+
+struct shm_input_state {
+	/// Control flag for the reader thread.
+	atomic_bool running;
+	/// The reader thread: waits for new packet containers in shared memory and copies them out.
+	thrd_t readerThread;
+	/// Transfer packet containers from the reader thread to the mainloop.
+	caerRingBuffer transferRing;
+	/// Packet containers in transferRing, see input_common.h for why this is tracked per module.
+	atomic_uint_fast32_t dataAvailableModule;
+	/// Shared memory segment name (with SHM_NAME_PREFIX).
+	char *segmentName;
+	/// The mapped shared memory segment, NULL while not connected to a writer.
+	struct caer_shm_header *segment;
+	size_t segmentSize;
+	/// Our entry in the segment's readers.
+	struct caer_shm_reader *reader;
+	/// Sequence number of the next packet container to read.
+	uint64_t nextSequence;
+	/// Source information was taken over from the writer.
+	bool sourceReady;
+	/// Statistics: packet containers lost because this reader fell behind.
+	uint64_t lostContainers;
+	/// Reference to parent module's original data.
+	caerModuleData parentModule;
+	/// Reference to sourceInfo node (to avoid getting it each time again).
+	sshsNode sourceInfoNode;
+};
+
+typedef struct shm_input_state *shmInputState;
+
+static bool caerInputShmInit(caerModuleData moduleData);
+static void caerInputShmRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out);
+static void caerInputShmExit(caerModuleData moduleData);
+static bool shmOpen(shmInputState state);
+static void shmClose(shmInputState state);
+static void shmSetupSource(shmInputState state);
+static caerEventPacketContainer shmReadContainer(shmInputState state, struct caer_shm_slot *slot);
+static int shmReaderThread(void *stateArg);
+
+static const struct caer_module_functions InputShmFunctions = {.moduleInit = &caerInputShmInit,
+	.moduleRun                                                             = &caerInputShmRun,
+	.moduleConfig                                                          = NULL,
+	.moduleExit                                                            = &caerInputShmExit};
+
+static const struct caer_event_stream_out InputShmOutputs[] = {{.type = -1}};
+
+static const struct caer_module_info InputShmInfo = {
+	.version           = 1,
+	.name              = "ShmInput",
+	.description       = "Read AEDAT 3 packet containers from another process through shared memory.",
+	.type              = CAER_MODULE_INPUT,
+	.memSize           = sizeof(struct shm_input_state),
+	.functions         = &InputShmFunctions,
+	.inputStreams      = NULL,
+	.inputStreamsSize  = 0,
+	.outputStreams     = InputShmOutputs,
+	.outputStreamsSize = CAER_EVENT_STREAM_OUT_SIZE(InputShmOutputs),
+};
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&InputShmInfo);
+}
+
+static bool caerInputShmInit(caerModuleData moduleData) {
+	shmInputState state = moduleData->moduleState;
+
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "caer", 1, 200, SSHS_FLAGS_NORMAL,
+		"Name of the shared memory segment to read from (" SHM_NAME_PREFIX "NAME).");
+	sshsNodeCreateInt(moduleData->moduleNode, "ringBufferSize", 128, 8, 4096, SSHS_FLAGS_NORMAL,
+		"Size of the EventPacketContainer queue, used for transfers between reader thread and mainloop.");
+	sshsNodeCreateLong(moduleData->moduleNode, "lostContainers", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Packet containers lost because this reader fell behind.");
+
+	state->parentModule   = moduleData;
+	state->sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+
+	size_t segmentNameLength = strlen(SHM_NAME_PREFIX) + strlen(shmName);
+
+	state->segmentName = malloc(segmentNameLength + 1);
+	if (state->segmentName == NULL) {
+		free(shmName);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for shared memory name.");
+		return (false);
+	}
+
+	snprintf(state->segmentName, segmentNameLength + 1, SHM_NAME_PREFIX "%s", shmName);
+	free(shmName);
+
+	// Like socket inputs, the other side has to exist already.
+	if (!shmOpen(state)) {
+		free(state->segmentName);
+		return (false);
+	}
+
+	state->transferRing = caerRingBufferInit((size_t) sshsNodeGetInt(moduleData->moduleNode, "ringBufferSize"));
+	if (state->transferRing == NULL) {
+		shmClose(state);
+		free(state->segmentName);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate transfer ring-buffer.");
+		return (false);
+	}
+
+	atomic_store(&state->running, true);
+
+	if (thrd_create(&state->readerThread, &shmReaderThread, state) != thrd_success) {
+		caerRingBufferFree(state->transferRing);
+		shmClose(state);
+		free(state->segmentName);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start reader thread.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static void caerInputShmRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
+	UNUSED_ARGUMENT(in);
+
+	shmInputState state = moduleData->moduleState;
+
+	*out = caerRingBufferGet(state->transferRing);
+
+	if (*out != NULL) {
+		caerMainloopDataNotifyDecrease(NULL);
+		atomic_fetch_sub_explicit(&state->dataAvailableModule, 1, memory_order_relaxed);
+
+		caerEventPacketHeaderConst special = caerEventPacketContainerFindEventPacketByTypeConst(*out, SPECIAL_EVENT);
+
+		if ((special != NULL) && (caerEventPacketHeaderGetEventNumber(special) == 1)
+			&& (caerSpecialEventPacketFindValidEventByTypeConst((caerSpecialEventPacketConst) special, TIMESTAMP_RESET)
+				   != NULL)) {
+			caerMainloopModuleResetOutputRevDeps(moduleData->moduleID);
+		}
+	}
+}
+
+static void caerInputShmExit(caerModuleData moduleData) {
+	shmInputState state = moduleData->moduleState;
+
+	// Stop reader thread and wait on it.
+	atomic_store(&state->running, false);
+
+	if ((errno = thrd_join(state->readerThread, NULL)) != thrd_success) {
+		// This should never happen!
+		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join reader thread. Error: %d.", errno);
+	}
+
+	// Empty ring-buffer.
+	caerEventPacketContainer container;
+	while ((container = caerRingBufferGet(state->transferRing)) != NULL) {
+		caerEventPacketContainerFree(container);
+
+		caerMainloopDataNotifyDecrease(NULL);
+		atomic_fetch_sub_explicit(&state->dataAvailableModule, 1, memory_order_relaxed);
+	}
+
+	caerRingBufferFree(state->transferRing);
+
+	shmClose(state);
+	free(state->segmentName);
+
+	sshsNodeRemoveAttribute(moduleData->moduleNode, "lostContainers", SSHS_LONG);
+	sshsNodeRemoveAllAttributes(state->sourceInfoNode);
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Statistics: %" PRIu64 " packet containers lost.", state->lostContainers);
+}
+
+/**
+ * Map the writer's shared memory and register as one of its readers.
+ *
+ * @param state input module state.
+ *
+ * @return true on success, false if there is no (usable) writer.
+ */
+static bool shmOpen(shmInputState state) {
+	int shmFd = shm_open(state->segmentName, O_RDWR, 0);
+	if (shmFd < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to open shared memory '%s'. Error: %d.",
+			state->segmentName, errno);
+		return (false);
+	}
+
+	struct stat shmStat;
+	if ((fstat(shmFd, &shmStat) != 0) || ((size_t) shmStat.st_size < sizeof(struct caer_shm_header))) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Shared memory '%s' is not ready.", state->segmentName);
+		close(shmFd);
+		return (false);
+	}
+
+	state->segmentSize = (size_t) shmStat.st_size;
+	state->segment     = mmap(NULL, state->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+
+	// The mapping stays valid without the file descriptor.
+	close(shmFd);
+
+	if (state->segment == MAP_FAILED) {
+		state->segment = NULL;
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to map shared memory. Error: %d.", errno);
+		return (false);
+	}
+
+	struct caer_shm_header *segment = state->segment;
+
+	if ((atomic_load_explicit(&segment->magicNumber, memory_order_acquire) != SHM_MAGIC_NUMBER)
+		|| (segment->version != SHM_VERSION)
+		|| (state->segmentSize < (segment->dataOffset + (segment->slotsNumber * segment->slotSize)))) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Shared memory '%s' has an unsupported format.",
+			state->segmentName);
+		shmClose(state);
+		return (false);
+	}
+
+	// Find a free reader entry.
+	uint32_t readerPid = U32T(getpid());
+
+	for (size_t i = 0; i < SHM_MAX_READERS; i++) {
+		uint32_t freePid = 0;
+
+		if (atomic_compare_exchange_strong(&segment->readers[i].pid, &freePid, readerPid)) {
+			state->reader = &segment->readers[i];
+			break;
+		}
+	}
+
+	if (state->reader == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Shared memory '%s' already has %d readers.",
+			state->segmentName, SHM_MAX_READERS);
+		shmClose(state);
+		return (false);
+	}
+
+	// Live data: start with the next packet container.
+	state->nextSequence = atomic_load_explicit(&segment->writeSequence, memory_order_acquire);
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Reading from shared memory '%s'.", state->segmentName);
+
+	return (true);
+}
+
+static void shmClose(shmInputState state) {
+	if (state->segment == NULL) {
+		return;
+	}
+
+	if (state->reader != NULL) {
+		atomic_store(&state->reader->readSequence, SHM_NO_SEQUENCE);
+		atomic_store(&state->reader->pid, 0);
+		state->reader = NULL;
+	}
+
+	munmap(state->segment, state->segmentSize);
+	state->segment = NULL;
+
+	// A new writer may have a different source.
+	state->sourceReady = false;
+}
+
+/**
+ * Take over source information from the writer, with this module as the
+ * new source (packets get this module's ID as their source).
+ *
+ * @param state input module state.
+ */
+static void shmSetupSource(shmInputState state) {
+	struct caer_shm_header *segment = state->segment;
+
+	static const char *sourceSizeKeys[SHM_SOURCE_SIZES] = {"polaritySizeX", "polaritySizeY", "frameSizeX",
+		"frameSizeY", "dataSizeX", "dataSizeY", "visualizerSizeX", "visualizerSizeY"};
+	static const char *sourceSizeDescriptions[SHM_SOURCE_SIZES]
+		= {"Polarity events width.", "Polarity events height.", "Frame events width.", "Frame events height.",
+			"Data width.", "Data height.", "Visualization width.", "Visualization height."};
+
+	for (size_t i = 0; i < SHM_SOURCE_SIZES; i++) {
+		if (segment->sourceSizes[i] > 0) {
+			sshsNodeCreateInt(state->sourceInfoNode, sourceSizeKeys[i], segment->sourceSizes[i], 1, INT16_MAX,
+				SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, sourceSizeDescriptions[i]);
+		}
+	}
+
+	// Generate source string for output modules, with the writer's source as parent.
+	char writerSourceString[SHM_SOURCE_STRING_SIZE];
+	memcpy(writerSourceString, segment->sourceString, SHM_SOURCE_STRING_SIZE);
+	writerSourceString[SHM_SOURCE_STRING_SIZE - 1] = '\0';
+
+	// Only the first line, without its '#Source N: ' prefix and line ending.
+	char *writerSource = strchr(writerSourceString, ':');
+	writerSource       = (writerSource == NULL) ? (writerSourceString) : (writerSource + 2);
+	writerSource[strcspn(writerSource, "\r\n")] = '\0';
+
+	size_t sourceStringLength = (size_t) snprintf(NULL, 0,
+		"#Source %" PRIu16 ": SharedMemory,"
+		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
+		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
+		"#-Source %" PRIi16 ": %s\r\n",
+		state->parentModule->moduleID, segment->sourceSizes[SHM_POLARITY_SIZE_X],
+		segment->sourceSizes[SHM_POLARITY_SIZE_Y], segment->sourceSizes[SHM_FRAME_SIZE_X],
+		segment->sourceSizes[SHM_FRAME_SIZE_Y], segment->sourceSizes[SHM_DATA_SIZE_X],
+		segment->sourceSizes[SHM_DATA_SIZE_Y], segment->sourceSizes[SHM_VISUALIZER_SIZE_X],
+		segment->sourceSizes[SHM_VISUALIZER_SIZE_Y], segment->sourceID, writerSource);
+
+	char sourceString[sourceStringLength + 1];
+	snprintf(sourceString, sourceStringLength + 1,
+		"#Source %" PRIu16 ": SharedMemory,"
+		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
+		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
+		"#-Source %" PRIi16 ": %s\r\n",
+		state->parentModule->moduleID, segment->sourceSizes[SHM_POLARITY_SIZE_X],
+		segment->sourceSizes[SHM_POLARITY_SIZE_Y], segment->sourceSizes[SHM_FRAME_SIZE_X],
+		segment->sourceSizes[SHM_FRAME_SIZE_Y], segment->sourceSizes[SHM_DATA_SIZE_X],
+		segment->sourceSizes[SHM_DATA_SIZE_Y], segment->sourceSizes[SHM_VISUALIZER_SIZE_X],
+		segment->sourceSizes[SHM_VISUALIZER_SIZE_Y], segment->sourceID, writerSource);
+	sourceString[sourceStringLength] = '\0';
+
+	sshsNodeCreateString(state->sourceInfoNode, "sourceString", sourceString, 1, 2048,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Description of the source.");
+
+	state->sourceReady = true;
+}
+
+/**
+ * Copy a packet container out of its slot, the one copy needed to hand
+ * it on to the mainloop. The slot must be held by this reader.
+ *
+ * @param state input module state.
+ * @param slot slot to read.
+ *
+ * @return the packet container, or NULL on malformed data or memory allocation failure.
+ */
+static caerEventPacketContainer shmReadContainer(shmInputState state, struct caer_shm_slot *slot) {
+	struct caer_shm_header *segment = state->segment;
+
+	size_t slotIndex        = (size_t)(slot - segment->slots);
+	const uint8_t *slotData = ((const uint8_t *) segment) + segment->dataOffset + (slotIndex * segment->slotSize);
+	size_t slotSize         = (slot->size > segment->slotSize) ? (segment->slotSize) : (slot->size);
+
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(I32T(slot->packetsNumber));
+	if (container == NULL) {
+		return (NULL);
+	}
+
+	size_t slotOffset = 0;
+
+	for (int32_t i = 0; i < I32T(slot->packetsNumber); i++) {
+		if ((slotSize - slotOffset) < CAER_EVENT_PACKET_HEADER_SIZE) {
+			caerEventPacketContainerFree(container);
+			return (NULL);
+		}
+
+		caerEventPacketHeaderConst slotPacket = (caerEventPacketHeaderConst)(slotData + slotOffset);
+
+		size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE
+							+ ((size_t) caerEventPacketHeaderGetEventNumber(slotPacket)
+								  * (size_t) caerEventPacketHeaderGetEventSize(slotPacket));
+
+		if ((caerEventPacketHeaderGetEventNumber(slotPacket) < 0) || (caerEventPacketHeaderGetEventSize(slotPacket) < 0)
+			|| (packetSize > (slotSize - slotOffset))) {
+			caerEventPacketContainerFree(container);
+			return (NULL);
+		}
+
+		caerEventPacketHeader packet = malloc(packetSize);
+		if (packet == NULL) {
+			caerEventPacketContainerFree(container);
+			return (NULL);
+		}
+
+		memcpy(packet, slotPacket, packetSize);
+
+		// This module is the source now.
+		caerEventPacketHeaderSetEventSource(packet, I16T(state->parentModule->moduleID));
+
+		caerEventPacketContainerSetEventPacket(container, i, packet);
+
+		slotOffset += SHM_PACKET_SIZE(slotPacket);
+	}
+
+	return (container);
+}
+
+static int shmReaderThread(void *stateArg) {
+	shmInputState state = stateArg;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 6]; // +1 for the NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Read]");
+	portable_thread_set_name(threadName);
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		struct caer_shm_header *segment = state->segment;
+
+		if (segment == NULL) {
+			// Writer went away, try to find a new one.
+			struct timespec retrySleep = {.tv_sec = SHM_READER_RETRY_DELAY, .tv_nsec = 0};
+			thrd_sleep(&retrySleep, NULL);
+
+			shmOpen(state);
+			continue;
+		}
+
+		uint32_t wakeup        = atomic_load_explicit(&segment->wakeup, memory_order_acquire);
+		uint64_t writeSequence = atomic_load_explicit(&segment->writeSequence, memory_order_acquire);
+
+		if (!state->sourceReady && atomic_load_explicit(&segment->sourceReady, memory_order_acquire)) {
+			shmSetupSource(state);
+		}
+
+		if (!state->sourceReady || (state->nextSequence >= writeSequence)) {
+			if (!caerShmWriterAlive(segment)) {
+				// Stopped, or crashed without telling.
+				caerModuleLog(state->parentModule, CAER_LOG_INFO, "Writer stopped, waiting for a new one.");
+				shmClose(state);
+				continue;
+			}
+
+			// Wait for new data, but wake up regularly to check for shutdown.
+			caerShmWait(&segment->wakeup, wakeup, 100);
+			continue;
+		}
+
+		uint64_t lostContainers = 0;
+
+		// Fell behind too much, the oldest ones are gone already.
+		if ((writeSequence - state->nextSequence) > segment->slotsNumber) {
+			lostContainers += (writeSequence - state->nextSequence) - segment->slotsNumber;
+			state->nextSequence = writeSequence - segment->slotsNumber;
+		}
+
+		struct caer_shm_slot *slot = &segment->slots[state->nextSequence % segment->slotsNumber];
+
+		// Hold the slot first, then check it wasn't reused meanwhile. The writer does
+		// the opposite, so either it sees our hold, or we see the slot is gone.
+		atomic_store(&state->reader->readSequence, state->nextSequence);
+
+		caerEventPacketContainer container = NULL;
+
+		if (atomic_load(&slot->sequence) == state->nextSequence) {
+			container = shmReadContainer(state, slot);
+
+			if (container == NULL) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to read packet container.");
+			}
+		}
+		else {
+			lostContainers++;
+		}
+
+		atomic_store_explicit(&state->reader->readSequence, SHM_NO_SEQUENCE, memory_order_release);
+		state->nextSequence++;
+
+		if (lostContainers > 0) {
+			state->lostContainers += lostContainers;
+
+			sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "lostContainers", SSHS_LONG,
+				(union sshs_node_attr_value){.ilong = I64T(state->lostContainers)});
+		}
+
+		if (container == NULL) {
+			continue;
+		}
+
+		// Put into ring-buffer, retry until there's space. Only this reader
+		// is held up, the writer doesn't wait on it while it's not holding a slot.
+		while (!caerRingBufferPut(state->transferRing, container)) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				caerEventPacketContainerFree(container);
+				container = NULL;
+				break;
+			}
+
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 1000000};
+			thrd_sleep(&retrySleep, NULL);
+		}
+
+		if (container != NULL) {
+			atomic_fetch_add_explicit(&state->dataAvailableModule, 1, memory_order_release);
+			caerMainloopDataNotifyIncrease(NULL);
+		}
+	}
+
+	return (thrd_success);
+}
@@ -30,17 +30,12 @@ caerModuleInfo caerModuleGetInfo(void) {
 	return (&InputUnixSocketInfo);
 }
 
-static bool caerInputUnixSocketInit(caerModuleData moduleData) {
-	// First, always create all needed setting nodes, set their default values
-	// and add their listeners.
-	sshsNodeCreateString(moduleData->moduleNode, "socketPath", "/tmp/caer.sock", 2, PATH_MAX, SSHS_FLAGS_NORMAL,
-		"Unix Socket path for reading input data.");
-
-	// Open an existing Unix local socket at a known path, where we'll write to.
+static int caerInputUnixSocketConnect(caerModuleData moduleData) {
+	// Open an existing Unix local socket at a known path, from which we'll read.
 	int sockFd = socket(AF_UNIX, SOCK_STREAM, 0);
 	if (sockFd < 0) {
 		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create local Unix socket. Error: %d.", errno);
-		return (false);
+		return (-1);
 	}
 
 	struct sockaddr_un unixSocketAddr;
@@ -58,15 +53,34 @@ static bool caerInputUnixSocketInit(caerModuleData moduleData) {
 		close(sockFd);
 
 		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not connect to local Unix socket. Error: %d.", errno);
+		return (-1);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Local Unix socket ready at '%s'.", unixSocketAddr.sun_path);
+
+	return (sockFd);
+}
+
+static bool caerInputUnixSocketInit(caerModuleData moduleData) {
+	inputCommonState state = moduleData->moduleState;
+
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "socketPath", "/tmp/caer.sock", 2, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Unix Socket path for reading input data.");
+
+	int sockFd = caerInputUnixSocketConnect(moduleData);
+	if (sockFd < 0) {
 		return (false);
 	}
 
+	// Same connection procedure is used to reconnect, if the stream is lost.
+	state->reconnect.connect = &caerInputUnixSocketConnect;
+
 	if (!caerInputCommonInit(moduleData, sockFd, true, false)) {
 		close(sockFd);
 		return (false);
 	}
 
-	caerModuleLog(moduleData, CAER_LOG_INFO, "Local Unix socket ready at '%s'.", unixSocketAddr.sun_path);
-
 	return (true);
 }
@@ -0,0 +1,109 @@
+#ifndef INPUT_OUTPUT_BITPACK_H_
+#define INPUT_OUTPUT_BITPACK_H_
+
+/*
+ * Block bit-packing, shared by the PolarityDelta and FastFrames codecs.
+ * Values are packed in blocks of 32, LSB first, all at the same bit width,
+ * so a block always takes exactly 4 * width bytes. Values in a block are
+ * independent of each other, which keeps unpacking branch-free and easy
+ * for the compiler to vectorize.
+ * Signed values (differences, prediction residuals) are zig-zag coded
+ * first, so that small negative values also get small widths.
+ */
+
+#include <libcaer/events/common.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define CAER_BITPACK_BLOCK_SIZE 32
+
+/// Size in bytes of one block of values packed at the given width.
+#define CAER_BITPACK_BLOCK_BYTES(WIDTH) ((size_t)(CAER_BITPACK_BLOCK_SIZE / 8) * (size_t)(WIDTH))
+
+static inline uint32_t caerBitPackZigZagEncode(uint32_t value) {
+	return ((value << 1) ^ (uint32_t)(-(int32_t)(value >> 31)));
+}
+
+static inline uint32_t caerBitPackZigZagDecode(uint32_t value) {
+	return ((value >> 1) ^ (uint32_t)(-(int32_t)(value & 0x01)));
+}
+
+/**
+ * Smallest bit width that can hold all values of a block.
+ */
+static inline uint8_t caerBitPackWidth(const uint32_t *values) {
+	uint32_t combined = 0;
+
+	for (size_t i = 0; i < CAER_BITPACK_BLOCK_SIZE; i++) {
+		combined |= values[i];
+	}
+
+	return ((combined == 0) ? (0) : (uint8_t)(32 - __builtin_clz(combined)));
+}
+
+/**
+ * Bit-pack one block of values at the given width.
+ *
+ * @return number of bytes written (4 * width).
+ */
+static inline size_t caerBitPackBlock(uint8_t *out, const uint32_t *values, uint8_t width) {
+	uint64_t bitBuffer = 0;
+	uint32_t bitCount  = 0;
+	size_t outPosition = 0;
+
+	for (size_t i = 0; i < CAER_BITPACK_BLOCK_SIZE; i++) {
+		bitBuffer |= ((uint64_t) values[i]) << bitCount;
+		bitCount += width;
+
+		while (bitCount >= 8) {
+			out[outPosition++] = (uint8_t) bitBuffer;
+			bitBuffer >>= 8;
+			bitCount -= 8;
+		}
+	}
+
+	// 32 values always fill complete bytes, nothing left over.
+	return (outPosition);
+}
+
+/**
+ * Unpack one block of values at the given width. Each value is extracted
+ * independently with one unaligned 64 bit load, so 'in' must have at least
+ * 8 readable bytes after the end of the block.
+ */
+static inline void caerBitUnpackBlockUnsafe(uint32_t *values, const uint8_t *in, uint8_t width) {
+	uint64_t mask = (((uint64_t) 1) << width) - 1;
+
+	for (size_t i = 0; i < CAER_BITPACK_BLOCK_SIZE; i++) {
+		size_t bitOffset = i * width;
+
+		uint64_t bits;
+		memcpy(&bits, in + (bitOffset / 8), sizeof(uint64_t));
+
+		values[i] = (uint32_t)((le64toh(bits) >> (bitOffset % 8)) & mask);
+	}
+}
+
+/**
+ * Unpack one block of values at the given width (at most 32), never reading
+ * past 'inEnd'. Blocks close to the end are copied to a padded buffer first.
+ */
+static inline void caerBitUnpackBlock(uint32_t *values, const uint8_t *in, const uint8_t *inEnd, uint8_t width) {
+	size_t blockBytes = CAER_BITPACK_BLOCK_BYTES(width);
+
+	if ((size_t)(inEnd - in) >= (blockBytes + sizeof(uint64_t))) {
+		caerBitUnpackBlockUnsafe(values, in, width);
+	}
+	else {
+		// Widest possible block, plus padding for the 64 bit loads.
+		uint8_t paddedBlock[CAER_BITPACK_BLOCK_BYTES(32) + sizeof(uint64_t)];
+
+		memcpy(paddedBlock, in, blockBytes);
+		memset(paddedBlock + blockBytes, 0, sizeof(uint64_t));
+
+		caerBitUnpackBlockUnsafe(values, paddedBlock, width);
+	}
+}
+
+#endif /* INPUT_OUTPUT_BITPACK_H_ */
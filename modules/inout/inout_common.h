@@ -4,10 +4,103 @@
 #include <libcaer/network.h>
 #include "caer-sdk/utils.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Segment index. Segmented file recordings end each segment with an index
+ * of its event packets, so readers can seek by time without scanning the
+ * whole file. The index is laid out as an event packet: a standard packet
+ * header with event type INOUT_INDEX_PACKET_TYPE, event source -1 (so
+ * readers not knowing about it skip it as a packet from a foreign source),
+ * event size 16 and number/valid/capacity the number of entries, followed
+ * by one entry per event packet in file order: 64 bit first timestamp and
+ * 64 bit offset from the start of the file, both little-endian.
+ * The '#Index-Offset: ' file header line gives the offset of the index,
+ * or 0 if the segment has no index (recording not stopped properly).
+ */
+#define INOUT_INDEX_PACKET_TYPE 0x7FFF
+#define INOUT_INDEX_PACKET_SOURCE -1
+#define INOUT_INDEX_HEADER_LINE "#Index-Offset: 0x%016" PRIX64 "\r\n"
+#define INOUT_INDEX_HEADER_LINE_LENGTH 35
+
+struct inout_index_entry {
+	int64_t timestamp;
+	uint64_t offset;
+} __attribute__((__packed__));
+
+/*
+ * UDP forward error correction. With FEC enabled, the UDP output follows
+ * each group of consecutive datagrams (network header plus data, as usual)
+ * with a parity datagram, from which receivers can rebuild any single lost
+ * datagram of the group without retransmission. The parity datagram starts
+ * with a network header with magic number INOUT_FEC_MAGIC_NUMBER (so that
+ * receivers not knowing about it drop it as invalid) and the sequence number
+ * of the first datagram of the group (highest bit zero), followed by struct
+ * inout_fec_header and the XOR of all datagrams of the group, each one
+ * zero-padded to the length of the longest. A lost datagram is the XOR of
+ * the parity data with all the others, cut to the XOR of their lengths,
+ * and is at the position in the group its sequence number is missing from.
+ * All fields are little-endian.
+ */
+#define INOUT_FEC_MAGIC_NUMBER 0x3143454652454143LL // "CAERFEC1" in little-endian.
+#define INOUT_FEC_MAX_GROUP_SIZE 32
+
+struct inout_fec_header {
+	/// Number of datagrams in the group.
+	uint16_t groupSize;
+	uint16_t reserved;
+	/// XOR of the lengths in bytes of all datagrams in the group.
+	uint32_t lengthParity;
+} __attribute__((__packed__));
+
 static inline void caerGenericEventSetTimestamp(
 	void *eventPtr, caerEventPacketHeaderConst headerPtr, int32_t timestamp) {
 	*((int32_t *) (((uint8_t *) eventPtr) + U64T(caerEventPacketHeaderGetEventTSOffset(headerPtr))))
 		= htole32(timestamp);
 }
 
+/**
+ * Read a whole file into memory, used for compression dictionaries.
+ *
+ * @param filePath path of the file to read.
+ * @param fileSize set to the size of the file in bytes on success.
+ *
+ * @return the file content (to be free()'d), or NULL on failure.
+ */
+static inline uint8_t *caerInOutReadFile(const char *filePath, size_t *fileSize) {
+	FILE *file = fopen(filePath, "rb");
+	if (file == NULL) {
+		return (NULL);
+	}
+
+	if (fseek(file, 0, SEEK_END) != 0) {
+		fclose(file);
+		return (NULL);
+	}
+
+	long size = ftell(file);
+	if (size <= 0 || fseek(file, 0, SEEK_SET) != 0) {
+		fclose(file);
+		return (NULL);
+	}
+
+	uint8_t *content = malloc((size_t) size);
+	if (content == NULL) {
+		fclose(file);
+		return (NULL);
+	}
+
+	if (fread(content, 1, (size_t) size, file) != (size_t) size) {
+		free(content);
+		fclose(file);
+		return (NULL);
+	}
+
+	fclose(file);
+
+	*fileSize = (size_t) size;
+	return (content);
+}
+
 #endif /* INPUT_OUTPUT_COMMON_H_ */
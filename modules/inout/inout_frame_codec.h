@@ -0,0 +1,380 @@
+#ifndef INPUT_OUTPUT_FRAME_CODEC_H_
+#define INPUT_OUTPUT_FRAME_CODEC_H_
+
+/*
+ * Fast lossless frame codec (FastFrames format, formatID 0x20).
+ * Much cheaper than PNG/zlib: pixels are predicted, and the prediction
+ * residuals are zig-zag coded and bit-packed (see inout_bitpack.h).
+ * Key frames predict each pixel from its neighbors in the same channel,
+ * using the median edge detector from LOCO-I/JPEG-LS. Delta frames predict
+ * each pixel from the same pixel of the previous frame with the same event
+ * source and ROI identifier, which is very effective for mostly static scenes.
+ * Frame pixels are often shifted up from the ADC resolution (low bits always
+ * zero), so common trailing zero bits are removed before prediction.
+ *
+ * Encoded frame layout (all little-endian):
+ * - uint8 flags: bit 0 set for delta frames.
+ * - uint8 shift: number of trailing zero bits removed from all pixels.
+ * - uint16 sequence: number of this frame, counted per source and ROI identifier.
+ * - uint16 reference sequence: number of the frame a delta frame was
+ *   predicted from, so decoders can detect if they don't have it (lost
+ *   packets, joined a stream late); 0 for key frames.
+ * - uint16 padding, always 0.
+ * - residuals in blocks of 32: 1 byte width, then 4 * width bytes.
+ */
+
+#include "inout_bitpack.h"
+
+#include <libcaer/events/frame.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_CODEC_HEADER_SIZE 8
+#define FRAME_CODEC_FLAG_DELTA 0x01
+/// One reference per possible ROI identifier (7 bits).
+#define FRAME_CODEC_MAX_REFERENCES 128
+
+/// Maximum encoded size in bytes, for N pixel values: header plus, per block,
+/// width byte and residuals at their largest (17 bits).
+#define FRAME_CODEC_MAX_SIZE(N)                                                                         \
+	(FRAME_CODEC_HEADER_SIZE                                                                            \
+		+ ((((N) + CAER_BITPACK_BLOCK_SIZE - 1) / CAER_BITPACK_BLOCK_SIZE) * (1 + CAER_BITPACK_BLOCK_BYTES(17))))
+
+/**
+ * Last frame seen for one ROI identifier, the prediction source for delta
+ * frames. Encoder and decoder keep identical copies.
+ */
+struct caer_frame_codec_reference {
+	/// Pixels of the reference frame.
+	uint16_t *pixels;
+	/// Allocated size of pixels, in values.
+	size_t pixelsCapacity;
+	/// Format of the reference frame, delta frames must match it.
+	int32_t lengthX;
+	int32_t lengthY;
+	int32_t channels;
+	/// Sequence number of the reference frame.
+	uint16_t sequence;
+	/// Frames encoded since the last key frame (encoder only).
+	uint32_t framesSinceKey;
+	/// Reference holds a valid frame.
+	bool valid;
+};
+
+enum caer_frame_codec_result {
+	FRAME_CODEC_OK,
+	FRAME_CODEC_MALFORMED,
+	FRAME_CODEC_NO_REFERENCE,
+};
+
+/**
+ * Median edge detector: predict from left (a), up (b) and up-left (c).
+ */
+static inline int32_t frameCodecPredict(int32_t a, int32_t b, int32_t c) {
+	int32_t minAB = (a < b) ? (a) : (b);
+	int32_t maxAB = (a < b) ? (b) : (a);
+
+	if (c >= maxAB) {
+		return (minAB);
+	}
+
+	if (c <= minAB) {
+		return (maxAB);
+	}
+
+	return (a + b - c);
+}
+
+/**
+ * Predict a key frame pixel from its already known neighbors in the same channel.
+ */
+static inline int32_t frameCodecPredictSpatial(
+	const uint16_t *values, uint8_t shift, size_t idx, int32_t x, int32_t y, size_t rowStride, size_t channels) {
+	if (y == 0) {
+		return ((x == 0) ? (0) : (values[idx - channels] >> shift));
+	}
+
+	if (x == 0) {
+		return (values[idx - rowStride] >> shift);
+	}
+
+	return (frameCodecPredict(values[idx - channels] >> shift, values[idx - rowStride] >> shift,
+		values[idx - rowStride - channels] >> shift));
+}
+
+/**
+ * Check if a reference can be used to predict a frame of the given format.
+ */
+static inline bool caerFrameCodecReferenceMatches(
+	const struct caer_frame_codec_reference *reference, int32_t lengthX, int32_t lengthY, int32_t channels) {
+	return ((reference != NULL) && reference->valid && (reference->lengthX == lengthX)
+			&& (reference->lengthY == lengthY) && (reference->channels == channels));
+}
+
+/**
+ * Store a frame as the new reference for its ROI identifier.
+ *
+ * @return true on success, false on memory allocation failure (reference is invalid then).
+ */
+static inline bool caerFrameCodecReferenceUpdate(struct caer_frame_codec_reference *reference,
+	const uint16_t *pixels, int32_t lengthX, int32_t lengthY, int32_t channels, uint16_t sequence) {
+	size_t pixelsNumber = (size_t) lengthX * (size_t) lengthY * (size_t) channels;
+
+	if (reference->pixelsCapacity < pixelsNumber) {
+		uint16_t *newPixels = realloc(reference->pixels, pixelsNumber * sizeof(uint16_t));
+		if (newPixels == NULL) {
+			reference->valid = false;
+			return (false);
+		}
+
+		reference->pixels         = newPixels;
+		reference->pixelsCapacity = pixelsNumber;
+	}
+
+	memcpy(reference->pixels, pixels, pixelsNumber * sizeof(uint16_t));
+
+	reference->lengthX  = lengthX;
+	reference->lengthY  = lengthY;
+	reference->channels = channels;
+	reference->sequence = sequence;
+	reference->valid    = true;
+
+	return (true);
+}
+
+static inline void caerFrameCodecReferenceFree(struct caer_frame_codec_reference *reference) {
+	free(reference->pixels);
+	memset(reference, 0, sizeof(*reference));
+}
+
+/**
+ * References of all ROI identifiers of one event source. A stream can carry
+ * frames of several sources (multi-source files), each with its own ROIs.
+ */
+struct caer_frame_codec_source_references {
+	int16_t sourceID;
+	struct caer_frame_codec_reference references[FRAME_CODEC_MAX_REFERENCES];
+};
+
+/**
+ * Get the references of an event source, adding empty ones if the source
+ * wasn't seen yet. Adding may move the table, previously returned references
+ * must not be used anymore afterwards.
+ *
+ * @param table references of all sources seen so far, grown as needed.
+ * @param tableSize number of sources in the table.
+ * @param sourceID event source of the frames.
+ *
+ * @return references of the source, indexed by ROI identifier, NULL on memory allocation failure.
+ */
+static inline struct caer_frame_codec_reference *caerFrameCodecSourceReferences(
+	struct caer_frame_codec_source_references **table, size_t *tableSize, int16_t sourceID) {
+	for (size_t i = 0; i < *tableSize; i++) {
+		if ((*table)[i].sourceID == sourceID) {
+			return ((*table)[i].references);
+		}
+	}
+
+	struct caer_frame_codec_source_references *newTable
+		= realloc(*table, (*tableSize + 1) * sizeof(struct caer_frame_codec_source_references));
+	if (newTable == NULL) {
+		return (NULL);
+	}
+
+	*table = newTable;
+
+	struct caer_frame_codec_source_references *source = &newTable[(*tableSize)++];
+	memset(source, 0, sizeof(*source));
+	source->sourceID = sourceID;
+
+	return (source->references);
+}
+
+static inline void caerFrameCodecSourceReferencesFree(
+	struct caer_frame_codec_source_references **table, size_t *tableSize) {
+	for (size_t i = 0; i < *tableSize; i++) {
+		for (size_t j = 0; j < FRAME_CODEC_MAX_REFERENCES; j++) {
+			caerFrameCodecReferenceFree(&(*table)[i].references[j]);
+		}
+	}
+
+	free(*table);
+	*table     = NULL;
+	*tableSize = 0;
+}
+
+/**
+ * Encode a frame's pixels.
+ *
+ * @param out memory for the encoded data, at least FRAME_CODEC_MAX_SIZE(pixels number) bytes.
+ * @param pixels frame pixels.
+ * @param lengthX frame width.
+ * @param lengthY frame height.
+ * @param channels number of color channels.
+ * @param reference previous frame to encode a delta frame against, NULL for a key frame.
+ *                  Must match the frame's format (see caerFrameCodecReferenceMatches()).
+ * @param sequence sequence number of this frame.
+ *
+ * @return size in bytes of the encoded data.
+ */
+static inline size_t caerFrameCodecEncode(uint8_t *out, const uint16_t *pixels, int32_t lengthX, int32_t lengthY,
+	int32_t channels, const struct caer_frame_codec_reference *reference, uint16_t sequence) {
+	size_t rowStride    = (size_t) lengthX * (size_t) channels;
+	size_t pixelsNumber = rowStride * (size_t) lengthY;
+
+	// Remove trailing zero bits common to all pixels.
+	uint32_t combined = 0;
+	for (size_t i = 0; i < pixelsNumber; i++) {
+		combined |= pixels[i];
+	}
+
+	uint8_t shift = (combined == 0) ? (0) : (uint8_t) __builtin_ctz(combined);
+
+	out[0] = (reference != NULL) ? (FRAME_CODEC_FLAG_DELTA) : (0);
+	out[1] = shift;
+
+	uint16_t header16[3] = {htole16(sequence), htole16((reference != NULL) ? (reference->sequence) : (0)), 0};
+	memcpy(out + 2, header16, sizeof(header16));
+
+	size_t outPosition = FRAME_CODEC_HEADER_SIZE;
+
+	uint32_t residuals[CAER_BITPACK_BLOCK_SIZE];
+
+	for (size_t blockStart = 0; blockStart < pixelsNumber; blockStart += CAER_BITPACK_BLOCK_SIZE) {
+		memset(residuals, 0, sizeof(residuals));
+
+		size_t blockPixels = pixelsNumber - blockStart;
+		if (blockPixels > CAER_BITPACK_BLOCK_SIZE) {
+			blockPixels = CAER_BITPACK_BLOCK_SIZE;
+		}
+
+		if (reference != NULL) {
+			for (size_t i = 0; i < blockPixels; i++) {
+				size_t idx = blockStart + i;
+
+				int32_t residual = (int32_t)(pixels[idx] >> shift) - (int32_t)(reference->pixels[idx] >> shift);
+				residuals[i]     = caerBitPackZigZagEncode((uint32_t) residual);
+			}
+		}
+		else {
+			for (size_t i = 0; i < blockPixels; i++) {
+				size_t idx = blockStart + i;
+				int32_t x  = (int32_t)((idx % rowStride) / (size_t) channels);
+				int32_t y  = (int32_t)(idx / rowStride);
+
+				int32_t prediction = frameCodecPredictSpatial(pixels, shift, idx, x, y, rowStride, (size_t) channels);
+				int32_t residual   = (int32_t)(pixels[idx] >> shift) - prediction;
+				residuals[i]       = caerBitPackZigZagEncode((uint32_t) residual);
+			}
+		}
+
+		uint8_t width     = caerBitPackWidth(residuals);
+		out[outPosition++] = width;
+		outPosition += caerBitPackBlock(out + outPosition, residuals, width);
+	}
+
+	return (outPosition);
+}
+
+/**
+ * Decode a frame's pixels.
+ *
+ * @param pixels memory for the decoded pixels (lengthX * lengthY * channels values).
+ * @param lengthX frame width.
+ * @param lengthY frame height.
+ * @param channels number of color channels.
+ * @param encoded encoded data.
+ * @param encodedSize size in bytes of the encoded data.
+ * @param reference last frame decoded for this frame's ROI identifier, can be NULL.
+ *                  Updated to this frame on success.
+ *
+ * @return FRAME_CODEC_OK on success, FRAME_CODEC_NO_REFERENCE for delta frames whose
+ *         reference frame is not available, FRAME_CODEC_MALFORMED on malformed data.
+ */
+static inline enum caer_frame_codec_result caerFrameCodecDecode(uint16_t *pixels, int32_t lengthX, int32_t lengthY,
+	int32_t channels, const uint8_t *encoded, size_t encodedSize, struct caer_frame_codec_reference *reference) {
+	if (encodedSize < FRAME_CODEC_HEADER_SIZE) {
+		return (FRAME_CODEC_MALFORMED);
+	}
+
+	size_t rowStride    = (size_t) lengthX * (size_t) channels;
+	size_t pixelsNumber = rowStride * (size_t) lengthY;
+
+	bool isDelta  = (encoded[0] & FRAME_CODEC_FLAG_DELTA);
+	uint8_t shift = encoded[1];
+
+	uint16_t header16[3];
+	memcpy(header16, encoded + 2, sizeof(header16));
+
+	uint16_t sequence          = le16toh(header16[0]);
+	uint16_t referenceSequence = le16toh(header16[1]);
+
+	if (shift > 15) {
+		return (FRAME_CODEC_MALFORMED);
+	}
+
+	if (isDelta
+		&& (!caerFrameCodecReferenceMatches(reference, lengthX, lengthY, channels)
+			   || (reference->sequence != referenceSequence))) {
+		return (FRAME_CODEC_NO_REFERENCE);
+	}
+
+	size_t inPosition = FRAME_CODEC_HEADER_SIZE;
+
+	uint32_t residuals[CAER_BITPACK_BLOCK_SIZE];
+
+	for (size_t blockStart = 0; blockStart < pixelsNumber; blockStart += CAER_BITPACK_BLOCK_SIZE) {
+		if (inPosition >= encodedSize) {
+			return (FRAME_CODEC_MALFORMED);
+		}
+
+		uint8_t width = encoded[inPosition++];
+		if (width > 17 || (encodedSize - inPosition) < CAER_BITPACK_BLOCK_BYTES(width)) {
+			return (FRAME_CODEC_MALFORMED);
+		}
+
+		caerBitUnpackBlock(residuals, encoded + inPosition, encoded + encodedSize, width);
+		inPosition += CAER_BITPACK_BLOCK_BYTES(width);
+
+		size_t blockPixels = pixelsNumber - blockStart;
+		if (blockPixels > CAER_BITPACK_BLOCK_SIZE) {
+			blockPixels = CAER_BITPACK_BLOCK_SIZE;
+		}
+
+		if (isDelta) {
+			for (size_t i = 0; i < blockPixels; i++) {
+				size_t idx = blockStart + i;
+
+				uint32_t value = (uint32_t)(reference->pixels[idx] >> shift) + caerBitPackZigZagDecode(residuals[i]);
+				pixels[idx]    = (uint16_t)(value << shift);
+			}
+		}
+		else {
+			for (size_t i = 0; i < blockPixels; i++) {
+				size_t idx = blockStart + i;
+				int32_t x  = (int32_t)((idx % rowStride) / (size_t) channels);
+				int32_t y  = (int32_t)(idx / rowStride);
+
+				int32_t prediction = frameCodecPredictSpatial(pixels, shift, idx, x, y, rowStride, (size_t) channels);
+				uint32_t value     = (uint32_t) prediction + caerBitPackZigZagDecode(residuals[i]);
+				pixels[idx]        = (uint16_t)(value << shift);
+			}
+		}
+	}
+
+	if (inPosition != encodedSize) {
+		return (FRAME_CODEC_MALFORMED);
+	}
+
+	// Decoded frame is the reference for the next one with this ROI.
+	if (reference != NULL) {
+		caerFrameCodecReferenceUpdate(reference, pixels, lengthX, lengthY, channels, sequence);
+	}
+
+	return (FRAME_CODEC_OK);
+}
+
+#endif /* INPUT_OUTPUT_FRAME_CODEC_H_ */
@@ -0,0 +1,156 @@
+#ifndef INPUT_OUTPUT_PACKET_COMPRESSION_H_
+#define INPUT_OUTPUT_PACKET_COMPRESSION_H_
+
+/*
+ * General-purpose packet compression (LZ4Packets format, formatID 0x08, and
+ * ZstdPackets format, formatID 0x10): the data portion of an event packet is
+ * compressed as one block, right after the unchanged packet header.
+ * As for all compressed packets, eventCapacity then holds the size of the
+ * compressed data. Data that doesn't get smaller is sent uncompressed, so
+ * compressed data is always at least one byte smaller than the original.
+ */
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+#include <lz4.h>
+
+/**
+ * Compress data with LZ4. The destination is limited to one byte less than
+ * the input, so LZ4 gives up early on data it can't make smaller.
+ *
+ * @param out memory for the compressed data, at least dataSize - 1 bytes.
+ * @param data data to compress.
+ * @param dataSize size in bytes of the data.
+ *
+ * @return size in bytes of the compressed data, 0 if the data can't be made smaller.
+ */
+static inline size_t caerPacketCompressLZ4(uint8_t *out, const uint8_t *data, size_t dataSize) {
+	if (dataSize < 2 || dataSize > LZ4_MAX_INPUT_SIZE) {
+		return (0);
+	}
+
+	int compressedSize
+		= LZ4_compress_default((const char *) data, (char *) out, (int) dataSize, (int) (dataSize - 1));
+	if (compressedSize <= 0) {
+		return (0);
+	}
+
+	return ((size_t) compressedSize);
+}
+
+/**
+ * Decompress LZ4 data.
+ *
+ * @param data memory for the decompressed data, must not overlap the compressed data.
+ * @param dataSize expected size in bytes of the decompressed data.
+ * @param compressed compressed data.
+ * @param compressedSize size in bytes of the compressed data.
+ *
+ * @return true if the compressed data decompressed to exactly dataSize
+ *         bytes, false on malformed data.
+ */
+static inline bool caerPacketDecompressLZ4(
+	uint8_t *data, size_t dataSize, const uint8_t *compressed, size_t compressedSize) {
+	if (dataSize > LZ4_MAX_INPUT_SIZE || compressedSize >= dataSize) {
+		return (false);
+	}
+
+	int decompressedSize
+		= LZ4_decompress_safe((const char *) compressed, (char *) data, (int) compressedSize, (int) dataSize);
+
+	return ((decompressedSize >= 0) && ((size_t) decompressedSize == dataSize));
+}
+
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+#include <zstd.h>
+
+/**
+ * Compress data with Zstd, with a dictionary if given, else at the given level.
+ *
+ * @param context compression context of the calling thread.
+ * @param dictionary trained dictionary, NULL if none.
+ * @param level compression level, only used without dictionary.
+ * @param out memory for the compressed data, at least dataSize - 1 bytes.
+ * @param data data to compress.
+ * @param dataSize size in bytes of the data.
+ *
+ * @return size in bytes of the compressed data, 0 if the data can't be made smaller.
+ */
+static inline size_t caerPacketCompressZstd(ZSTD_CCtx *context, const ZSTD_CDict *dictionary, int level,
+	uint8_t *out, const uint8_t *data, size_t dataSize) {
+	if (dataSize < 2) {
+		return (0);
+	}
+
+	size_t compressedSize;
+
+	if (dictionary != NULL) {
+		compressedSize = ZSTD_compress_usingCDict(context, out, dataSize - 1, data, dataSize, dictionary);
+	}
+	else {
+		compressedSize = ZSTD_compressCCtx(context, out, dataSize - 1, data, dataSize, level);
+	}
+
+	if (ZSTD_isError(compressedSize)) {
+		// Not compressible (destination too small).
+		return (0);
+	}
+
+	return (compressedSize);
+}
+
+/**
+ * Decompress Zstd data.
+ *
+ * @param context decompression context of the calling thread.
+ * @param dictionary dictionary the data was compressed with, NULL if none.
+ * @param data memory for the decompressed data, must not overlap the compressed data.
+ * @param dataSize expected size in bytes of the decompressed data.
+ * @param compressed compressed data.
+ * @param compressedSize size in bytes of the compressed data.
+ * @param errorName set to the Zstd error description if decompression
+ *                  itself failed, to NULL otherwise. Can be NULL.
+ *
+ * @return true if the compressed data decompressed to exactly dataSize
+ *         bytes, false on malformed data.
+ */
+static inline bool caerPacketDecompressZstd(ZSTD_DCtx *context, const ZSTD_DDict *dictionary, uint8_t *data,
+	size_t dataSize, const uint8_t *compressed, size_t compressedSize, const char **errorName) {
+	if (errorName != NULL) {
+		*errorName = NULL;
+	}
+
+	if (compressedSize >= dataSize) {
+		return (false);
+	}
+
+	size_t decompressedSize;
+
+	if (dictionary != NULL) {
+		decompressedSize
+			= ZSTD_decompress_usingDDict(context, data, dataSize, compressed, compressedSize, dictionary);
+	}
+	else {
+		decompressedSize = ZSTD_decompressDCtx(context, data, dataSize, compressed, compressedSize);
+	}
+
+	if (ZSTD_isError(decompressedSize)) {
+		if (errorName != NULL) {
+			*errorName = ZSTD_getErrorName(decompressedSize);
+		}
+
+		return (false);
+	}
+
+	return (decompressedSize == dataSize);
+}
+
+#endif
+
+#endif /* INPUT_OUTPUT_PACKET_COMPRESSION_H_ */
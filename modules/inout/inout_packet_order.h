@@ -0,0 +1,124 @@
+#ifndef INPUT_OUTPUT_PACKET_ORDER_H_
+#define INPUT_OUTPUT_PACKET_ORDER_H_
+
+/*
+ * Ordering of the event packets of a packet container.
+ * Outputs send the packets of a container ordered by the timestamp of their
+ * first event (required), then by type ID (convenience). Inputs accumulate
+ * packets ordered by type ID, then by event size, and keep one packet for
+ * each combination of the two.
+ */
+
+#include <libcaer/events/common.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/// Sort key of an event packet, for ordering the packets of a container.
+struct caer_packet_order {
+	/// Timestamp of the first event.
+	int64_t timestamp;
+	int16_t eventType;
+	caerEventPacketHeader packet;
+};
+
+static inline int caerPacketOrderCmp(const void *a, const void *b) {
+	const struct caer_packet_order *aa = a;
+	const struct caer_packet_order *bb = b;
+
+	// Sort first by timestamp of the first event.
+	if (aa->timestamp < bb->timestamp) {
+		return (-1);
+	}
+	else if (aa->timestamp > bb->timestamp) {
+		return (1);
+	}
+	else {
+		// If equal, further sort by type ID.
+		if (aa->eventType < bb->eventType) {
+			return (-1);
+		}
+		else if (aa->eventType > bb->eventType) {
+			return (1);
+		}
+		else {
+			return (0);
+		}
+	}
+}
+
+/**
+ * Order event packets by the timestamp of their first event, then by type ID.
+ * The sort keys are taken once per packet, instead of on every comparison.
+ * Containers hold few packets and are usually in order already, so an
+ * insertion sort is used: a single pass for packets in order, and without
+ * qsort()'s call per comparison otherwise.
+ *
+ * @param order memory for packetsSize entries, filled with the packets in order.
+ * @param packets event packets to order, each with at least one event.
+ * @param packetsSize number of event packets.
+ */
+static inline void caerPacketOrderByTimestamp(
+	struct caer_packet_order *order, caerEventPacketHeader *packets, size_t packetsSize) {
+	for (size_t i = 0; i < packetsSize; i++) {
+		caerEventPacketHeader packet = packets[i];
+
+		struct caer_packet_order packetOrder = {
+			.timestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, 0), packet),
+			.eventType = caerEventPacketHeaderGetEventType(packet),
+			.packet    = packet,
+		};
+
+		// Move bigger ones up, until the place of this packet is found.
+		size_t j = i;
+		while ((j > 0) && (caerPacketOrderCmp(&order[j - 1], &packetOrder) > 0)) {
+			order[j] = order[j - 1];
+			j--;
+		}
+
+		order[j] = packetOrder;
+	}
+}
+
+/**
+ * Sort key for packets ordered by type ID first, then by event size.
+ * Event sizes are never negative, so the key keeps the same order as comparing both.
+ */
+static inline int64_t caerPacketTypeSizeKey(int16_t eventType, int32_t eventSize) {
+	return ((I64T(eventType) * 4294967296LL) + eventSize);
+}
+
+/**
+ * Find the packet with the given type ID and event size, in packets ordered
+ * by type ID, then by event size. The search stops at the first bigger one,
+ * which is also where a new packet has to go to keep the order.
+ *
+ * @param packets event packets, ordered by type ID, then by event size.
+ * @param packetsSize number of event packets.
+ * @param eventType type ID to find.
+ * @param eventSize event size to find.
+ * @param index set to the index of the packet if found, else to the index
+ *              a new packet with this type ID and event size has to be inserted at.
+ *
+ * @return true if found, false otherwise.
+ */
+static inline bool caerPacketFindTypeSize(
+	caerEventPacketHeader *packets, size_t packetsSize, int16_t eventType, int32_t eventSize, size_t *index) {
+	int64_t key = caerPacketTypeSizeKey(eventType, eventSize);
+
+	for (size_t i = 0; i < packetsSize; i++) {
+		int64_t packetKey = caerPacketTypeSizeKey(
+			caerEventPacketHeaderGetEventType(packets[i]), caerEventPacketHeaderGetEventSize(packets[i]));
+
+		if (packetKey >= key) {
+			*index = i;
+			return (packetKey == key);
+		}
+	}
+
+	*index = packetsSize;
+	return (false);
+}
+
+#endif /* INPUT_OUTPUT_PACKET_ORDER_H_ */
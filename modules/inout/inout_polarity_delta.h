@@ -0,0 +1,177 @@
+#ifndef INPUT_OUTPUT_POLARITY_DELTA_H_
+#define INPUT_OUTPUT_POLARITY_DELTA_H_
+
+/*
+ * Delta-coded polarity events (PolarityDelta format, formatID 0x04).
+ * Polarity events are split into four streams: timestamp, X address,
+ * Y address (as differences to the previous event, zig-zag coded so
+ * small negative values stay small), and the two flag bits (polarity,
+ * valid mark) as they are.
+ * The encoded data starts with the first event's timestamp (4 bytes,
+ * little-endian), followed by one block per 32 events (the last one
+ * padded with zeros): 4 bytes giving the bit width of each stream in
+ * this block (timestamp, X, Y, flags), then the 32 values of each
+ * stream, bit-packed at that width (see inout_bitpack.h).
+ * Lossless, as the streams hold all 64 bits of each event.
+ */
+
+#include "inout_bitpack.h"
+
+#include <libcaer/events/polarity.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define POLARITY_DELTA_BLOCK_SIZE CAER_BITPACK_BLOCK_SIZE
+#define POLARITY_DELTA_STREAMS 4
+
+/// Maximum encoded size in bytes, for N events: base timestamp plus, per block,
+/// widths and streams at their largest (32 bit timestamp, 16 bit X/Y, 2 bit flags).
+#define POLARITY_DELTA_MAX_SIZE(N)                                             \
+	(sizeof(int32_t)                                                           \
+		+ ((((N) + POLARITY_DELTA_BLOCK_SIZE - 1) / POLARITY_DELTA_BLOCK_SIZE) \
+			  * (POLARITY_DELTA_STREAMS + ((POLARITY_DELTA_BLOCK_SIZE / 8) * (32 + 16 + 16 + 2)))))
+
+/**
+ * Encode polarity events.
+ *
+ * @param out memory for the encoded data, at least POLARITY_DELTA_MAX_SIZE(eventNumber) bytes.
+ * @param events polarity events to encode.
+ * @param eventNumber number of events.
+ *
+ * @return size in bytes of the encoded data.
+ */
+static inline size_t caerPolarityDeltaEncode(uint8_t *out, const uint8_t *events, size_t eventNumber) {
+	if (eventNumber == 0) {
+		return (0);
+	}
+
+	const struct caer_polarity_event *polarityEvents = (const struct caer_polarity_event *) (const void *) events;
+
+	uint32_t lastTimestamp = le32toh(U32T(polarityEvents[0].timestamp));
+	uint32_t lastX         = 0;
+	uint32_t lastY         = 0;
+
+	uint32_t baseTimestamp = htole32(lastTimestamp);
+	memcpy(out, &baseTimestamp, sizeof(uint32_t));
+	size_t outPosition = sizeof(uint32_t);
+
+	uint32_t streams[POLARITY_DELTA_STREAMS][POLARITY_DELTA_BLOCK_SIZE];
+
+	for (size_t blockStart = 0; blockStart < eventNumber; blockStart += POLARITY_DELTA_BLOCK_SIZE) {
+		memset(streams, 0, sizeof(streams));
+
+		size_t blockEvents = eventNumber - blockStart;
+		if (blockEvents > POLARITY_DELTA_BLOCK_SIZE) {
+			blockEvents = POLARITY_DELTA_BLOCK_SIZE;
+		}
+
+		for (size_t i = 0; i < blockEvents; i++) {
+			uint32_t data      = le32toh(polarityEvents[blockStart + i].data);
+			uint32_t timestamp = le32toh(U32T(polarityEvents[blockStart + i].timestamp));
+			uint32_t x         = (data >> POLARITY_X_ADDR_SHIFT) & POLARITY_X_ADDR_MASK;
+			uint32_t y         = (data >> POLARITY_Y_ADDR_SHIFT) & POLARITY_Y_ADDR_MASK;
+
+			// Differences in 32 bit wrap-around arithmetic, always reversible.
+			streams[0][i] = caerBitPackZigZagEncode(timestamp - lastTimestamp);
+			streams[1][i] = caerBitPackZigZagEncode(x - lastX);
+			streams[2][i] = caerBitPackZigZagEncode(y - lastY);
+			streams[3][i] = data & 0x03;
+
+			lastTimestamp = timestamp;
+			lastX         = x;
+			lastY         = y;
+		}
+
+		uint8_t *widths = out + outPosition;
+		outPosition += POLARITY_DELTA_STREAMS;
+
+		for (size_t s = 0; s < POLARITY_DELTA_STREAMS; s++) {
+			widths[s] = caerBitPackWidth(streams[s]);
+			outPosition += caerBitPackBlock(out + outPosition, streams[s], widths[s]);
+		}
+	}
+
+	return (outPosition);
+}
+
+/**
+ * Decode polarity events.
+ *
+ * @param events memory for the decoded events (eventNumber * 8 bytes).
+ * @param eventNumber number of events expected.
+ * @param encoded encoded data.
+ * @param encodedSize size in bytes of the encoded data.
+ *
+ * @return true if exactly all encoded data was decoded into exactly the
+ *         number of expected events, false on malformed data.
+ */
+static inline bool caerPolarityDeltaDecode(
+	uint8_t *events, size_t eventNumber, const uint8_t *encoded, size_t encodedSize) {
+	if (eventNumber == 0) {
+		return (encodedSize == 0);
+	}
+
+	if (encodedSize < sizeof(uint32_t)) {
+		return (false);
+	}
+
+	struct caer_polarity_event *polarityEvents = (struct caer_polarity_event *) (void *) events;
+
+	uint32_t lastTimestamp;
+	memcpy(&lastTimestamp, encoded, sizeof(uint32_t));
+	lastTimestamp = le32toh(lastTimestamp);
+
+	uint32_t lastX = 0;
+	uint32_t lastY = 0;
+
+	size_t inPosition = sizeof(uint32_t);
+
+	uint32_t streams[POLARITY_DELTA_STREAMS][POLARITY_DELTA_BLOCK_SIZE];
+
+	for (size_t blockStart = 0; blockStart < eventNumber; blockStart += POLARITY_DELTA_BLOCK_SIZE) {
+		if ((encodedSize - inPosition) < POLARITY_DELTA_STREAMS) {
+			return (false);
+		}
+
+		const uint8_t *widths = encoded + inPosition;
+		inPosition += POLARITY_DELTA_STREAMS;
+
+		for (size_t s = 0; s < POLARITY_DELTA_STREAMS; s++) {
+			if (widths[s] > 32) {
+				return (false);
+			}
+
+			size_t blockBytes = CAER_BITPACK_BLOCK_BYTES(widths[s]);
+
+			if ((encodedSize - inPosition) < blockBytes) {
+				return (false);
+			}
+
+			caerBitUnpackBlock(streams[s], encoded + inPosition, encoded + encodedSize, widths[s]);
+			inPosition += blockBytes;
+		}
+
+		size_t blockEvents = eventNumber - blockStart;
+		if (blockEvents > POLARITY_DELTA_BLOCK_SIZE) {
+			blockEvents = POLARITY_DELTA_BLOCK_SIZE;
+		}
+
+		for (size_t i = 0; i < blockEvents; i++) {
+			lastTimestamp += caerBitPackZigZagDecode(streams[0][i]);
+			lastX += caerBitPackZigZagDecode(streams[1][i]);
+			lastY += caerBitPackZigZagDecode(streams[2][i]);
+
+			uint32_t data = ((lastX & POLARITY_X_ADDR_MASK) << POLARITY_X_ADDR_SHIFT)
+							| ((lastY & POLARITY_Y_ADDR_MASK) << POLARITY_Y_ADDR_SHIFT) | (streams[3][i] & 0x03);
+
+			polarityEvents[blockStart + i].data      = htole32(data);
+			polarityEvents[blockStart + i].timestamp = I32T(htole32(lastTimestamp));
+		}
+	}
+
+	return (inPosition == encodedSize);
+}
+
+#endif /* INPUT_OUTPUT_POLARITY_DELTA_H_ */
@@ -0,0 +1,427 @@
+#ifndef INPUT_OUTPUT_SERIALIZED_TS_H_
+#define INPUT_OUTPUT_SERIALIZED_TS_H_
+
+/*
+ * Serialized timestamps (SerializedTS format, formatID 0x01): runs of at
+ * least 3 events with the same timestamp keep their first event, with the
+ * highest timestamp bit set to one, and their second event, whose timestamp
+ * holds the number of further events. Those then follow as data only, with
+ * their timestamp (always the last member of an event) removed.
+ * See compressTimestampSerialize() in output_common.c for the details.
+ *
+ * Both directions have a generic implementation, working on any event type
+ * with the timestamp as last member, and an AVX2 one for the common 8 byte
+ * events with 4 bytes of data (polarity), selected at run-time. The encoded
+ * output is exactly the same in both cases.
+ */
+
+#include <libcaer/events/common.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#	define SERIALIZED_TS_HAVE_AVX2 1
+#	include <immintrin.h>
+#endif
+
+#define SERIALIZED_TS_RUN_MIN 3
+#define SERIALIZED_TS_RUN_MARK I32T(0x80000000)
+
+static inline int32_t serializedTSGet(const uint8_t *event, size_t tsOffset) {
+	int32_t timestamp;
+	memcpy(&timestamp, event + tsOffset, sizeof(int32_t));
+
+	return (I32T(le32toh(U32T(timestamp))));
+}
+
+static inline void serializedTSSet(uint8_t *event, size_t tsOffset, int32_t timestamp) {
+	timestamp = I32T(htole32(U32T(timestamp)));
+	memcpy(event + tsOffset, &timestamp, sizeof(int32_t));
+}
+
+/**
+ * Find the end of the run of events with the same timestamp as the
+ * one at index 'start' (generic implementation).
+ *
+ * @return index of the first event with a different timestamp, or eventNumber.
+ */
+static inline size_t serializedTSRunEnd(
+	const uint8_t *events, size_t start, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	int32_t timestamp = serializedTSGet(events + (start * eventSize), tsOffset);
+
+	size_t end = start + 1;
+
+	while (end < eventNumber && serializedTSGet(events + (end * eventSize), tsOffset) == timestamp) {
+		end++;
+	}
+
+	return (end);
+}
+
+/**
+ * Find the start of the next run of at least SERIALIZED_TS_RUN_MIN events
+ * with the same timestamp, starting at index 'start', which must not
+ * continue a run of the event before it (generic implementation).
+ *
+ * @return index of the first event of the run, or eventNumber if none.
+ */
+static inline size_t serializedTSRunStart(
+	const uint8_t *events, size_t start, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	while ((start + 2) < eventNumber) {
+		int32_t timestamp = serializedTSGet(events + (start * eventSize), tsOffset);
+
+		if (serializedTSGet(events + ((start + 1) * eventSize), tsOffset) != timestamp) {
+			start += 1;
+		}
+		else if (serializedTSGet(events + ((start + 2) * eventSize), tsOffset) != timestamp) {
+			// Next event can't start a run either, it has only one follower with its timestamp.
+			start += 2;
+		}
+		else {
+			return (start);
+		}
+	}
+
+	return (eventNumber);
+}
+
+/**
+ * Copy only the data part of events (everything before the timestamp)
+ * back to back. Destination may overlap source, as long as it's before it.
+ */
+static inline void serializedTSPackData(
+	uint8_t *dest, const uint8_t *events, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	for (size_t i = 0; i < eventNumber; i++) {
+		memmove(dest + (i * tsOffset), events + (i * eventSize), tsOffset);
+	}
+}
+
+/**
+ * Restore events from data parts stored back to back, adding the timestamp.
+ */
+static inline void serializedTSExpandData(
+	uint8_t *dest, const uint8_t *data, size_t eventNumber, size_t eventSize, size_t tsOffset, int32_t timestamp) {
+	for (size_t i = 0; i < eventNumber; i++) {
+		memcpy(dest + (i * eventSize), data + (i * tsOffset), tsOffset);
+		serializedTSSet(dest + (i * eventSize), tsOffset, timestamp);
+	}
+}
+
+/**
+ * Find the first event whose timestamp has the run mark set,
+ * starting at index 'start' (generic implementation).
+ *
+ * @return index of the marked event, or eventNumber if none.
+ */
+static inline size_t serializedTSFindMark(
+	const uint8_t *events, size_t start, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	while (start < eventNumber && !(serializedTSGet(events + (start * eventSize), tsOffset) & SERIALIZED_TS_RUN_MARK)) {
+		start++;
+	}
+
+	return (start);
+}
+
+#ifdef SERIALIZED_TS_HAVE_AVX2
+
+// The AVX2 variants only handle 8 byte events: 4 bytes data, then 4 bytes timestamp.
+// They process 8 events (64 bytes) at a time, and finish with the generic code.
+
+__attribute__((target("avx2"))) static inline size_t serializedTSRunEndAVX2(
+	const uint8_t *events, size_t start, size_t eventNumber) {
+	int32_t startTimestamp = serializedTSGet(events + (start * 8), 4);
+	__m256i timestamp      = _mm256_set1_epi32(I32T(htole32(U32T(startTimestamp))));
+
+	size_t end = start + 1;
+
+	while ((end + 8) <= eventNumber) {
+		__m256i eventsLow  = _mm256_loadu_si256((const __m256i *) (const void *) (events + (end * 8)));
+		__m256i eventsHigh = _mm256_loadu_si256((const __m256i *) (const void *) (events + (end * 8) + 32));
+
+		// One bit per 32 bit lane, timestamps are in the odd lanes.
+		unsigned int equalLow
+			= (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(eventsLow, timestamp)));
+		unsigned int equalHigh
+			= (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(eventsHigh, timestamp)));
+
+		unsigned int different = ((~equalLow) & 0xAA) | (((~equalHigh) & 0xAA) << 8);
+
+		if (different != 0) {
+			return (end + ((size_t) __builtin_ctz(different) / 2));
+		}
+
+		end += 8;
+	}
+
+	while (end < eventNumber && serializedTSGet(events + (end * 8), 4) == startTimestamp) {
+		end++;
+	}
+
+	return (end);
+}
+
+__attribute__((target("avx2"))) static inline size_t serializedTSRunStartAVX2(
+	const uint8_t *events, size_t start, size_t eventNumber) {
+	// Compare 8 events with the 8 starting one and two events later, which
+	// need 10 events in total.
+	while ((start + 10) <= eventNumber) {
+		const uint8_t *block = events + (start * 8);
+
+		__m256i eventsLow  = _mm256_loadu_si256((const __m256i *) (const void *) block);
+		__m256i eventsHigh = _mm256_loadu_si256((const __m256i *) (const void *) (block + 32));
+		__m256i nextLow    = _mm256_loadu_si256((const __m256i *) (const void *) (block + 8));
+		__m256i nextHigh   = _mm256_loadu_si256((const __m256i *) (const void *) (block + 40));
+		__m256i afterLow   = _mm256_loadu_si256((const __m256i *) (const void *) (block + 16));
+		__m256i afterHigh  = _mm256_loadu_si256((const __m256i *) (const void *) (block + 48));
+
+		__m256i equalLow
+			= _mm256_and_si256(_mm256_cmpeq_epi32(eventsLow, nextLow), _mm256_cmpeq_epi32(eventsLow, afterLow));
+		__m256i equalHigh
+			= _mm256_and_si256(_mm256_cmpeq_epi32(eventsHigh, nextHigh), _mm256_cmpeq_epi32(eventsHigh, afterHigh));
+
+		// One bit per 32 bit lane, timestamps are in the odd lanes.
+		unsigned int runs = ((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(equalLow)) & 0xAA)
+							| (((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(equalHigh)) & 0xAA) << 8);
+
+		if (runs != 0) {
+			return (start + ((size_t) __builtin_ctz(runs) / 2));
+		}
+
+		start += 8;
+	}
+
+	return (serializedTSRunStart(events, start, eventNumber, 8, 4));
+}
+
+__attribute__((target("avx2"))) static inline void serializedTSPackDataAVX2(
+	uint8_t *dest, const uint8_t *events, size_t eventNumber) {
+	// Move the data lanes (even) of each 128 bit half to its lower 64 bits.
+	const __m256i dataFirst = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+	size_t i = 0;
+
+	// Both loads happen before the store, and the destination is never after
+	// the source: overlapping in-place compaction is safe.
+	for (; (i + 8) <= eventNumber; i += 8) {
+		__m256i eventsLow  = _mm256_loadu_si256((const __m256i *) (const void *) (events + (i * 8)));
+		__m256i eventsHigh = _mm256_loadu_si256((const __m256i *) (const void *) (events + (i * 8) + 32));
+
+		eventsLow  = _mm256_permutevar8x32_epi32(eventsLow, dataFirst);
+		eventsHigh = _mm256_permutevar8x32_epi32(eventsHigh, dataFirst);
+
+		_mm256_storeu_si256(
+			(__m256i *) (void *) (dest + (i * 4)), _mm256_permute2x128_si256(eventsLow, eventsHigh, 0x20));
+	}
+
+	serializedTSPackData(dest + (i * 4), events + (i * 8), eventNumber - i, 8, 4);
+}
+
+__attribute__((target("avx2"))) static inline void serializedTSExpandDataAVX2(
+	uint8_t *dest, const uint8_t *data, size_t eventNumber, int32_t timestamp) {
+	__m256i timestampVec = _mm256_set1_epi32(I32T(htole32(U32T(timestamp))));
+
+	size_t i = 0;
+
+	for (; (i + 8) <= eventNumber; i += 8) {
+		__m256i dataVec = _mm256_loadu_si256((const __m256i *) (const void *) (data + (i * 4)));
+
+		// Interleave data and timestamp, per 128 bit half: events 0,1 | 4,5 and 2,3 | 6,7.
+		__m256i eventsA = _mm256_unpacklo_epi32(dataVec, timestampVec);
+		__m256i eventsB = _mm256_unpackhi_epi32(dataVec, timestampVec);
+
+		_mm256_storeu_si256((__m256i *) (void *) (dest + (i * 8)), _mm256_permute2x128_si256(eventsA, eventsB, 0x20));
+		_mm256_storeu_si256(
+			(__m256i *) (void *) (dest + (i * 8) + 32), _mm256_permute2x128_si256(eventsA, eventsB, 0x31));
+	}
+
+	serializedTSExpandData(dest + (i * 8), data + (i * 4), eventNumber - i, 8, 4, timestamp);
+}
+
+__attribute__((target("avx2"))) static inline size_t serializedTSFindMarkAVX2(
+	const uint8_t *events, size_t start, size_t eventNumber) {
+	while ((start + 8) <= eventNumber) {
+		__m256i eventsLow  = _mm256_loadu_si256((const __m256i *) (const void *) (events + (start * 8)));
+		__m256i eventsHigh = _mm256_loadu_si256((const __m256i *) (const void *) (events + (start * 8) + 32));
+
+		// Sign bit of the odd lanes is the run mark.
+		unsigned int marked = ((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(eventsLow)) & 0xAA)
+							  | (((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(eventsHigh)) & 0xAA) << 8);
+
+		if (marked != 0) {
+			return (start + ((size_t) __builtin_ctz(marked) / 2));
+		}
+
+		start += 8;
+	}
+
+	return (serializedTSFindMark(events, start, eventNumber, 8, 4));
+}
+
+static inline bool serializedTSUseAVX2(size_t eventSize, size_t tsOffset) {
+	if (eventSize != 8 || tsOffset != 4) {
+		return (false);
+	}
+
+	__builtin_cpu_init();
+	return (__builtin_cpu_supports("avx2"));
+}
+
+#else
+
+static inline bool serializedTSUseAVX2(size_t eventSize, size_t tsOffset) {
+	(void) (eventSize);
+	(void) (tsOffset);
+
+	return (false);
+}
+
+#endif
+
+/**
+ * Encode events with serialized timestamps, in place.
+ *
+ * @param events the events to encode, they get overwritten by the encoded data.
+ * @param eventNumber number of events.
+ * @param eventSize size of an event in bytes.
+ * @param tsOffset offset of the timestamp, must be the last 4 bytes of an event.
+ *
+ * @return size in bytes of the encoded data, always equal or smaller than the input.
+ */
+static inline size_t caerSerializedTSEncode(uint8_t *events, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	bool useAVX2 = serializedTSUseAVX2(eventSize, tsOffset);
+
+	size_t encodedSize = 0;
+	size_t plainStart  = 0; // Start of events to copy unchanged.
+
+	while (true) {
+		// Events that are not part of a long enough run are skipped in bulk.
+		size_t runStart = (useAVX2) ? (serializedTSRunStartAVX2(events, plainStart, eventNumber))
+									: (serializedTSRunStart(events, plainStart, eventNumber, eventSize, tsOffset));
+		if (runStart == eventNumber) {
+			break;
+		}
+
+		size_t runEnd = (useAVX2) ? (serializedTSRunEndAVX2(events, runStart, eventNumber))
+								  : (serializedTSRunEnd(events, runStart, eventNumber, eventSize, tsOffset));
+		size_t runLength = runEnd - runStart;
+
+		// Copy the unchanged events before this run in one go (only needed
+		// once the output has become shorter than the input).
+		size_t plainSize = (runStart - plainStart) * eventSize;
+		if (encodedSize != (plainStart * eventSize)) {
+			memmove(events + encodedSize, events + (plainStart * eventSize), plainSize);
+		}
+		encodedSize += plainSize;
+
+		int32_t timestamp = serializedTSGet(events + (runStart * eventSize), tsOffset);
+
+		// First event stays, with the run mark set on its timestamp.
+		memmove(events + encodedSize, events + (runStart * eventSize), eventSize * 2);
+		serializedTSSet(events + encodedSize, tsOffset, timestamp | SERIALIZED_TS_RUN_MARK);
+		encodedSize += eventSize;
+
+		// Second event stays, its timestamp holds how many further events follow.
+		serializedTSSet(events + encodedSize, tsOffset, I32T(runLength - 2));
+		encodedSize += eventSize;
+
+		// Further events: data only, back to back.
+		if (useAVX2) {
+			serializedTSPackDataAVX2(events + encodedSize, events + ((runStart + 2) * 8), runLength - 2);
+		}
+		else {
+			serializedTSPackData(
+				events + encodedSize, events + ((runStart + 2) * eventSize), runLength - 2, eventSize, tsOffset);
+		}
+		encodedSize += (runLength - 2) * tsOffset;
+
+		plainStart = runEnd;
+	}
+
+	// Copy remaining unchanged events.
+	size_t plainSize = (eventNumber - plainStart) * eventSize;
+	if (encodedSize != (plainStart * eventSize)) {
+		memmove(events + encodedSize, events + (plainStart * eventSize), plainSize);
+	}
+	encodedSize += plainSize;
+
+	return (encodedSize);
+}
+
+/**
+ * Decode events with serialized timestamps.
+ *
+ * @param encoded encoded data.
+ * @param encodedSize size in bytes of the encoded data.
+ * @param events memory for the decoded events, must not overlap the encoded data.
+ * @param eventNumber number of events expected.
+ * @param eventSize size of an event in bytes.
+ * @param tsOffset offset of the timestamp, must be the last 4 bytes of an event.
+ *
+ * @return true if exactly all encoded data was decoded into exactly the
+ *         number of expected events, false on malformed data.
+ */
+static inline bool caerSerializedTSDecode(const uint8_t *encoded, size_t encodedSize, uint8_t *events,
+	size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	bool useAVX2 = serializedTSUseAVX2(eventSize, tsOffset);
+
+	size_t encodedPosition = 0;
+	size_t eventsPosition  = 0;
+
+	while (encodedPosition < encodedSize) {
+		// Unchanged events up to the next run, located in one go. Only look at
+		// complete events that fit both in the input and in the output.
+		size_t plainMax = (encodedSize - encodedPosition) / eventSize;
+		if (plainMax > (eventNumber - eventsPosition)) {
+			plainMax = eventNumber - eventsPosition;
+		}
+
+		size_t plainNumber
+			= (useAVX2) ? (serializedTSFindMarkAVX2(encoded + encodedPosition, 0, plainMax))
+						: (serializedTSFindMark(encoded + encodedPosition, 0, plainMax, eventSize, tsOffset));
+
+		memcpy(events + (eventsPosition * eventSize), encoded + encodedPosition, plainNumber * eventSize);
+		encodedPosition += plainNumber * eventSize;
+		eventsPosition += plainNumber;
+
+		if (plainNumber == plainMax) {
+			// No run found in what is left, which then has to be empty.
+			break;
+		}
+
+		// Run: first and second event complete, then data only.
+		if ((encodedSize - encodedPosition) < (eventSize * 2) || (eventNumber - eventsPosition) < 2) {
+			return (false);
+		}
+
+		int32_t timestamp = serializedTSGet(encoded + encodedPosition, tsOffset) & ~SERIALIZED_TS_RUN_MARK;
+		int32_t runLength = serializedTSGet(encoded + encodedPosition + eventSize, tsOffset);
+
+		memcpy(events + (eventsPosition * eventSize), encoded + encodedPosition, eventSize * 2);
+		serializedTSSet(events + (eventsPosition * eventSize), tsOffset, timestamp);
+		serializedTSSet(events + ((eventsPosition + 1) * eventSize), tsOffset, timestamp);
+		encodedPosition += eventSize * 2;
+		eventsPosition += 2;
+
+		if (runLength < 0 || ((size_t) runLength * tsOffset) > (encodedSize - encodedPosition)
+			|| (size_t) runLength > (eventNumber - eventsPosition)) {
+			return (false);
+		}
+
+		if (useAVX2) {
+			serializedTSExpandDataAVX2(
+				events + (eventsPosition * 8), encoded + encodedPosition, (size_t) runLength, timestamp);
+		}
+		else {
+			serializedTSExpandData(events + (eventsPosition * eventSize), encoded + encodedPosition,
+				(size_t) runLength, eventSize, tsOffset, timestamp);
+		}
+		encodedPosition += (size_t) runLength * tsOffset;
+		eventsPosition += (size_t) runLength;
+	}
+
+	return ((encodedPosition == encodedSize) && (eventsPosition == eventNumber));
+}
+
+#endif /* INPUT_OUTPUT_SERIALIZED_TS_H_ */
@@ -0,0 +1,173 @@
+#ifndef INPUT_OUTPUT_SHM_H_
+#define INPUT_OUTPUT_SHM_H_
+
+/*
+ * Shared memory transport, between processes on the same host.
+ * The writer (ShmOutput module) creates a POSIX shared memory segment
+ * named SHM_NAME_PREFIX + name (/dev/shm/caer-NAME on Linux), laid out as:
+ * - struct caer_shm_header, followed by its slotsNumber slot descriptors.
+ * - at dataOffset (page aligned), slotsNumber slots of slotSize bytes each.
+ * Each slot holds one packet container: its event packets back to back,
+ * each as in AEDAT 3 (header plus eventNumber events, eventCapacity equal
+ * to eventNumber, all little-endian), starting at 8 byte aligned offsets.
+ * Container N goes into slot N % slotsNumber. The writer publishes it by
+ * setting the slot's sequence to N, then writeSequence to N + 1, then
+ * incrementing the wakeup word (a futex on Linux).
+ * Readers (any number up to SHM_MAX_READERS) register by claiming a free
+ * entry in readers with their process ID. To read container N in place,
+ * a reader first sets its readSequence to N, then checks the slot's
+ * sequence is still N. The writer marks a slot as invalid before reusing
+ * it, then checks that no reader holds it, spinning for at most a few
+ * microseconds on readers setting their readSequence back to
+ * SHM_NO_SEQUENCE. If they don't, the writer drops containers instead of
+ * reusing that slot, until they do. So a slot stays untouched
+ * for as long as any reader holds it, while readers falling behind by
+ * more than slotsNumber containers just lose the oldest ones and never
+ * stall the writer, nor each other. Readers should hold a slot only
+ * briefly: ShmInput copies each container out of its slot (packets in the
+ * mainloop must be freeable), other programs can read slots in place.
+ * The writer's process ID lets readers, and a new writer, tell a writer
+ * that crashed without resetting writerActive from a running one.
+ */
+
+#include <libcaer/events/common.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define SHM_MAGIC_NUMBER 0x314D485352454143LL // "CAERSHM1" in little-endian.
+#define SHM_VERSION 1
+#define SHM_NAME_PREFIX "/caer-"
+#define SHM_MAX_READERS 16
+#define SHM_NO_SEQUENCE UINT64_MAX
+#define SHM_SOURCE_STRING_SIZE 2048
+#define SHM_PACKET_ALIGNMENT 8
+
+/// Source sizes, in the order of sourceSizes in the header.
+enum caer_shm_source_size {
+	SHM_POLARITY_SIZE_X,
+	SHM_POLARITY_SIZE_Y,
+	SHM_FRAME_SIZE_X,
+	SHM_FRAME_SIZE_Y,
+	SHM_DATA_SIZE_X,
+	SHM_DATA_SIZE_Y,
+	SHM_VISUALIZER_SIZE_X,
+	SHM_VISUALIZER_SIZE_Y,
+	SHM_SOURCE_SIZES,
+};
+
+struct caer_shm_reader {
+	/// Process ID of the reader, 0 if this entry is free.
+	_Atomic(uint32_t) pid;
+	uint32_t padding;
+	/// Sequence number of the container the reader currently holds,
+	/// SHM_NO_SEQUENCE if none.
+	_Atomic(uint64_t) readSequence;
+};
+
+struct caer_shm_slot {
+	/// Sequence number of the container in this slot, SHM_NO_SEQUENCE while
+	/// it is being written.
+	_Atomic(uint64_t) sequence;
+	/// Size of the data in this slot, in bytes.
+	uint64_t size;
+	/// Number of event packets in this slot.
+	uint32_t packetsNumber;
+	uint32_t padding;
+};
+
+struct caer_shm_header {
+	/// SHM_MAGIC_NUMBER, written last by the writer once the segment is ready.
+	_Atomic(uint64_t) magicNumber;
+	uint32_t version;
+	uint32_t slotsNumber;
+	uint64_t slotSize;
+	/// Offset of the first slot from the start of the segment.
+	uint64_t dataOffset;
+	/// Process ID of the writer.
+	uint32_t writerPid;
+	uint32_t padding;
+	/// Writer still running, 0 once it stopped.
+	_Atomic(uint32_t) writerActive;
+	/// Incremented on every change readers may wait for.
+	_Atomic(uint32_t) wakeup;
+	/// Number of containers published, the sequence number of the next one.
+	_Atomic(uint64_t) writeSequence;
+	/// Source information below is valid.
+	_Atomic(uint32_t) sourceReady;
+	int16_t sourceID;
+	int16_t sourceSizes[SHM_SOURCE_SIZES];
+	char sourceString[SHM_SOURCE_STRING_SIZE];
+	struct caer_shm_reader readers[SHM_MAX_READERS];
+	struct caer_shm_slot slots[];
+};
+
+/// Offset of the slot data, for the given number of slots (page aligned).
+#define SHM_DATA_OFFSET(SLOTS) \
+	((((sizeof(struct caer_shm_header) + ((SLOTS) * sizeof(struct caer_shm_slot))) + 4095) / 4096) * 4096)
+
+/// Size of an event packet in a slot, including alignment padding.
+#define SHM_PACKET_SIZE(PACKET)                                                                  \
+	((((size_t) CAER_EVENT_PACKET_HEADER_SIZE                                                    \
+		  + ((size_t) caerEventPacketHeaderGetEventNumber(PACKET)                                \
+				* (size_t) caerEventPacketHeaderGetEventSize(PACKET))                            \
+		  + SHM_PACKET_ALIGNMENT - 1)                                                            \
+		 / SHM_PACKET_ALIGNMENT)                                                                 \
+		* SHM_PACKET_ALIGNMENT)
+
+/**
+ * Check if the writer of a segment is still running: it didn't stop, and
+ * its process still exists.
+ */
+static inline bool caerShmWriterAlive(struct caer_shm_header *segment) {
+	if (atomic_load(&segment->writerActive) == 0) {
+		return (false);
+	}
+
+	// EPERM means the process exists, but belongs to someone else.
+	return ((kill((pid_t) segment->writerPid, 0) == 0) || (errno != ESRCH));
+}
+
+/**
+ * Wait for the wakeup word to change from the given value, or at most
+ * timeoutMs milliseconds. Spurious wakeups are possible.
+ */
+static inline void caerShmWait(_Atomic(uint32_t) *wakeup, uint32_t expected, int32_t timeoutMs) {
+#if defined(__linux__)
+	struct timespec timeout = {.tv_sec = timeoutMs / 1000, .tv_nsec = (timeoutMs % 1000) * 1000000L};
+
+	// Not FUTEX_PRIVATE_FLAG, the word is shared between processes.
+	syscall(SYS_futex, (uint32_t *) wakeup, FUTEX_WAIT, expected, &timeout, NULL, 0);
+#else
+	// No cross-process wakeups, check again in 1 ms.
+	if (atomic_load(wakeup) == expected) {
+		struct timespec waitSleep = {.tv_sec = 0, .tv_nsec = 1000000};
+		nanosleep(&waitSleep, NULL);
+	}
+
+	(void) (timeoutMs); // UNUSED.
+#endif
+}
+
+/**
+ * Change the wakeup word and wake up all readers waiting on it.
+ */
+static inline void caerShmWake(_Atomic(uint32_t) *wakeup) {
+	atomic_fetch_add(wakeup, 1);
+
+#if defined(__linux__)
+	syscall(SYS_futex, (uint32_t *) wakeup, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+#endif
+}
+
+#endif /* INPUT_OUTPUT_SHM_H_ */
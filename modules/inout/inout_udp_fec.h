@@ -0,0 +1,180 @@
+#ifndef INPUT_OUTPUT_UDP_FEC_H_
+#define INPUT_OUTPUT_UDP_FEC_H_
+
+/*
+ * Receiver side of UDP forward error correction (format in inout_common.h).
+ * Keeps copies of the most recent datagrams, and when a parity datagram
+ * arrives for a group with exactly one of them missing, rebuilds it.
+ * Groups must fit in the datagrams kept, which INOUT_FEC_RECEIVER_DATAGRAMS
+ * ensures for groups of up to INOUT_FEC_MAX_GROUP_SIZE, with the parity
+ * arriving up to one group late.
+ */
+
+#include "inout_common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INOUT_FEC_RECEIVER_DATAGRAMS (2 * INOUT_FEC_MAX_GROUP_SIZE)
+#define INOUT_FEC_DATAGRAM_MAX_LENGTH (AEDAT3_NETWORK_HEADER_LENGTH + AEDAT3_MAX_UDP_SIZE)
+#define INOUT_FEC_PARITY_MAX_LENGTH \
+	(AEDAT3_NETWORK_HEADER_LENGTH + sizeof(struct inout_fec_header) + INOUT_FEC_DATAGRAM_MAX_LENGTH)
+
+struct inout_fec_receiver {
+	/// Copies of the most recent datagrams (network header plus data),
+	/// at their sequence number modulo INOUT_FEC_RECEIVER_DATAGRAMS.
+	uint8_t *datagrams[INOUT_FEC_RECEIVER_DATAGRAMS];
+	size_t lengths[INOUT_FEC_RECEIVER_DATAGRAMS];
+	/// Sequence number (highest bit cleared) of each kept datagram.
+	uint64_t sequences[INOUT_FEC_RECEIVER_DATAGRAMS];
+	bool valid[INOUT_FEC_RECEIVER_DATAGRAMS];
+};
+
+/**
+ * Sequence number of a datagram, without the start of packet marker.
+ */
+static inline uint64_t inoutFECSequence(const uint8_t *datagram) {
+	struct aedat3_network_header header = caerParseNetworkHeader(datagram);
+
+	return (U64T(header.sequenceNumber) & 0x7FFFFFFFFFFFFFFFLLU);
+}
+
+/**
+ * Check if a datagram is an FEC parity datagram, instead of data.
+ */
+static inline bool inoutFECIsParity(const uint8_t *datagram, size_t length) {
+	if (length < (AEDAT3_NETWORK_HEADER_LENGTH + sizeof(struct inout_fec_header))) {
+		return (false);
+	}
+
+	struct aedat3_network_header header = caerParseNetworkHeader(datagram);
+
+	return (header.magicNumber == INOUT_FEC_MAGIC_NUMBER);
+}
+
+/**
+ * Free all datagram copies kept by a receiver.
+ */
+static inline void inoutFECReceiverFree(struct inout_fec_receiver *receiver) {
+	for (size_t i = 0; i < INOUT_FEC_RECEIVER_DATAGRAMS; i++) {
+		free(receiver->datagrams[i]);
+		receiver->datagrams[i] = NULL;
+		receiver->valid[i]     = false;
+	}
+}
+
+/**
+ * Keep a copy of a received data datagram, for recovering others of its group.
+ *
+ * @param receiver FEC receiver state, zero-initialized before first use.
+ * @param datagram data datagram, network header plus data.
+ * @param length length of the datagram in bytes.
+ *
+ * @return true on success, false on invalid length or memory allocation failure.
+ */
+static inline bool inoutFECReceiverAdd(struct inout_fec_receiver *receiver, const uint8_t *datagram, size_t length) {
+	if ((length < AEDAT3_NETWORK_HEADER_LENGTH) || (length > INOUT_FEC_DATAGRAM_MAX_LENGTH)) {
+		return (false);
+	}
+
+	uint64_t sequence = inoutFECSequence(datagram);
+	size_t slot       = (size_t) (sequence % INOUT_FEC_RECEIVER_DATAGRAMS);
+
+	if (receiver->datagrams[slot] == NULL) {
+		receiver->datagrams[slot] = malloc(INOUT_FEC_DATAGRAM_MAX_LENGTH);
+		if (receiver->datagrams[slot] == NULL) {
+			return (false);
+		}
+	}
+
+	memcpy(receiver->datagrams[slot], datagram, length);
+	receiver->lengths[slot]   = length;
+	receiver->sequences[slot] = sequence;
+	receiver->valid[slot]     = true;
+
+	return (true);
+}
+
+/**
+ * Rebuild the missing datagram of a group from its parity datagram, if
+ * exactly one is missing. The rebuilt datagram is also kept, as if received.
+ *
+ * @param receiver FEC receiver state.
+ * @param parity parity datagram, network header plus parity data.
+ * @param parityLength length of the parity datagram in bytes.
+ * @param recovered memory for INOUT_FEC_DATAGRAM_MAX_LENGTH bytes, where the
+ *                  rebuilt datagram (network header plus data) is written.
+ *
+ * @return length of the rebuilt datagram, or 0 if none is missing, more
+ *         than one is, or the parity datagram is invalid.
+ */
+static inline size_t inoutFECReceiverRecover(
+	struct inout_fec_receiver *receiver, const uint8_t *parity, size_t parityLength, uint8_t *recovered) {
+	if (!inoutFECIsParity(parity, parityLength)) {
+		return (0);
+	}
+
+	struct inout_fec_header fecHeader;
+	memcpy(&fecHeader, parity + AEDAT3_NETWORK_HEADER_LENGTH, sizeof(struct inout_fec_header));
+
+	uint64_t groupSequence = inoutFECSequence(parity);
+	size_t groupSize       = le16toh(fecHeader.groupSize);
+	size_t recoveredLength = le32toh(fecHeader.lengthParity);
+
+	const uint8_t *parityData = parity + AEDAT3_NETWORK_HEADER_LENGTH + sizeof(struct inout_fec_header);
+	size_t parityDataLength   = parityLength - AEDAT3_NETWORK_HEADER_LENGTH - sizeof(struct inout_fec_header);
+
+	if ((groupSize == 0) || (groupSize > INOUT_FEC_MAX_GROUP_SIZE)
+		|| (parityDataLength > INOUT_FEC_DATAGRAM_MAX_LENGTH)) {
+		return (0);
+	}
+
+	// Find the one missing datagram, and XOR all others into the parity.
+	size_t missingNumber    = 0;
+	uint64_t missingSequence = 0;
+
+	memcpy(recovered, parityData, parityDataLength);
+
+	for (size_t i = 0; i < groupSize; i++) {
+		uint64_t sequence = groupSequence + i;
+		size_t slot       = (size_t) (sequence % INOUT_FEC_RECEIVER_DATAGRAMS);
+
+		if (!receiver->valid[slot] || (receiver->sequences[slot] != sequence)) {
+			missingNumber++;
+			missingSequence = sequence;
+			continue;
+		}
+
+		// Datagrams are zero-padded to the parity length, so only their bytes count.
+		size_t length = receiver->lengths[slot];
+		if (length > parityDataLength) {
+			return (0);
+		}
+
+		for (size_t j = 0; j < length; j++) {
+			recovered[j] ^= receiver->datagrams[slot][j];
+		}
+
+		recoveredLength ^= length;
+	}
+
+	if ((missingNumber != 1) || (recoveredLength < AEDAT3_NETWORK_HEADER_LENGTH)
+		|| (recoveredLength > parityDataLength)) {
+		return (0);
+	}
+
+	// The rebuilt header must carry the sequence number it was missing at.
+	if (inoutFECSequence(recovered) != missingSequence) {
+		return (0);
+	}
+
+	if (!inoutFECReceiverAdd(receiver, recovered, recoveredLength)) {
+		return (0);
+	}
+
+	return (recoveredLength);
+}
+
+#endif /* INPUT_OUTPUT_UDP_FEC_H_ */
@@ -1,3 +1,8 @@
+// GNU extensions: O_DIRECT. Must come before any system header.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include "caer-sdk/cross/portable_io.h"
 #include "caer-sdk/mainloop.h"
 
@@ -37,7 +42,9 @@ caerModuleInfo caerModuleGetInfo(void) {
 }
 
 static char *getUserHomeDirectory(caerModuleData moduleData);
-static char *getFullFilePath(caerModuleData moduleData, const char *directory, const char *prefix);
+static char *getFullFilePath(caerModuleData moduleData, const char *directory, const char *prefix, ssize_t segment);
+static int openOutputFile(caerModuleData moduleData, const char *filePath);
+static int openSegmentFile(caerModuleData moduleData, size_t segment, char **filePath);
 
 // Remember to free strings returned by this.
 static char *getUserHomeDirectory(caerModuleData moduleData) {
@@ -60,7 +67,7 @@ static char *getUserHomeDirectory(caerModuleData moduleData) {
 	return (homeDir);
 }
 
-static char *getFullFilePath(caerModuleData moduleData, const char *directory, const char *prefix) {
+static char *getFullFilePath(caerModuleData moduleData, const char *directory, const char *prefix, ssize_t segment) {
 	// First get time suffix string.
 	time_t currentTimeEpoch = time(NULL);
 
@@ -96,17 +103,86 @@ static char *getFullFilePath(caerModuleData moduleData, const char *directory, c
 	// 1 for the directory/prefix separating slash, 1 for prefix-time separating
 	// dash, 6 for file extension, 1 for terminating NUL byte = +9.
 
+	// Segments: directory/prefix-time-segment.aedat.part, the segment number keeps
+	// names unique and ordered, the suffix is removed once the segment is complete.
+	if (segment >= 0) {
+		filePathLength += 21 + strlen(FILE_SEGMENT_PARTIAL_SUFFIX); // 1 for dash, 20 for number.
+	}
+
 	char *filePath = malloc(filePathLength);
 	if (filePath == NULL) {
 		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Unable to allocate memory for full file path.");
 		return (NULL);
 	}
 
-	snprintf(filePath, filePathLength, "%s/%s-%s.aedat", directory, prefix, currentTimeString);
+	if (segment >= 0) {
+		snprintf(filePath, filePathLength, "%s/%s-%s-%04zd.aedat" FILE_SEGMENT_PARTIAL_SUFFIX, directory, prefix,
+			currentTimeString, segment);
+	}
+	else {
+		snprintf(filePath, filePathLength, "%s/%s-%s.aedat", directory, prefix, currentTimeString);
+	}
 
 	return (filePath);
 }
 
+static int openOutputFile(caerModuleData moduleData, const char *filePath) {
+	int fileFlags = O_WRONLY | O_CREAT;
+
+#if defined(O_DIRECT)
+	if (sshsNodeGetBool(moduleData->moduleNode, "directIO")) {
+		fileFlags |= O_DIRECT;
+	}
+#endif
+
+	int fileFd = open(filePath, fileFlags, S_IWUSR | S_IRUSR | S_IRGRP);
+
+#if defined(O_DIRECT)
+	// Not all filesystems support O_DIRECT (tmpfs for example), fall back to normal IO.
+	if ((fileFd < 0) && (errno == EINVAL) && ((fileFlags & O_DIRECT) != 0)) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING,
+			"Direct IO not supported for output file '%s', using normal IO instead.", filePath);
+
+		fileFd = open(filePath, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
+	}
+#endif
+
+	if (fileFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL,
+			"Could not create or open output file '%s' for writing. Error: %d.", filePath, errno);
+		return (-1);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened output file '%s' successfully for writing.", filePath);
+
+	return (fileFd);
+}
+
+// Called from the segment thread of the common output code for new segments.
+static int openSegmentFile(caerModuleData moduleData, size_t segment, char **filePath) {
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *prefix    = sshsNodeGetString(moduleData->moduleNode, "prefix");
+
+	char *segmentFilePath = getFullFilePath(moduleData, directory, prefix, (ssize_t) segment);
+	free(directory);
+	free(prefix);
+
+	if (segmentFilePath == NULL) {
+		// caerModuleLog() called inside getFullFilePath().
+		return (-1);
+	}
+
+	int fileFd = openOutputFile(moduleData, segmentFilePath);
+	if (fileFd < 0) {
+		free(segmentFilePath);
+		return (-1);
+	}
+
+	*filePath = segmentFilePath;
+
+	return (fileFd);
+}
+
 static bool caerOutputFileInit(caerModuleData moduleData) {
 	// First, always create all needed setting nodes, set their default values
 	// and add their listeners.
@@ -126,34 +202,58 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 	sshsNodeCreateString(moduleData->moduleNode, "prefix", DEFAULT_PREFIX, 1, MAX_PREFIX_LENGTH, SSHS_FLAGS_NORMAL,
 		"Output data files name prefix.");
 
-	// Generate current file name and open it.
-	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
-	char *prefix    = sshsNodeGetString(moduleData->moduleNode, "prefix");
+	sshsNodeCreateBool(moduleData->moduleNode, "directIO", false, SSHS_FLAGS_NORMAL,
+		"Write directly to disk, bypassing the page cache (O_DIRECT). Helps with sustained high data rates.");
+	sshsNodeCreateInt(moduleData->moduleNode, "segmentSize", 0, 0, INT32_MAX, SSHS_FLAGS_NORMAL,
+		"Split the recording into files (segments) of this size in MB. 0 for no size limit.");
+	sshsNodeCreateInt(moduleData->moduleNode, "segmentDuration", 0, 0, INT32_MAX, SSHS_FLAGS_NORMAL,
+		"Split the recording into files (segments) of this duration in seconds. 0 for no time limit.");
 
-	char *filePath = getFullFilePath(moduleData, directory, prefix);
-	free(directory);
-	free(prefix);
+	outputCommonState state = moduleData->moduleState;
 
-	if (filePath == NULL) {
-		// caerModuleLog() called inside getFullFilePath().
-		return (false);
+	int32_t segmentSize     = sshsNodeGetInt(moduleData->moduleNode, "segmentSize");
+	int32_t segmentDuration = sshsNodeGetInt(moduleData->moduleNode, "segmentDuration");
+
+	int fileFd = -1;
+
+	if ((segmentSize > 0) || (segmentDuration > 0)) {
+		// Segmented recording: the common output code switches segments,
+		// opening the next one in advance through openSegmentFile().
+		state->segments.openFile    = &openSegmentFile;
+		state->segments.maxSize     = (uint64_t) segmentSize * 1024 * 1024;
+		state->segments.maxDuration = segmentDuration;
+		state->segments.number      = 0;
+
+		fileFd = openSegmentFile(moduleData, 0, &state->segments.filePath);
 	}
+	else {
+		// Generate current file name and open it.
+		char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+		char *prefix    = sshsNodeGetString(moduleData->moduleNode, "prefix");
 
-	int fileFd = open(filePath, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
-	if (fileFd < 0) {
-		caerModuleLog(moduleData, CAER_LOG_CRITICAL,
-			"Could not create or open output file '%s' for writing. Error: %d.", filePath, errno);
+		char *filePath = getFullFilePath(moduleData, directory, prefix, -1);
+		free(directory);
+		free(prefix);
+
+		if (filePath == NULL) {
+			// caerModuleLog() called inside getFullFilePath().
+			return (false);
+		}
+
+		fileFd = openOutputFile(moduleData, filePath);
 		free(filePath);
+	}
 
+	if (fileFd < 0) {
 		return (false);
 	}
 
-	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened output file '%s' successfully for writing.", filePath);
-	free(filePath);
-
 	if (!caerOutputCommonInit(moduleData, fileFd, NULL)) {
 		close(fileFd);
 
+		free(state->segments.filePath);
+		state->segments.filePath = NULL;
+
 		return (false);
 	}
 
@@ -2,6 +2,7 @@
 #define EXT_LIBUV_H_
 
 #include "caer-sdk/buffers.h"
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -118,10 +119,25 @@ static inline bool simpleBufferFileRead(uv_loop_t *loop, uv_file file, int64_t f
 struct libuvWriteBufStruct {
 	uv_buf_t buf;
 	void *freeBuf;
+	atomic_uint_fast32_t *freeBufReferences; // Shared between writers if not NULL, last one frees freeBuf.
 };
 
 typedef struct libuvWriteBufStruct *libuvWriteBuf;
 
+static inline void libuvWriteBufFreeData(libuvWriteBuf writeBuf) {
+	// Shared data is only freed by the last writer to release it.
+	// Other writers may be in other threads, so this must be atomic.
+	if (writeBuf->freeBufReferences != NULL) {
+		if (atomic_fetch_sub_explicit(writeBuf->freeBufReferences, 1, memory_order_acq_rel) != 1) {
+			return;
+		}
+
+		free(writeBuf->freeBufReferences);
+	}
+
+	free(writeBuf->freeBuf);
+}
+
 struct libuvWriteMultiBufStruct {
 	void *data;      // Allow arbitrary data to be attached to buffers for callback. Must be on heap for free().
 	size_t refCount; // Reference count this to allow efficient multiple destination writes.
@@ -155,7 +171,7 @@ static inline void libuvWriteBufFree(libuvWriteMultiBuf buffers) {
 	// within one thread's event loop, no locking is needed.
 	if (buffers->refCount == 1) {
 		for (size_t i = 0; i < buffers->buffersSize; i++) {
-			free(buffers->buffers[i].freeBuf);
+			libuvWriteBufFreeData(&buffers->buffers[i]);
 		}
 
 		free(buffers->data);
@@ -168,8 +184,9 @@ static inline void libuvWriteBufFree(libuvWriteMultiBuf buffers) {
 
 static inline void libuvWriteBufInternalInit(
 	libuvWriteBuf writeBuf, void *buffer, size_t bufferSize, void *bufferToFree) {
-	writeBuf->buf.base = (char *) buffer;
-	writeBuf->buf.len  = bufferSize;
+	writeBuf->buf.base          = (char *) buffer;
+	writeBuf->buf.len           = bufferSize;
+	writeBuf->freeBufReferences = NULL;
 
 	if (bufferToFree == NULL) {
 		writeBuf->freeBuf = buffer;
@@ -2,6 +2,8 @@
 #include "output_common.h"
 
 static bool caerOutputNetUDPInit(caerModuleData moduleData);
+static bool caerOutputNetUDPMulticastSetup(
+	caerModuleData moduleData, uv_udp_t *udp, const struct sockaddr_storage *address);
 
 static const struct caer_module_functions OutputNetUDPFunctions = {.moduleInit = &caerOutputNetUDPInit,
 	.moduleRun                                                                 = &caerOutputCommonRun,
@@ -14,7 +16,7 @@ static const struct caer_event_stream_in OutputNetUDPInputs[] = {{.type = -1, .n
 static const struct caer_module_info OutputNetUDPInfo = {
 	.version           = 1,
 	.name              = "NetUDPOutput",
-	.description       = "Send AEDAT 3 data out via UDP messages.",
+	.description       = "Send AEDAT 3 data out via UDP messages, to one receiver or a multicast group.",
 	.type              = CAER_MODULE_OUTPUT,
 	.memSize           = sizeof(struct output_common_state),
 	.functions         = &OutputNetUDPFunctions,
@@ -31,19 +33,30 @@ caerModuleInfo caerModuleGetInfo(void) {
 static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 	// First, always create all needed setting nodes, set their default values
 	// and add their listeners.
-	sshsNodeCreateString(moduleData->moduleNode, "ipAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL,
-		"IPv4 address to connect to (client mode).");
+	sshsNodeCreateString(moduleData->moduleNode, "ipAddress", "127.0.0.1", 2, INET6_ADDRSTRLEN, SSHS_FLAGS_NORMAL,
+		"IPv4 or IPv6 address to connect to (client mode), can be a multicast group.");
 	sshsNodeCreateInt(moduleData->moduleNode, "portNumber", 6666, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
 		"Port number to connect to (client mode).");
+	sshsNodeCreateInt(moduleData->moduleNode, "multicastTTL", 1, 0, 255, SSHS_FLAGS_NORMAL,
+		"Multicast: time-to-live (hop limit) of sent datagrams, 1 to stay within the local network.");
+	sshsNodeCreateString(moduleData->moduleNode, "multicastInterface", "", 0, INET6_ADDRSTRLEN, SSHS_FLAGS_NORMAL,
+		"Multicast: address of the local interface to send on, empty for the system default.");
+	sshsNodeCreateBool(moduleData->moduleNode, "multicastLoopback", true, SSHS_FLAGS_NORMAL,
+		"Multicast: also deliver sent datagrams to receivers on this host.");
 
 	int retVal;
 
-	// Generate address.
-	struct sockaddr_in serverAddress;
+	// Generate address, IPv4 or IPv6.
+	struct sockaddr_storage serverAddress;
 
 	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
-	retVal          = uv_ip4_addr(ipAddress, sshsNodeGetInt(moduleData->moduleNode, "portNumber"), &serverAddress);
-	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_ip4_addr", free(ipAddress); return (false));
+	int portNumber  = sshsNodeGetInt(moduleData->moduleNode, "portNumber");
+
+	retVal = uv_ip4_addr(ipAddress, portNumber, (struct sockaddr_in *) &serverAddress);
+	if (retVal < 0) {
+		retVal = uv_ip6_addr(ipAddress, portNumber, (struct sockaddr_in6 *) &serverAddress);
+	}
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_ip6_addr", free(ipAddress); return (false));
 	free(ipAddress);
 
 	// Allocate memory.
@@ -54,7 +67,7 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 		return (false);
 	}
 
-	streams->address = malloc(sizeof(struct sockaddr_in));
+	streams->address = malloc(sizeof(struct sockaddr_storage));
 	if (streams->address == NULL) {
 		free(streams);
 
@@ -81,7 +94,7 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 	streams->server        = NULL;
 
 	// Remember address.
-	memcpy(streams->address, &serverAddress, sizeof(struct sockaddr_in));
+	memcpy(streams->address, &serverAddress, sizeof(struct sockaddr_storage));
 
 	udp->data = streams;
 
@@ -99,6 +112,29 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_udp_init", uv_loop_close(&streams->loop); free(udp);
 				 free(streams->address); free(streams); return (false));
 
+	// Multicast options and batched sending need the socket, so it has to exist already.
+	struct sockaddr_storage localAddress;
+
+	if (serverAddress.ss_family == AF_INET6) {
+		uv_ip6_addr("::", 0, (struct sockaddr_in6 *) &localAddress);
+	}
+	else {
+		uv_ip4_addr("0.0.0.0", 0, (struct sockaddr_in *) &localAddress);
+	}
+
+	retVal = uv_udp_bind(udp, (const struct sockaddr *) &localAddress, 0);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_udp_bind", libuvCloseLoopHandles(&streams->loop);
+				 uv_loop_close(&streams->loop); free(streams->address); free(streams); return (false));
+
+	if (!caerOutputNetUDPMulticastSetup(moduleData, udp, &serverAddress)) {
+		libuvCloseLoopHandles(&streams->loop);
+		uv_loop_close(&streams->loop);
+		free(streams->address);
+		free(streams);
+
+		return (false);
+	}
+
 	// Start.
 	if (!caerOutputCommonInit(moduleData, -1, streams)) {
 		libuvCloseLoopHandles(&streams->loop);
@@ -111,3 +147,46 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 
 	return (true);
 }
+
+/**
+ * Apply the multicast options, if sending to a multicast group.
+ *
+ * @param moduleData module data, for configuration.
+ * @param udp bound UDP handle.
+ * @param address destination address.
+ *
+ * @return true on success (or not multicast), false on failure.
+ */
+static bool caerOutputNetUDPMulticastSetup(
+	caerModuleData moduleData, uv_udp_t *udp, const struct sockaddr_storage *address) {
+	bool multicast = false;
+
+	if (address->ss_family == AF_INET) {
+		multicast = IN_MULTICAST(ntohl(((const struct sockaddr_in *) address)->sin_addr.s_addr));
+	}
+	else if (address->ss_family == AF_INET6) {
+		multicast = IN6_IS_ADDR_MULTICAST(&((const struct sockaddr_in6 *) address)->sin6_addr);
+	}
+
+	if (!multicast) {
+		return (true);
+	}
+
+	int retVal = uv_udp_set_multicast_ttl(udp, sshsNodeGetInt(moduleData->moduleNode, "multicastTTL"));
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_udp_set_multicast_ttl", return (false));
+
+	retVal = uv_udp_set_multicast_loop(udp, sshsNodeGetBool(moduleData->moduleNode, "multicastLoopback"));
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_udp_set_multicast_loop", return (false));
+
+	char *multicastInterface = sshsNodeGetString(moduleData->moduleNode, "multicastInterface");
+
+	if (multicastInterface[0] != '\0') {
+		retVal = uv_udp_set_multicast_interface(udp, multicastInterface);
+		UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_udp_set_multicast_interface",
+					 free(multicastInterface); return (false));
+	}
+
+	free(multicastInterface);
+
+	return (true);
+}
@@ -66,10 +66,20 @@
  * a sane restriction to impose anyway.
  */
 
+// GNU extensions: sendmmsg(), O_DIRECT and fallocate(). Must come before any system header.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include "output_common.h"
+#include "../inout_packet_compression.h"
+#include "../inout_packet_order.h"
+#include "../inout_polarity_delta.h"
+#include "../inout_serialized_ts.h"
 #include "caer-sdk/buffers.h"
 #include "caer-sdk/cross/portable_io.h"
 #include "caer-sdk/cross/portable_threads.h"
+#include "caer-sdk/cross/portable_time.h"
 #include "caer-sdk/mainloop.h"
 #include "ext/net_rw.h"
 
@@ -81,10 +91,45 @@
 #include <libcaer/events/frame.h>
 #include <libcaer/events/packetContainer.h>
 #include <libcaer/events/special.h>
+#include <fcntl.h>
+#include <float.h>
+#include <limits.h>
+#include <netinet/tcp.h>
 #include <stdatomic.h>
 
+#ifdef ENABLE_INOUT_SENDMMSG
+#include <sys/socket.h>
+#endif
+
 static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static union sshs_node_attr_value compressionWorkerStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type);
+static double compressionWorkerUtilization(struct output_common_compression_worker *worker);
+static union sshs_node_attr_value fileWriterStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type);
+static double fileWriterBytesPerSecond(struct output_common_file_writer *writer);
+static union sshs_node_attr_value udpStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type);
+static double udpDatagramsPerSecond(struct output_common_udp_batch *batch);
+static union sshs_node_attr_value streamWritesStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type);
+static double streamWritesPerSecond(struct output_common_stream_writes *writes);
+static union sshs_node_attr_value clientStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type);
+static bool udpBatchInit(outputCommonState state);
+static bool packetCompressionInit(outputCommonState state);
+static void packetCompressionExit(outputCommonState state);
+static void compressionGroupSetup(outputCommonState state);
+static void compressionGroupJoin(outputCommonState state, int16_t sourceID);
+static void compressionGroupLeave(outputCommonState state);
+static bool compressionGroupIsFollower(outputCommonState state);
+static bool compressionGroupInit(void *groupArg);
+static void compressionGroupDestroy(void *groupArg);
+static bool fileSegmentsStart(outputCommonState state);
+static void fileSegmentsStop(outputCommonState state);
+static int fileSegmentThread(void *stateArg);
+static void fileSegmentComplete(outputCommonState state, int fileDescriptor, char *filePath);
 
 /**
  * ============================================================================
@@ -107,6 +152,11 @@ void caerOutputCommonRun(caerModuleData moduleData, caerEventPacketContainer in,
 void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID) {
 	outputCommonState state = moduleData->moduleState;
 
+	// The output compressing for the group sends the TS_RESET to all of them.
+	if (compressionGroupIsFollower(state)) {
+		return;
+	}
+
 	if (resetCallSourceID == I16T(atomic_load_explicit(&state->sourceID, memory_order_relaxed))) {
 		// The timestamp reset call came in from the Source ID this output module
 		// is responsible for, so we ensure the timestamps are reset and that the
@@ -180,6 +230,11 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 				state->sourceInfoString = sshsNodeGetString(sourceInfoNode, "sourceString");
 
 				atomic_store(&state->sourceID, eventSource); // Remember this!
+
+				// Sharing compression only makes sense with outputs of the same source.
+				if (state->compression.groupSettings != NULL) {
+					compressionGroupJoin(state, eventSource);
+				}
 			}
 			else if (sourceID != eventSource) {
 				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
@@ -212,6 +267,12 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 		return;
 	}
 
+	// Another output in the compression group copies and compresses these
+	// packets, and passes them on to this one.
+	if (compressionGroupIsFollower(state)) {
+		return;
+	}
+
 	// Allocate memory for event packet array structure that will get passed to output handler thread.
 	caerEventPacketContainer eventPackets = caerEventPacketContainerAllocate((int32_t) packetsSize);
 	if (eventPackets == NULL) {
@@ -321,12 +382,34 @@ retry:
  * ============================================================================
  */
 static int compressorThread(void *stateArg);
+static int compressionWorkerThread(void *workerArg);
 
+static bool compressionWorkersStart(outputCommonState state);
+static void compressionWorkersStop(outputCommonState state);
+static bool collectCompressedPackets(outputCommonState state, bool untilEmpty);
+static caerEventPacketContainer compressorRingGet(outputCommonState state);
+static bool liveModeHasTimestampReset(caerEventPacketContainer container);
 static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer);
-static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b);
 static void sendEventPacket(outputCommonState state, caerEventPacketHeader packet);
-static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static void dispatchPacketBuffer(outputCommonState state, libuvWriteBuf packetBuffer);
+static void commitPacketBuffer(outputCommonState state, libuvWriteBuf packetBuffer);
+static void outputRingSignal(outputCommonState state);
+static void compressionGroupDistribute(outputCommonState state, libuvWriteBuf packetBuffer);
+static size_t compressEventPacket(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize);
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet);
+static size_t compressPolarityDelta(outputCommonState state, caerEventPacketHeader packet);
+static size_t compressFramesFast(outputCommonState state, caerEventPacketHeader packet);
+static uint8_t *compressionContextBuffer(struct output_common_compression_context *context, size_t size);
+static void compressionContextFree(struct output_common_compression_context *context);
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+static size_t compressPacketLZ4(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize);
+#endif
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+static size_t compressPacketZstd(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize);
+#endif
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 static void caerLibPNGWriteBuffer(png_structp png_ptr, png_bytep data, png_size_t length);
@@ -343,17 +426,26 @@ static int compressorThread(void *stateArg) {
 	strcat(threadName, "[Compressor]");
 	portable_thread_set_name(threadName);
 
+	// Compression workers only make sense if there is something to compress.
+	if (state->compression.workersNumber > 0 && state->formatID != 0 && !compressionWorkersStart(state)) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to start compression workers, compressing on the compressor thread only.");
+	}
+
 	// If no data is available on the transfer ring-buffer, sleep for 1 ms.
 	// to avoid wasting resources in a busy loop.
 	struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
 
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 		// Get the newest event packet container from the transfer ring-buffer.
-		caerEventPacketContainer currPacketContainer = caerRingBufferGet(state->compressorRing);
+		caerEventPacketContainer currPacketContainer = compressorRingGet(state);
 		if (currPacketContainer == NULL) {
-			// There is none, so we can't work on and commit this.
-			// We just sleep here a little and then try again, as we need the data!
-			thrd_sleep(&noDataSleep, NULL);
+			// There is none, so we can't work on and commit this. Pass on any
+			// packets the workers finished in the meantime, and if there were
+			// none, we just sleep here a little and then try again.
+			if (!collectCompressedPackets(state, false)) {
+				thrd_sleep(&noDataSleep, NULL);
+			}
 			continue;
 		}
 
@@ -366,59 +458,272 @@ static int compressorThread(void *stateArg) {
 
 	// Handle shutdown, write out all content remaining in the transfer ring-buffer.
 	caerEventPacketContainer packetContainer;
-	while ((packetContainer = caerRingBufferGet(state->compressorRing)) != NULL) {
+	while ((packetContainer = compressorRingGet(state)) != NULL) {
 		orderAndSendEventPackets(state, packetContainer);
 	}
 
+	// Wait for all packets still being compressed, then stop the workers.
+	compressionWorkersStop(state);
+
+	compressionContextFree(&state->compression.context);
+
 	return (thrd_success);
 }
 
-static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer) {
-	// Sort container by first timestamp (required) and by type ID (convenience).
-	size_t currPacketContainerSize = (size_t) caerEventPacketContainerGetEventPacketsNumber(currPacketContainer);
+/**
+ * Get the next packet container to compress from the transfer ring-buffer.
+ * In live mode, of the containers waiting there only the newest ones are
+ * kept, older ones are dropped, so that what's sent out is always recent,
+ * even if the output can't keep up. Containers with a timestamp reset are
+ * never dropped, as what follows them depends on it.
+ *
+ * @param state common output state.
+ *
+ * @return next packet container, or NULL if none is waiting.
+ */
+static caerEventPacketContainer compressorRingGet(outputCommonState state) {
+	struct output_common_live_mode *live = &state->liveMode;
 
-	qsort(currPacketContainer->eventPackets, currPacketContainerSize, sizeof(caerEventPacketHeader),
-		&packetsFirstTimestampThenTypeCmp);
+	if (atomic_load_explicit(&live->enabled, memory_order_relaxed)) {
+		size_t containersNumber = atomic_load_explicit(&live->containersNumber, memory_order_relaxed);
 
-	for (size_t cpIdx = 0; cpIdx < currPacketContainerSize; cpIdx++) {
-		// Send the packets out to the file descriptor.
-		sendEventPacket(state, caerEventPacketContainerGetEventPacket(currPacketContainer, (int32_t) cpIdx));
+		// Take all waiting containers, making room by dropping the oldest.
+		while (caerRingBufferLook(state->compressorRing) != NULL) {
+			if (live->windowSize >= containersNumber) {
+				caerEventPacketContainer oldest = live->window[live->windowHead];
+
+				if (liveModeHasTimestampReset(oldest)) {
+					// Send it on first, then continue from there.
+					break;
+				}
+
+				live->windowHead = (live->windowHead + 1) % LIVE_MODE_MAX_CONTAINERS;
+				live->windowSize--;
+
+				caerEventPacketContainerFree(oldest);
+				atomic_fetch_add_explicit(&live->containersDropped, 1, memory_order_relaxed);
+			}
+
+			live->window[(live->windowHead + live->windowSize) % LIVE_MODE_MAX_CONTAINERS]
+				= caerRingBufferGet(state->compressorRing);
+			live->windowSize++;
+		}
+	}
+	else if (live->windowSize == 0) {
+		return (caerRingBufferGet(state->compressorRing));
 	}
 
-	// Free packet container. The individual packets have already been either
-	// freed on error, or have been transferred out.
-	free(currPacketContainer);
+	// Live mode, or it was just disabled: send on what was already taken first.
+	if (live->windowSize == 0) {
+		return (NULL);
+	}
+
+	caerEventPacketContainer container = live->window[live->windowHead];
+
+	live->windowHead = (live->windowHead + 1) % LIVE_MODE_MAX_CONTAINERS;
+	live->windowSize--;
+
+	return (container);
+}
+
+static bool liveModeHasTimestampReset(caerEventPacketContainer container) {
+	caerEventPacketHeaderConst special = caerEventPacketContainerFindEventPacketByTypeConst(container, SPECIAL_EVENT);
+
+	return ((special != NULL)
+			&& (caerSpecialEventPacketFindEventByTypeConst((caerSpecialEventPacketConst) special, TIMESTAMP_RESET)
+				   != NULL));
 }
 
-static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b) {
-	const caerEventPacketHeader *aa = a;
-	const caerEventPacketHeader *bb = b;
+static int compressionWorkerThread(void *workerArg) {
+	struct output_common_compression_worker *worker = workerArg;
+	outputCommonState state                         = worker->state;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 16]; // +1 for NUL character.
+	snprintf(threadName, threadNameLength + 1 + 16, "%s[Compressor%zu]", state->parentModule->moduleSubSystemString,
+		worker->index);
+	portable_thread_set_name(threadName);
+
+	// If no data is available on the input ring-buffer, sleep for 1 ms.
+	// to avoid wasting resources in a busy loop.
+	struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
+
+	while (atomic_load_explicit(&state->compression.workersRunning, memory_order_relaxed)) {
+		libuvWriteBuf packetBuffer = caerRingBufferGet(worker->inputRing);
+		if (packetBuffer == NULL) {
+			thrd_sleep(&noDataSleep, NULL);
+			continue;
+		}
+
+		struct timespec compressStart, compressEnd;
+		portable_clock_gettime_monotonic(&compressStart);
+
+		size_t packetSize = packetBuffer->buf.len;
+
+		packetBuffer->buf.len
+			= compressEventPacket(state, &worker->context, (caerEventPacketHeader) packetBuffer->buf.base, packetSize);
 
-	// Sort first by timestamp of the first event.
-	int32_t eventTimestampA = caerGenericEventGetTimestamp(caerGenericEventGetEvent(*aa, 0), *aa);
-	int32_t eventTimestampB = caerGenericEventGetTimestamp(caerGenericEventGetEvent(*bb, 0), *bb);
+		portable_clock_gettime_monotonic(&compressEnd);
 
-	if (eventTimestampA < eventTimestampB) {
-		return (-1);
+		uint64_t compressTime = (uint64_t)(((int64_t)(compressEnd.tv_sec - compressStart.tv_sec) * 1000000000LL)
+										   + (int64_t)(compressEnd.tv_nsec - compressStart.tv_nsec));
+
+		// Statistics support.
+		atomic_fetch_add_explicit(&worker->packets, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&worker->bytesIn, packetSize, memory_order_relaxed);
+		atomic_fetch_add_explicit(&worker->bytesOut, packetBuffer->buf.len, memory_order_relaxed);
+		atomic_fetch_add_explicit(&worker->busyTime, compressTime, memory_order_relaxed);
+
+		// The compressor thread always collects eventually, retry until successful.
+		while (!caerRingBufferPut(worker->outputRing, packetBuffer)) {
+			// Delay by 100 µs if no change, to avoid a wasteful busy loop.
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 100000};
+			thrd_sleep(&retrySleep, NULL);
+		}
 	}
-	else if (eventTimestampA > eventTimestampB) {
-		return (1);
+
+	compressionContextFree(&worker->context);
+
+	return (thrd_success);
+}
+
+static bool compressionWorkersStart(outputCommonState state) {
+	// Each worker has a small queue of packets, so work can be handed out
+	// without waiting while keeping the amount of data in flight bounded.
+	size_t workerRingSize = 32;
+
+	atomic_store(&state->compression.workersRunning, true);
+
+	size_t started = 0;
+
+	for (; started < state->compression.workersNumber; started++) {
+		struct output_common_compression_worker *worker = &state->compression.workers[started];
+
+		worker->inputRing = caerRingBufferInit(workerRingSize);
+		if (worker->inputRing == NULL) {
+			break;
+		}
+
+		worker->outputRing = caerRingBufferInit(workerRingSize);
+		if (worker->outputRing == NULL) {
+			caerRingBufferFree(worker->inputRing);
+			break;
+		}
+
+		if (thrd_create(&worker->thread, &compressionWorkerThread, worker) != thrd_success) {
+			caerRingBufferFree(worker->inputRing);
+			caerRingBufferFree(worker->outputRing);
+			break;
+		}
 	}
-	else {
-		// If equal, further sort by type ID.
-		int16_t eventTypeA = caerEventPacketHeaderGetEventType(*aa);
-		int16_t eventTypeB = caerEventPacketHeaderGetEventType(*bb);
 
-		if (eventTypeA < eventTypeB) {
-			return (-1);
+	if (started < state->compression.workersNumber) {
+		// Failure, stop all already started workers. They have no work yet.
+		atomic_store(&state->compression.workersRunning, false);
+
+		for (size_t i = 0; i < started; i++) {
+			thrd_join(state->compression.workers[i].thread, NULL);
+
+			caerRingBufferFree(state->compression.workers[i].inputRing);
+			caerRingBufferFree(state->compression.workers[i].outputRing);
 		}
-		else if (eventTypeA > eventTypeB) {
-			return (1);
+
+		return (false);
+	}
+
+	state->compression.dispatchIndex   = 0;
+	state->compression.collectIndex    = 0;
+	state->compression.packetsInFlight = 0;
+	state->compression.workersStarted  = true;
+
+	return (true);
+}
+
+static void compressionWorkersStop(outputCommonState state) {
+	if (!state->compression.workersStarted) {
+		return;
+	}
+
+	// Pass on all packets still in flight, this requires the workers to run.
+	collectCompressedPackets(state, true);
+
+	atomic_store(&state->compression.workersRunning, false);
+
+	for (size_t i = 0; i < state->compression.workersNumber; i++) {
+		struct output_common_compression_worker *worker = &state->compression.workers[i];
+
+		if ((errno = thrd_join(worker->thread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
+				"Failed to join compression worker thread %zu. Error: %d.", i, errno);
 		}
-		else {
-			return (0);
+
+		// All packets were collected, so the ring-buffers are empty.
+		caerRingBufferFree(worker->inputRing);
+		caerRingBufferFree(worker->outputRing);
+	}
+
+	state->compression.workersStarted = false;
+}
+
+/**
+ * Pass on compressed packets from the workers to the output thread.
+ * Packets are collected in the same round-robin order they were handed
+ * out in, so the stream keeps exactly the order orderAndSendEventPackets()
+ * decided on, independently of how long each packet took to compress.
+ *
+ * @param state common output state.
+ * @param untilEmpty wait for all packets in flight, instead of stopping
+ * at the first one that is not yet compressed.
+ *
+ * @return true if any packet was passed on, false otherwise.
+ */
+static bool collectCompressedPackets(outputCommonState state, bool untilEmpty) {
+	bool collected = false;
+
+	while (state->compression.packetsInFlight > 0) {
+		struct output_common_compression_worker *worker
+			= &state->compression.workers[state->compression.collectIndex];
+
+		libuvWriteBuf packetBuffer = caerRingBufferGet(worker->outputRing);
+		if (packetBuffer == NULL) {
+			if (!untilEmpty) {
+				break;
+			}
+
+			// Delay by 100 µs if no change, to avoid a wasteful busy loop.
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 100000};
+			thrd_sleep(&retrySleep, NULL);
+			continue;
 		}
+
+		commitPacketBuffer(state, packetBuffer);
+
+		state->compression.collectIndex = (state->compression.collectIndex + 1) % state->compression.workersNumber;
+		state->compression.packetsInFlight--;
+
+		collected = true;
+	}
+
+	return (collected);
+}
+
+static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer) {
+	// Sort container by first timestamp (required) and by type ID (convenience).
+	size_t currPacketContainerSize = (size_t) caerEventPacketContainerGetEventPacketsNumber(currPacketContainer);
+
+	struct caer_packet_order packetsOrder[currPacketContainerSize];
+	caerPacketOrderByTimestamp(packetsOrder, currPacketContainer->eventPackets, currPacketContainerSize);
+
+	for (size_t cpIdx = 0; cpIdx < currPacketContainerSize; cpIdx++) {
+		// Send the packets out to the file descriptor.
+		sendEventPacket(state, packetsOrder[cpIdx].packet);
 	}
+
+	// Free packet container. The individual packets have already been either
+	// freed on error, or have been transferred out.
+	free(currPacketContainer);
 }
 
 static void sendEventPacket(outputCommonState state, caerEventPacketHeader packet) {
@@ -433,37 +738,187 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 	state->statistics.packetsDataSize
 		+= (size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet));
 
-	if (state->formatID != 0) {
-		packetSize = compressEventPacket(state, packet, packetSize);
-	}
-
-	// Statistics support (after compression).
-	state->statistics.dataWritten += packetSize;
-
-	// Send compressed packet out to output handling thread.
+	// Send packet out to output handling thread, after compression.
 	// Already format it as a libuv buffer.
-	libuvWriteBuf packetBuffer = malloc(sizeof(*packetBuffer));
-	if (packetBuffer == NULL) {
+	struct output_common_packet_buffer *outputBuffer = malloc(sizeof(*outputBuffer));
+	if (outputBuffer == NULL) {
 		free(packet);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for libuv packet buffer.");
 		return;
 	}
 
+	// Remember first timestamp for the segment index.
+	outputBuffer->timestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, 0), packet);
+
+	// Special events and frames are kept for slow network clients. Delta-coded
+	// frame packets only if they turn out to contain key frames only (see below).
+	int16_t eventType       = caerEventPacketHeaderGetEventType(packet);
+	outputBuffer->keyPacket = (eventType == SPECIAL_EVENT) || (eventType == FRAME_EVENT);
+
+	libuvWriteBuf packetBuffer = &outputBuffer->writeBuffer;
 	libuvWriteBufInitWithAnyBuffer(packetBuffer, packet, packetSize);
 
+	if (state->formatID != 0) {
+		// Delta-coded frames depend on the previous frame, so they have to be
+		// compressed one after the other, in stream order.
+		bool compressInOrder = (state->formatID & 0x20) && (state->compression.frameDeltaInterval > 0)
+							   && (eventType == FRAME_EVENT);
+
+		if (state->compression.workersStarted) {
+			if (!compressInOrder) {
+				// Compressed in parallel, passed on by collectCompressedPackets().
+				dispatchPacketBuffer(state, packetBuffer);
+				return;
+			}
+
+			// Pass on all packets in flight first, to keep the packet order.
+			collectCompressedPackets(state, true);
+		}
+
+		packetBuffer->buf.len = compressEventPacket(state, &state->compression.context, packet, packetSize);
+
+		if (compressInOrder) {
+			outputBuffer->keyPacket = state->compression.frameKeyPacket;
+		}
+	}
+
+	commitPacketBuffer(state, packetBuffer);
+}
+
+static void dispatchPacketBuffer(outputCommonState state, libuvWriteBuf packetBuffer) {
+	struct output_common_compression_worker *worker = &state->compression.workers[state->compression.dispatchIndex];
+
+	while (!caerRingBufferPut(worker->inputRing, packetBuffer)) {
+		// Worker is busy, pass on finished packets while waiting for it.
+		if (!collectCompressedPackets(state, false)) {
+			// Delay by 100 µs if no change, to avoid a wasteful busy loop.
+			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 100000};
+			thrd_sleep(&retrySleep, NULL);
+		}
+	}
+
+	state->compression.dispatchIndex = (state->compression.dispatchIndex + 1) % state->compression.workersNumber;
+	state->compression.packetsInFlight++;
+}
+
+static void commitPacketBuffer(outputCommonState state, libuvWriteBuf packetBuffer) {
+	// Statistics support (after compression).
+	state->statistics.dataWritten += packetBuffer->buf.len;
+
+	// Other outputs in the compression group get the same packet.
+	if (state->compression.group != NULL) {
+		compressionGroupDistribute(state, packetBuffer);
+	}
+
 	// Put packet buffer onto output ring-buffer. Retry until successful.
 	while (!caerRingBufferPut(state->outputRing, packetBuffer)) {
 		// If the output thread failed, we'd forever block here, if it can't accept
 		// any more data. So we detect that condition and discard remaining packets.
 		if (atomic_load_explicit(&state->outputThreadFailure, memory_order_relaxed)) {
-			break;
+			libuvWriteBufFreeData(packetBuffer);
+			free(packetBuffer);
+			return;
 		}
 
+		// In live mode, the output thread takes everything waiting and drops
+		// the oldest packets there (outputRingGet()), so the newest data is
+		// kept and this only waits for it to get to run.
+
 		// Delay by 500 µs if no change, to avoid a wasteful busy loop.
 		struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 500000};
 		thrd_sleep(&retrySleep, NULL);
 	}
+
+	outputRingSignal(state);
+}
+
+/**
+ * Wake up the libuv event loop of network outputs, to get the new data
+ * from the output ring-buffer. Multiple signals before it gets to run
+ * are coalesced into one. File outputs check the ring-buffer on their own.
+ *
+ * @param state common output state, with new data in its output ring-buffer.
+ */
+static void outputRingSignal(outputCommonState state) {
+	if (state->isNetworkStream) {
+		uv_async_send(&state->networkIO->ringBufferGet);
+	}
+}
+
+/**
+ * Pass a compressed packet on to all other outputs in the compression group.
+ * The packet data is not copied, but shared: each output gets its own packet
+ * buffer referencing it, and the last one to be done with it frees it.
+ * Outputs that can't take the packet right now (output ring-buffer full)
+ * lose it, so a slow output never holds up the others.
+ *
+ * @param state common output state of the output compressing for the group.
+ * @param packetBuffer compressed packet buffer, about to be committed.
+ */
+static void compressionGroupDistribute(outputCommonState state, libuvWriteBuf packetBuffer) {
+	struct output_common_compression_group *group = state->compression.group;
+
+	mtx_lock(&group->lock);
+
+	if (group->membersSize > 1) {
+		atomic_uint_fast32_t *references = malloc(sizeof(*references));
+		if (references == NULL) {
+			mtx_unlock(&group->lock);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to allocate memory for shared packet buffer, not passing packet on.");
+			return;
+		}
+
+		// The reference of this output.
+		atomic_store(references, 1);
+		packetBuffer->freeBufReferences = references;
+
+		// Compressed packets keep their event number and size, so statistics
+		// on the uncompressed data can still be collected.
+		caerEventPacketHeaderConst packet = (caerEventPacketHeaderConst) packetBuffer->buf.base;
+		size_t packetDataSize
+			= (size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet));
+
+		for (size_t i = 0; i < group->membersSize; i++) {
+			outputCommonState member = group->members[i];
+
+			if (member == state) {
+				continue;
+			}
+
+			struct output_common_packet_buffer *memberBuffer = malloc(sizeof(*memberBuffer));
+			if (memberBuffer == NULL) {
+				atomic_fetch_add_explicit(&member->compression.groupPacketsDropped, 1, memory_order_relaxed);
+				continue;
+			}
+
+			*memberBuffer = *((struct output_common_packet_buffer *) packetBuffer);
+
+			// Take the reference before the output thread can release it.
+			atomic_fetch_add_explicit(references, 1, memory_order_relaxed);
+
+			if (!caerRingBufferPut(member->outputRing, memberBuffer)) {
+				atomic_fetch_sub_explicit(references, 1, memory_order_relaxed);
+				free(memberBuffer);
+
+				atomic_fetch_add_explicit(&member->compression.groupPacketsDropped, 1, memory_order_relaxed);
+				continue;
+			}
+
+			outputRingSignal(member);
+
+			// Statistics support. Only touched by the compressing output while in the group.
+			member->statistics.packetsNumber++;
+			member->statistics.packetsTotalSize += CAER_EVENT_PACKET_HEADER_SIZE + packetDataSize;
+			member->statistics.packetsHeaderSize += CAER_EVENT_PACKET_HEADER_SIZE;
+			member->statistics.packetsDataSize += packetDataSize;
+			member->statistics.dataWritten += packetBuffer->buf.len;
+		}
+	}
+
+	mtx_unlock(&group->lock);
 }
 
 /**
@@ -475,27 +930,55 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
  * in any input/output stream, and as such is redundant information.
  *
  * @param state common output state.
+ * @param context compression context of the calling thread.
  * @param packet the event packet to compress.
  * @param packetSize the current event packet size (header + data).
  *
  * @return the event packet size (header + data) after compression.
  *         Must be equal or smaller than the input packetSize.
  */
-static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+static size_t compressEventPacket(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize) {
+#if !defined(ENABLE_INOUT_LZ4_COMPRESSION) && !defined(ENABLE_INOUT_ZSTD_COMPRESSION)
+	UNUSED_ARGUMENT(context); // Only used by general-purpose compression.
+#endif
+
 	size_t compressedSize = packetSize;
+	int16_t eventType     = caerEventPacketHeaderGetEventType(packet);
 
 	// Data compression technique 1: serialize timestamps for event types that tend to repeat them a lot.
 	// Currently, this means polarity events.
-	if ((state->formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+	// Data compression technique 3: delta-code polarity events. Takes precedence over technique 1.
+	if ((state->formatID & 0x04) && eventType == POLARITY_EVENT) {
+		compressedSize = compressPolarityDelta(state, packet);
+	}
+	else if ((state->formatID & 0x01) && eventType == POLARITY_EVENT) {
 		compressedSize = compressTimestampSerialize(state, packet);
 	}
-
-#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	// Data compression technique 5: fast predictive frame codec, optionally with inter-frame
+	// deltas. Takes precedence over technique 2.
+	else if ((state->formatID & 0x20) && eventType == FRAME_EVENT) {
+		compressedSize = compressFramesFast(state, packet);
+	}
 	// Data compression technique 2: do PNG compression on frames, Grayscale and RGB(A).
-	if ((state->formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+	else if ((state->formatID & 0x02) && eventType == FRAME_EVENT) {
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
 		compressedSize = compressFramePNG(state, packet);
+#endif
 	}
+	// Data compression technique 4: general-purpose compression (LZ4 or Zstd) of all
+	// packets not handled by a specialized technique above. Which technique applies
+	// depends only on format and event type, so the decoder can always tell.
+	else if (state->formatID & 0x08) {
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+		compressedSize = compressPacketLZ4(state, context, packet, packetSize);
 #endif
+	}
+	else if (state->formatID & 0x10) {
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+		compressedSize = compressPacketZstd(state, context, packet, packetSize);
+#endif
+	}
 
 	// If any compression was possible, we mark the packet as compressed
 	// and store its data size in eventCapacity.
@@ -529,7 +1012,8 @@ static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader
  * together with eventSize, to come up with a generic implementation applicable to all other event
  * types that satisfy this condition of TS-as-last-member (so we can use that offset as event size).
  * When this is enabled, it requires full iteration thorough the whole event packet, both at
- * compression and at decompression time.
+ * compression and at decompression time. The implementation is shared with the decoder, see
+ * inout_serialized_ts.h, and uses AVX2 for polarity events where supported.
  *
  * @param state common output state.
  * @param packet the packet to timestamp-compress.
@@ -540,76 +1024,285 @@ static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet) {
 	UNUSED_ARGUMENT(state);
 
-	size_t currPacketOffset = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
-	int32_t eventSize       = caerEventPacketHeaderGetEventSize(packet);
-	int32_t eventTSOffset   = caerEventPacketHeaderGetEventTSOffset(packet);
-
-	int32_t lastTS = -1;
-	int32_t currTS = -1;
-	size_t tsRun   = 0;
-	bool doMemMove = false; // Initially don't move memory, until we actually shrink the size.
-
-	for (int32_t caerIteratorCounter = 0; caerIteratorCounter <= caerEventPacketHeaderGetEventNumber(packet);
-		 caerIteratorCounter++) {
-		// Iterate until one element past the end, to flush the last run. In that particular case,
-		// we don't get a new element or TS, as we'd be past the end of the array.
-		if (caerIteratorCounter < caerEventPacketHeaderGetEventNumber(packet)) {
-			const void *caerIteratorElement = caerGenericEventGetEvent(packet, caerIteratorCounter);
-
-			currTS = caerGenericEventGetTimestamp(caerIteratorElement, packet);
-			if (currTS == lastTS) {
-				// Increase size of run of same TS events currently being seen.
-				tsRun++;
-				continue;
-			}
-		}
+	// Start after the header, no change to it.
+	size_t dataSize = caerSerializedTSEncode(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE,
+		(size_t) caerEventPacketHeaderGetEventNumber(packet), (size_t) caerEventPacketHeaderGetEventSize(packet),
+		(size_t) caerEventPacketHeaderGetEventTSOffset(packet));
 
-		// TS are different, at this point look if the last run was long enough
-		// and if it makes sense to compress. It does starting with 3 events.
-		if (tsRun >= 3) {
-			// First event to remains there, we set its TS highest bit.
-			const uint8_t *firstEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-			caerGenericEventSetTimestamp(
-				(void *) firstEvent, packet, caerGenericEventGetTimestamp(firstEvent, packet) | I32T(0x80000000));
+	return (CAER_EVENT_PACKET_HEADER_SIZE + dataSize);
+}
 
-			// Now use second event's timestamp for storing how many further events.
-			const uint8_t *secondEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-			caerGenericEventSetTimestamp((void *) secondEvent, packet, I32T(tsRun)); // Is at least 1.
+/**
+ * Delta-code polarity events: timestamps and addresses are stored as differences
+ * to the previous event, bit-packed in blocks of 32 events at the smallest width
+ * that fits them. See inout_polarity_delta.h for the exact format.
+ * The data is encoded into a separate buffer and only copied back into the packet
+ * if it actually got smaller, which it almost always does for real sensor data.
+ *
+ * @param state common output state.
+ * @param packet the polarity packet to delta-compress.
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Must be equal or smaller than the input packetSize.
+ */
+static size_t compressPolarityDelta(outputCommonState state, caerEventPacketHeader packet) {
+	size_t eventNumber = (size_t) caerEventPacketHeaderGetEventNumber(packet);
+	size_t packetSize  = CAER_EVENT_PACKET_HEADER_SIZE
+						+ (eventNumber * (size_t) caerEventPacketHeaderGetEventSize(packet));
 
-			// Finally move modified memory where it needs to go.
-			if (doMemMove) {
-				memmove(((uint8_t *) packet) + currPacketOffset, firstEvent, (size_t) eventSize * 2);
-			}
-			else {
-				doMemMove = true; // After first shrink always move memory.
-			}
-			currPacketOffset += (size_t) eventSize * 2;
+	uint8_t *encodedData = malloc(POLARITY_DELTA_MAX_SIZE(eventNumber));
+	if (encodedData == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate memory for polarity delta compression, sending packet uncompressed.");
+		return (packetSize);
+	}
 
-			// Now go through remaining events and move their data close together.
-			while (tsRun > 0) {
-				const uint8_t *thirdEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-				memmove(((uint8_t *) packet) + currPacketOffset, thirdEvent, (size_t) eventTSOffset);
-				currPacketOffset += (size_t) eventTSOffset;
-			}
-		}
-		else {
-			// Just copy data unchanged if no compression is possible.
-			if (doMemMove) {
-				const uint8_t *startEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun);
-				memmove(((uint8_t *) packet) + currPacketOffset, startEvent, (size_t) eventSize * tsRun);
-			}
-			currPacketOffset += (size_t) eventSize * tsRun;
-		}
+	// Start after the header, no change to it.
+	size_t dataSize = caerPolarityDeltaEncode(
+		encodedData, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, eventNumber);
 
-		// Reset values for next iteration.
-		lastTS = currTS;
-		tsRun  = 1;
+	if ((CAER_EVENT_PACKET_HEADER_SIZE + dataSize) < packetSize) {
+		memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, encodedData, dataSize);
+		packetSize = CAER_EVENT_PACKET_HEADER_SIZE + dataSize;
 	}
 
-	return (currPacketOffset);
+	free(encodedData);
+
+	return (packetSize);
 }
 
-#ifdef ENABLE_INOUT_PNG_COMPRESSION
+/**
+ * Compress frames with the fast lossless codec from inout_frame_codec.h.
+ * Frames are stored like PNG-compressed ones: the frame event header with bit 31
+ * of info set, followed by the size of the encoded block as 4 byte integer and
+ * the encoded block itself. Frames that don't shrink are kept uncompressed.
+ * With delta mode enabled, frames are encoded against the previous frame with the
+ * same ROI identifier, except every 'compressFramesDeltaInterval' frames, which
+ * are key frames, so decoders joining a stream late can catch up. References are
+ * only updated by compressed frames, as only those are seen by the decoder.
+ *
+ * @param state common output state.
+ * @param packet the frame packet to compress.
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Must be equal or smaller than the input packetSize.
+ */
+static size_t compressFramesFast(outputCommonState state, caerEventPacketHeader packet) {
+	size_t currPacketOffset = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
+	// '- sizeof(uint16_t)' to compensate for pixels[1] at end of struct for C++ compatibility.
+	size_t frameEventHeaderSize = (sizeof(struct caer_frame_event) - sizeof(uint16_t));
+
+	// Only delta mode uses frameKeyPacket, and compresses frames on the compressor thread
+	// alone. Without it, frames are compressed on the workers, which must not touch it.
+	if (state->compression.frameDeltaInterval > 0) {
+		state->compression.frameKeyPacket = true;
+	}
+
+	CAER_FRAME_ITERATOR_ALL_START((caerFrameEventPacket) packet)
+	size_t pixelSize = caerFrameEventGetPixelsSize(caerFrameIteratorElement);
+
+	int32_t lengthX  = caerFrameEventGetLengthX(caerFrameIteratorElement);
+	int32_t lengthY  = caerFrameEventGetLengthY(caerFrameIteratorElement);
+	int32_t channels = (int32_t) caerFrameEventGetChannelNumber(caerFrameIteratorElement);
+
+	// Delta frame if possible and enabled, key frame otherwise. References are only
+	// used in delta mode, where frames are compressed on the compressor thread only.
+	struct caer_frame_codec_reference *reference = NULL;
+	bool isDelta                                 = false;
+	uint16_t sequence                            = 0;
+
+	if (state->compression.frameDeltaInterval > 0) {
+		reference = &state->compression.frameReferences[caerFrameEventGetROIIdentifier(caerFrameIteratorElement)];
+
+		isDelta = caerFrameCodecReferenceMatches(reference, lengthX, lengthY, channels)
+				  && (reference->framesSinceKey < (uint32_t) state->compression.frameDeltaInterval);
+
+		sequence = (uint16_t)(reference->sequence + 1);
+	}
+
+	uint8_t *outBuffer = malloc(FRAME_CODEC_MAX_SIZE(pixelSize / sizeof(uint16_t)));
+	size_t outSize     = 0;
+
+	if (outBuffer != NULL) {
+		outSize = caerFrameCodecEncode(outBuffer, caerFrameEventGetPixelArrayUnsafe(caerFrameIteratorElement), lengthX,
+			lengthY, channels, (isDelta) ? (reference) : (NULL), sequence);
+	}
+
+	// Add integer needed for storing encoded block length.
+	size_t encodedSize = outSize + sizeof(int32_t);
+
+	// If memory allocation failed, or we don't gain any size advantages, just keep it uncompressed.
+	if (outBuffer == NULL || encodedSize >= pixelSize) {
+		// Copy this frame uncompressed. Don't want to loose data.
+		size_t fullCopySize = frameEventHeaderSize + pixelSize;
+		memmove(((uint8_t *) packet) + currPacketOffset, caerFrameIteratorElement, fullCopySize);
+		currPacketOffset += fullCopySize;
+
+		free(outBuffer);
+		continue;
+	}
+
+	// This frame is the new reference for its ROI, update it before its pixels get overwritten.
+	if ((reference != NULL)
+		&& caerFrameCodecReferenceUpdate(reference, caerFrameEventGetPixelArrayUnsafe(caerFrameIteratorElement),
+			   lengthX, lengthY, channels, sequence)) {
+		reference->framesSinceKey = (isDelta) ? (reference->framesSinceKey + 1) : (1);
+	}
+
+	// Delta frames only exist in delta mode, see above.
+	if (isDelta) {
+		state->compression.frameKeyPacket = false;
+	}
+
+	// Mark frame as compressed. Use info member in frame event header struct,
+	// to store highest bit equals one.
+	SET_NUMBITS32(caerFrameIteratorElement->info, 31, 0x01, 1);
+
+	// Keep frame event header intact, copy all image data, move memory close together.
+	memmove(((uint8_t *) packet) + currPacketOffset, caerFrameIteratorElement, frameEventHeaderSize);
+	currPacketOffset += frameEventHeaderSize;
+
+	// Store size of encoded block as 4 byte integer.
+	*((int32_t *) (((uint8_t *) packet) + currPacketOffset)) = htole32(I32T(outSize));
+	currPacketOffset += sizeof(int32_t);
+
+	memcpy(((uint8_t *) packet) + currPacketOffset, outBuffer, outSize);
+	currPacketOffset += outSize;
+
+	free(outBuffer);
+}
+
+return (currPacketOffset);
+}
+
+static uint8_t *compressionContextBuffer(struct output_common_compression_context *context, size_t size) {
+	if (context->bufferSize < size) {
+		uint8_t *newBuffer = realloc(context->buffer, size);
+		if (newBuffer == NULL) {
+			return (NULL);
+		}
+
+		context->buffer     = newBuffer;
+		context->bufferSize = size;
+	}
+
+	return (context->buffer);
+}
+
+static void compressionContextFree(struct output_common_compression_context *context) {
+	free(context->buffer);
+	context->buffer     = NULL;
+	context->bufferSize = 0;
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_freeCCtx(context->zstdContext);
+	context->zstdContext = NULL;
+#endif
+}
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+
+/**
+ * Compress the data portion of a packet with LZ4. Fast enough to keep up with
+ * live event streams, with modest compression ratios, so the default for network
+ * outputs. The destination is limited to one byte less than the input, so LZ4
+ * gives up early on data it can't make smaller, which is then sent uncompressed.
+ *
+ * @param state common output state.
+ * @param context compression context of the calling thread.
+ * @param packet the event packet to compress.
+ * @param packetSize the current event packet size (header + data).
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Must be equal or smaller than the input packetSize.
+ */
+static size_t compressPacketLZ4(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize) {
+	size_t dataSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	if (dataSize < 2 || dataSize > LZ4_MAX_INPUT_SIZE) {
+		return (packetSize);
+	}
+
+	uint8_t *compressedData = compressionContextBuffer(context, dataSize - 1);
+	if (compressedData == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate memory for LZ4 compression, sending packet uncompressed.");
+		return (packetSize);
+	}
+
+	// Start after the header, no change to it.
+	size_t compressedSize = caerPacketCompressLZ4(
+		compressedData, ((const uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, dataSize);
+	if (compressedSize == 0) {
+		// Not compressible.
+		return (packetSize);
+	}
+
+	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, compressedData, compressedSize);
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + compressedSize);
+}
+
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+
+/**
+ * Compress the data portion of a packet with Zstd, at the configured level and
+ * with the optional trained dictionary, which helps a lot with small packets.
+ * Better compression ratios than LZ4 at higher CPU cost, so the default for
+ * file recording. As with LZ4, data that doesn't get smaller is sent uncompressed.
+ *
+ * @param state common output state.
+ * @param context compression context of the calling thread.
+ * @param packet the event packet to compress.
+ * @param packetSize the current event packet size (header + data).
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Must be equal or smaller than the input packetSize.
+ */
+static size_t compressPacketZstd(outputCommonState state, struct output_common_compression_context *context,
+	caerEventPacketHeader packet, size_t packetSize) {
+	size_t dataSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	if (dataSize < 2) {
+		return (packetSize);
+	}
+
+	if (context->zstdContext == NULL) {
+		context->zstdContext = ZSTD_createCCtx();
+		if (context->zstdContext == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to create Zstd compression context, sending packet uncompressed.");
+			return (packetSize);
+		}
+	}
+
+	uint8_t *compressedData = compressionContextBuffer(context, dataSize - 1);
+	if (compressedData == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate memory for Zstd compression, sending packet uncompressed.");
+		return (packetSize);
+	}
+
+	// Start after the header, no change to it.
+	size_t compressedSize = caerPacketCompressZstd(context->zstdContext, state->compression.zstdDictionary,
+		state->compression.zstdLevel, compressedData, ((const uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE,
+		dataSize);
+	if (compressedSize == 0) {
+		// Not compressible.
+		return (packetSize);
+	}
+
+	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, compressedData, compressedSize);
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + compressedSize);
+}
+
+#endif
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
 
 // Simple structure to store PNG image bytes.
 struct caer_libpng_buffer {
@@ -800,23 +1493,70 @@ return (currPacketOffset);
  * OUTPUT THREAD
  * ============================================================================
  * Handle writing of data to output. Uses libuv/eventloop for network outputs,
- * while simple FD+writeUntilDone() for normal files.
+ * while simple FD+writeUntilDone() for normal files. File data is collected
+ * in a large aligned buffer and written out in big blocks, optionally with
+ * O_DIRECT, into space preallocated in big extents.
+ * Segmented file recordings switch to a new file (segment) between packets,
+ * once the current one reached its maximum size or duration. Each segment
+ * is a complete AEDAT 3.1 file ending with an index of its packets.
  * ============================================================================
  */
 static int outputThread(void *stateArg);
-static void libuvRingBufferGet(uv_idle_t *handle);
+static void libuvRingBufferGet(uv_async_t *handle);
+static void libuvWriteBatchTimeout(uv_timer_t *handle);
 static void libuvAsyncShutdown(uv_async_t *handle);
 static void libuvClientShutdown(uv_shutdown_t *clientShutdown, int status);
 static void libuvWriteStatusCheck(uv_handle_t *handle, int status);
 static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer);
 static void initializeNetworkHeader(outputCommonState state);
+static void nextNetworkHeader(
+	outputCommonNetIO streams, struct aedat3_network_header *header, bool startOfUDPPacket);
 static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, bool startOfUDPPacket);
+static bool udpFECAdd(
+	outputCommonState state, const struct aedat3_network_header *header, const uint8_t *data, size_t dataSize);
+static bool udpFECParity(outputCommonState state, struct aedat3_network_header *header, libuvWriteBuf parityBuffer);
+#ifdef ENABLE_INOUT_SENDMMSG
+static void udpBatchAdd(outputCommonState state, libuvWriteBuf packetBuffer);
+static void udpBatchAddParity(outputCommonState state);
+static void udpBatchSend(outputCommonState state);
+static void udpBatchWritable(uv_poll_t *handle, int status, int events);
+static void udpBatchDrop(outputCommonState state);
+#else
+static void udpFECSendParity(outputCommonState state);
+#endif
+static void clientOpen(outputCommonNetIO streams, size_t index);
+static void clientClose(outputCommonNetIO streams, size_t index);
+static libuvWriteBuf outputRingGet(outputCommonState state);
+static bool liveModeDropOldestPacket(outputCommonState state);
+static void clientEnqueue(
+	outputCommonNetIO streams, size_t index, libuvWriteMultiBuf buffers, bool keyPacket, bool liveMode);
+static void clientQueueDropOldest(struct output_common_client *client);
+static bool clientQueueDropOldestNonKey(struct output_common_client *client);
+static void clientQueueDropNonKey(struct output_common_client *client);
+static void clientSend(outputCommonNetIO streams, size_t index, bool sendAll);
+static bool clientWrite(outputCommonNetIO streams, size_t index, size_t packetsNumber);
+static void clientWriteDone(uv_write_t *writeRequest, int status);
+static void clientSetCork(outputCommonNetIO streams, size_t index, bool cork);
+static void streamWritesScheduleFlush(outputCommonNetIO streams, uint64_t delay);
+static void streamWritesUpdateMode(outputCommonNetIO streams);
+static void streamWritesSetThroughput(outputCommonNetIO streams, bool throughput);
+static void clientUpdateStatistics(struct output_common_client *client);
+static void clientsUpdateList(outputCommonNetIO streams);
 static void writeFileHeader(outputCommonState state);
+static bool fileWriterWrite(outputCommonState state, const uint8_t *data, size_t dataSize);
+static bool fileWriterFlush(outputCommonState state, bool final);
+static void fileWriterPreallocate(outputCommonState state, size_t writeSize);
+static bool fileWriterDisableDirectIO(outputCommonState state);
+static bool fileWritePacket(outputCommonState state, libuvWriteBuf packetBuffer);
+static bool fileSegmentIsFull(outputCommonState state, size_t packetSize);
+static bool fileSegmentSwitch(outputCommonState state);
+static void fileSegmentIndexAdd(outputCommonState state, int64_t timestamp);
+static bool fileSegmentFinish(outputCommonState state);
 
 static inline _Noreturn void errorExit(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Free currently held memory.
 	if (packetBuffer != NULL) {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 	}
 
@@ -840,6 +1580,19 @@ static int outputThread(void *stateArg) {
 	strcat(threadName, "[Output]");
 	portable_thread_set_name(threadName);
 
+	// Files are written in big blocks, collected in a buffer first.
+	// Aligned for O_DIRECT, which requires it.
+	if (!state->isNetworkStream) {
+		if (posix_memalign(
+				(void **) &state->fileWriter.buffer, FILE_WRITER_ALIGNMENT, state->fileWriter.bufferSize)
+			!= 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate file write buffer.");
+			errorExit(state, NULL);
+		}
+
+		portable_clock_gettime_monotonic(&state->fileWriter.lastWriteTime);
+	}
+
 	bool headerSent = false;
 
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
@@ -873,7 +1626,7 @@ static int outputThread(void *stateArg) {
 	if (!headerSent) {
 		libuvWriteBuf packetBuffer;
 		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-			free(packetBuffer->freeBuf);
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 		}
 
@@ -901,53 +1654,181 @@ static int outputThread(void *stateArg) {
 		while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 			libuvWriteBuf packetBuffer = caerRingBufferGet(state->outputRing);
 			if (packetBuffer == NULL) {
+				// Don't keep data in the write buffer for long if the data rate
+				// is low, write it out after one second without writes.
+				if (state->fileWriter.bufferUsed > 0) {
+					struct timespec currentTime;
+					portable_clock_gettime_monotonic(&currentTime);
+
+					if ((currentTime.tv_sec - state->fileWriter.lastWriteTime.tv_sec) >= 1
+						&& !fileWriterFlush(state, false)) {
+						errorExit(state, NULL);
+					}
+				}
+
 				// There is none, so we can't work on and commit this.
 				// We just sleep here a little and then try again, as we need the data!
 				thrd_sleep(&noDataSleep, NULL);
 				continue;
 			}
 
-			// Write buffer to file descriptor.
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
+			// Write buffer to file (through write buffer).
+			if (!fileWritePacket(state, packetBuffer)) {
 				errorExit(state, packetBuffer);
 			}
 
-			free(packetBuffer->freeBuf);
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 		}
 
 		// Write all remaining buffers to file.
 		libuvWriteBuf packetBuffer;
 		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
+			if (!fileWritePacket(state, packetBuffer)) {
 				errorExit(state, packetBuffer);
 			}
 
-			free(packetBuffer->freeBuf);
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 		}
+
+		// Segments also get their index written at the end.
+		if (state->segments.openFile != NULL) {
+			if (!fileSegmentFinish(state)) {
+				errorExit(state, NULL);
+			}
+		}
+		else if (!fileWriterFlush(state, true)) {
+			errorExit(state, NULL);
+		}
 	}
 
 	return (thrd_success);
 }
 
-static void libuvRingBufferGet(uv_idle_t *handle) {
+/**
+ * Get the next packet buffer to write out from the output ring-buffer.
+ * In live mode, all packet buffers waiting there are taken, and once more
+ * than LIVE_MODE_MAX_PACKETS are waiting, the oldest ones are dropped, so
+ * the newest data is always kept and the compressor never has to drop it.
+ * Key packets are never dropped.
+ *
+ * @param state common output state.
+ *
+ * @return next packet buffer, or NULL if none is waiting.
+ */
+static libuvWriteBuf outputRingGet(outputCommonState state) {
+	struct output_common_live_mode *live = &state->liveMode;
+
+	if (atomic_load_explicit(&live->enabled, memory_order_relaxed)) {
+		// Take all waiting packet buffers, making room by dropping the oldest.
+		while (caerRingBufferLook(state->outputRing) != NULL) {
+			if (live->outputWindowSize == LIVE_MODE_MAX_PACKETS && !liveModeDropOldestPacket(state)) {
+				// Only key packets waiting, write them out first.
+				break;
+			}
+
+			live->outputWindow[(live->outputWindowHead + live->outputWindowSize) % LIVE_MODE_MAX_PACKETS]
+				= caerRingBufferGet(state->outputRing);
+			live->outputWindowSize++;
+		}
+	}
+	else if (live->outputWindowSize == 0) {
+		return (caerRingBufferGet(state->outputRing));
+	}
+
+	// Live mode, or it was just disabled: write out what was already taken first.
+	if (live->outputWindowSize == 0) {
+		return (NULL);
+	}
+
+	libuvWriteBuf packetBuffer = live->outputWindow[live->outputWindowHead];
+
+	live->outputWindowHead = (live->outputWindowHead + 1) % LIVE_MODE_MAX_PACKETS;
+	live->outputWindowSize--;
+
+	return (packetBuffer);
+}
+
+/**
+ * Drop the oldest non-key packet buffer taken from the output ring-buffer
+ * in live mode, keeping the order of the others.
+ *
+ * @param state common output state.
+ *
+ * @return true if one was dropped, false if all are key packets.
+ */
+static bool liveModeDropOldestPacket(outputCommonState state) {
+	struct output_common_live_mode *live = &state->liveMode;
+
+	for (size_t i = 0; i < live->outputWindowSize; i++) {
+		libuvWriteBuf *entry = &live->outputWindow[(live->outputWindowHead + i) % LIVE_MODE_MAX_PACKETS];
+
+		if (((struct output_common_packet_buffer *) *entry)->keyPacket) {
+			continue;
+		}
+
+		libuvWriteBufFreeData(*entry);
+		free(*entry);
+
+		// Move the newer ones down into its place.
+		for (size_t j = i + 1; j < live->outputWindowSize; j++) {
+			live->outputWindow[(live->outputWindowHead + j - 1) % LIVE_MODE_MAX_PACKETS]
+				= live->outputWindow[(live->outputWindowHead + j) % LIVE_MODE_MAX_PACKETS];
+		}
+
+		live->outputWindowSize--;
+
+		atomic_fetch_add_explicit(&live->packetsDropped, 1, memory_order_relaxed);
+		return (true);
+	}
+
+	return (false);
+}
+
+static void libuvRingBufferGet(uv_async_t *handle) {
 	outputCommonState state = handle->data;
 
 	// Write all packets that are currently available out in order,
 	// but never more than 10 at a time.
 	size_t count = 0;
 	libuvWriteBuf packetBuffer;
-	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = outputRingGet(state)) != NULL) {
 		writePacket(state, packetBuffer);
 		count++;
 	}
 
-	// If nothing, avoid busy loop within libuv event loop by sleeping a little.
-	if (count == 0) {
-		// Sleep for 1 ms.
-		struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-		thrd_sleep(&noDataSleep, NULL);
+	// More data left: come back for it, after letting libuv handle pending I/O.
+	if (count == MAX_OUTPUT_RINGBUFFER_GET) {
+		uv_async_send(handle);
+	}
+
+#ifdef ENABLE_INOUT_SENDMMSG
+	// Send all UDP datagrams of this round together.
+	if (state->networkIO->isUDP) {
+		udpBatchSend(state);
+	}
+#endif
+
+	// Pass on queued data to clients that can take more now.
+	if (state->networkIO->clientQueues != NULL) {
+		streamWritesUpdateMode(state->networkIO);
+
+		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+			if (state->networkIO->clients[i] != NULL) {
+				clientSend(state->networkIO, i, false);
+			}
+		}
+	}
+}
+
+static void libuvWriteBatchTimeout(uv_timer_t *handle) {
+	outputCommonNetIO streams = handle->data;
+
+	for (size_t i = 0; i < streams->clientsSize; i++) {
+		if (streams->clients[i] != NULL) {
+			clientSend(streams, i, false);
+		}
 	}
 }
 
@@ -956,19 +1837,45 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 	outputCommonState state = handle->data;
 
 	// Shutdown, write remaining buffers to network.
-	// First we stop and close the idle handles checking for new data,
-	// then we manually schedule writes for the remaining data.
-	int retVal = uv_idle_stop(&state->networkIO->ringBufferGet);
-	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_stop", );
-
+	// First we close the handles checking for new data and pending batches,
+	// then we manually schedule writes for the remaining data. The compressor
+	// thread is done at this point, so no new data can be signalled anymore.
 	uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 
-	// Then we empty the ring-buffer and write out all data.
+	int retVal = uv_timer_stop(&state->networkIO->writeBatchTimer);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_timer_stop", );
+
+	uv_close((uv_handle_t *) &state->networkIO->writeBatchTimer, NULL);
+
+	// Then we empty the ring-buffer and write out all data (in live mode,
+	// what was already taken from it first, and only the newest).
 	libuvWriteBuf packetBuffer;
-	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+	while ((packetBuffer = outputRingGet(state)) != NULL) {
 		writePacket(state, packetBuffer);
 	}
 
+#ifdef ENABLE_INOUT_SENDMMSG
+	if (state->networkIO->isUDP) {
+		udpBatchSend(state);
+
+		// No more waiting for the socket to drain, drop what's left.
+		if (state->networkIO->udpBatch.writableWait) {
+			udpBatchDrop(state);
+		}
+
+		uv_close((uv_handle_t *) &state->networkIO->udpBatch.writablePoll, NULL);
+	}
+#endif
+
+	// All queued data goes to libuv now, the shutdown below waits for it to be written.
+	if (state->networkIO->clientQueues != NULL) {
+		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+			if (state->networkIO->clients[i] != NULL) {
+				clientSend(state->networkIO, i, true);
+			}
+		}
+	}
+
 	// Shutdown server (if it exists).
 	if (state->networkIO->server != NULL) {
 		uv_close((uv_handle_t *) state->networkIO->server, &libuvCloseFree);
@@ -1025,12 +1932,7 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 
 		for (size_t i = 0; i < streams->clientsSize; i++) {
 			if ((uv_handle_t *) streams->clients[i] == handle) {
-				streams->clients[i] = NULL;
-				streams->activeClients--;
-
-				// Close connection and free its memory.
-				uv_close(handle, &libuvCloseFree);
-
+				clientClose(streams, i);
 				break;
 			}
 		}
@@ -1040,7 +1942,7 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// If no active clients exist, don't write anything.
 	if (state->networkIO->activeClients == 0) {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 
 		return;
@@ -1054,6 +1956,10 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// the packets up into manageable sizes (<=64K), together with keeping track
 	// of the sequence number.
 	if (state->networkIO->isUDP) {
+#ifdef ENABLE_INOUT_SENDMMSG
+		// UDP output, sent in batches directly from the packet buffer.
+		udpBatchAdd(state, packetBuffer);
+#else
 		// UDP output.
 		// If too much data waiting to be sent, just skip current packet.
 		if (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
@@ -1106,6 +2012,14 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 				retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDP", libuvWriteBufFree(buffers);
 				goto freePacketBufferUDP);
 
+			atomic_fetch_add_explicit(&state->networkIO->udpBatch.datagramsSent, 1, memory_order_relaxed);
+			atomic_fetch_add_explicit(&state->networkIO->udpBatch.sendCalls, 1, memory_order_relaxed);
+
+			if (udpFECAdd(state, (const struct aedat3_network_header *) buffers->buffers[0].buf.base,
+					(const uint8_t *) packetBuffer->buf.base + packetIndex, sendSize)) {
+				udpFECSendParity(state);
+			}
+
 			// Update loop indexes.
 			packetSize -= sendSize;
 			packetIndex += sendSize;
@@ -1113,18 +2027,22 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 
 	// Free all packet memory.
 	freePacketBufferUDP : {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 	}
+#endif
 	}
 	else {
 		// TCP/Pipe outputs.
+		bool keyPacket = ((struct output_common_packet_buffer *) packetBuffer)->keyPacket;
+		bool liveMode  = atomic_load_explicit(&state->liveMode.enabled, memory_order_relaxed);
+
 		// Prepare buffers, increase reference count.
 		libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
 		if (buffers == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
 
-			free(packetBuffer->freeBuf);
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 			return;
 		}
@@ -1136,22 +2054,22 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 		buffers->buffers[0] = *packetBuffer;
 		free(packetBuffer);
 
-		// Write to each client, but use common reference-counted buffer.
-		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
-			uv_stream_t *client = state->networkIO->clients[i];
+		state->networkIO->streamWrites.ratePackets++;
 
-			if (client == NULL) {
+		// Queue for each client, but use common reference-counted buffer. Each client
+		// releases its reference once written or dropped, so slow clients only ever
+		// hold up themselves.
+		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+			if (state->networkIO->clients[i] == NULL) {
 				continue;
 			}
 
-			// If too much data waiting to be sent, just skip current packet.
-			if (client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
-				libuvWriteBufFree(buffers);
-				return;
-			}
+			clientEnqueue(state->networkIO, i, buffers, keyPacket, liveMode);
 
-			int retVal = libuvWrite(client, buffers);
-			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers));
+			// Client may have been disconnected by its slow client policy.
+			if (state->networkIO->clients[i] != NULL) {
+				clientSend(state->networkIO, i, false);
+			}
 		}
 	}
 }
@@ -1175,6 +2093,21 @@ static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, boo
 		return (false);
 	}
 
+	nextNetworkHeader(streams, (struct aedat3_network_header *) (void *) buf->buf.base, startOfUDPPacket);
+
+	return (true);
+}
+
+/**
+ * Copy the current network header, then advance its sequence number
+ * for message-based protocols (UDP).
+ *
+ * @param streams network output streams.
+ * @param header memory to copy the network header to.
+ * @param startOfUDPPacket this message starts a new event packet.
+ */
+static void nextNetworkHeader(
+	outputCommonNetIO streams, struct aedat3_network_header *header, bool startOfUDPPacket) {
 	if (streams->isUDP && startOfUDPPacket) {
 		// Set highest bit of sequence number to one.
 		streams->networkHeader.sequenceNumber
@@ -1182,7 +2115,7 @@ static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, boo
 	}
 
 	// Copy in current header.
-	memcpy(buf->buf.base, &streams->networkHeader, AEDAT3_NETWORK_HEADER_LENGTH);
+	memcpy(header, &streams->networkHeader, AEDAT3_NETWORK_HEADER_LENGTH);
 
 	if (streams->isUDP) {
 		if (startOfUDPPacket) {
@@ -1195,180 +2128,2253 @@ static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, boo
 		// message-based network protocol (UDP for example).
 		streams->networkHeader.sequenceNumber = I64T(htole64(le64toh(U64T(streams->networkHeader.sequenceNumber)) + 1));
 	}
-
-	return (true);
 }
 
-static void writeFileHeader(outputCommonState state) {
-	// Write AEDAT 3.1 header.
-	writeUntilDone(
-		state->fileIO, (const uint8_t *) "#!AER-DAT" AEDAT3_FILE_VERSION "\r\n", 11 + strlen(AEDAT3_FILE_VERSION));
-
-	// Write format header for all supported formats.
-	writeUntilDone(state->fileIO, (const uint8_t *) "#Format: ", 9);
+/**
+ * Add a datagram to the current FEC group, see inout_common.h for the format.
+ *
+ * @param state common output state.
+ * @param header network header of the datagram.
+ * @param data data of the datagram, following the header.
+ * @param dataSize size of the data in bytes.
+ *
+ * @return true if the group is now complete, and its parity datagram has
+ *         to be sent next, false otherwise (or if FEC is disabled).
+ */
+static bool udpFECAdd(
+	outputCommonState state, const struct aedat3_network_header *header, const uint8_t *data, size_t dataSize) {
+	struct output_common_udp_fec *fec = &state->networkIO->udpBatch.fec;
 
-	if (state->formatID == 0x00) {
-		writeUntilDone(state->fileIO, (const uint8_t *) "RAW", 3);
+	if (fec->groupSize == 0) {
+		return (false);
 	}
-	else {
-		// Support the various formats and their mixing.
-		if (state->formatID == 0x01) {
-			writeUntilDone(state->fileIO, (const uint8_t *) "SerializedTS", 12);
-		}
 
-		if (state->formatID == 0x02) {
-			writeUntilDone(state->fileIO, (const uint8_t *) "PNGFrames", 9);
+	if (fec->parity == NULL) {
+		fec->parity = malloc(AEDAT3_NETWORK_HEADER_LENGTH + AEDAT3_MAX_UDP_SIZE);
+		if (fec->parity == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to allocate memory for FEC parity, disabling forward error correction.");
+			fec->groupSize = 0;
+			return (false);
 		}
+	}
 
-		if (state->formatID == 0x03) {
-			// Serial and PNG together.
-			writeUntilDone(state->fileIO, (const uint8_t *) "SerializedTS,PNGFrames", 12 + 1 + 9);
-		}
+	size_t datagramLength = AEDAT3_NETWORK_HEADER_LENGTH + dataSize;
+
+	if (fec->groupDatagrams == 0) {
+		fec->groupSequence = le64toh(U64T(header->sequenceNumber)) & 0x7FFFFFFFFFFFFFFFLLU;
+		fec->parityLength  = 0;
+		fec->lengthParity  = 0;
 	}
 
-	writeUntilDone(state->fileIO, (const uint8_t *) "\r\n", 2);
+	// Grow the parity to the new length, zero-padding all datagrams so far.
+	if (datagramLength > fec->parityLength) {
+		memset(fec->parity + fec->parityLength, 0, datagramLength - fec->parityLength);
+		fec->parityLength = datagramLength;
+	}
 
-	writeUntilDone(state->fileIO, (const uint8_t *) state->sourceInfoString, strlen(state->sourceInfoString));
+	const uint8_t *headerBytes = (const uint8_t *) header;
 
-	// First prepend the time.
-	time_t currentTimeEpoch = time(NULL);
+	for (size_t i = 0; i < AEDAT3_NETWORK_HEADER_LENGTH; i++) {
+		fec->parity[i] ^= headerBytes[i];
+	}
 
-#if defined(OS_WINDOWS)
-	// localtime() is thread-safe on Windows (and there is no localtime_r() at all).
-	struct tm *currentTime = localtime(&currentTimeEpoch);
+	uint8_t *dataParity = fec->parity + AEDAT3_NETWORK_HEADER_LENGTH;
 
-	// Windows doesn't support %z (numerical timezone), so no TZ info here.
-	// Following time format uses exactly 34 characters (20 separators/characters,
-	// 4 year, 2 month, 2 day, 2 hours, 2 minutes, 2 seconds).
-	size_t currentTimeStringLength = 34;
-	char currentTimeString[currentTimeStringLength + 1]; // + 1 for terminating NUL byte.
-	strftime(currentTimeString, currentTimeStringLength + 1, "#Start-Time: %Y-%m-%d %H:%M:%S\r\n", currentTime);
-#else
-	// From localtime_r() man-page: "According to POSIX.1-2004, localtime()
-	// is required to behave as though tzset(3) was called, while
-	// localtime_r() does not have this requirement."
-	// So we make sure to call it here, to be portable.
-	tzset();
+	for (size_t i = 0; i < dataSize; i++) {
+		dataParity[i] ^= data[i];
+	}
 
-	struct tm currentTime;
-	localtime_r(&currentTimeEpoch, &currentTime);
+	fec->lengthParity ^= U32T(datagramLength);
+	fec->groupDatagrams++;
 
-	// Following time format uses exactly 44 characters (25 separators/characters,
-	// 4 year, 2 month, 2 day, 2 hours, 2 minutes, 2 seconds, 5 time-zone).
+	return (fec->groupDatagrams == fec->groupSize);
+}
+
+/**
+ * Generate the parity datagram of the current FEC group, and start a new group.
+ *
+ * @param state common output state.
+ * @param header network header of the parity datagram, to fill in.
+ * @param parityBuffer data of the parity datagram, allocated here.
+ *
+ * @return true on success, false on memory allocation failure.
+ */
+static bool udpFECParity(outputCommonState state, struct aedat3_network_header *header, libuvWriteBuf parityBuffer) {
+	struct output_common_udp_fec *fec = &state->networkIO->udpBatch.fec;
+
+	size_t groupDatagrams = fec->groupDatagrams;
+	fec->groupDatagrams   = 0;
+
+	libuvWriteBufInit(parityBuffer, sizeof(struct inout_fec_header) + fec->parityLength);
+	if (parityBuffer->buf.base == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for FEC parity datagram.");
+		return (false);
+	}
+
+	*header                = state->networkIO->networkHeader;
+	header->magicNumber    = I64T(htole64(INOUT_FEC_MAGIC_NUMBER));
+	header->sequenceNumber = I64T(htole64(fec->groupSequence));
+
+	struct inout_fec_header *fecHeader = (struct inout_fec_header *) parityBuffer->buf.base;
+	fecHeader->groupSize               = htole16(U16T(groupDatagrams));
+	fecHeader->reserved                = 0;
+	fecHeader->lengthParity            = htole32(fec->lengthParity);
+
+	memcpy(parityBuffer->buf.base + sizeof(struct inout_fec_header), fec->parity, fec->parityLength);
+
+	atomic_fetch_add_explicit(&state->networkIO->udpBatch.fecDatagrams, 1, memory_order_relaxed);
+
+	return (true);
+}
+
+#ifndef ENABLE_INOUT_SENDMMSG
+
+/**
+ * Send the parity datagram of the completed FEC group.
+ *
+ * @param state common output state.
+ */
+static void udpFECSendParity(outputCommonState state) {
+	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(2); // One for network header, one for parity.
+	if (buffers == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
+		state->networkIO->udpBatch.fec.groupDatagrams = 0;
+		return;
+	}
+
+	buffers->statusCheck = &libuvWriteStatusCheck;
+
+	libuvWriteBufInit(&buffers->buffers[0], AEDAT3_NETWORK_HEADER_LENGTH);
+	if (buffers->buffers[0].buf.base == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network header.");
+		state->networkIO->udpBatch.fec.groupDatagrams = 0;
+		libuvWriteBufFree(buffers);
+		return;
+	}
+
+	if (!udpFECParity(
+			state, (struct aedat3_network_header *) buffers->buffers[0].buf.base, &buffers->buffers[1])) {
+		libuvWriteBufFree(buffers);
+		return;
+	}
+
+	int retVal = libuvWriteUDP((uv_udp_t *) state->networkIO->clients[0], state->networkIO->address, buffers);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDP", libuvWriteBufFree(buffers);
+				 return );
+
+	atomic_fetch_add_explicit(&state->networkIO->udpBatch.datagramsSent, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&state->networkIO->udpBatch.sendCalls, 1, memory_order_relaxed);
+}
+
+#endif
+
+#ifdef ENABLE_INOUT_SENDMMSG
+
+/**
+ * Queue an event packet for sending over UDP, split into datagrams of at most
+ * AEDAT3_MAX_UDP_SIZE bytes of data, each with its own network header.
+ * The datagrams point directly into the packet buffer, which is kept until
+ * they are sent. A full batch is sent right away. While the socket buffer
+ * is full, packets are dropped.
+ *
+ * @param state common output state.
+ * @param packetBuffer the event packet to send.
+ */
+static void udpBatchAdd(outputCommonState state, libuvWriteBuf packetBuffer) {
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	size_t packetSize  = packetBuffer->buf.len;
+	size_t packetIndex = 0;
+	bool firstChunk    = true;
+
+	while (packetSize > 0) {
+		// Datagrams, or packet buffers (room for this one included), full.
+		if ((batch->datagrams == UDP_BATCH_MAX_DATAGRAMS) || (batch->packetBuffersSize == UDP_BATCH_MAX_DATAGRAMS)) {
+			// This packet is not in packetBuffers yet, so it's kept.
+			udpBatchSend(state);
+		}
+
+		if (batch->writableWait) {
+			// Socket buffer full, drop the rest of the packet. Datagrams of it
+			// already in the batch still point into it, so it's kept below.
+			size_t datagramsDropped = (packetSize + AEDAT3_MAX_UDP_SIZE - 1) / AEDAT3_MAX_UDP_SIZE;
+			atomic_fetch_add_explicit(&batch->datagramsDropped, datagramsDropped, memory_order_relaxed);
+			break;
+		}
+
+		size_t datagram = batch->datagrams++;
+		size_t sendSize = (packetSize > AEDAT3_MAX_UDP_SIZE) ? (AEDAT3_MAX_UDP_SIZE) : (packetSize);
+
+		nextNetworkHeader(state->networkIO, &batch->headers[datagram], firstChunk);
+		firstChunk = false;
+
+		batch->vectors[datagram][1].iov_base = packetBuffer->buf.base + packetIndex;
+		batch->vectors[datagram][1].iov_len  = sendSize;
+
+		if (udpFECAdd(state, &batch->headers[datagram], (const uint8_t *) packetBuffer->buf.base + packetIndex,
+				sendSize)) {
+			udpBatchAddParity(state);
+		}
+
+		packetSize -= sendSize;
+		packetIndex += sendSize;
+	}
+
+	if (packetIndex == 0) {
+		// Empty or dropped completely, nothing points into it.
+		libuvWriteBufFreeData(packetBuffer);
+		free(packetBuffer);
+		return;
+	}
+
+	batch->packetBuffers[batch->packetBuffersSize++] = packetBuffer;
+}
+
+/**
+ * Queue the parity datagram of the completed FEC group for sending.
+ *
+ * @param state common output state.
+ */
+static void udpBatchAddParity(outputCommonState state) {
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	libuvWriteBuf parityBuffer = malloc(sizeof(*parityBuffer));
+	if (parityBuffer == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for FEC parity buffer.");
+		batch->fec.groupDatagrams = 0;
+		return;
+	}
+
+	// The parity buffer and the current packet, added after it, both need room
+	// in packetBuffers. A full batch sent here leaves the current packet with no
+	// datagrams in the new batch, but it's still added to packetBuffers.
+	if ((batch->datagrams == UDP_BATCH_MAX_DATAGRAMS)
+		|| ((batch->packetBuffersSize + 2) > UDP_BATCH_MAX_DATAGRAMS)) {
+		// The current packet is not in packetBuffers yet, so it's kept.
+		udpBatchSend(state);
+	}
+
+	if (batch->writableWait) {
+		// Socket buffer full, the group goes without parity.
+		atomic_fetch_add_explicit(&batch->datagramsDropped, 1, memory_order_relaxed);
+		batch->fec.groupDatagrams = 0;
+		free(parityBuffer);
+		return;
+	}
+
+	size_t datagram = batch->datagrams;
+
+	if (!udpFECParity(state, &batch->headers[datagram], parityBuffer)) {
+		free(parityBuffer);
+		return;
+	}
+
+	batch->datagrams++;
+
+	batch->vectors[datagram][1].iov_base = parityBuffer->buf.base;
+	batch->vectors[datagram][1].iov_len  = parityBuffer->buf.len;
+
+	batch->packetBuffers[batch->packetBuffersSize++] = parityBuffer;
+}
+
+/**
+ * Send all queued UDP datagrams, with as few sendmmsg() calls as possible.
+ * If the socket buffer is full, the rest is sent from udpBatchWritable()
+ * once the socket is writable again, so the event loop never blocks.
+ *
+ * @param state common output state.
+ */
+static void udpBatchSend(outputCommonState state) {
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	if (batch->writableWait) {
+		// Resumed by udpBatchWritable().
+		return;
+	}
+
+	size_t datagramsSent = 0;
+
+	while ((batch->sendOffset + datagramsSent) < batch->datagrams) {
+		int result = sendmmsg(batch->socket, &batch->messages[batch->sendOffset + datagramsSent],
+			(unsigned int) (batch->datagrams - batch->sendOffset - datagramsSent), 0);
+
+		atomic_fetch_add_explicit(&batch->sendCalls, 1, memory_order_relaxed);
+
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+				// Socket buffer full, continue once it drained.
+				int retVal = uv_poll_start(&batch->writablePoll, UV_WRITABLE, &udpBatchWritable);
+				UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_poll_start", break);
+
+				atomic_fetch_add_explicit(&batch->datagramsSent, datagramsSent, memory_order_relaxed);
+
+				batch->sendOffset += datagramsSent;
+				batch->writableWait = true;
+				return;
+			}
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to send UDP datagrams. Error: %d.", errno);
+			break;
+		}
+
+		datagramsSent += (size_t) result;
+	}
+
+	atomic_fetch_add_explicit(&batch->datagramsSent, datagramsSent, memory_order_relaxed);
+
+	batch->sendOffset += datagramsSent;
+
+	udpBatchDrop(state);
+}
+
+static void udpBatchWritable(uv_poll_t *handle, int status, int events) {
+	UNUSED_ARGUMENT(events);
+
+	outputCommonState state               = handle->data;
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	int retVal = uv_poll_stop(handle);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_poll_stop", );
+
+	batch->writableWait = false;
+
+	if (status < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to wait for UDP socket. Error: %d (%s).", status,
+			uv_err_name(status));
+
+		udpBatchDrop(state);
+		return;
+	}
+
+	udpBatchSend(state);
+}
+
+/**
+ * Drop all queued UDP datagrams not sent yet, and free the packet buffers
+ * of the batch.
+ *
+ * @param state common output state.
+ */
+static void udpBatchDrop(outputCommonState state) {
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	atomic_fetch_add_explicit(&batch->datagramsDropped, batch->datagrams - batch->sendOffset, memory_order_relaxed);
+
+	for (size_t i = 0; i < batch->packetBuffersSize; i++) {
+		libuvWriteBufFreeData(batch->packetBuffers[i]);
+		free(batch->packetBuffers[i]);
+	}
+
+	batch->datagrams         = 0;
+	batch->packetBuffersSize = 0;
+	batch->sendOffset        = 0;
+	batch->writableWait      = false;
+}
+
+#endif
+
+/**
+ * Prepare the send queue of a newly connected client, and in server mode
+ * publish it in the connected clients list, with its statistics.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ */
+static void clientOpen(outputCommonNetIO streams, size_t index) {
+	if (streams->clientQueues == NULL) {
+		return;
+	}
+
+	struct output_common_client *client = &streams->clientQueues[index];
+
+	client->queueHead      = 0;
+	client->queueSize      = 0;
+	client->queueBytes     = 0;
+	client->keyPacketsOnly = false;
+	client->connectTime    = uv_hrtime();
+
+	atomic_store(&client->packetsSent, 0);
+	atomic_store(&client->bytesSent, 0);
+	atomic_store(&client->packetsDropped, 0);
+	clientUpdateStatistics(client);
+
+	// Remote address, only TCP peers have a meaningful one.
+	snprintf(client->address, CLIENT_ADDRESS_MAX_LENGTH, "local%zu", index);
+
+	if (streams->isTCP) {
+		struct sockaddr_storage peerAddress;
+		int peerAddressLength = sizeof(peerAddress);
+
+		if (uv_tcp_getpeername(
+				(uv_tcp_t *) streams->clients[index], (struct sockaddr *) &peerAddress, &peerAddressLength)
+			== 0) {
+			char peerIP[INET6_ADDRSTRLEN] = {0};
+			int peerPort                  = 0;
+
+			if (peerAddress.ss_family == AF_INET) {
+				struct sockaddr_in *peerAddress4 = (struct sockaddr_in *) &peerAddress;
+				uv_ip4_name(peerAddress4, peerIP, INET6_ADDRSTRLEN);
+				peerPort = ntohs(peerAddress4->sin_port);
+			}
+			else if (peerAddress.ss_family == AF_INET6) {
+				struct sockaddr_in6 *peerAddress6 = (struct sockaddr_in6 *) &peerAddress;
+				uv_ip6_name(peerAddress6, peerIP, INET6_ADDRSTRLEN);
+				peerPort = ntohs(peerAddress6->sin6_port);
+			}
+
+			snprintf(client->address, CLIENT_ADDRESS_MAX_LENGTH, "%s:%d", peerIP, peerPort);
+		}
+
+		// Writes are coalesced here in throughput mode, never delay them further in the network stack.
+		uv_tcp_nodelay((uv_tcp_t *) streams->clients[index], true);
+		clientSetCork(streams, index, streams->streamWrites.throughput);
+	}
+
+	if (streams->server == NULL) {
+		return;
+	}
+
+	char clientNodeName[48];
+	snprintf(clientNodeName, 48, "connectedClients/client%zu/", index);
+
+	client->statisticsNode = sshsGetRelativeNode(streams->moduleNode, clientNodeName);
+
+	sshsNodeCreateString(client->statisticsNode, "address", client->address, 0, CLIENT_ADDRESS_MAX_LENGTH,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Address of this client.");
+	sshsNodeCreateLong(client->statisticsNode, "packetsSent", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of packets sent to this client.");
+	sshsNodeCreateLong(client->statisticsNode, "bytesSent", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes sent to this client.");
+	sshsNodeCreateDouble(client->statisticsNode, "bytesPerSecond", 0, 0, DBL_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average throughput to this client in bytes per second.");
+	sshsNodeCreateLong(client->statisticsNode, "packetsDropped", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of packets dropped because this client was too slow.");
+	sshsNodeCreateLong(client->statisticsNode, "queuedBytes", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes waiting to be sent to this client.");
+	sshsNodeCreateLong(client->statisticsNode, "lag", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Time the oldest packet waiting to be sent to this client has been waiting, in ms.");
+
+	sshsAttributeUpdaterAdd(client->statisticsNode, "packetsSent", SSHS_LONG, &clientStatisticsUpdater, client);
+	sshsAttributeUpdaterAdd(client->statisticsNode, "bytesSent", SSHS_LONG, &clientStatisticsUpdater, client);
+	sshsAttributeUpdaterAdd(client->statisticsNode, "bytesPerSecond", SSHS_DOUBLE, &clientStatisticsUpdater, client);
+	sshsAttributeUpdaterAdd(client->statisticsNode, "packetsDropped", SSHS_LONG, &clientStatisticsUpdater, client);
+	sshsAttributeUpdaterAdd(client->statisticsNode, "queuedBytes", SSHS_LONG, &clientStatisticsUpdater, client);
+	sshsAttributeUpdaterAdd(client->statisticsNode, "lag", SSHS_LONG, &clientStatisticsUpdater, client);
+
+	clientsUpdateList(streams);
+}
+
+/**
+ * Close the connection to a client, and release everything still queued for it.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ */
+static void clientClose(outputCommonNetIO streams, size_t index) {
+	uv_stream_t *stream = streams->clients[index];
+
+	streams->clients[index] = NULL;
+	streams->activeClients--;
+
+	if (streams->clientQueues != NULL) {
+		struct output_common_client *client = &streams->clientQueues[index];
+
+		while (client->queueSize > 0) {
+			libuvWriteBufFree(client->queue[client->queueHead].buffers);
+
+			client->queueHead = (client->queueHead + 1) % CLIENT_QUEUE_MAX_PACKETS;
+			client->queueSize--;
+		}
+
+		client->queueBytes = 0;
+		clientUpdateStatistics(client);
+
+		if (client->statisticsNode != NULL) {
+			sshsAttributeUpdaterRemoveAllForNode(client->statisticsNode);
+			sshsNodeRemoveAllAttributes(client->statisticsNode);
+
+			clientsUpdateList(streams);
+		}
+	}
+
+	// Close connection and free its memory.
+	uv_close((uv_handle_t *) stream, &libuvCloseFree);
+}
+
+/**
+ * Queue a packet for a client. If the client's queue is full, its slow
+ * client policy decides what to drop, or disconnects it.
+ * In live mode, the newest data always goes out: full queues drop their
+ * oldest non-key packets, whatever the slow client policy. Disconnecting,
+ * or sending only key packets until caught up, would both drop new data.
+ * The client always takes over one reference to the packet buffers.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ * @param buffers packet buffers, shared by all clients.
+ * @param keyPacket packet is a key packet (special events, key frames).
+ * @param liveMode live mode is enabled.
+ */
+static void clientEnqueue(
+	outputCommonNetIO streams, size_t index, libuvWriteMultiBuf buffers, bool keyPacket, bool liveMode) {
+	struct output_common_client *client = &streams->clientQueues[index];
+
+	size_t packetSize = buffers->buffers[0].buf.len;
+
+	enum output_common_client_policy clientPolicy = (liveMode) ? (CLIENT_POLICY_DROP_OLDEST) : (streams->clientPolicy);
+
+	if (liveMode) {
+		client->keyPacketsOnly = false;
+	}
+
+	// Only back to all packets once the queue is half empty again.
+	if (client->keyPacketsOnly && (client->queueBytes <= (streams->clientQueueLimit / 2))) {
+		client->keyPacketsOnly = false;
+	}
+
+	bool queueFull = (client->queueSize == CLIENT_QUEUE_MAX_PACKETS)
+					 || ((client->queueBytes + packetSize) > streams->clientQueueLimit);
+
+	if (queueFull && (clientPolicy == CLIENT_POLICY_DISCONNECT)) {
+		caerLog(CAER_LOG_WARNING, __func__, "Client %s can't keep up, closing connection.", client->address);
+
+		libuvWriteBufFree(buffers);
+		clientClose(streams, index);
+		return;
+	}
+
+	if (queueFull && (clientPolicy == CLIENT_POLICY_KEY_PACKETS_ONLY) && !client->keyPacketsOnly) {
+		client->keyPacketsOnly = true;
+		clientQueueDropNonKey(client);
+	}
+
+	if (client->keyPacketsOnly && !keyPacket) {
+		libuvWriteBufFree(buffers);
+		atomic_fetch_add_explicit(&client->packetsDropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	// Make room by dropping the oldest packets. With CLIENT_POLICY_KEY_PACKETS_ONLY,
+	// this only happens if the key packets alone don't fit anymore. Live mode
+	// drops key packets too only once nothing else is left.
+	while ((client->queueSize > 0)
+		   && ((client->queueSize == CLIENT_QUEUE_MAX_PACKETS)
+				  || ((client->queueBytes + packetSize) > streams->clientQueueLimit))) {
+		if (!liveMode || !clientQueueDropOldestNonKey(client)) {
+			clientQueueDropOldest(client);
+		}
+	}
+
+	struct output_common_client_queue_entry *entry
+		= &client->queue[(client->queueHead + client->queueSize) % CLIENT_QUEUE_MAX_PACKETS];
+
+	entry->buffers   = buffers;
+	entry->keyPacket = keyPacket;
+	entry->queueTime = uv_hrtime();
+
+	client->queueSize++;
+	client->queueBytes += packetSize;
+
+	clientUpdateStatistics(client);
+}
+
+static void clientQueueDropOldest(struct output_common_client *client) {
+	struct output_common_client_queue_entry *entry = &client->queue[client->queueHead];
+
+	client->queueBytes -= entry->buffers->buffers[0].buf.len;
+	libuvWriteBufFree(entry->buffers);
+
+	client->queueHead = (client->queueHead + 1) % CLIENT_QUEUE_MAX_PACKETS;
+	client->queueSize--;
+
+	atomic_fetch_add_explicit(&client->packetsDropped, 1, memory_order_relaxed);
+}
+
+static bool clientQueueDropOldestNonKey(struct output_common_client *client) {
+	for (size_t i = 0; i < client->queueSize; i++) {
+		struct output_common_client_queue_entry *entry
+			= &client->queue[(client->queueHead + i) % CLIENT_QUEUE_MAX_PACKETS];
+
+		if (entry->keyPacket) {
+			continue;
+		}
+
+		client->queueBytes -= entry->buffers->buffers[0].buf.len;
+		libuvWriteBufFree(entry->buffers);
+
+		// Move the newer ones down into its place, keeping their order.
+		for (size_t j = i + 1; j < client->queueSize; j++) {
+			client->queue[(client->queueHead + j - 1) % CLIENT_QUEUE_MAX_PACKETS]
+				= client->queue[(client->queueHead + j) % CLIENT_QUEUE_MAX_PACKETS];
+		}
+
+		client->queueSize--;
+
+		atomic_fetch_add_explicit(&client->packetsDropped, 1, memory_order_relaxed);
+		return (true);
+	}
+
+	return (false);
+}
+
+static void clientQueueDropNonKey(struct output_common_client *client) {
+	size_t keptPackets = 0;
+
+	// Move kept packets to the front, keeping their order.
+	for (size_t i = 0; i < client->queueSize; i++) {
+		struct output_common_client_queue_entry *entry
+			= &client->queue[(client->queueHead + i) % CLIENT_QUEUE_MAX_PACKETS];
+
+		if (entry->keyPacket) {
+			client->queue[(client->queueHead + keptPackets) % CLIENT_QUEUE_MAX_PACKETS] = *entry;
+			keptPackets++;
+		}
+		else {
+			client->queueBytes -= entry->buffers->buffers[0].buf.len;
+			libuvWriteBufFree(entry->buffers);
+
+			atomic_fetch_add_explicit(&client->packetsDropped, 1, memory_order_relaxed);
+		}
+	}
+
+	client->queueSize = keptPackets;
+}
+
+/**
+ * Hand queued packets on to libuv for sending, as long as the client keeps
+ * up, so that data only accumulates in its queue.
+ * In low-latency mode, each packet is written on its own right away. In
+ * throughput mode, packets are held back until a full batch is queued, or
+ * the oldest one waited long enough, and then written together.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ * @param sendAll hand on all queued packets, regardless (for shutdown).
+ */
+static void clientSend(outputCommonNetIO streams, size_t index, bool sendAll) {
+	struct output_common_client *client        = &streams->clientQueues[index];
+	struct output_common_stream_writes *writes = &streams->streamWrites;
+	uv_stream_t *stream                        = streams->clients[index];
+
+	if (client->queueSize == 0) {
+		return;
+	}
+
+	while ((client->queueSize > 0) && (sendAll || (stream->write_queue_size < CLIENT_WRITE_QUEUE_SIZE))) {
+		size_t packetsNumber = 1;
+
+		if (writes->throughput) {
+			uint64_t queueWait = uv_hrtime() - client->queue[client->queueHead].queueTime;
+
+			if (!sendAll && (client->queueBytes < writes->batchSize) && (queueWait < writes->batchDelay)) {
+				// Write at the latest once the oldest packet waited long enough.
+				streamWritesScheduleFlush(streams, writes->batchDelay - queueWait);
+				break;
+			}
+
+			// Coalesce as many queued packets as fit into one batch.
+			size_t batchBytes = client->queue[client->queueHead].buffers->buffers[0].buf.len;
+
+			while ((packetsNumber < client->queueSize) && (packetsNumber < STREAM_WRITE_MAX_PACKETS)) {
+				size_t queueIndex = (client->queueHead + packetsNumber) % CLIENT_QUEUE_MAX_PACKETS;
+				size_t packetSize = client->queue[queueIndex].buffers->buffers[0].buf.len;
+
+				if ((batchBytes + packetSize) > writes->batchSize) {
+					break;
+				}
+
+				batchBytes += packetSize;
+				packetsNumber++;
+			}
+		}
+
+		if (!clientWrite(streams, index, packetsNumber)) {
+			// Client was closed.
+			return;
+		}
+	}
+
+	clientUpdateStatistics(client);
+}
+
+/**
+ * Write the oldest queued packets of a client with a single write request.
+ * On failure, the client is closed.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ * @param packetsNumber number of queued packets to write.
+ *
+ * @return true on success, false if the client was closed.
+ */
+static bool clientWrite(outputCommonNetIO streams, size_t index, size_t packetsNumber) {
+	struct output_common_client *client = &streams->clientQueues[index];
+
+	struct output_common_client_write *clientWrite
+		= malloc(sizeof(struct output_common_client_write) + (packetsNumber * sizeof(libuvWriteMultiBuf)));
+	if (clientWrite == NULL) {
+		caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for write request.");
+		clientClose(streams, index);
+		return (false);
+	}
+
+	uv_buf_t buffers[packetsNumber];
+	size_t writeSize = 0;
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		libuvWriteMultiBuf packet = client->queue[(client->queueHead + i) % CLIENT_QUEUE_MAX_PACKETS].buffers;
+
+		clientWrite->packets[i] = packet;
+		buffers[i]              = packet->buffers[0].buf;
+		writeSize += packet->buffers[0].buf.len;
+	}
+
+	clientWrite->packetsSize = packetsNumber;
+
+	int retVal = uv_write(
+		&clientWrite->request, streams->clients[index], buffers, (unsigned int) packetsNumber, &clientWriteDone);
+	UV_RET_CHECK(retVal, __func__, "uv_write", free(clientWrite); clientClose(streams, index); return (false));
+
+	// Packet references now belong to the write request.
+	client->queueHead = (client->queueHead + packetsNumber) % CLIENT_QUEUE_MAX_PACKETS;
+	client->queueSize -= packetsNumber;
+	client->queueBytes -= writeSize;
+
+	atomic_fetch_add_explicit(&client->packetsSent, packetsNumber, memory_order_relaxed);
+	atomic_fetch_add_explicit(&client->bytesSent, writeSize, memory_order_relaxed);
+
+	atomic_fetch_add_explicit(&streams->streamWrites.writes, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&streams->streamWrites.bytesWritten, writeSize, memory_order_relaxed);
+
+	return (true);
+}
+
+static void clientWriteDone(uv_write_t *writeRequest, int status) {
+	struct output_common_client_write *clientWrite = (struct output_common_client_write *) writeRequest;
+	uv_stream_t *stream                            = writeRequest->handle;
+
+	libuvWriteStatusCheck((uv_handle_t *) stream, status);
+
+	for (size_t i = 0; i < clientWrite->packetsSize; i++) {
+		libuvWriteBufFree(clientWrite->packets[i]);
+	}
+
+	free(clientWrite);
+
+	// The client can take more data now, pass on what queued up meanwhile.
+	outputCommonNetIO streams = stream->data;
+
+	for (size_t i = 0; i < streams->clientsSize; i++) {
+		if (streams->clients[i] == stream) {
+			clientSend(streams, i, false);
+			break;
+		}
+	}
+}
+
+/**
+ * Set or clear TCP_CORK on a TCP client, if enabled, so that while set
+ * only full segments are sent. Clearing it sends out any partial segment.
+ *
+ * @param streams network output streams.
+ * @param index client slot in streams->clients.
+ * @param cork set (true) or clear (false) TCP_CORK.
+ */
+static void clientSetCork(outputCommonNetIO streams, size_t index, bool cork) {
+#if defined(TCP_CORK)
+	if (!streams->isTCP || !streams->streamWrites.tcpCork) {
+		return;
+	}
+
+	uv_os_fd_t clientSocket;
+	if (uv_fileno((uv_handle_t *) streams->clients[index], &clientSocket) < 0) {
+		return;
+	}
+
+	int corkValue = cork;
+	if (setsockopt(clientSocket, IPPROTO_TCP, TCP_CORK, &corkValue, sizeof(corkValue)) < 0) {
+		caerLog(
+			CAER_LOG_WARNING, __func__, "Failed to set TCP_CORK on client %s.", streams->clientQueues[index].address);
+	}
+#else
+	UNUSED_ARGUMENT(streams);
+	UNUSED_ARGUMENT(index);
+	UNUSED_ARGUMENT(cork);
+#endif
+}
+
+/**
+ * Make sure pending batches get written within the given delay, even if
+ * no more data comes in. The timer is shared by all clients, and at worst
+ * just fires earlier than needed for some, which then wait again.
+ *
+ * @param streams network output streams (TCP/Pipe).
+ * @param delay maximum delay in ns.
+ */
+static void streamWritesScheduleFlush(outputCommonNetIO streams, uint64_t delay) {
+	if (uv_is_active((uv_handle_t *) &streams->writeBatchTimer)) {
+		return;
+	}
+
+	// libuv timers have ms resolution, round up.
+	uint64_t delayMs = (delay + 999999) / 1000000;
+
+	int retVal = uv_timer_start(&streams->writeBatchTimer, &libuvWriteBatchTimeout, delayMs, 0);
+	UV_RET_CHECK(retVal, __func__, "uv_timer_start", );
+}
+
+/**
+ * Auto latency mode: use throughput mode at high packet rates, where the
+ * per-write overhead adds up, and low-latency mode otherwise. The packet
+ * rate is checked every 'autoRateInterval', with hysteresis between the
+ * two thresholds, so a rate close to one of them doesn't flip the mode on
+ * every check.
+ *
+ * @param streams network output streams (TCP/Pipe).
+ */
+static void streamWritesUpdateMode(outputCommonNetIO streams) {
+	struct output_common_stream_writes *writes = &streams->streamWrites;
+
+	if (writes->mode != LATENCY_MODE_AUTO) {
+		return;
+	}
+
+	uint64_t currentTime = uv_hrtime();
+	uint64_t elapsedTime = currentTime - writes->rateCheckTime;
+
+	if (elapsedTime < writes->rateInterval) {
+		return;
+	}
+
+	uint64_t packetRate = (writes->ratePackets * 1000000000LLU) / elapsedTime;
+
+	writes->ratePackets   = 0;
+	writes->rateCheckTime = currentTime;
+
+	if (!writes->throughput && (packetRate > writes->throughputRate)) {
+		streamWritesSetThroughput(streams, true);
+	}
+	else if (writes->throughput && (packetRate < writes->lowLatencyRate)) {
+		streamWritesSetThroughput(streams, false);
+	}
+	else {
+		return;
+	}
+
+	caerLog(CAER_LOG_DEBUG, __func__, "Packet rate %" PRIu64 "/s, switched to %s mode.", packetRate,
+		(writes->throughput) ? ("throughput") : ("low-latency"));
+}
+
+static void streamWritesSetThroughput(outputCommonNetIO streams, bool throughput) {
+	streams->streamWrites.throughput = throughput;
+	atomic_store(&streams->streamWrites.throughputActive, throughput);
+
+	for (size_t i = 0; i < streams->clientsSize; i++) {
+		if (streams->clients[i] != NULL) {
+			clientSetCork(streams, i, throughput);
+		}
+	}
+}
+
+static void clientUpdateStatistics(struct output_common_client *client) {
+	atomic_store_explicit(&client->queuedBytes, client->queueBytes, memory_order_relaxed);
+	atomic_store_explicit(&client->oldestQueueTime,
+		(client->queueSize == 0) ? (0) : (client->queue[client->queueHead].queueTime), memory_order_relaxed);
+}
+
+/**
+ * Update the 'connectedClients' list with the addresses of all clients.
+ *
+ * @param streams network output streams (server mode).
+ */
+static void clientsUpdateList(outputCommonNetIO streams) {
+	char clientsList[(streams->clientsSize * (CLIENT_ADDRESS_MAX_LENGTH + 2)) + 1];
+	size_t clientsListLength = 0;
+
+	clientsList[0] = '\0';
+
+	for (size_t i = 0; i < streams->clientsSize; i++) {
+		if (streams->clients[i] == NULL) {
+			continue;
+		}
+
+		clientsListLength += (size_t) snprintf(clientsList + clientsListLength,
+			sizeof(clientsList) - clientsListLength, (clientsListLength == 0) ? ("%s") : (", %s"),
+			streams->clientQueues[i].address);
+	}
+
+	sshsNodeUpdateReadOnlyAttribute(
+		streams->moduleNode, "connectedClients", SSHS_STRING, (union sshs_node_attr_value){.string = clientsList});
+}
+
+static void writeFileHeader(outputCommonState state) {
+	// Write AEDAT 3.1 header.
+	fileWriterWrite(
+		state, (const uint8_t *) "#!AER-DAT" AEDAT3_FILE_VERSION "\r\n", 11 + strlen(AEDAT3_FILE_VERSION));
+
+	// Write format header for all supported formats.
+	fileWriterWrite(state, (const uint8_t *) "#Format: ", 9);
+
+	if (state->formatID == 0x00) {
+		fileWriterWrite(state, (const uint8_t *) "RAW", 3);
+	}
+	else {
+		// Support the various formats and their mixing, as a comma-separated list.
+		static const char *formatNames[]
+			= {"SerializedTS", "PNGFrames", "PolarityDelta", "LZ4Packets", "ZstdPackets", "FastFrames"};
+		bool firstFormat                 = true;
+
+		for (size_t i = 0; i < (sizeof(formatNames) / sizeof(formatNames[0])); i++) {
+			if (state->formatID & (0x01 << i)) {
+				if (!firstFormat) {
+					fileWriterWrite(state, (const uint8_t *) ",", 1);
+				}
+
+				fileWriterWrite(state, (const uint8_t *) formatNames[i], strlen(formatNames[i]));
+				firstFormat = false;
+			}
+		}
+	}
+
+	fileWriterWrite(state, (const uint8_t *) "\r\n", 2);
+
+	fileWriterWrite(state, (const uint8_t *) state->sourceInfoString, strlen(state->sourceInfoString));
+
+	// First prepend the time.
+	time_t currentTimeEpoch = time(NULL);
+
+#if defined(OS_WINDOWS)
+	// localtime() is thread-safe on Windows (and there is no localtime_r() at all).
+	struct tm *currentTime = localtime(&currentTimeEpoch);
+
+	// Windows doesn't support %z (numerical timezone), so no TZ info here.
+	// Following time format uses exactly 34 characters (20 separators/characters,
+	// 4 year, 2 month, 2 day, 2 hours, 2 minutes, 2 seconds).
+	size_t currentTimeStringLength = 34;
+	char currentTimeString[currentTimeStringLength + 1]; // + 1 for terminating NUL byte.
+	strftime(currentTimeString, currentTimeStringLength + 1, "#Start-Time: %Y-%m-%d %H:%M:%S\r\n", currentTime);
+#else
+	// From localtime_r() man-page: "According to POSIX.1-2004, localtime()
+	// is required to behave as though tzset(3) was called, while
+	// localtime_r() does not have this requirement."
+	// So we make sure to call it here, to be portable.
+	tzset();
+
+	struct tm currentTime;
+	localtime_r(&currentTimeEpoch, &currentTime);
+
+	// Following time format uses exactly 44 characters (25 separators/characters,
+	// 4 year, 2 month, 2 day, 2 hours, 2 minutes, 2 seconds, 5 time-zone).
 	size_t currentTimeStringLength = 44;
 	char currentTimeString[currentTimeStringLength + 1]; // + 1 for terminating NUL byte.
 	strftime(currentTimeString, currentTimeStringLength + 1, "#Start-Time: %Y-%m-%d %H:%M:%S (TZ%z)\r\n", &currentTime);
 #endif
 
-	writeUntilDone(state->fileIO, (const uint8_t *) currentTimeString, currentTimeStringLength);
+	fileWriterWrite(state, (const uint8_t *) currentTimeString, currentTimeStringLength);
+
+	if (state->segments.openFile != NULL) {
+		char segmentString[64];
+		int segmentStringLength = snprintf(segmentString, 64, "#Segment: %zu\r\n", state->segments.number);
+
+		fileWriterWrite(state, (const uint8_t *) segmentString, (size_t) segmentStringLength);
+
+		// Index offset is not known yet, it is filled in when the segment is finished.
+		state->segments.indexHeaderPosition = state->fileWriter.fileOffset + state->fileWriter.bufferUsed;
+
+		char indexString[INOUT_INDEX_HEADER_LINE_LENGTH + 1];
+		snprintf(indexString, INOUT_INDEX_HEADER_LINE_LENGTH + 1, INOUT_INDEX_HEADER_LINE, U64T(0));
+
+		fileWriterWrite(state, (const uint8_t *) indexString, INOUT_INDEX_HEADER_LINE_LENGTH);
+	}
+
+	fileWriterWrite(state, (const uint8_t *) "#!END-HEADER\r\n", 14);
+}
+
+/**
+ * Append data to the file write buffer, writing it out to the file
+ * whenever it is full.
+ *
+ * @param state common output state.
+ * @param data data to write.
+ * @param dataSize size of data in bytes.
+ *
+ * @return true on success, false on write failure.
+ */
+static bool fileWriterWrite(outputCommonState state, const uint8_t *data, size_t dataSize) {
+	struct output_common_file_writer *writer = &state->fileWriter;
+
+	while (dataSize > 0) {
+		size_t copySize = writer->bufferSize - writer->bufferUsed;
+		if (copySize > dataSize) {
+			copySize = dataSize;
+		}
+
+		memcpy(writer->buffer + writer->bufferUsed, data, copySize);
+		writer->bufferUsed += copySize;
+
+		data += copySize;
+		dataSize -= copySize;
+
+		if ((writer->bufferUsed == writer->bufferSize) && !fileWriterFlush(state, false)) {
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
+/**
+ * Write the content of the file write buffer out to the file.
+ * With O_DIRECT, only whole aligned blocks can be written: the rest
+ * stays in the buffer, until the final flush, which switches back to
+ * normal writes to write out everything.
+ *
+ * @param state common output state.
+ * @param final last write to this file.
+ *
+ * @return true on success, false on write failure.
+ */
+static bool fileWriterFlush(outputCommonState state, bool final) {
+	struct output_common_file_writer *writer = &state->fileWriter;
+
+	size_t writeSize = writer->bufferUsed;
+
+#if !defined(O_DIRECT) && !defined(FALLOC_FL_KEEP_SIZE)
+	UNUSED_ARGUMENT(final);
+#endif
+
+#if defined(O_DIRECT)
+	if (writer->directIO) {
+		if (!final) {
+			writeSize -= (writeSize % FILE_WRITER_ALIGNMENT);
+		}
+		else if (((writeSize % FILE_WRITER_ALIGNMENT) != 0) && !fileWriterDisableDirectIO(state)) {
+			return (false);
+		}
+	}
+#endif
+
+	if (writeSize > 0) {
+		fileWriterPreallocate(state, writeSize);
+
+		struct timespec writeStartTime, writeEndTime;
+		portable_clock_gettime_monotonic(&writeStartTime);
+
+		if (!writeUntilDone(state->fileIO, writer->buffer, writeSize)) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to write to output file. Error: %d.", errno);
+			return (false);
+		}
+
+		portable_clock_gettime_monotonic(&writeEndTime);
+
+		uint64_t writeTime = (uint64_t)(((writeEndTime.tv_sec - writeStartTime.tv_sec) * 1000000000LL)
+										+ (writeEndTime.tv_nsec - writeStartTime.tv_nsec));
+
+		atomic_fetch_add_explicit(&writer->writes, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&writer->bytesWritten, writeSize, memory_order_relaxed);
+		atomic_fetch_add_explicit(&writer->writeTime, writeTime, memory_order_relaxed);
+
+		// Only the output thread writes, so no compare-exchange needed.
+		if (writeTime > atomic_load_explicit(&writer->writeTimeMax, memory_order_relaxed)) {
+			atomic_store_explicit(&writer->writeTimeMax, writeTime, memory_order_relaxed);
+		}
+
+		writer->fileOffset += writeSize;
+		writer->lastWriteTime = writeEndTime;
+
+		// Keep what wasn't written at the start of the buffer.
+		writer->bufferUsed -= writeSize;
+		memmove(writer->buffer, writer->buffer + writeSize, writer->bufferUsed);
+	}
+
+#if defined(FALLOC_FL_KEEP_SIZE)
+	// Give back preallocated space that wasn't used.
+	if (final && (writer->preallocatedEnd > writer->fileOffset)) {
+		if (ftruncate(state->fileIO, (off_t) writer->fileOffset) != 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Failed to release unused preallocated file space. Error: %d.", errno);
+		}
+	}
+#endif
+
+	return (true);
+}
+
+/**
+ * Make sure the next write goes into preallocated file space, reserving
+ * it in big extents. This keeps the file contiguous on disk and saves the
+ * filesystem from allocating blocks on every write.
+ * The file size doesn't change until data is actually written.
+ *
+ * @param state common output state.
+ * @param writeSize size of the next write in bytes.
+ */
+static void fileWriterPreallocate(outputCommonState state, size_t writeSize) {
+#if defined(FALLOC_FL_KEEP_SIZE)
+	struct output_common_file_writer *writer = &state->fileWriter;
+
+	if ((writer->preallocateSize == 0) || ((writer->fileOffset + writeSize) <= writer->preallocatedEnd)) {
+		return;
+	}
+
+	uint64_t preallocateStart = writer->preallocatedEnd;
+	if (preallocateStart < writer->fileOffset) {
+		preallocateStart = writer->fileOffset;
+	}
+
+	uint64_t preallocateLength = writer->preallocateSize;
+	if ((preallocateStart + preallocateLength) < (writer->fileOffset + writeSize)) {
+		preallocateLength = (writer->fileOffset + writeSize) - preallocateStart;
+	}
+
+	if (fallocate(state->fileIO, FALLOC_FL_KEEP_SIZE, (off_t) preallocateStart, (off_t) preallocateLength) != 0) {
+		// Not supported by all filesystems, and not required, so just stop trying.
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to preallocate file space, disabling preallocation. Error: %d.", errno);
+
+		writer->preallocateSize = 0;
+		return;
+	}
+
+	writer->preallocatedEnd = preallocateStart + preallocateLength;
+#else
+	UNUSED_ARGUMENT(state);
+	UNUSED_ARGUMENT(writeSize);
+#endif
+}
+
+/**
+ * Switch the file back to normal IO, for writes that are not aligned.
+ *
+ * @param state common output state.
+ *
+ * @return true on success, false on failure.
+ */
+static bool fileWriterDisableDirectIO(outputCommonState state) {
+#if defined(O_DIRECT)
+	if (!state->fileWriter.directIO) {
+		return (true);
+	}
+
+	int fileFlags = fcntl(state->fileIO, F_GETFL);
+
+	if ((fileFlags == -1) || (fcntl(state->fileIO, F_SETFL, fileFlags & ~O_DIRECT) == -1)) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to disable direct IO. Error: %d.", errno);
+		return (false);
+	}
+
+	state->fileWriter.directIO = false;
+#else
+	UNUSED_ARGUMENT(state);
+#endif
+
+	return (true);
+}
+
+/**
+ * Write an event packet to the file. With segments, a new segment is
+ * started first if the current one is full, and the packet is added to
+ * the segment index.
+ *
+ * @param state common output state.
+ * @param packetBuffer the event packet to write.
+ *
+ * @return true on success, false on write failure.
+ */
+static bool fileWritePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
+	if (state->segments.openFile != NULL) {
+		if (fileSegmentIsFull(state, packetBuffer->buf.len) && !fileSegmentSwitch(state)) {
+			return (false);
+		}
+
+		fileSegmentIndexAdd(state, ((struct output_common_packet_buffer *) packetBuffer)->timestamp);
+	}
+
+	return (fileWriterWrite(state, (const uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len));
+}
+
+static bool fileSegmentIsFull(outputCommonState state, size_t packetSize) {
+	struct output_common_file_segments *segments = &state->segments;
+
+	// Every segment gets at least one packet, even if bigger than the size limit.
+	if (segments->indexSize == 0) {
+		return (false);
+	}
+
+	if ((segments->maxSize != 0)
+		&& ((state->fileWriter.fileOffset + state->fileWriter.bufferUsed + packetSize) > segments->maxSize)) {
+		return (true);
+	}
+
+	if (segments->maxDuration != 0) {
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		if ((currentTime.tv_sec - segments->startTime.tv_sec) >= segments->maxDuration) {
+			return (true);
+		}
+	}
+
+	return (false);
+}
+
+/**
+ * Finish the current segment and continue with the next one, opened in
+ * advance by the segment thread. If that's not ready yet, the current
+ * segment just continues, and switching is tried again on the next packet,
+ * so that the output never stalls.
+ *
+ * @param state common output state.
+ *
+ * @return true on success (also when not switching yet), false on write failure.
+ */
+static bool fileSegmentSwitch(outputCommonState state) {
+	struct output_common_file_segments *segments = &state->segments;
+
+	mtx_lock(&segments->lock);
+	bool canSwitch = (segments->nextReady && !segments->finishedPending);
+	mtx_unlock(&segments->lock);
+
+	if (!canSwitch) {
+		return (true);
+	}
+
+	if (!fileSegmentFinish(state)) {
+		return (false);
+	}
+
+	mtx_lock(&segments->lock);
+
+	// Sync, close and rename are slow, leave them to the segment thread.
+	segments->finishedFileDescriptor = state->fileIO;
+	segments->finishedFilePath       = segments->filePath;
+	segments->finishedPending        = true;
+
+	state->fileIO                = segments->nextFileDescriptor;
+	segments->filePath           = segments->nextFilePath;
+	segments->nextFileDescriptor = -1;
+	segments->nextFilePath       = NULL;
+	segments->nextReady          = false;
+
+	// Wake up the segment thread to complete this segment and open the next one.
+	cnd_broadcast(&segments->changed);
+	mtx_unlock(&segments->lock);
+
+	segments->number++;
+
+	// Start the new segment like a new file.
+	struct output_common_file_writer *writer = &state->fileWriter;
+
+	writer->fileOffset      = 0;
+	writer->preallocatedEnd = 0;
+
+#if defined(O_DIRECT)
+	int fileFlags    = fcntl(state->fileIO, F_GETFL);
+	writer->directIO = ((fileFlags != -1) && ((fileFlags & O_DIRECT) != 0));
+#endif
+
+	segments->indexSize   = 0;
+	segments->indexFailed = false;
+	portable_clock_gettime_monotonic(&segments->startTime);
+
+	writeFileHeader(state);
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Continuing with segment file '%s'.", segments->filePath);
+
+	return (true);
+}
+
+static void fileSegmentIndexAdd(outputCommonState state, int64_t timestamp) {
+	struct output_common_file_segments *segments = &state->segments;
+
+	if (!segments->indexFailed && (segments->indexSize == segments->indexCapacity)) {
+		size_t newCapacity = (segments->indexCapacity == 0) ? (1024) : (segments->indexCapacity * 2);
+
+		struct inout_index_entry *newIndex = realloc(segments->index, newCapacity * sizeof(struct inout_index_entry));
+		if (newIndex == NULL) {
+			// The recording itself is fine, this segment just has no index.
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Failed to allocate memory for segment index, segment '%s' will have no index.",
+				segments->filePath);
+
+			segments->indexFailed = true;
+		}
+		else {
+			segments->index         = newIndex;
+			segments->indexCapacity = newCapacity;
+		}
+	}
+
+	if (!segments->indexFailed) {
+		segments->index[segments->indexSize].timestamp = I64T(htole64(U64T(timestamp)));
+		segments->index[segments->indexSize].offset
+			= htole64(state->fileWriter.fileOffset + state->fileWriter.bufferUsed);
+	}
+
+	segments->indexSize++;
+}
+
+/**
+ * Write the index at the end of the current segment, write out all data
+ * and fill in the index offset in the segment header.
+ *
+ * @param state common output state.
+ *
+ * @return true on success, false on write failure.
+ */
+static bool fileSegmentFinish(outputCommonState state) {
+	struct output_common_file_segments *segments = &state->segments;
+	struct output_common_file_writer *writer     = &state->fileWriter;
+
+	uint64_t indexOffset = 0;
+
+	if (!segments->indexFailed && (segments->indexSize > 0)) {
+		indexOffset = writer->fileOffset + writer->bufferUsed;
+
+		// Index is laid out as an event packet, see inout_common.h.
+		struct caer_event_packet_header indexHeader;
+		memset(&indexHeader, 0, sizeof(indexHeader));
+
+		caerEventPacketHeaderSetEventType(&indexHeader, INOUT_INDEX_PACKET_TYPE);
+		caerEventPacketHeaderSetEventSource(&indexHeader, INOUT_INDEX_PACKET_SOURCE);
+		caerEventPacketHeaderSetEventSize(&indexHeader, I32T(sizeof(struct inout_index_entry)));
+		caerEventPacketHeaderSetEventTSOffset(&indexHeader, 0);
+		caerEventPacketHeaderSetEventCapacity(&indexHeader, I32T(segments->indexSize));
+		caerEventPacketHeaderSetEventNumber(&indexHeader, I32T(segments->indexSize));
+		caerEventPacketHeaderSetEventValid(&indexHeader, I32T(segments->indexSize));
+
+		if (!fileWriterWrite(state, (const uint8_t *) &indexHeader, CAER_EVENT_PACKET_HEADER_SIZE)
+			|| !fileWriterWrite(state, (const uint8_t *) segments->index,
+				   segments->indexSize * sizeof(struct inout_index_entry))) {
+			return (false);
+		}
+	}
+
+	if (!fileWriterFlush(state, true)) {
+		return (false);
+	}
+
+	if (indexOffset != 0) {
+		if (!fileWriterDisableDirectIO(state)) {
+			return (false);
+		}
+
+		char indexString[INOUT_INDEX_HEADER_LINE_LENGTH + 1];
+		snprintf(indexString, INOUT_INDEX_HEADER_LINE_LENGTH + 1, INOUT_INDEX_HEADER_LINE, indexOffset);
+
+		if (pwrite(state->fileIO, indexString, INOUT_INDEX_HEADER_LINE_LENGTH, (off_t) segments->indexHeaderPosition)
+			!= INOUT_INDEX_HEADER_LINE_LENGTH) {
+			// Segment data is complete, readers just can't find the index.
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Failed to write index offset to segment '%s'. Error: %d.", segments->filePath, errno);
+		}
+	}
+
+	return (true);
+}
+
+void caerOutputCommonOnServerConnection(uv_stream_t *server, int status) {
+	outputCommonNetIO streams = server->data;
+
+	UV_RET_CHECK(status, __func__, "Connection", return );
+
+	uv_stream_t *client = NULL;
+
+	if (streams->isTCP) {
+		client = malloc(sizeof(uv_tcp_t));
+	}
+	else {
+		client = malloc(sizeof(uv_pipe_t));
+	}
+
+	if (client == NULL) {
+		caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for new client.");
+		return;
+	}
+
+	int retVal;
+
+	if (streams->isTCP) {
+		retVal = uv_tcp_init(server->loop, (uv_tcp_t *) client);
+		UV_RET_CHECK(retVal, __func__, "uv_tcp_init", free(client); return );
+	}
+	else {
+		retVal = uv_pipe_init(server->loop, (uv_pipe_t *) client, false);
+		UV_RET_CHECK(retVal, __func__, "uv_pipe_init", free(client); return );
+	}
+
+	// All clients need to remember the main streams structure.
+	client->data = streams;
+
+	retVal = uv_accept(server, client);
+	UV_RET_CHECK(retVal, __func__, "uv_accept", goto killConnection);
+
+	// Find place for new connection. If all exhausted, we've reached maximum
+	// number of clients and just kill the connection.
+	for (size_t i = 0; i < streams->clientsSize; i++) {
+		if (streams->clients[i] == NULL) {
+			// TCP/PIPE: send out initial header. Only those two can call this function!
+			libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
+			if (buffers == NULL) {
+				caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for network header buffers.");
+
+				goto killConnection;
+			}
+
+			buffers->statusCheck = &libuvWriteStatusCheck;
+
+			if (!writeNetworkHeader(streams, &buffers->buffers[0], false)) {
+				caerLog(CAER_LOG_ERROR, __func__, "Failed to write network header.");
+
+				libuvWriteBufFree(buffers);
+				goto killConnection;
+			}
+
+			retVal = libuvWrite(client, buffers);
+			UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto killConnection);
+
+			// Ready now for more data, so set client field for writePacket().
+			streams->clients[i] = client;
+			streams->activeClients++;
+
+			clientOpen(streams, i);
+
+			return;
+		}
+	}
+
+// Kill connection if maximum number reached.
+killConnection : { uv_close((uv_handle_t *) client, &libuvCloseFree); }
+}
+
+void caerOutputCommonOnClientConnection(uv_connect_t *connectionRequest, int status) {
+	outputCommonNetIO streams = connectionRequest->handle->data;
+
+	UV_RET_CHECK(status, __func__, "Connection", goto cleanupRequest);
+
+	// TCP/PIPE: send out initial header. Only those two can call this function!
+	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
+	if (buffers == NULL) {
+		caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for network header buffers.");
+
+		goto cleanupRequest;
+	}
+
+	buffers->statusCheck = &libuvWriteStatusCheck;
+
+	if (!writeNetworkHeader(streams, &buffers->buffers[0], false)) {
+		caerLog(CAER_LOG_ERROR, __func__, "Failed to write network header.");
+
+		libuvWriteBufFree(buffers);
+		goto cleanupRequest;
+	}
+
+	int retVal = libuvWrite(connectionRequest->handle, buffers);
+	UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto cleanupRequest);
+
+	// Ready now for more data, so set client field for writePacket().
+	streams->clients[0] = connectionRequest->handle;
+	streams->activeClients++;
+
+	clientOpen(streams, 0);
+
+cleanupRequest : { free(connectionRequest); }
+}
+
+static union sshs_node_attr_value compressionWorkerStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type) {
+	UNUSED_ARGUMENT(type);
+
+	struct output_common_compression_worker *worker = userData;
+
+	union sshs_node_attr_value statisticValue = {.ilong = 0};
+
+	if (caerStrEquals(key, "packets")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&worker->packets, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesIn")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&worker->bytesIn, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesOut")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&worker->bytesOut, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "utilization")) {
+		statisticValue.ddouble = compressionWorkerUtilization(worker);
+	}
+
+	return (statisticValue);
+}
+
+/**
+ * Percentage of time a compression worker spent compressing, since
+ * the module was started.
+ *
+ * @param worker compression worker.
+ *
+ * @return utilization in percent (0-100).
+ */
+static double compressionWorkerUtilization(struct output_common_compression_worker *worker) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	struct timespec *startTime = &worker->state->compression.startTime;
+
+	double elapsedTime = ((double) (currentTime.tv_sec - startTime->tv_sec) * 1000000000.0)
+						 + (double) (currentTime.tv_nsec - startTime->tv_nsec);
+	if (elapsedTime <= 0) {
+		return (0);
+	}
+
+	double utilization
+		= ((double) atomic_load_explicit(&worker->busyTime, memory_order_relaxed) * 100.0) / elapsedTime;
+
+	return ((utilization > 100.0) ? (100.0) : (utilization));
+}
+
+static union sshs_node_attr_value fileWriterStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type) {
+	UNUSED_ARGUMENT(type);
+
+	struct output_common_file_writer *writer = userData;
+
+	union sshs_node_attr_value statisticValue = {.ilong = 0};
+
+	uint64_t writes = atomic_load_explicit(&writer->writes, memory_order_relaxed);
+
+	if (caerStrEquals(key, "writes")) {
+		statisticValue.ilong = I64T(writes);
+	}
+	else if (caerStrEquals(key, "bytesWritten")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&writer->bytesWritten, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesPerSecond")) {
+		statisticValue.ddouble = fileWriterBytesPerSecond(writer);
+	}
+	else if (caerStrEquals(key, "writeLatencyAverage") && (writes > 0)) {
+		statisticValue.ddouble
+			= (double) atomic_load_explicit(&writer->writeTime, memory_order_relaxed) / (double) writes / 1000.0;
+	}
+	else if (caerStrEquals(key, "writeLatencyMax")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&writer->writeTimeMax, memory_order_relaxed) / 1000);
+	}
+
+	return (statisticValue);
+}
+
+/**
+ * Average file write throughput, since the module was started.
+ *
+ * @param writer file writer.
+ *
+ * @return throughput in bytes per second.
+ */
+static double fileWriterBytesPerSecond(struct output_common_file_writer *writer) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	double elapsedTime = (double) (currentTime.tv_sec - writer->startTime.tv_sec)
+						 + ((double) (currentTime.tv_nsec - writer->startTime.tv_nsec) / 1000000000.0);
+	if (elapsedTime <= 0) {
+		return (0);
+	}
+
+	return ((double) atomic_load_explicit(&writer->bytesWritten, memory_order_relaxed) / elapsedTime);
+}
+
+static union sshs_node_attr_value udpStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type) {
+	UNUSED_ARGUMENT(type);
+
+	struct output_common_udp_batch *batch = userData;
+
+	union sshs_node_attr_value statisticValue = {.ilong = 0};
+
+	if (caerStrEquals(key, "datagramsSent")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&batch->datagramsSent, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "datagramsDropped")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&batch->datagramsDropped, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "sendCalls")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&batch->sendCalls, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "fecDatagrams")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&batch->fecDatagrams, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "datagramsPerSecond")) {
+		statisticValue.ddouble = udpDatagramsPerSecond(batch);
+	}
+
+	return (statisticValue);
+}
+
+/**
+ * Average UDP datagram rate, since the module was started.
+ *
+ * @param batch UDP batch state.
+ *
+ * @return datagrams sent per second.
+ */
+static double udpDatagramsPerSecond(struct output_common_udp_batch *batch) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	double elapsedTime = (double) (currentTime.tv_sec - batch->startTime.tv_sec)
+						 + ((double) (currentTime.tv_nsec - batch->startTime.tv_nsec) / 1000000000.0);
+	if (elapsedTime <= 0) {
+		return (0);
+	}
+
+	return ((double) atomic_load_explicit(&batch->datagramsSent, memory_order_relaxed) / elapsedTime);
+}
+
+static union sshs_node_attr_value streamWritesStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type) {
+	UNUSED_ARGUMENT(type);
+
+	struct output_common_stream_writes *writes = userData;
+
+	union sshs_node_attr_value statisticValue = {.ilong = 0};
+
+	if (caerStrEquals(key, "writes")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&writes->writes, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesWritten")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&writes->bytesWritten, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "writesPerSecond")) {
+		statisticValue.ddouble = streamWritesPerSecond(writes);
+	}
+	else if (caerStrEquals(key, "averageWriteSize")) {
+		uint64_t writesNumber = atomic_load_explicit(&writes->writes, memory_order_relaxed);
+		uint64_t bytesWritten = atomic_load_explicit(&writes->bytesWritten, memory_order_relaxed);
+
+		statisticValue.ddouble = (writesNumber == 0) ? (0) : ((double) bytesWritten / (double) writesNumber);
+	}
+	else if (caerStrEquals(key, "throughputMode")) {
+		statisticValue.boolean = atomic_load_explicit(&writes->throughputActive, memory_order_relaxed);
+	}
+
+	return (statisticValue);
+}
+
+/**
+ * Average stream write rate, since the module was started.
+ *
+ * @param writes stream writes state.
+ *
+ * @return write requests per second.
+ */
+static double streamWritesPerSecond(struct output_common_stream_writes *writes) {
+	double elapsedTime = (double) (uv_hrtime() - writes->startTime) / 1000000000.0;
+	if (elapsedTime <= 0) {
+		return (0);
+	}
+
+	return ((double) atomic_load_explicit(&writes->writes, memory_order_relaxed) / elapsedTime);
+}
+
+static union sshs_node_attr_value clientStatisticsUpdater(
+	void *userData, const char *key, enum sshs_node_attr_value_type type) {
+	UNUSED_ARGUMENT(type);
+
+	struct output_common_client *client = userData;
+
+	union sshs_node_attr_value statisticValue = {.ilong = 0};
+
+	if (caerStrEquals(key, "packetsSent")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&client->packetsSent, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesSent")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&client->bytesSent, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "bytesPerSecond")) {
+		double elapsedTime = (double) (uv_hrtime() - client->connectTime) / 1000000000.0;
+
+		if (elapsedTime > 0) {
+			statisticValue.ddouble
+				= (double) atomic_load_explicit(&client->bytesSent, memory_order_relaxed) / elapsedTime;
+		}
+	}
+	else if (caerStrEquals(key, "packetsDropped")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&client->packetsDropped, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "queuedBytes")) {
+		statisticValue.ilong = I64T(atomic_load_explicit(&client->queuedBytes, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "lag")) {
+		uint64_t oldestQueueTime = atomic_load_explicit(&client->oldestQueueTime, memory_order_relaxed);
+		uint64_t currentTime     = uv_hrtime();
+
+		if ((oldestQueueTime != 0) && (currentTime > oldestQueueTime)) {
+			statisticValue.ilong = I64T((currentTime - oldestQueueTime) / 1000000);
+		}
+	}
+
+	return (statisticValue);
+}
+
+/**
+ * Prepare UDP sending: statistics, and for batched sending the socket
+ * and the message headers, which never change for a given client.
+ *
+ * @param state common output state.
+ *
+ * @return true on success, false if the socket is not available.
+ */
+static bool udpBatchInit(outputCommonState state) {
+	struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+	atomic_store(&batch->datagramsSent, 0);
+	atomic_store(&batch->datagramsDropped, 0);
+	atomic_store(&batch->sendCalls, 0);
+	atomic_store(&batch->fecDatagrams, 0);
+
+	portable_clock_gettime_monotonic(&batch->startTime);
+
+	batch->fec.groupSize      = (size_t) sshsNodeGetInt(state->parentModule->moduleNode, "fecGroupSize");
+	batch->fec.groupDatagrams = 0;
+	batch->fec.parity         = NULL;
+
+#ifdef ENABLE_INOUT_SENDMMSG
+	uv_os_fd_t socket;
+	int retVal = uv_fileno((uv_handle_t *) state->networkIO->clients[0], &socket);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_fileno", return (false));
+
+	batch->socket            = socket;
+	batch->datagrams         = 0;
+	batch->packetBuffersSize = 0;
+	batch->sendOffset        = 0;
+	batch->writableWait      = false;
+
+	// Only started while the socket buffer is full. libuv never reads from or
+	// writes to the UDP handle here, so this is the only watcher on the socket.
+	retVal = uv_poll_init_socket(&state->networkIO->loop, &batch->writablePoll, socket);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_poll_init_socket", return (false));
+
+	batch->writablePoll.data = state;
+
+	socklen_t addressLength = (((struct sockaddr *) state->networkIO->address)->sa_family == AF_INET6)
+								  ? (sizeof(struct sockaddr_in6))
+								  : (sizeof(struct sockaddr_in));
+
+	for (size_t i = 0; i < UDP_BATCH_MAX_DATAGRAMS; i++) {
+		batch->vectors[i][0].iov_base = &batch->headers[i];
+		batch->vectors[i][0].iov_len  = AEDAT3_NETWORK_HEADER_LENGTH;
+
+		memset(&batch->messages[i], 0, sizeof(struct mmsghdr));
+		batch->messages[i].msg_hdr.msg_name    = state->networkIO->address;
+		batch->messages[i].msg_hdr.msg_namelen = addressLength;
+		batch->messages[i].msg_hdr.msg_iov     = batch->vectors[i];
+		batch->messages[i].msg_hdr.msg_iovlen  = 2;
+	}
+
+	// Make room for a full batch in the socket buffer. Failure is not fatal.
+	int sendBufferSize = MAX_OUTPUT_QUEUED_SIZE;
+	uv_send_buffer_size((uv_handle_t *) state->networkIO->clients[0], &sendBufferSize);
+#endif
+
+	return (true);
+}
+
+/**
+ * Select the general-purpose compression ('compressPackets' setting) and
+ * prepare its shared resources, like the Zstd dictionary.
+ *
+ * @param state common output state.
+ *
+ * @return true on success, false on invalid configuration.
+ */
+static bool packetCompressionInit(outputCommonState state) {
+	sshsNode moduleNode = state->parentModule->moduleNode;
+
+	char *compressPackets = sshsNodeGetString(moduleNode, "compressPackets");
+
+	bool useLZ4  = false;
+	bool useZstd = false;
+
+	if (caerStrEquals(compressPackets, "auto")) {
+		// Low latency for live streams, best ratio for recordings.
+		// Fall back to the other if only one of them is available.
+#if defined(ENABLE_INOUT_LZ4_COMPRESSION) && defined(ENABLE_INOUT_ZSTD_COMPRESSION)
+		useLZ4  = state->isNetworkStream;
+		useZstd = !state->isNetworkStream;
+#elif defined(ENABLE_INOUT_LZ4_COMPRESSION)
+		useLZ4 = true;
+#elif defined(ENABLE_INOUT_ZSTD_COMPRESSION)
+		useZstd = true;
+#endif
+	}
+	else if (caerStrEquals(compressPackets, "lz4")) {
+		useLZ4 = true;
+	}
+	else if (caerStrEquals(compressPackets, "zstd")) {
+		useZstd = true;
+	}
+	else if (!caerStrEquals(compressPackets, "none")) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Invalid packet compression '%s', must be one of 'none', 'lz4', 'zstd' or 'auto'.", compressPackets);
+		free(compressPackets);
+		return (false);
+	}
+
+	free(compressPackets);
+
+#ifndef ENABLE_INOUT_LZ4_COMPRESSION
+	if (useLZ4) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "LZ4 packet compression not supported by this build.");
+		return (false);
+	}
+#endif
+
+#ifndef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (useZstd) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Zstd packet compression not supported by this build.");
+		return (false);
+	}
+#endif
+
+	if (useLZ4) {
+		state->formatID = I8T(state->formatID | 0x08);
+	}
+
+	if (useZstd) {
+		state->formatID = I8T(state->formatID | 0x10);
+	}
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	state->compression.zstdLevel      = sshsNodeGetInt(moduleNode, "compressPacketsLevel");
+	state->compression.zstdDictionary = NULL;
+
+	char *dictionaryPath = sshsNodeGetString(moduleNode, "compressPacketsDictionary");
+
+	if (useZstd && !caerStrEquals(dictionaryPath, "")) {
+		size_t dictionarySize;
+		uint8_t *dictionary = caerInOutReadFile(dictionaryPath, &dictionarySize);
+
+		if (dictionary != NULL) {
+			// The dictionary content is copied, so it can be freed right away.
+			state->compression.zstdDictionary
+				= ZSTD_createCDict(dictionary, dictionarySize, state->compression.zstdLevel);
+			free(dictionary);
+		}
+
+		if (state->compression.zstdDictionary == NULL) {
+			caerModuleLog(
+				state->parentModule, CAER_LOG_ERROR, "Failed to load Zstd dictionary '%s'.", dictionaryPath);
+			free(dictionaryPath);
+			return (false);
+		}
+
+		caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Loaded Zstd dictionary '%s' (%zu bytes).",
+			dictionaryPath, dictionarySize);
+	}
+
+	free(dictionaryPath);
+#endif
+
+	return (true);
+}
+
+static void packetCompressionExit(outputCommonState state) {
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_freeCDict(state->compression.zstdDictionary);
+	state->compression.zstdDictionary = NULL;
+#endif
+
+	for (size_t i = 0; i < FRAME_CODEC_MAX_REFERENCES; i++) {
+		caerFrameCodecReferenceFree(&state->compression.frameReferences[i]);
+	}
+}
+
+/**
+ * Prepare sharing compression with other outputs ('shareCompression' setting).
+ * Outputs share compression if all settings affecting the compressed data are
+ * the same, these are collected here. Failure is not fatal, the output then
+ * just compresses on its own.
+ *
+ * @param state common output state.
+ */
+static void compressionGroupSetup(outputCommonState state) {
+	state->compression.groupSettings = NULL;
+	state->compression.groupName     = NULL;
+	state->compression.group         = NULL;
+
+	if (!sshsNodeGetBool(state->parentModule->moduleNode, "shareCompression")) {
+		return;
+	}
+
+	int zstdLevel        = 0;
+	char *dictionaryPath = NULL;
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (state->formatID & 0x10) {
+		zstdLevel      = state->compression.zstdLevel;
+		dictionaryPath = sshsNodeGetString(state->parentModule->moduleNode, "compressPacketsDictionary");
+	}
+#endif
+
+	size_t settingsLength = (size_t) snprintf(NULL, 0,
+		"outputCompression/format=%" PRIi8 ",framesDeltaInterval=%" PRIi32 ",packetsLevel=%d,packetsDictionary=%s",
+		state->formatID, state->compression.frameDeltaInterval, zstdLevel,
+		(dictionaryPath == NULL) ? ("") : (dictionaryPath));
+
+	state->compression.groupSettings = malloc(settingsLength + 1);
+	if (state->compression.groupSettings == NULL) {
+		free(dictionaryPath);
+
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to allocate memory for compression settings, not sharing compression.");
+		return;
+	}
+
+	snprintf(state->compression.groupSettings, settingsLength + 1,
+		"outputCompression/format=%" PRIi8 ",framesDeltaInterval=%" PRIi32 ",packetsLevel=%d,packetsDictionary=%s",
+		state->formatID, state->compression.frameDeltaInterval, zstdLevel,
+		(dictionaryPath == NULL) ? ("") : (dictionaryPath));
+
+	free(dictionaryPath);
+}
+
+/**
+ * Join the compression group of all outputs with the same source and
+ * compression settings. Called from the mainloop, as soon as the source
+ * is known. The first output to join compresses for the whole group.
+ *
+ * @param state common output state.
+ * @param sourceID source of the packets this output gets.
+ */
+static void compressionGroupJoin(outputCommonState state, int16_t sourceID) {
+	size_t nameLength
+		= (size_t) snprintf(NULL, 0, "%s,source=%" PRIi16, state->compression.groupSettings, sourceID);
+
+	char *groupName = malloc(nameLength + 1);
+	if (groupName == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to allocate memory for compression group name, not sharing compression.");
+		return;
+	}
+
+	snprintf(groupName, nameLength + 1, "%s,source=%" PRIi16, state->compression.groupSettings, sourceID);
+
+	struct output_common_compression_group *group
+		= caerMainloopSharedStateAcquire(groupName, sizeof(struct output_common_compression_group),
+			&compressionGroupInit);
+	if (group == NULL) {
+		free(groupName);
+
+		caerModuleLog(
+			state->parentModule, CAER_LOG_WARNING, "Failed to get compression group, not sharing compression.");
+		return;
+	}
+
+	mtx_lock(&group->lock);
+
+	if (group->membersSize == MAX_COMPRESSION_GROUP_MEMBERS) {
+		mtx_unlock(&group->lock);
+
+		caerMainloopSharedStateRelease(groupName, &compressionGroupDestroy);
+		free(groupName);
+
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Compression group already has %d outputs, not sharing compression.", MAX_COMPRESSION_GROUP_MEMBERS);
+		return;
+	}
+
+	group->members[group->membersSize++] = state;
+
+	size_t membersSize = group->membersSize;
+
+	mtx_unlock(&group->lock);
+
+	state->compression.groupName = groupName;
+	state->compression.group     = group;
+
+	if (membersSize == 1) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Compressing packets for all outputs with the same source and compression settings.");
+	}
+	else {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Sharing compressed packets with %zu other outputs with the same source and compression settings.",
+			membersSize - 1);
+	}
+}
+
+/**
+ * Leave the compression group. If this output was compressing for the group,
+ * the next one in line takes over, starting with the next packet container.
+ *
+ * @param state common output state.
+ */
+static void compressionGroupLeave(outputCommonState state) {
+	struct output_common_compression_group *group = state->compression.group;
+
+	if (group == NULL) {
+		return;
+	}
+
+	mtx_lock(&group->lock);
+
+	for (size_t i = 0; i < group->membersSize; i++) {
+		if (group->members[i] == state) {
+			// Keep the joining order, the oldest member takes over.
+			memmove(&group->members[i], &group->members[i + 1],
+				(group->membersSize - i - 1) * sizeof(struct output_common_state *));
+			group->membersSize--;
+			break;
+		}
+	}
+
+	mtx_unlock(&group->lock);
+
+	state->compression.group = NULL;
+
+	caerMainloopSharedStateRelease(state->compression.groupName, &compressionGroupDestroy);
+
+	free(state->compression.groupName);
+	state->compression.groupName = NULL;
+}
+
+/**
+ * Check if another output in the compression group compresses for this one.
+ *
+ * @param state common output state.
+ *
+ * @return true if another output compresses for this one, false if this
+ * output compresses by itself (or for the group).
+ */
+static bool compressionGroupIsFollower(outputCommonState state) {
+	struct output_common_compression_group *group = state->compression.group;
+
+	if (group == NULL) {
+		return (false);
+	}
+
+	mtx_lock(&group->lock);
+
+	bool isFollower = (group->members[0] != state);
+
+	mtx_unlock(&group->lock);
+
+	return (isFollower);
+}
+
+static bool compressionGroupInit(void *groupArg) {
+	struct output_common_compression_group *group = groupArg;
+
+	return (mtx_init(&group->lock, mtx_plain) == thrd_success);
+}
+
+static void compressionGroupDestroy(void *groupArg) {
+	struct output_common_compression_group *group = groupArg;
+
+	mtx_destroy(&group->lock);
+}
+
+/**
+ * Start the segment thread, if the file output module set up segments.
+ *
+ * @param state common output state.
+ *
+ * @return true on success, false on thread start failure.
+ */
+static bool fileSegmentsStart(outputCommonState state) {
+	struct output_common_file_segments *segments = &state->segments;
+
+	if (segments->openFile == NULL) {
+		return (true);
+	}
+
+	segments->nextNumber             = segments->number + 1;
+	segments->nextFileDescriptor     = -1;
+	segments->finishedFileDescriptor = -1;
+	segments->nextReady              = false;
+	segments->finishedPending        = false;
+	segments->running                = true;
+
+	portable_clock_gettime_monotonic(&segments->startTime);
+
+	if (mtx_init(&segments->lock, mtx_plain) != thrd_success) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize segment lock.");
+		return (false);
+	}
+
+	if (cnd_init(&segments->changed) != thrd_success) {
+		mtx_destroy(&segments->lock);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize segment condition.");
+		return (false);
+	}
+
+	if (thrd_create(&segments->segmentThread, &fileSegmentThread, state) != thrd_success) {
+		cnd_destroy(&segments->changed);
+		mtx_destroy(&segments->lock);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start segment thread.");
+		return (false);
+	}
+
+	segments->threadStarted = true;
+
+	return (true);
+}
+
+/**
+ * Stop the segment thread, complete a finished segment it didn't get to
+ * yet, and remove the next segment file if it was opened but never used.
+ * Must be called after the output thread is done.
+ *
+ * @param state common output state.
+ */
+static void fileSegmentsStop(outputCommonState state) {
+	struct output_common_file_segments *segments = &state->segments;
 
-	writeUntilDone(state->fileIO, (const uint8_t *) "#!END-HEADER\r\n", 14);
-}
+	if (!segments->threadStarted) {
+		return;
+	}
 
-void caerOutputCommonOnServerConnection(uv_stream_t *server, int status) {
-	outputCommonNetIO streams = server->data;
+	// Set under the lock, so the segment thread can't miss the wakeup.
+	mtx_lock(&segments->lock);
+	segments->running = false;
+	cnd_broadcast(&segments->changed);
+	mtx_unlock(&segments->lock);
 
-	UV_RET_CHECK(status, __func__, "Connection", return );
+	if ((errno = thrd_join(segments->segmentThread, NULL)) != thrd_success) {
+		// This should never happen!
+		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join segment thread. Error: %d.", errno);
+	}
 
-	uv_stream_t *client = NULL;
+	segments->threadStarted = false;
 
-	if (streams->isTCP) {
-		client = malloc(sizeof(uv_tcp_t));
-	}
-	else {
-		client = malloc(sizeof(uv_pipe_t));
-	}
+	// Segment thread is gone, no more locking needed.
+	if (segments->finishedPending) {
+		fileSegmentComplete(state, segments->finishedFileDescriptor, segments->finishedFilePath);
 
-	if (client == NULL) {
-		caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for new client.");
-		return;
+		segments->finishedFileDescriptor = -1;
+		segments->finishedFilePath       = NULL;
+		segments->finishedPending        = false;
 	}
 
-	int retVal;
+	if (segments->nextReady) {
+		close(segments->nextFileDescriptor);
+		unlink(segments->nextFilePath);
+		free(segments->nextFilePath);
 
-	if (streams->isTCP) {
-		retVal = uv_tcp_init(server->loop, (uv_tcp_t *) client);
-		UV_RET_CHECK(retVal, __func__, "uv_tcp_init", free(client); return );
-	}
-	else {
-		retVal = uv_pipe_init(server->loop, (uv_pipe_t *) client, false);
-		UV_RET_CHECK(retVal, __func__, "uv_pipe_init", free(client); return );
+		segments->nextFileDescriptor = -1;
+		segments->nextFilePath       = NULL;
+		segments->nextReady          = false;
 	}
 
-	// All clients need to remember the main streams structure.
-	client->data = streams;
+	cnd_destroy(&segments->changed);
+	mtx_destroy(&segments->lock);
+}
 
-	retVal = uv_accept(server, client);
-	UV_RET_CHECK(retVal, __func__, "uv_accept", goto killConnection);
+static int fileSegmentThread(void *stateArg) {
+	outputCommonState state                      = stateArg;
+	struct output_common_file_segments *segments = &state->segments;
 
-	// Find place for new connection. If all exhausted, we've reached maximum
-	// number of clients and just kill the connection.
-	for (size_t i = 0; i < streams->clientsSize; i++) {
-		if (streams->clients[i] == NULL) {
-			// TCP/PIPE: send out initial header. Only those two can call this function!
-			libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
-			if (buffers == NULL) {
-				caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for network header buffers.");
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 9]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Segment]");
+	portable_thread_set_name(threadName);
 
-				goto killConnection;
-			}
+	mtx_lock(&segments->lock);
 
-			buffers->statusCheck = &libuvWriteStatusCheck;
+	while (segments->running) {
+		if (segments->finishedPending) {
+			int fileDescriptor = segments->finishedFileDescriptor;
+			char *filePath     = segments->finishedFilePath;
 
-			if (!writeNetworkHeader(streams, &buffers->buffers[0], false)) {
-				caerLog(CAER_LOG_ERROR, __func__, "Failed to write network header.");
+			// The output thread doesn't touch a pending finished segment, so it
+			// can be completed without holding the lock.
+			mtx_unlock(&segments->lock);
+			fileSegmentComplete(state, fileDescriptor, filePath);
+			mtx_lock(&segments->lock);
 
-				libuvWriteBufFree(buffers);
-				goto killConnection;
-			}
+			segments->finishedFileDescriptor = -1;
+			segments->finishedFilePath       = NULL;
+			segments->finishedPending        = false;
 
-			retVal = libuvWrite(client, buffers);
-			UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto killConnection);
+			continue;
+		}
 
-			// Ready now for more data, so set client field for writePacket().
-			streams->clients[i] = client;
-			streams->activeClients++;
+		if (!segments->nextReady) {
+			char *filePath = NULL;
 
-			// TODO: add client IP to connected clients list.
+			mtx_unlock(&segments->lock);
+			int fileDescriptor = segments->openFile(state->parentModule, segments->nextNumber, &filePath);
+			mtx_lock(&segments->lock);
 
-			return;
-		}
-	}
+			if (fileDescriptor < 0) {
+				// Error already logged by openFile(). The output thread continues
+				// with the current segment meanwhile, so just retry in a second
+				// (or right away on shutdown).
+				struct timespec retryTime;
+				portable_clock_gettime_realtime(&retryTime);
+				retryTime.tv_sec += 1;
 
-// Kill connection if maximum number reached.
-killConnection : { uv_close((uv_handle_t *) client, &libuvCloseFree); }
-}
+				cnd_timedwait(&segments->changed, &segments->lock, &retryTime);
 
-void caerOutputCommonOnClientConnection(uv_connect_t *connectionRequest, int status) {
-	outputCommonNetIO streams = connectionRequest->handle->data;
+				continue;
+			}
 
-	UV_RET_CHECK(status, __func__, "Connection", goto cleanupRequest);
+			segments->nextFileDescriptor = fileDescriptor;
+			segments->nextFilePath       = filePath;
+			segments->nextNumber++;
+			segments->nextReady = true;
 
-	// TCP/PIPE: send out initial header. Only those two can call this function!
-	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
-	if (buffers == NULL) {
-		caerLog(CAER_LOG_ERROR, __func__, "Failed to allocate memory for network header buffers.");
+			continue;
+		}
 
-		goto cleanupRequest;
+		// Nothing to do until the output thread switches segments.
+		cnd_wait(&segments->changed, &segments->lock);
 	}
 
-	buffers->statusCheck = &libuvWriteStatusCheck;
+	mtx_unlock(&segments->lock);
 
-	if (!writeNetworkHeader(streams, &buffers->buffers[0], false)) {
-		caerLog(CAER_LOG_ERROR, __func__, "Failed to write network header.");
+	return (thrd_success);
+}
 
-		libuvWriteBufFree(buffers);
-		goto cleanupRequest;
+/**
+ * Make a finished segment available: sync it to disk, close it, and
+ * remove the partial suffix from its name, so whatever picks up finished
+ * segments only ever sees complete files.
+ *
+ * @param state common output state.
+ * @param fileDescriptor segment file descriptor, closed here.
+ * @param filePath segment file path, freed here.
+ */
+static void fileSegmentComplete(outputCommonState state, int fileDescriptor, char *filePath) {
+	portable_fsync(fileDescriptor);
+	close(fileDescriptor);
+
+	size_t filePathLength = strlen(filePath);
+	size_t suffixLength   = strlen(FILE_SEGMENT_PARTIAL_SUFFIX);
+
+	if ((filePathLength > suffixLength)
+		&& caerStrEquals(filePath + filePathLength - suffixLength, FILE_SEGMENT_PARTIAL_SUFFIX)) {
+		char completePath[filePathLength - suffixLength + 1]; // +1 for NUL character.
+		memcpy(completePath, filePath, filePathLength - suffixLength);
+		completePath[filePathLength - suffixLength] = '\0';
+
+		if (rename(filePath, completePath) != 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to rename segment file '%s'. Error: %d.",
+				filePath, errno);
+		}
+		else {
+			caerModuleLog(state->parentModule, CAER_LOG_INFO, "Completed segment file '%s'.", completePath);
+		}
 	}
 
-	int retVal = libuvWrite(connectionRequest->handle, buffers);
-	UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto cleanupRequest);
-
-	// Ready now for more data, so set client field for writePacket().
-	streams->clients[0] = connectionRequest->handle;
-	streams->activeClients++;
-
-cleanupRequest : { free(connectionRequest); }
+	free(filePath);
 }
 
 bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputCommonNetIO streams) {
@@ -1402,16 +4408,241 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	sshsNodeCreateInt(moduleData->moduleNode, "ringBufferSize", 512, 8, 4096, SSHS_FLAGS_NORMAL,
 		"Size of EventPacketContainer and EventPacket queues, used for transfers between mainloop and output threads.");
 
+	// Compression configuration (only changes here at init time!).
+	sshsNodeCreateBool(moduleData->moduleNode, "compressTimestamps", false, SSHS_FLAGS_NORMAL,
+		"Compress runs of events with the same timestamp (SerializedTS format).");
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	sshsNodeCreateBool(moduleData->moduleNode, "compressFrames", false, SSHS_FLAGS_NORMAL,
+		"Compress frame events losslessly as PNG images (PNGFrames format).");
+#endif
+	sshsNodeCreateBool(moduleData->moduleNode, "compressPolarity", false, SSHS_FLAGS_NORMAL,
+		"Delta-code and bit-pack polarity events (PolarityDelta format, takes precedence over SerializedTS).");
+	sshsNodeCreateBool(moduleData->moduleNode, "compressFramesFast", false, SSHS_FLAGS_NORMAL,
+		"Compress frame events losslessly with a fast predictive codec (FastFrames format, takes precedence over "
+		"PNGFrames).");
+	sshsNodeCreateInt(moduleData->moduleNode, "compressFramesDeltaInterval", 0, 0, 10000, SSHS_FLAGS_NORMAL,
+		"Encode frames as differences to the previous frame with the same ROI (FastFrames only), with a key frame "
+		"every this many frames. 0 for key frames only.");
+	sshsNodeCreateString(moduleData->moduleNode, "compressPackets", "none", 3, 4, SSHS_FLAGS_NORMAL,
+		"General-purpose compression of all packets not handled by the options above: 'none', 'lz4' (low "
+		"latency, LZ4Packets format), 'zstd' (high ratio, ZstdPackets format) or 'auto' (lz4 for network "
+		"outputs, zstd for files).");
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	sshsNodeCreateInt(moduleData->moduleNode, "compressPacketsLevel", 3, 1, ZSTD_maxCLevel(), SSHS_FLAGS_NORMAL,
+		"Zstd compression level, higher is smaller but slower.");
+	sshsNodeCreateString(moduleData->moduleNode, "compressPacketsDictionary", "", 0, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Zstd dictionary file (trained with 'zstd --train'), improves compression of small packets. "
+		"Inputs must use the same dictionary. Empty to disable.");
+#endif
+	sshsNodeCreateInt(moduleData->moduleNode, "compressionThreads", 0, 0, MAX_COMPRESSION_WORKERS, SSHS_FLAGS_NORMAL,
+		"Number of threads compressing packets in parallel, 0 to compress on the compressor thread only.");
+	sshsNodeCreateBool(moduleData->moduleNode, "shareCompression", false, SSHS_FLAGS_NORMAL,
+		"Compress packets only once for all output modules with this enabled, the same source and the same "
+		"compression settings. The first one started does it for all of them, and its validOnly and keepPackets "
+		"settings apply.");
+
+	// File writing configuration (only changes here at init time!).
+	if (!state->isNetworkStream) {
+		sshsNodeCreateInt(moduleData->moduleNode, "writeBufferSize", 4096, 64, 65536, SSHS_FLAGS_NORMAL,
+			"Size of the file write buffer in KB. Data is written to the file in blocks of this size.");
+		sshsNodeCreateInt(moduleData->moduleNode, "preallocateSize", 64, 0, 4096, SSHS_FLAGS_NORMAL,
+			"Preallocate file space in extents of this size in MB, to keep the file contiguous. 0 to disable.");
+	}
+
+	// Live streaming configuration.
+	if (state->isNetworkStream) {
+		sshsNodeCreateBool(moduleData->moduleNode, "liveMode", false, SSHS_FLAGS_NORMAL,
+			"Keep only the newest data if the output can't keep up, for low latency instead of completeness. "
+			"Timestamp resets, other special events and key frames are always kept. Slow clients always get their "
+			"oldest queued packets dropped, whatever 'slowClientPolicy' says.");
+		sshsNodeCreateInt(moduleData->moduleNode, "liveModeContainers", 4, 1, LIVE_MODE_MAX_CONTAINERS,
+			SSHS_FLAGS_NORMAL, "Live mode: maximum number of packet containers waiting to be compressed.");
+	}
+
+	// Stream client configuration (only changes here at init time!).
+	if (state->isNetworkStream && !state->networkIO->isUDP) {
+		sshsNodeCreateInt(moduleData->moduleNode, "clientQueueSize", 1024, 16, 262144, SSHS_FLAGS_NORMAL,
+			"Maximum data queued per client in KB, before the slow client policy applies.");
+		sshsNodeCreateString(moduleData->moduleNode, "slowClientPolicy", "dropOldest", 10, 14, SSHS_FLAGS_NORMAL,
+			"What to do when a client can't keep up: 'dropOldest' (drop oldest queued packets), 'keyPacketsOnly' "
+			"(send only special events and key frames until caught up) or 'disconnect'.");
+		sshsNodeCreateString(moduleData->moduleNode, "latencyMode", "auto", 4, 10, SSHS_FLAGS_NORMAL,
+			"How to write packets to clients: 'lowLatency' (each packet right away), 'throughput' (coalesce packets "
+			"into larger writes) or 'auto' (throughput mode at high packet rates).");
+		sshsNodeCreateInt(moduleData->moduleNode, "writeBatchSize", 64, 1, 1024, SSHS_FLAGS_NORMAL,
+			"Throughput mode: write to a client once this much data in KB is queued for it.");
+		sshsNodeCreateInt(moduleData->moduleNode, "writeBatchDelay", 10, 1, 1000, SSHS_FLAGS_NORMAL,
+			"Throughput mode: write to a client at the latest once data was queued this long in ms.");
+		sshsNodeCreateBool(moduleData->moduleNode, "tcpCork", false, SSHS_FLAGS_NORMAL,
+			"Throughput mode: set TCP_CORK on TCP clients, to only send full segments (Linux only).");
+		sshsNodeCreateInt(moduleData->moduleNode, "autoThroughputRate", 1000, 1, 1000000, SSHS_FLAGS_NORMAL,
+			"Auto mode: switch to throughput mode above this many packets/s. At about one write per ms, the "
+			"per-write system call and TCP segment overhead starts to add up.");
+		sshsNodeCreateInt(moduleData->moduleNode, "autoLowLatencyRate", 500, 0, 1000000, SSHS_FLAGS_NORMAL,
+			"Auto mode: switch back to low-latency mode below this many packets/s. Keep it well below "
+			"'autoThroughputRate', so rates in between don't flip the mode on every check.");
+		sshsNodeCreateInt(moduleData->moduleNode, "autoRateInterval", 1000, 100, 60000, SSHS_FLAGS_NORMAL,
+			"Auto mode: measure the packet rate over this many ms. Longer intervals ignore short bursts, but "
+			"react later to sustained rate changes.");
+	}
+
+	// UDP configuration (only changes here at init time!).
+	if (state->isNetworkStream && state->networkIO->isUDP) {
+		sshsNodeCreateInt(moduleData->moduleNode, "fecGroupSize", 0, 0, INOUT_FEC_MAX_GROUP_SIZE, SSHS_FLAGS_NORMAL,
+			"Forward error correction: send a parity datagram after this many datagrams, from which receivers can "
+			"recover any single lost one. 0 to disable.");
+	}
+
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
+
+	if (state->isNetworkStream) {
+		atomic_store(&state->liveMode.enabled, sshsNodeGetBool(moduleData->moduleNode, "liveMode"));
+		atomic_store(&state->liveMode.containersNumber,
+			U32T(sshsNodeGetInt(moduleData->moduleNode, "liveModeContainers")));
+	}
+
 	int ringSize = sshsNodeGetInt(moduleData->moduleNode, "ringBufferSize");
 
 	// Format configuration (compression modes).
 	state->formatID = 0x00; // RAW format by default.
 
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressTimestamps")) {
+		state->formatID = I8T(state->formatID | 0x01);
+	}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressFrames")) {
+		state->formatID = I8T(state->formatID | 0x02);
+	}
+#endif
+
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressPolarity")) {
+		state->formatID = I8T(state->formatID | 0x04);
+	}
+
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressFramesFast")) {
+		state->formatID = I8T(state->formatID | 0x20);
+
+		state->compression.frameDeltaInterval = sshsNodeGetInt(moduleData->moduleNode, "compressFramesDeltaInterval");
+	}
+
+	if (!state->isNetworkStream) {
+		// Buffer size must be a multiple of the alignment, for O_DIRECT.
+		size_t bufferSize = (size_t) sshsNodeGetInt(moduleData->moduleNode, "writeBufferSize") * 1024;
+
+		state->fileWriter.bufferSize
+			= ((bufferSize + FILE_WRITER_ALIGNMENT - 1) / FILE_WRITER_ALIGNMENT) * FILE_WRITER_ALIGNMENT;
+		state->fileWriter.preallocateSize
+			= (uint64_t) sshsNodeGetInt(moduleData->moduleNode, "preallocateSize") * 1024 * 1024;
+
+#if defined(O_DIRECT)
+		// Output modules can open their file with O_DIRECT, detect it here.
+		int fileFlags               = fcntl(fileDescriptor, F_GETFL);
+		state->fileWriter.directIO = ((fileFlags != -1) && ((fileFlags & O_DIRECT) != 0));
+#endif
+
+		portable_clock_gettime_monotonic(&state->fileWriter.startTime);
+	}
+
+	if (state->isNetworkStream) {
+		state->networkIO->clientQueues = NULL;
+		state->networkIO->moduleNode   = moduleData->moduleNode;
+	}
+
+	if (state->isNetworkStream && !state->networkIO->isUDP) {
+		state->networkIO->clientQueueLimit
+			= (size_t) sshsNodeGetInt(moduleData->moduleNode, "clientQueueSize") * 1024;
+
+		char *slowClientPolicy = sshsNodeGetString(moduleData->moduleNode, "slowClientPolicy");
+
+		if (caerStrEquals(slowClientPolicy, "dropOldest")) {
+			state->networkIO->clientPolicy = CLIENT_POLICY_DROP_OLDEST;
+		}
+		else if (caerStrEquals(slowClientPolicy, "keyPacketsOnly")) {
+			state->networkIO->clientPolicy = CLIENT_POLICY_KEY_PACKETS_ONLY;
+		}
+		else if (caerStrEquals(slowClientPolicy, "disconnect")) {
+			state->networkIO->clientPolicy = CLIENT_POLICY_DISCONNECT;
+		}
+		else {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Invalid slow client policy '%s', must be one of 'dropOldest', 'keyPacketsOnly' or 'disconnect'.",
+				slowClientPolicy);
+			free(slowClientPolicy);
+			return (false);
+		}
+
+		free(slowClientPolicy);
+
+		struct output_common_stream_writes *writes = &state->networkIO->streamWrites;
+
+		char *latencyMode = sshsNodeGetString(moduleData->moduleNode, "latencyMode");
+
+		if (caerStrEquals(latencyMode, "lowLatency")) {
+			writes->mode = LATENCY_MODE_LOW_LATENCY;
+		}
+		else if (caerStrEquals(latencyMode, "throughput")) {
+			writes->mode = LATENCY_MODE_THROUGHPUT;
+		}
+		else if (caerStrEquals(latencyMode, "auto")) {
+			writes->mode = LATENCY_MODE_AUTO;
+		}
+		else {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Invalid latency mode '%s', must be one of 'lowLatency', 'throughput' or 'auto'.", latencyMode);
+			free(latencyMode);
+			return (false);
+		}
+
+		free(latencyMode);
+
+		writes->batchSize  = (size_t) sshsNodeGetInt(moduleData->moduleNode, "writeBatchSize") * 1024;
+		writes->batchDelay = U64T(sshsNodeGetInt(moduleData->moduleNode, "writeBatchDelay")) * 1000000LLU;
+		writes->tcpCork    = sshsNodeGetBool(moduleData->moduleNode, "tcpCork");
+
+		writes->throughputRate = U64T(sshsNodeGetInt(moduleData->moduleNode, "autoThroughputRate"));
+		writes->lowLatencyRate = U64T(sshsNodeGetInt(moduleData->moduleNode, "autoLowLatencyRate"));
+		writes->rateInterval   = U64T(sshsNodeGetInt(moduleData->moduleNode, "autoRateInterval")) * 1000000LLU;
+
+		if (writes->lowLatencyRate > writes->throughputRate) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Invalid auto mode rates, 'autoLowLatencyRate' (%" PRIu64 ") must not be above 'autoThroughputRate' "
+				"(%" PRIu64 ").",
+				writes->lowLatencyRate, writes->throughputRate);
+			return (false);
+		}
+
+		// Auto mode starts out in low-latency mode.
+		writes->throughput    = (writes->mode == LATENCY_MODE_THROUGHPUT);
+		writes->ratePackets   = 0;
+		writes->rateCheckTime = uv_hrtime();
+		writes->startTime     = writes->rateCheckTime;
+
+		atomic_store(&writes->writes, 0);
+		atomic_store(&writes->bytesWritten, 0);
+		atomic_store(&writes->throughputActive, writes->throughput);
+	}
+
+	if (!packetCompressionInit(state)) {
+		return (false);
+	}
+
+	// Parallel compression workers.
+	state->compression.workersNumber = (size_t) sshsNodeGetInt(moduleData->moduleNode, "compressionThreads");
+
+	portable_clock_gettime_monotonic(&state->compression.startTime);
+
+	for (size_t i = 0; i < state->compression.workersNumber; i++) {
+		state->compression.workers[i].index = i;
+		state->compression.workers[i].state = state;
+	}
+
 	// Initialize compressor ring-buffer. ringBufferSize only changes here at init time!
 	state->compressorRing = caerRingBufferInit((size_t) ringSize);
 	if (state->compressorRing == NULL) {
+		packetCompressionExit(state);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate compressor ring-buffer.");
 		return (false);
 	}
@@ -1420,6 +4651,7 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	state->outputRing = caerRingBufferInit((size_t) ringSize);
 	if (state->outputRing == NULL) {
 		caerRingBufferFree(state->compressorRing);
+		packetCompressionExit(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate output ring-buffer.");
 		return (false);
@@ -1427,38 +4659,79 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 
 	// If network output, initialize common libuv components.
 	if (state->isNetworkStream) {
+		if (state->networkIO->isUDP && !udpBatchInit(state)) {
+			caerRingBufferFree(state->compressorRing);
+			caerRingBufferFree(state->outputRing);
+			packetCompressionExit(state);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize UDP sending.");
+			return (false);
+		}
+
 		// Add support for asynchronous shutdown (from caerOutputCommonExit()).
 		state->networkIO->shutdown.data = state;
 		int retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->shutdown, &libuvAsyncShutdown);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
 					 caerRingBufferFree(state->compressorRing);
-					 caerRingBufferFree(state->outputRing); return (false));
+					 caerRingBufferFree(state->outputRing); packetCompressionExit(state); return (false));
 
-		// Use idle handles to check for new data on every loop run.
+		// The compressor thread signals new data, so the loop only runs when there is work.
 		state->networkIO->ringBufferGet.data = state;
-		retVal                               = uv_idle_init(&state->networkIO->loop, &state->networkIO->ringBufferGet);
-		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_init",
+		retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->ringBufferGet, &libuvRingBufferGet);
+		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
 					 uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
-					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing);
+					 packetCompressionExit(state); return (false));
 
-		retVal = uv_idle_start(&state->networkIO->ringBufferGet, &libuvRingBufferGet);
-		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_start",
+		state->networkIO->writeBatchTimer.data = state->networkIO;
+		retVal = uv_timer_init(&state->networkIO->loop, &state->networkIO->writeBatchTimer);
+		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_timer_init",
 					 uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 					 uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
-					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing);
+					 packetCompressionExit(state); return (false));
+	}
+
+	// Start segment thread, if segmented file output.
+	if (!fileSegmentsStart(state)) {
+		caerRingBufferFree(state->compressorRing);
+		caerRingBufferFree(state->outputRing);
+		packetCompressionExit(state);
+
+		return (false);
+	}
+
+	// Send queues for stream clients. Clients only connect once the output thread runs.
+	if (state->isNetworkStream && !state->networkIO->isUDP) {
+		state->networkIO->clientQueues = calloc(state->networkIO->clientsSize, sizeof(struct output_common_client));
+		if (state->networkIO->clientQueues == NULL) {
+			uv_close((uv_handle_t *) &state->networkIO->writeBatchTimer, NULL);
+			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
+			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			caerRingBufferFree(state->compressorRing);
+			caerRingBufferFree(state->outputRing);
+			packetCompressionExit(state);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for client queues.");
+			return (false);
+		}
 	}
 
 	// Start output handling thread.
 	atomic_store(&state->running, true);
 
 	if (thrd_create(&state->compressorThread, &compressorThread, state) != thrd_success) {
+		fileSegmentsStop(state);
+
 		if (state->isNetworkStream) {
-			uv_idle_stop(&state->networkIO->ringBufferGet);
+			uv_close((uv_handle_t *) &state->networkIO->writeBatchTimer, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			free(state->networkIO->clientQueues);
 		}
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
+		packetCompressionExit(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start compressor thread.");
 		return (false);
@@ -1474,19 +4747,132 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 				state->parentModule, CAER_LOG_CRITICAL, "Failed to join compressor thread. Error: %d.", errno);
 		}
 
+		fileSegmentsStop(state);
+
 		if (state->isNetworkStream) {
-			uv_idle_stop(&state->networkIO->ringBufferGet);
+			uv_close((uv_handle_t *) &state->networkIO->writeBatchTimer, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			free(state->networkIO->clientQueues);
 		}
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
+		packetCompressionExit(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start output thread.");
 		return (false);
 	}
 
-	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	// Add statistics updaters and config listeners last, to avoid having them
+	// dangling if Init doesn't succeed.
+	for (size_t i = 0; i < state->compression.workersNumber; i++) {
+		struct output_common_compression_worker *worker = &state->compression.workers[i];
+
+		char workerNodeName[32];
+		snprintf(workerNodeName, 32, "statistics/compressionWorker%zu/", i);
+
+		worker->statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, workerNodeName);
+
+		sshsNodeCreateLong(worker->statisticsNode, "packets", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of packets compressed by this worker.");
+		sshsNodeCreateLong(worker->statisticsNode, "bytesIn", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes compressed by this worker (before compression).");
+		sshsNodeCreateLong(worker->statisticsNode, "bytesOut", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes compressed by this worker (after compression).");
+		sshsNodeCreateDouble(worker->statisticsNode, "utilization", 0, 0, 100,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Percentage of time spent compressing by this worker.");
+
+		sshsAttributeUpdaterAdd(
+			worker->statisticsNode, "packets", SSHS_LONG, &compressionWorkerStatisticsUpdater, worker);
+		sshsAttributeUpdaterAdd(
+			worker->statisticsNode, "bytesIn", SSHS_LONG, &compressionWorkerStatisticsUpdater, worker);
+		sshsAttributeUpdaterAdd(
+			worker->statisticsNode, "bytesOut", SSHS_LONG, &compressionWorkerStatisticsUpdater, worker);
+		sshsAttributeUpdaterAdd(
+			worker->statisticsNode, "utilization", SSHS_DOUBLE, &compressionWorkerStatisticsUpdater, worker);
+	}
+
+	if (!state->isNetworkStream) {
+		struct output_common_file_writer *writer = &state->fileWriter;
+
+		writer->statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/fileWriter/");
+
+		sshsNodeCreateLong(writer->statisticsNode, "writes", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of writes to the output file.");
+		sshsNodeCreateLong(writer->statisticsNode, "bytesWritten", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes written to the output file.");
+		sshsNodeCreateDouble(writer->statisticsNode, "bytesPerSecond", 0, 0, DBL_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average write throughput in bytes per second.");
+		sshsNodeCreateDouble(writer->statisticsNode, "writeLatencyAverage", 0, 0, DBL_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average time taken by a write in µs.");
+		sshsNodeCreateLong(writer->statisticsNode, "writeLatencyMax", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Longest time taken by a write in µs.");
+
+		sshsAttributeUpdaterAdd(writer->statisticsNode, "writes", SSHS_LONG, &fileWriterStatisticsUpdater, writer);
+		sshsAttributeUpdaterAdd(
+			writer->statisticsNode, "bytesWritten", SSHS_LONG, &fileWriterStatisticsUpdater, writer);
+		sshsAttributeUpdaterAdd(
+			writer->statisticsNode, "bytesPerSecond", SSHS_DOUBLE, &fileWriterStatisticsUpdater, writer);
+		sshsAttributeUpdaterAdd(
+			writer->statisticsNode, "writeLatencyAverage", SSHS_DOUBLE, &fileWriterStatisticsUpdater, writer);
+		sshsAttributeUpdaterAdd(
+			writer->statisticsNode, "writeLatencyMax", SSHS_LONG, &fileWriterStatisticsUpdater, writer);
+	}
+
+	if (state->isNetworkStream && state->networkIO->isUDP) {
+		struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+		batch->statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/udp/");
+
+		sshsNodeCreateLong(batch->statisticsNode, "datagramsSent", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of UDP datagrams sent.");
+		sshsNodeCreateLong(batch->statisticsNode, "datagramsDropped", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of UDP datagrams dropped, socket buffer full.");
+		sshsNodeCreateLong(batch->statisticsNode, "sendCalls", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of send system calls.");
+		sshsNodeCreateLong(batch->statisticsNode, "fecDatagrams", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of FEC parity datagrams sent.");
+		sshsNodeCreateDouble(batch->statisticsNode, "datagramsPerSecond", 0, 0, DBL_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average UDP datagrams sent per second.");
+
+		sshsAttributeUpdaterAdd(batch->statisticsNode, "datagramsSent", SSHS_LONG, &udpStatisticsUpdater, batch);
+		sshsAttributeUpdaterAdd(batch->statisticsNode, "datagramsDropped", SSHS_LONG, &udpStatisticsUpdater, batch);
+		sshsAttributeUpdaterAdd(batch->statisticsNode, "sendCalls", SSHS_LONG, &udpStatisticsUpdater, batch);
+		sshsAttributeUpdaterAdd(batch->statisticsNode, "fecDatagrams", SSHS_LONG, &udpStatisticsUpdater, batch);
+		sshsAttributeUpdaterAdd(
+			batch->statisticsNode, "datagramsPerSecond", SSHS_DOUBLE, &udpStatisticsUpdater, batch);
+	}
+
+	if (state->isNetworkStream && !state->networkIO->isUDP) {
+		struct output_common_stream_writes *writes = &state->networkIO->streamWrites;
+
+		writes->statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/streamWrites/");
+
+		sshsNodeCreateLong(writes->statisticsNode, "writes", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of write requests, to all clients.");
+		sshsNodeCreateLong(writes->statisticsNode, "bytesWritten", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Bytes written, to all clients.");
+		sshsNodeCreateDouble(writes->statisticsNode, "writesPerSecond", 0, 0, DBL_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average write requests per second.");
+		sshsNodeCreateDouble(writes->statisticsNode, "averageWriteSize", 0, 0, DBL_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average size of a write request in bytes.");
+		sshsNodeCreateBool(writes->statisticsNode, "throughputMode", false,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Throughput mode currently in use.");
+
+		sshsAttributeUpdaterAdd(writes->statisticsNode, "writes", SSHS_LONG, &streamWritesStatisticsUpdater, writes);
+		sshsAttributeUpdaterAdd(
+			writes->statisticsNode, "bytesWritten", SSHS_LONG, &streamWritesStatisticsUpdater, writes);
+		sshsAttributeUpdaterAdd(
+			writes->statisticsNode, "writesPerSecond", SSHS_DOUBLE, &streamWritesStatisticsUpdater, writes);
+		sshsAttributeUpdaterAdd(
+			writes->statisticsNode, "averageWriteSize", SSHS_DOUBLE, &streamWritesStatisticsUpdater, writes);
+		sshsAttributeUpdaterAdd(
+			writes->statisticsNode, "throughputMode", SSHS_BOOL, &streamWritesStatisticsUpdater, writes);
+	}
+
+	// The compression group is joined on the first packet, as it depends on the source.
+	compressionGroupSetup(state);
+
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputCommonConfigListener);
 
 	return (true);
@@ -1498,22 +4884,56 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 
 	outputCommonState state = moduleData->moduleState;
 
-	// Stop output thread and wait on it.
-	atomic_store(&state->running, false);
-	if (state->isNetworkStream) {
-		uv_async_send(&state->networkIO->shutdown);
+	// Remove statistics updaters, which reference the workers in the state.
+	for (size_t i = 0; i < state->compression.workersNumber; i++) {
+		sshsAttributeUpdaterRemoveAllForNode(state->compression.workers[i].statisticsNode);
+	}
+
+	if (!state->isNetworkStream) {
+		sshsAttributeUpdaterRemoveAllForNode(state->fileWriter.statisticsNode);
+	}
+	else if (state->networkIO->isUDP) {
+		sshsAttributeUpdaterRemoveAllForNode(state->networkIO->udpBatch.statisticsNode);
+	}
+	else {
+		sshsAttributeUpdaterRemoveAllForNode(state->networkIO->streamWrites.statisticsNode);
+	}
+
+	// Outputs getting packets from the compression group must stop getting them
+	// before their output thread is gone. The one compressing for the group still
+	// passes on all remaining packets, so it only leaves once its compressor is done.
+	bool groupFollower = compressionGroupIsFollower(state);
+
+	if (groupFollower) {
+		compressionGroupLeave(state);
 	}
 
+	// Stop compressor thread and wait on it.
+	atomic_store(&state->running, false);
+
 	if ((errno = thrd_join(state->compressorThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join compressor thread. Error: %d.", errno);
 	}
 
+	if (!groupFollower) {
+		compressionGroupLeave(state);
+	}
+
+	// Stop output thread and wait on it. Network outputs only do so once told to,
+	// after all data was signalled to them (compressor thread and group are done).
+	if (state->isNetworkStream) {
+		uv_async_send(&state->networkIO->shutdown);
+	}
+
 	if ((errno = thrd_join(state->outputThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join output thread. Error: %d.", errno);
 	}
 
+	// Output thread is done with segments, so the segment thread can go too.
+	fileSegmentsStop(state);
+
 	// Now clean up the ring-buffers: they should be empty, so sanity check!
 	caerEventPacketContainer packetContainer;
 
@@ -1535,8 +4955,22 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Output ring-buffer was not empty!");
 	}
 
+	// Live mode packet buffers are only left over if the output thread failed.
+	while (state->liveMode.outputWindowSize > 0) {
+		packetBuffer = state->liveMode.outputWindow[state->liveMode.outputWindowHead];
+
+		libuvWriteBufFreeData(packetBuffer);
+		free(packetBuffer);
+
+		state->liveMode.outputWindowHead = (state->liveMode.outputWindowHead + 1) % LIVE_MODE_MAX_PACKETS;
+		state->liveMode.outputWindowSize--;
+	}
+
 	caerRingBufferFree(state->outputRing);
 
+	// All compression threads are done, free shared compression resources.
+	packetCompressionExit(state);
+
 	// Cleanup IO resources.
 	if (state->isNetworkStream) {
 		if (state->networkIO->server != NULL) {
@@ -1551,16 +4985,66 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		retVal = uv_loop_close(&state->networkIO->loop);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_loop_close", );
 
+		if (state->networkIO->isUDP) {
+			struct output_common_udp_batch *batch = &state->networkIO->udpBatch;
+
+			caerModuleLog(state->parentModule, CAER_LOG_INFO,
+				"Statistics: sent %" PRIu64 " UDP datagrams (%" PRIu64 " FEC parity) with %" PRIu64
+				" send calls, dropped %" PRIu64 " datagrams, %.1f datagrams/s.",
+				U64T(atomic_load(&batch->datagramsSent)), U64T(atomic_load(&batch->fecDatagrams)),
+				U64T(atomic_load(&batch->sendCalls)), U64T(atomic_load(&batch->datagramsDropped)),
+				udpDatagramsPerSecond(batch));
+
+			free(batch->fec.parity);
+		}
+		else {
+			struct output_common_stream_writes *writes = &state->networkIO->streamWrites;
+
+			uint64_t writesNumber = U64T(atomic_load(&writes->writes));
+			uint64_t bytesWritten = U64T(atomic_load(&writes->bytesWritten));
+
+			caerModuleLog(state->parentModule, CAER_LOG_INFO,
+				"Statistics: did %" PRIu64 " stream writes, for a total of %" PRIu64
+				" bytes, average write size %.1f bytes, %.1f writes/s.",
+				writesNumber, bytesWritten,
+				(writesNumber == 0) ? (0.0) : ((double) bytesWritten / (double) writesNumber),
+				streamWritesPerSecond(writes));
+		}
+
+		// Remove client statistics, the output thread doesn't use them anymore.
+		if (state->networkIO->clientQueues != NULL) {
+			for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+				sshsNode clientNode = state->networkIO->clientQueues[i].statisticsNode;
+
+				if (clientNode != NULL) {
+					sshsAttributeUpdaterRemoveAllForNode(clientNode);
+					sshsNodeRemoveAllAttributes(clientNode);
+				}
+			}
+
+			free(state->networkIO->clientQueues);
+		}
+
 		// Free allocated memory. libuv already frees all client/server related memory.
 		free(state->networkIO->address);
 		free(state->networkIO);
 	}
+	else if (state->segments.openFile != NULL) {
+		// Last segment is complete too.
+		fileSegmentComplete(state, state->fileIO, state->segments.filePath);
+		state->segments.filePath = NULL;
+
+		free(state->segments.index);
+		free(state->fileWriter.buffer);
+	}
 	else {
 		// Ensure all data written to disk.
 		portable_fsync(state->fileIO);
 
 		// Close file descriptor.
 		close(state->fileIO);
+
+		free(state->fileWriter.buffer);
 	}
 
 	free(state->sourceInfoString);
@@ -1574,6 +5058,43 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		state->statistics.packetsNumber, state->statistics.packetsTotalSize, state->statistics.packetsHeaderSize,
 		state->statistics.packetsDataSize, state->statistics.dataWritten,
 		(state->statistics.packetsTotalSize - state->statistics.dataWritten));
+
+	if (state->isNetworkStream) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Statistics: live mode dropped %" PRIu64 " packet containers and %" PRIu64 " packets to keep up.",
+			U64T(atomic_load(&state->liveMode.containersDropped)), U64T(atomic_load(&state->liveMode.packetsDropped)));
+	}
+
+	if (state->compression.groupSettings != NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Statistics: dropped %" PRIu64 " packets compressed for the group, output ring-buffer full.",
+			U64T(atomic_load(&state->compression.groupPacketsDropped)));
+
+		free(state->compression.groupSettings);
+	}
+
+	for (size_t i = 0; i < state->compression.workersNumber; i++) {
+		struct output_common_compression_worker *worker = &state->compression.workers[i];
+
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Statistics: compression worker %zu compressed %" PRIu64 " packets, from %" PRIu64 " to %" PRIu64
+			" bytes, utilization %.1f%%.",
+			i, U64T(atomic_load(&worker->packets)), U64T(atomic_load(&worker->bytesIn)),
+			U64T(atomic_load(&worker->bytesOut)), compressionWorkerUtilization(worker));
+	}
+
+	if (!state->isNetworkStream) {
+		struct output_common_file_writer *writer = &state->fileWriter;
+
+		uint64_t writes = U64T(atomic_load(&writer->writes));
+
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"Statistics: file writer did %" PRIu64 " writes, for a total of %" PRIu64
+			" bytes, average latency %.1f µs, maximum latency %" PRIu64 " µs.",
+			writes, U64T(atomic_load(&writer->bytesWritten)),
+			(writes == 0) ? (0) : ((double) U64T(atomic_load(&writer->writeTime)) / (double) writes / 1000.0),
+			U64T(atomic_load(&writer->writeTimeMax)) / 1000);
+	}
 }
 
 static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -1592,5 +5113,13 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
 			// Set keep packets flag to given value.
 			atomic_store(&state->keepPackets, changeValue.boolean);
 		}
+		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "liveMode")) {
+			// Set live mode flag to given value.
+			atomic_store(&state->liveMode.enabled, changeValue.boolean);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "liveModeContainers")) {
+			// Set live mode window size to given value.
+			atomic_store(&state->liveMode.containersNumber, U32T(changeValue.iint));
+		}
 	}
 }
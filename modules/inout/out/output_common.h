@@ -4,14 +4,168 @@
 #include <libcaer/ringbuffer.h>
 #include "caer-sdk/module.h"
 #include "../inout_common.h"
+#include "../inout_frame_codec.h"
 #include "libuv.h"
 
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+#include <zstd.h>
+#endif
+
 #ifdef HAVE_PTHREADS
 #include "caer-sdk/cross/c11threads_posix.h"
 #endif
 
 #define MAX_OUTPUT_RINGBUFFER_GET 10
 #define MAX_OUTPUT_QUEUED_SIZE (1 * 1024 * 1024) // 1MB outstanding writes
+#define MAX_COMPRESSION_WORKERS 16
+#define MAX_COMPRESSION_GROUP_MEMBERS 16
+#define FILE_WRITER_ALIGNMENT 4096
+#define FILE_SEGMENT_PARTIAL_SUFFIX ".part"
+#define UDP_BATCH_MAX_DATAGRAMS 64
+#define CLIENT_QUEUE_MAX_PACKETS 512
+#define CLIENT_WRITE_QUEUE_SIZE (64 * 1024) // Hand data to libuv only up to 64KB outstanding.
+#define CLIENT_ADDRESS_MAX_LENGTH 64
+#define STREAM_WRITE_MAX_PACKETS 64
+#define LIVE_MODE_MAX_CONTAINERS 64
+#define LIVE_MODE_MAX_PACKETS 64
+
+struct output_common_udp_fec {
+	/// Datagrams per parity datagram, 0 if FEC is disabled.
+	size_t groupSize;
+	/// Datagrams in the current group so far.
+	size_t groupDatagrams;
+	/// XOR of the datagrams in the current group, length of the longest one,
+	/// and XOR of their lengths. The buffer is allocated on first use.
+	uint8_t *parity;
+	size_t parityLength;
+	uint32_t lengthParity;
+	/// Sequence number of the first datagram in the current group.
+	uint64_t groupSequence;
+};
+
+struct output_common_udp_batch {
+#ifdef ENABLE_INOUT_SENDMMSG
+	/// Socket of the UDP handle, written to directly with sendmmsg().
+	int socket;
+	/// Datagrams waiting to be sent: network header, plus data pointing
+	/// directly into the packet buffer (no copies).
+	struct mmsghdr messages[UDP_BATCH_MAX_DATAGRAMS];
+	struct iovec vectors[UDP_BATCH_MAX_DATAGRAMS][2];
+	struct aedat3_network_header headers[UDP_BATCH_MAX_DATAGRAMS];
+	size_t datagrams;
+	/// Packet buffers the waiting datagrams point into, freed once sent.
+	libuvWriteBuf packetBuffers[UDP_BATCH_MAX_DATAGRAMS];
+	size_t packetBuffersSize;
+	/// Socket buffer full: sending continues from datagram 'sendOffset' once
+	/// 'writablePoll' reports the socket writable. New packets are dropped
+	/// meanwhile, as libuv sending does with a full send queue.
+	uv_poll_t writablePoll;
+	bool writableWait;
+	size_t sendOffset;
+#endif
+	/// Statistics: datagrams sent and dropped (socket buffer full or send
+	/// error), and number of send system calls.
+	atomic_uint_fast64_t datagramsSent;
+	atomic_uint_fast64_t datagramsDropped;
+	atomic_uint_fast64_t sendCalls;
+	/// Forward error correction support, and parity datagrams queued for sending.
+	struct output_common_udp_fec fec;
+	atomic_uint_fast64_t fecDatagrams;
+	/// Time sending started, to calculate datagram rate.
+	struct timespec startTime;
+	/// Reference to the statistics node of the UDP output.
+	sshsNode statisticsNode;
+};
+
+enum output_common_client_policy {
+	/// Drop the oldest queued packets to make room for new ones.
+	CLIENT_POLICY_DROP_OLDEST,
+	/// Drop all but key packets (special events, key frames), until the queue drained.
+	CLIENT_POLICY_KEY_PACKETS_ONLY,
+	/// Close the connection to the client.
+	CLIENT_POLICY_DISCONNECT,
+};
+
+enum output_common_latency_mode {
+	/// Hand each packet on to be written as soon as it comes in.
+	LATENCY_MODE_LOW_LATENCY,
+	/// Coalesce packets into larger writes, up to a size or time bound.
+	LATENCY_MODE_THROUGHPUT,
+	/// Select one of the above, depending on the packet rate.
+	LATENCY_MODE_AUTO,
+};
+
+struct output_common_stream_writes {
+	/// Configured latency mode, and whether throughput mode is in use right now.
+	enum output_common_latency_mode mode;
+	bool throughput;
+	/// Throughput mode: write once this many bytes are queued for a client, or
+	/// once its oldest queued packet waited this long (in ns).
+	size_t batchSize;
+	uint64_t batchDelay;
+	/// Throughput mode: set TCP_CORK on TCP clients, to only send full segments.
+	bool tcpCork;
+	/// Auto mode: switch to throughput mode above, and back to low-latency mode
+	/// below, these packet rates (packets/s). The rate is measured over
+	/// rateInterval (in ns).
+	uint64_t throughputRate;
+	uint64_t lowLatencyRate;
+	uint64_t rateInterval;
+	/// Auto mode: packets since the last packet rate check, and its time (uv_hrtime()).
+	uint64_t ratePackets;
+	uint64_t rateCheckTime;
+	/// Statistics: write requests and bytes written to all clients, and if
+	/// throughput mode is in use (for display).
+	atomic_uint_fast64_t writes;
+	atomic_uint_fast64_t bytesWritten;
+	atomic_bool throughputActive;
+	/// Time writing started (uv_hrtime()), to calculate the write rate.
+	uint64_t startTime;
+	/// Reference to the statistics node of the stream writes.
+	sshsNode statisticsNode;
+};
+
+struct output_common_client_write {
+	/// libuv write request, for all packets below in one go (writev).
+	uv_write_t request;
+	/// Packets written, one reference each, released once written.
+	size_t packetsSize;
+	libuvWriteMultiBuf packets[];
+};
+
+struct output_common_client_queue_entry {
+	/// Packet data, reference-counted and shared with all other clients.
+	libuvWriteMultiBuf buffers;
+	/// Special events or key frames only, kept by CLIENT_POLICY_KEY_PACKETS_ONLY.
+	bool keyPacket;
+	/// Time the packet was queued (uv_hrtime()), to calculate the client lag.
+	uint64_t queueTime;
+};
+
+struct output_common_client {
+	/// Packets waiting to be handed to libuv, oldest first. Only as much data
+	/// as the client can currently take is handed on, the rest waits here,
+	/// where the slow client policy can act on it.
+	struct output_common_client_queue_entry queue[CLIENT_QUEUE_MAX_PACKETS];
+	size_t queueHead;
+	size_t queueSize;
+	size_t queueBytes;
+	/// CLIENT_POLICY_KEY_PACKETS_ONLY currently active.
+	bool keyPacketsOnly;
+	/// Remote address and port, for display.
+	char address[CLIENT_ADDRESS_MAX_LENGTH];
+	/// Statistics: packets and bytes handed on to be sent, packets dropped,
+	/// bytes currently queued and queue time of the oldest queued packet (0 if none).
+	atomic_uint_fast64_t packetsSent;
+	atomic_uint_fast64_t bytesSent;
+	atomic_uint_fast64_t packetsDropped;
+	atomic_uint_fast64_t queuedBytes;
+	atomic_uint_fast64_t oldestQueueTime;
+	/// Time the client connected (uv_hrtime()), to calculate throughput.
+	uint64_t connectTime;
+	/// Reference to the statistics node of this client (server mode only).
+	sshsNode statisticsNode;
+};
 
 struct output_common_netio {
 	/// Keep the full network header around, so we can easily update and write it.
@@ -22,7 +176,21 @@ struct output_common_netio {
 	void *address;
 	uv_loop_t loop;
 	uv_async_t shutdown;
-	uv_idle_t ringBufferGet;
+	/// Signalled on new data in the output ring-buffer.
+	uv_async_t ringBufferGet;
+	/// Throughput mode: writes batches that waited long enough (TCP/Pipe only).
+	uv_timer_t writeBatchTimer;
+	/// Batched sending support (UDP only).
+	struct output_common_udp_batch udpBatch;
+	/// Per-client send queues (TCP/Pipe only), one per entry in clients.
+	struct output_common_client *clientQueues;
+	/// Maximum bytes queued per client, and what to do with slow clients that exceed it.
+	size_t clientQueueLimit;
+	enum output_common_client_policy clientPolicy;
+	/// Write coalescing support (TCP/Pipe only).
+	struct output_common_stream_writes streamWrites;
+	/// Module configuration node, for the connected clients list and statistics.
+	sshsNode moduleNode;
 	uv_stream_t *server;
 	size_t activeClients;
 	size_t clientsSize;
@@ -31,6 +199,26 @@ struct output_common_netio {
 
 typedef struct output_common_netio *outputCommonNetIO;
 
+struct output_common_live_mode {
+	/// Keep only the newest data, dropping older data the output can't keep up with.
+	atomic_bool enabled;
+	/// Maximum number of packet containers waiting to be compressed.
+	atomic_uint_fast32_t containersNumber;
+	/// Packet containers taken from the transfer ring-buffer, oldest first
+	/// (compressor thread only).
+	caerEventPacketContainer window[LIVE_MODE_MAX_CONTAINERS];
+	size_t windowHead;
+	size_t windowSize;
+	/// Packet buffers taken from the output ring-buffer, oldest first (output
+	/// thread only). Beyond this, the oldest non-key ones are dropped.
+	libuvWriteBuf outputWindow[LIVE_MODE_MAX_PACKETS];
+	size_t outputWindowHead;
+	size_t outputWindowSize;
+	/// Statistics: packet containers and packets dropped to keep up.
+	atomic_uint_fast64_t containersDropped;
+	atomic_uint_fast64_t packetsDropped;
+};
+
 struct output_common_statistics {
 	uint64_t packetsNumber;
 	uint64_t packetsTotalSize;
@@ -39,6 +227,185 @@ struct output_common_statistics {
 	uint64_t dataWritten;
 };
 
+struct output_common_compression_context {
+	/// Scratch memory for general-purpose compression, grown as needed.
+	uint8_t *buffer;
+	size_t bufferSize;
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	/// Zstd compression context, created on first use.
+	ZSTD_CCtx *zstdContext;
+#endif
+};
+
+struct output_common_compression_worker {
+	/// Worker number, for thread naming and statistics.
+	size_t index;
+	/// Reference to common output state (for compression settings and logging).
+	struct output_common_state *state;
+	/// Compression worker thread.
+	thrd_t thread;
+	/// Packet buffers to compress, handed out in stream order by the compressor thread.
+	caerRingBuffer inputRing;
+	/// Compressed packet buffers, in the same order they came in.
+	caerRingBuffer outputRing;
+	/// Compression context, owned by the worker thread.
+	struct output_common_compression_context context;
+	/// Statistics: packets compressed, bytes before/after compression and
+	/// time spent compressing (in ns), to calculate utilization.
+	atomic_uint_fast64_t packets;
+	atomic_uint_fast64_t bytesIn;
+	atomic_uint_fast64_t bytesOut;
+	atomic_uint_fast64_t busyTime;
+	/// Reference to the statistics node of this worker.
+	sshsNode statisticsNode;
+};
+
+struct output_common_compression_group {
+	/// Protects members: the output compressing for the group goes through them
+	/// for every packet, while outputs join and leave.
+	mtx_t lock;
+	/// Output modules with the same source and compression settings, in the
+	/// order they joined. The first one compresses packets for all of them.
+	struct output_common_state *members[MAX_COMPRESSION_GROUP_MEMBERS];
+	size_t membersSize;
+};
+
+struct output_common_compression {
+	/// Number of compression workers, 0 to compress on the compressor thread itself.
+	size_t workersNumber;
+	/// Worker threads were started and have to be joined.
+	bool workersStarted;
+	/// Control flag for compression worker threads. Separate from 'running',
+	/// as they must outlive it to flush all packets still in flight.
+	atomic_bool workersRunning;
+	/// Next worker to hand a packet to (round-robin).
+	size_t dispatchIndex;
+	/// Next worker to collect a compressed packet from. Following the same
+	/// round-robin order as dispatch restores the original packet order.
+	size_t collectIndex;
+	/// Packets handed to workers and not yet collected.
+	size_t packetsInFlight;
+	/// Time compression started, to calculate worker utilization.
+	struct timespec startTime;
+	/// Compression context of the compressor thread itself.
+	struct output_common_compression_context context;
+	/// FastFrames delta mode: key frame interval (0 for key frames only), and
+	/// last frame per ROI identifier. Frame packets are then compressed in stream
+	/// order on the compressor thread, as each frame depends on the previous one.
+	int32_t frameDeltaInterval;
+	struct caer_frame_codec_reference frameReferences[FRAME_CODEC_MAX_REFERENCES];
+	/// Last frame packet compressed in delta mode had key frames only.
+	bool frameKeyPacket;
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	/// Zstd compression level and optional dictionary, shared by all threads.
+	int zstdLevel;
+	ZSTD_CDict *zstdDictionary;
+#endif
+	/// Compression workers.
+	struct output_common_compression_worker workers[MAX_COMPRESSION_WORKERS];
+	/// Compression settings, identifying the group to share compression with
+	/// ('shareCompression'), NULL if not sharing. The source ID is added on joining.
+	char *groupSettings;
+	/// Shared state name and compression group, once joined (on the first packet
+	/// from the source). Set before any packet reaches the compressor thread.
+	char *groupName;
+	struct output_common_compression_group *group;
+	/// Statistics: compressed packets from the group dropped, output ring-buffer full.
+	atomic_uint_fast64_t groupPacketsDropped;
+};
+
+struct output_common_file_writer {
+	/// Data is collected here and written out in large blocks. Aligned to
+	/// FILE_WRITER_ALIGNMENT, as required for O_DIRECT.
+	uint8_t *buffer;
+	/// Size of buffer, a multiple of FILE_WRITER_ALIGNMENT.
+	size_t bufferSize;
+	/// Bytes of data currently held in buffer.
+	size_t bufferUsed;
+	/// File was opened with O_DIRECT: writes must be aligned in size and offset.
+	bool directIO;
+	/// Bytes written to the file so far.
+	uint64_t fileOffset;
+	/// Size of extents to preallocate file space in (0 to disable), and how
+	/// much of the file is preallocated already.
+	uint64_t preallocateSize;
+	uint64_t preallocatedEnd;
+	/// Time of the last write, to not keep data buffered for long when idle.
+	struct timespec lastWriteTime;
+	/// Time writing started, to calculate throughput.
+	struct timespec startTime;
+	/// Statistics: number of writes, bytes written, and time spent in writes
+	/// (total and longest single write, in ns).
+	atomic_uint_fast64_t writes;
+	atomic_uint_fast64_t bytesWritten;
+	atomic_uint_fast64_t writeTime;
+	atomic_uint_fast64_t writeTimeMax;
+	/// Reference to the statistics node of the file writer.
+	sshsNode statisticsNode;
+};
+
+struct output_common_file_segments {
+	/// Open the file for the given segment, returns its file descriptor, or
+	/// -1 on failure, and its path in filePath (to be free()'d).
+	/// Segment files are opened with FILE_SEGMENT_PARTIAL_SUFFIX appended to
+	/// their path, which is removed once the segment is complete.
+	/// Set by the file output module before common initialization, NULL to
+	/// write a single file.
+	int (*openFile)(caerModuleData moduleData, size_t segment, char **filePath);
+	/// Start a new segment after this many bytes, 0 for no size limit.
+	/// Set by the file output module before common initialization.
+	uint64_t maxSize;
+	/// Start a new segment after this many seconds, 0 for no time limit.
+	/// Set by the file output module before common initialization.
+	int64_t maxDuration;
+	/// Number of the current segment.
+	size_t number;
+	/// Path of the current segment file.
+	char *filePath;
+	/// When the current segment was started.
+	struct timespec startTime;
+	/// Position of the '#Index-Offset' header line in the current segment.
+	uint64_t indexHeaderPosition;
+	/// Index of the event packets in the current segment.
+	struct inout_index_entry *index;
+	size_t indexSize;
+	size_t indexCapacity;
+	/// Index memory could not be allocated, the current segment gets no index.
+	bool indexFailed;
+	/// The segment thread: opens the next segment file and completes finished
+	/// segments (sync, close, rename) in the background, so the output thread
+	/// never stalls when switching segments.
+	thrd_t segmentThread;
+	/// Segment thread was started and has to be joined on exit.
+	bool threadStarted;
+	/// Protects running, nextReady and finishedPending, and the segment files
+	/// they refer to. The segment thread waits on 'changed' for work.
+	mtx_t lock;
+	cnd_t changed;
+	/// Control flag for the segment thread.
+	bool running;
+	/// Number of the next segment the segment thread will open.
+	size_t nextNumber;
+	/// Next segment file is open and ready to be switched to.
+	bool nextReady;
+	int nextFileDescriptor;
+	char *nextFilePath;
+	/// Finished segment waiting to be completed by the segment thread.
+	bool finishedPending;
+	int finishedFileDescriptor;
+	char *finishedFilePath;
+};
+
+/// Packet buffer as passed from the compressor to the output thread. The libuv
+/// write buffer comes first, so this can be used and freed as a libuvWriteBuf.
+struct output_common_packet_buffer {
+	struct libuvWriteBufStruct writeBuffer;
+	/// First timestamp of the packet, not readable anymore after compression.
+	int64_t timestamp;
+	/// Special events or key frames, that slow network clients should still get.
+	bool keyPacket;
+};
+
 struct output_common_state {
 	/// Control flag for output handling thread.
 	atomic_bool running;
@@ -57,6 +424,10 @@ struct output_common_state {
 	char *sourceInfoString;
 	/// The file descriptor for file writing.
 	int fileIO;
+	/// Large block writing support (files only).
+	struct output_common_file_writer fileWriter;
+	/// Segmented recording support (files only).
+	struct output_common_file_segments segments;
 	/// Network-like stream or file-like stream. Matters for header format.
 	bool isNetworkStream;
 	/// The libuv stream descriptors for network writing and server mode.
@@ -67,6 +438,8 @@ struct output_common_state {
 	/// This results in no loss of data, but may slow down processing considerably.
 	/// It may also block it altogether, if the output goes away for any reason.
 	atomic_bool keepPackets;
+	/// Live streaming support (network outputs only).
+	struct output_common_live_mode liveMode;
 	/// Transfer packets coming from a mainloop run to the compression handling thread.
 	/// We use EventPacketContainers as data structure for convenience, they do exactly
 	/// keep track of the data we do want to transfer and are part of libcaer.
@@ -77,6 +450,8 @@ struct output_common_state {
 	int64_t lastTimestamp;
 	/// Support different formats, providing data compression.
 	int8_t formatID;
+	/// Parallel compression support.
+	struct output_common_compression compression;
 	/// Output module statistics collection.
 	struct output_common_statistics statistics;
 	/// Reference to parent module's original data.
@@ -0,0 +1,503 @@
+#include "caer-sdk/cross/portable_io.h"
+#include "caer-sdk/cross/portable_time.h"
+#include "caer-sdk/mainloop.h"
+
+#include "../inout_shm.h"
+
+#include <libcaer/events/packetContainer.h>
+#include <libcaer/events/special.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHM_WRITER_SPIN_TIME 5000 // ns to spin on readers still copying a slot, never sleep.
+
+struct shm_output_state {
+	/// Shared memory segment name (with SHM_NAME_PREFIX).
+	char *segmentName;
+	/// The mapped shared memory segment.
+	struct caer_shm_header *segment;
+	size_t segmentSize;
+	/// Per slot, sequence number of the container a reader didn't release
+	/// in time. The slot isn't written again until it does.
+	uint64_t *releasePending;
+	/// Track source ID (cannot change!). One source per output module!
+	int16_t sourceID;
+	/// Last timestamp written, for the TS_RESET packet overflow.
+	int64_t lastTimestamp;
+	/// Statistics: containers written and dropped (too big, or a reader didn't release its slot).
+	uint64_t containersWritten;
+	uint64_t containersDropped;
+};
+
+typedef struct shm_output_state *shmOutputState;
+
+static bool caerOutputShmInit(caerModuleData moduleData);
+static void caerOutputShmRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out);
+static void caerOutputShmExit(caerModuleData moduleData);
+static void caerOutputShmReset(caerModuleData moduleData, int16_t resetCallSourceID);
+static bool shmRemoveStale(caerModuleData moduleData, const char *segmentName);
+static void shmSetupSource(caerModuleData moduleData, int16_t sourceID);
+static bool shmClaimSlot(caerModuleData moduleData, size_t slotIndex);
+static void shmWriteContainer(caerModuleData moduleData, caerEventPacketHeaderConst *packets, size_t packetsSize);
+
+static const struct caer_module_functions OutputShmFunctions = {.moduleInit = &caerOutputShmInit,
+	.moduleRun                                                              = &caerOutputShmRun,
+	.moduleConfig                                                           = NULL,
+	.moduleExit                                                             = &caerOutputShmExit,
+	.moduleReset                                                            = &caerOutputShmReset};
+
+static const struct caer_event_stream_in OutputShmInputs[] = {{.type = -1, .number = -1, .readOnly = true}};
+
+static const struct caer_module_info OutputShmInfo = {
+	.version           = 1,
+	.name              = "ShmOutput",
+	.description       = "Send AEDAT 3 packet containers to other processes through shared memory.",
+	.type              = CAER_MODULE_OUTPUT,
+	.memSize           = sizeof(struct shm_output_state),
+	.functions         = &OutputShmFunctions,
+	.inputStreams      = OutputShmInputs,
+	.inputStreamsSize  = CAER_EVENT_STREAM_IN_SIZE(OutputShmInputs),
+	.outputStreams     = NULL,
+	.outputStreamsSize = 0,
+};
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&OutputShmInfo);
+}
+
+static bool caerOutputShmInit(caerModuleData moduleData) {
+	shmOutputState state = moduleData->moduleState;
+
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "caer", 1, 200, SSHS_FLAGS_NORMAL,
+		"Name of the shared memory segment to create (" SHM_NAME_PREFIX "NAME).");
+	sshsNodeCreateInt(moduleData->moduleNode, "slotsNumber", 64, 4, 1024, SSHS_FLAGS_NORMAL,
+		"Number of packet containers the shared memory can hold.");
+	sshsNodeCreateInt(moduleData->moduleNode, "slotSize", 1024, 16, 65536, SSHS_FLAGS_NORMAL,
+		"Maximum size of a packet container in KB, bigger ones are dropped.");
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+
+	size_t segmentNameLength = strlen(SHM_NAME_PREFIX) + strlen(shmName);
+
+	state->segmentName = malloc(segmentNameLength + 1);
+	if (state->segmentName == NULL) {
+		free(shmName);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for shared memory name.");
+		return (false);
+	}
+
+	snprintf(state->segmentName, segmentNameLength + 1, SHM_NAME_PREFIX "%s", shmName);
+	free(shmName);
+
+	uint32_t slotsNumber = U32T(sshsNodeGetInt(moduleData->moduleNode, "slotsNumber"));
+	uint64_t slotSize    = U64T(sshsNodeGetInt(moduleData->moduleNode, "slotSize")) * 1024;
+
+	state->segmentSize = SHM_DATA_OFFSET(slotsNumber) + (slotsNumber * slotSize);
+
+	state->releasePending = malloc(slotsNumber * sizeof(uint64_t));
+	if (state->releasePending == NULL) {
+		free(state->segmentName);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for slot states.");
+		return (false);
+	}
+
+	for (size_t i = 0; i < slotsNumber; i++) {
+		state->releasePending[i] = SHM_NO_SEQUENCE;
+	}
+
+	int shmFd = shm_open(state->segmentName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+	if ((shmFd < 0) && (errno == EEXIST) && shmRemoveStale(moduleData, state->segmentName)) {
+		shmFd = shm_open(state->segmentName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+	}
+
+	if (shmFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to create shared memory '%s'. Error: %d.",
+			state->segmentName, errno);
+		free(state->releasePending);
+		free(state->segmentName);
+		return (false);
+	}
+
+	if (ftruncate(shmFd, (off_t) state->segmentSize) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to size shared memory to %zu bytes. Error: %d.",
+			state->segmentSize, errno);
+		close(shmFd);
+		shm_unlink(state->segmentName);
+		free(state->releasePending);
+		free(state->segmentName);
+		return (false);
+	}
+
+	state->segment = mmap(NULL, state->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+
+	// The mapping stays valid without the file descriptor.
+	close(shmFd);
+
+	if (state->segment == MAP_FAILED) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to map shared memory. Error: %d.", errno);
+		shm_unlink(state->segmentName);
+		free(state->releasePending);
+		free(state->segmentName);
+		return (false);
+	}
+
+	// Fresh memory from ftruncate() is all zeros, only set what differs.
+	struct caer_shm_header *segment = state->segment;
+
+	segment->version     = SHM_VERSION;
+	segment->slotsNumber = slotsNumber;
+	segment->slotSize    = slotSize;
+	segment->dataOffset  = SHM_DATA_OFFSET(slotsNumber);
+	segment->writerPid   = U32T(getpid());
+
+	atomic_store(&segment->writerActive, 1);
+
+	for (size_t i = 0; i < SHM_MAX_READERS; i++) {
+		atomic_store(&segment->readers[i].readSequence, SHM_NO_SEQUENCE);
+	}
+
+	for (size_t i = 0; i < slotsNumber; i++) {
+		atomic_store(&segment->slots[i].sequence, SHM_NO_SEQUENCE);
+	}
+
+	// Ready for readers now.
+	atomic_store_explicit(&segment->magicNumber, SHM_MAGIC_NUMBER, memory_order_release);
+
+	state->sourceID = -1;
+
+	sshsNodeCreateLong(moduleData->moduleNode, "containersDropped", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Packet containers dropped, because too big or a reader didn't release its slot in time.");
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Shared memory '%s' ready, %" PRIu32 " slots of %" PRIu64 " bytes.",
+		state->segmentName, slotsNumber, slotSize);
+
+	return (true);
+}
+
+static void caerOutputShmRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
+	UNUSED_ARGUMENT(out);
+
+	shmOutputState state = moduleData->moduleState;
+
+	if (in == NULL) {
+		return;
+	}
+
+	caerEventPacketHeaderConst packets[caerEventPacketContainerGetEventPacketsNumber(in)];
+	size_t packetsSize = 0;
+
+	// Collect non-empty event packets from our source.
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
+		caerEventPacketHeaderConst packetHeader = caerEventPacketContainerGetEventPacketConst(in, i);
+
+		if ((packetHeader == NULL) || (caerEventPacketHeaderGetEventNumber(packetHeader) == 0)) {
+			continue;
+		}
+
+		int16_t eventSource = caerEventPacketHeaderGetEventSource(packetHeader);
+
+		if (state->sourceID == -1) {
+			shmSetupSource(moduleData, eventSource);
+		}
+		else if (state->sourceID != eventSource) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR,
+				"An output module can only handle packets from the same source! "
+				"A packet with source %" PRIi16
+				" was sent, but this output module expects only packets from source %" PRIi16 ".",
+				eventSource, state->sourceID);
+			continue;
+		}
+
+		packets[packetsSize++] = packetHeader;
+
+		int64_t lastTimestamp = caerGenericEventGetTimestamp64(
+			caerGenericEventGetEvent(packetHeader, caerEventPacketHeaderGetEventNumber(packetHeader) - 1),
+			packetHeader);
+		if (lastTimestamp > state->lastTimestamp) {
+			state->lastTimestamp = lastTimestamp;
+		}
+	}
+
+	if (packetsSize == 0) {
+		return;
+	}
+
+	shmWriteContainer(moduleData, packets, packetsSize);
+}
+
+static void caerOutputShmExit(caerModuleData moduleData) {
+	shmOutputState state = moduleData->moduleState;
+
+	// Tell readers we're gone, they keep their mapping until they let go of it.
+	atomic_store(&state->segment->writerActive, 0);
+	caerShmWake(&state->segment->wakeup);
+
+	munmap(state->segment, state->segmentSize);
+	shm_unlink(state->segmentName);
+
+	free(state->releasePending);
+	free(state->segmentName);
+
+	sshsNodeRemoveAttribute(moduleData->moduleNode, "containersDropped", SSHS_LONG);
+
+	caerModuleLog(moduleData, CAER_LOG_INFO,
+		"Statistics: wrote %" PRIu64 " packet containers to shared memory, dropped %" PRIu64 ".",
+		state->containersWritten, state->containersDropped);
+}
+
+static void caerOutputShmReset(caerModuleData moduleData, int16_t resetCallSourceID) {
+	shmOutputState state = moduleData->moduleState;
+
+	if (resetCallSourceID != state->sourceID) {
+		return;
+	}
+
+	// Send lone packet container with just TS_RESET, so readers reset too.
+	caerSpecialEventPacket tsResetPacket
+		= caerSpecialEventPacketAllocate(1, resetCallSourceID, I32T(state->lastTimestamp >> 31));
+	if (tsResetPacket == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Failed to allocate tsReset special event packet.");
+		return;
+	}
+
+	caerSpecialEvent tsResetEvent = caerSpecialEventPacketGetEvent(tsResetPacket, 0);
+	caerSpecialEventSetTimestamp(tsResetEvent, INT32_MAX);
+	caerSpecialEventSetType(tsResetEvent, TIMESTAMP_RESET);
+	caerSpecialEventValidate(tsResetEvent, tsResetPacket);
+
+	caerEventPacketHeaderConst packets[1] = {(caerEventPacketHeaderConst) tsResetPacket};
+	shmWriteContainer(moduleData, packets, 1);
+
+	free(tsResetPacket);
+
+	state->lastTimestamp = 0;
+}
+
+/**
+ * Remove a segment left over by a writer that didn't exit properly. Readers
+ * still having it mapped keep it until they let go. A segment whose writer
+ * is still running is left alone.
+ *
+ * @param moduleData module data.
+ * @param segmentName name of the existing segment.
+ *
+ * @return true if the segment was removed, false if it is in use.
+ */
+static bool shmRemoveStale(caerModuleData moduleData, const char *segmentName) {
+	int shmFd = shm_open(segmentName, O_RDONLY, 0);
+	if (shmFd < 0) {
+		// Gone meanwhile.
+		return (errno == ENOENT);
+	}
+
+	struct stat shmStat;
+	struct caer_shm_header *segment = MAP_FAILED;
+
+	if ((fstat(shmFd, &shmStat) == 0) && ((size_t) shmStat.st_size >= sizeof(struct caer_shm_header))) {
+		segment = mmap(NULL, sizeof(struct caer_shm_header), PROT_READ, MAP_SHARED, shmFd, 0);
+	}
+
+	close(shmFd);
+
+	if (segment != MAP_FAILED) {
+		bool writerAlive = (atomic_load_explicit(&segment->magicNumber, memory_order_acquire) == SHM_MAGIC_NUMBER)
+						   && caerShmWriterAlive(segment);
+		pid_t writerPid = (pid_t) segment->writerPid;
+
+		munmap(segment, sizeof(struct caer_shm_header));
+
+		if (writerAlive) {
+			caerModuleLog(
+				moduleData, CAER_LOG_ERROR, "Shared memory '%s' is in use by process %d.", segmentName, writerPid);
+			errno = EEXIST;
+			return (false);
+		}
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Removing stale shared memory '%s'.", segmentName);
+
+	return ((shm_unlink(segmentName) == 0) || (errno == ENOENT));
+}
+
+/**
+ * Publish source information for readers, from the first packet's source.
+ *
+ * @param moduleData module data.
+ * @param sourceID source ID of the event packets.
+ */
+static void shmSetupSource(caerModuleData moduleData, int16_t sourceID) {
+	shmOutputState state            = moduleData->moduleState;
+	struct caer_shm_header *segment = state->segment;
+
+	state->sourceID = sourceID;
+
+	sshsNode sourceInfoNode = caerMainloopGetSourceInfo(sourceID);
+	if (sourceInfoNode == NULL) {
+		// This should never happen, but we handle it gracefully.
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to get source info to setup output module.");
+		return;
+	}
+
+	static const char *sourceSizeKeys[SHM_SOURCE_SIZES] = {"polaritySizeX", "polaritySizeY", "frameSizeX",
+		"frameSizeY", "dataSizeX", "dataSizeY", "visualizerSizeX", "visualizerSizeY"};
+
+	for (size_t i = 0; i < SHM_SOURCE_SIZES; i++) {
+		segment->sourceSizes[i] = (sshsNodeAttributeExists(sourceInfoNode, sourceSizeKeys[i], SSHS_INT))
+									  ? (I16T(sshsNodeGetInt(sourceInfoNode, sourceSizeKeys[i])))
+									  : (0);
+	}
+
+	char *sourceString = sshsNodeGetString(sourceInfoNode, "sourceString");
+	strncpy(segment->sourceString, sourceString, SHM_SOURCE_STRING_SIZE - 1);
+	segment->sourceString[SHM_SOURCE_STRING_SIZE - 1] = '\0';
+	free(sourceString);
+
+	segment->sourceID = sourceID;
+
+	atomic_store_explicit(&segment->sourceReady, 1, memory_order_release);
+	caerShmWake(&segment->wakeup);
+}
+
+/**
+ * Take a slot away from readers, before writing to it. This runs in the
+ * mainloop, so readers currently holding it are only spun on very briefly
+ * (SHM_WRITER_SPIN_TIME in total), or removed if their process doesn't exist
+ * anymore. If a reader didn't release it by then, the container is dropped,
+ * and the slot is only checked again, without spinning, on the following claims.
+ *
+ * @param moduleData module data.
+ * @param slotIndex index of the slot about to be written to.
+ *
+ * @return true if the slot can be written, false if a reader didn't release it in time.
+ */
+static bool shmClaimSlot(caerModuleData moduleData, size_t slotIndex) {
+	shmOutputState state            = moduleData->moduleState;
+	struct caer_shm_header *segment = state->segment;
+	struct caer_shm_slot *slot      = &segment->slots[slotIndex];
+
+	uint64_t oldSequence = atomic_load(&slot->sequence);
+
+	// Invalidate first, then look for readers: a reader that starts holding
+	// the slot after this will see it's invalid and skip it.
+	atomic_store(&slot->sequence, SHM_NO_SEQUENCE);
+
+	int64_t spinTimeout = SHM_WRITER_SPIN_TIME;
+
+	if (oldSequence == SHM_NO_SEQUENCE) {
+		// Already invalid, but a reader may still hold what was there before.
+		oldSequence = state->releasePending[slotIndex];
+		spinTimeout = 0;
+
+		if (oldSequence == SHM_NO_SEQUENCE) {
+			return (true);
+		}
+	}
+
+	// One spin budget for all readers together, so many readers can't add up.
+	struct timespec spinStart;
+	portable_clock_gettime_monotonic(&spinStart);
+
+	for (size_t i = 0; i < SHM_MAX_READERS; i++) {
+		struct caer_shm_reader *reader = &segment->readers[i];
+
+		while (atomic_load(&reader->readSequence) == oldSequence) {
+			struct timespec currentTime;
+			portable_clock_gettime_monotonic(&currentTime);
+
+			int64_t spinTime = ((int64_t)(currentTime.tv_sec - spinStart.tv_sec) * 1000000000LL)
+							   + (int64_t)(currentTime.tv_nsec - spinStart.tv_nsec);
+
+			if (spinTime >= spinTimeout) {
+				pid_t readerPid = (pid_t) atomic_load(&reader->pid);
+
+				if ((kill(readerPid, 0) != 0) && (errno == ESRCH)) {
+					// Reader crashed, free its entry.
+					caerModuleLog(moduleData, CAER_LOG_WARNING, "Removing reader %d, its process is gone.", readerPid);
+
+					atomic_store(&reader->readSequence, SHM_NO_SEQUENCE);
+					atomic_store(&reader->pid, 0);
+					break;
+				}
+
+				// Still held: remember by whom, the slot stays invalid meanwhile.
+				state->releasePending[slotIndex] = oldSequence;
+				return (false);
+			}
+		}
+	}
+
+	state->releasePending[slotIndex] = SHM_NO_SEQUENCE;
+
+	return (true);
+}
+
+/**
+ * Write event packets as one packet container to the next slot, and publish it.
+ *
+ * @param moduleData module data.
+ * @param packets event packets to write.
+ * @param packetsSize number of event packets.
+ */
+static void shmWriteContainer(caerModuleData moduleData, caerEventPacketHeaderConst *packets, size_t packetsSize) {
+	shmOutputState state            = moduleData->moduleState;
+	struct caer_shm_header *segment = state->segment;
+
+	size_t containerSize = 0;
+	for (size_t i = 0; i < packetsSize; i++) {
+		containerSize += SHM_PACKET_SIZE(packets[i]);
+	}
+
+	uint64_t sequence          = atomic_load_explicit(&segment->writeSequence, memory_order_relaxed);
+	size_t slotIndex           = sequence % segment->slotsNumber;
+	struct caer_shm_slot *slot = &segment->slots[slotIndex];
+
+	if ((containerSize > segment->slotSize) || !shmClaimSlot(moduleData, slotIndex)) {
+		if (state->containersDropped == 0) {
+			caerModuleLog(moduleData, CAER_LOG_WARNING,
+				"Dropped packet container of %zu bytes (too big, or a reader is stuck). Further drops are only "
+				"counted in 'containersDropped'.",
+				containerSize);
+		}
+
+		state->containersDropped++;
+		sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "containersDropped", SSHS_LONG,
+			(union sshs_node_attr_value){.ilong = I64T(state->containersDropped)});
+		return;
+	}
+
+	uint8_t *slotData = ((uint8_t *) segment) + segment->dataOffset + (slotIndex * segment->slotSize);
+	size_t slotOffset = 0;
+
+	for (size_t i = 0; i < packetsSize; i++) {
+		size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE
+							+ (size_t)(caerEventPacketHeaderGetEventNumber(packets[i])
+									   * caerEventPacketHeaderGetEventSize(packets[i]));
+
+		memcpy(slotData + slotOffset, packets[i], packetSize);
+
+		// Capacity is always equal to number in streams.
+		caerEventPacketHeaderSetEventCapacity(
+			(caerEventPacketHeader)(slotData + slotOffset), caerEventPacketHeaderGetEventNumber(packets[i]));
+
+		slotOffset += SHM_PACKET_SIZE(packets[i]);
+	}
+
+	slot->size          = slotOffset;
+	slot->packetsNumber = U32T(packetsSize);
+
+	// Publish: slot first, then the new sequence readers wait for.
+	atomic_store_explicit(&slot->sequence, sequence, memory_order_release);
+	atomic_store_explicit(&segment->writeSequence, sequence + 1, memory_order_release);
+
+	caerShmWake(&segment->wakeup);
+
+	state->containersWritten++;
+}
@@ -0,0 +1,376 @@
+/*
+ * Benchmark for the input/output codecs, on the synthetic data from
+ * inout_test_data.h. Prints compression ratio and encode/decode throughput
+ * (MB/s of uncompressed data, single thread) for each codec.
+ * Not run by CTest, as results depend on the machine; run it directly on
+ * a Release build: modules/inout/tests/inout_codec_bench
+ */
+
+#include "inout_test_data.h"
+#include "modules/inout/inout_frame_codec.h"
+#include "modules/inout/inout_packet_compression.h"
+#include "modules/inout/inout_polarity_delta.h"
+#include "modules/inout/inout_serialized_ts.h"
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+#include <png.h>
+#endif
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Events per packet, a typical size for polarity packets from DAVIS cameras.
+#define BENCH_PACKET_EVENTS 4096
+// Packets per measurement.
+#define BENCH_PACKETS 2000
+// Frames per measurement, DAVIS346 resolution.
+#define BENCH_FRAMES 200
+#define BENCH_FRAME_X 346
+#define BENCH_FRAME_Y 260
+
+struct bench_result {
+	size_t rawBytes;
+	size_t encodedBytes;
+	double encodeSeconds;
+	double decodeSeconds;
+};
+
+static double benchNow(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((double) now.tv_sec + ((double) now.tv_nsec / 1.0e9));
+}
+
+static void *benchMalloc(size_t size) {
+	void *memory = malloc(size);
+	if (memory == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	return (memory);
+}
+
+static void benchPrint(const char *name, const struct bench_result *result) {
+	double megaBytes = (double) result->rawBytes / 1.0e6;
+
+	printf("%-34s ratio %5.2f  encode %8.1f MB/s", name, (double) result->rawBytes / (double) result->encodedBytes,
+		megaBytes / result->encodeSeconds);
+
+	if (result->decodeSeconds > 0) {
+		printf("  decode %8.1f MB/s", megaBytes / result->decodeSeconds);
+	}
+
+	printf("\n");
+}
+
+/**
+ * Serialized timestamps, current encoder and decoder, or the 1.2.1 encoder
+ * (no decoder timing then). Events have runs of equal timestamps depending
+ * on density, see serializedTSGenerate().
+ */
+static void benchSerializedTS(size_t eventSize, uint32_t density, bool reference) {
+	size_t tsOffset   = eventSize - sizeof(int32_t);
+	size_t packetSize = BENCH_PACKET_EVENTS * eventSize;
+
+	uint8_t *original = benchMalloc(packetSize);
+	uint8_t *encoded  = benchMalloc(packetSize);
+	uint8_t *decoded  = benchMalloc(packetSize);
+
+	// Same data for the old and new encoder.
+	randomSeed(density);
+	serializedTSGenerate(original, BENCH_PACKET_EVENTS, eventSize, tsOffset, density, 1000);
+
+	struct bench_result result = {0};
+
+	for (size_t p = 0; p < BENCH_PACKETS; p++) {
+		// Encoding is in place, so every run starts from a fresh copy (also timed,
+		// the same for both encoders).
+		double start = benchNow();
+		memcpy(encoded, original, packetSize);
+		size_t encodedSize = (reference)
+								 ? (serializedTSEncodeReference(encoded, BENCH_PACKET_EVENTS, eventSize, tsOffset))
+								 : (caerSerializedTSEncode(encoded, BENCH_PACKET_EVENTS, eventSize, tsOffset));
+		result.encodeSeconds += benchNow() - start;
+
+		if (!reference) {
+			start = benchNow();
+			caerSerializedTSDecode(encoded, encodedSize, decoded, BENCH_PACKET_EVENTS, eventSize, tsOffset);
+			result.decodeSeconds += benchNow() - start;
+		}
+
+		result.rawBytes += packetSize;
+		result.encodedBytes += encodedSize;
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "SerializedTS %s%zuB runs 1/%" PRIu32, (reference) ? ("1.2.1 ") : (""), eventSize,
+		density);
+	benchPrint(name, &result);
+
+	free(original);
+	free(encoded);
+	free(decoded);
+}
+
+static void benchPolarityDelta(enum polarity_pattern pattern, const char *name) {
+	size_t packetSize = BENCH_PACKET_EVENTS * sizeof(struct caer_polarity_event);
+
+	struct caer_polarity_event *original = benchMalloc(packetSize);
+	uint8_t *encoded                     = benchMalloc(POLARITY_DELTA_MAX_SIZE(BENCH_PACKET_EVENTS));
+	uint8_t *decoded                     = benchMalloc(packetSize);
+
+	polarityGenerate(original, BENCH_PACKET_EVENTS, pattern);
+
+	struct bench_result result = {0};
+
+	for (size_t p = 0; p < BENCH_PACKETS; p++) {
+		double start       = benchNow();
+		size_t encodedSize = caerPolarityDeltaEncode(encoded, (const uint8_t *) original, BENCH_PACKET_EVENTS);
+		result.encodeSeconds += benchNow() - start;
+
+		start = benchNow();
+		caerPolarityDeltaDecode(decoded, BENCH_PACKET_EVENTS, encoded, encodedSize);
+		result.decodeSeconds += benchNow() - start;
+
+		result.rawBytes += packetSize;
+		result.encodedBytes += encodedSize;
+	}
+
+	benchPrint(name, &result);
+
+	free(original);
+	free(encoded);
+	free(decoded);
+}
+
+/**
+ * FastFrames on a sequence of 10 bit grayscale frames, only key frames or
+ * with delta frames (key frame every 10 frames).
+ */
+static void benchFrameCodec(bool deltaFrames) {
+	size_t pixelNumber = BENCH_FRAME_X * BENCH_FRAME_Y;
+	size_t frameSize   = pixelNumber * sizeof(uint16_t);
+
+	uint16_t *original = benchMalloc(frameSize);
+	uint16_t *decoded  = benchMalloc(frameSize);
+	uint8_t *encoded   = benchMalloc(FRAME_CODEC_MAX_SIZE(pixelNumber));
+
+	struct caer_frame_codec_reference encoderReference = {0};
+	struct caer_frame_codec_reference decoderReference = {0};
+
+	struct bench_result result = {0};
+
+	for (int32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+		frameGenerate(original, BENCH_FRAME_X, BENCH_FRAME_Y, 1, frame, false);
+
+		bool delta        = deltaFrames && (frame % 10 != 0);
+		uint16_t sequence = (uint16_t)(encoderReference.sequence + 1);
+
+		double start       = benchNow();
+		size_t encodedSize = caerFrameCodecEncode(encoded, original, BENCH_FRAME_X, BENCH_FRAME_Y, 1,
+			(delta) ? (&encoderReference) : (NULL), sequence);
+		if (deltaFrames) {
+			caerFrameCodecReferenceUpdate(&encoderReference, original, BENCH_FRAME_X, BENCH_FRAME_Y, 1, sequence);
+		}
+		result.encodeSeconds += benchNow() - start;
+
+		start = benchNow();
+		caerFrameCodecDecode(decoded, BENCH_FRAME_X, BENCH_FRAME_Y, 1, encoded, encodedSize, &decoderReference);
+		result.decodeSeconds += benchNow() - start;
+
+		result.rawBytes += frameSize;
+		result.encodedBytes += encodedSize;
+	}
+
+	benchPrint((deltaFrames) ? ("FastFrames 346x260 delta 1/10 key") : ("FastFrames 346x260 key only"), &result);
+
+	caerFrameCodecReferenceFree(&encoderReference);
+	caerFrameCodecReferenceFree(&decoderReference);
+
+	free(original);
+	free(decoded);
+	free(encoded);
+}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+
+struct bench_png_buffer {
+	uint8_t *buffer;
+	size_t size;
+	size_t capacity;
+};
+
+static void benchPNGWrite(png_structp png, png_bytep data, png_size_t length) {
+	struct bench_png_buffer *buffer = png_get_io_ptr(png);
+
+	if ((buffer->size + length) > buffer->capacity) {
+		png_error(png, "Write Buffer Error");
+	}
+
+	memcpy(buffer->buffer + buffer->size, data, length);
+	buffer->size += length;
+}
+
+/**
+ * PNG compression of the same frames, with the settings compressFramePNG()
+ * in output_common.c uses. Encoding only, for comparison with FastFrames.
+ */
+static void benchFramePNG(void) {
+	size_t frameSize = BENCH_FRAME_X * BENCH_FRAME_Y * sizeof(uint16_t);
+
+	uint16_t *original = benchMalloc(frameSize);
+	png_bytep rows[BENCH_FRAME_Y];
+
+	struct bench_png_buffer buffer = {.buffer = benchMalloc(frameSize * 2), .size = 0, .capacity = frameSize * 2};
+
+	struct bench_result result = {0};
+
+	for (int32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+		frameGenerate(original, BENCH_FRAME_X, BENCH_FRAME_Y, 1, frame, false);
+
+		for (size_t y = 0; y < BENCH_FRAME_Y; y++) {
+			rows[y] = (png_bytep) &original[y * BENCH_FRAME_X];
+		}
+
+		buffer.size = 0;
+
+		double start = benchNow();
+
+		png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+		png_infop info  = png_create_info_struct(png);
+		if (png == NULL || info == NULL || setjmp(png_jmpbuf(png))) {
+			fprintf(stderr, "PNG compression failure.\n");
+			exit(EXIT_FAILURE);
+		}
+
+		png_set_IHDR(png, info, BENCH_FRAME_X, BENCH_FRAME_Y, 16, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_set_swap(png);
+		png_set_write_fn(png, &buffer, &benchPNGWrite, NULL);
+		png_set_rows(png, info, rows);
+		png_write_png(png, info, PNG_TRANSFORM_IDENTITY, NULL);
+		png_destroy_write_struct(&png, &info);
+
+		result.encodeSeconds += benchNow() - start;
+
+		result.rawBytes += frameSize;
+		result.encodedBytes += buffer.size;
+	}
+
+	benchPrint("PNGFrames 346x260", &result);
+
+	free(original);
+	free(buffer.buffer);
+}
+
+#endif
+
+#if defined(ENABLE_INOUT_LZ4_COMPRESSION) || defined(ENABLE_INOUT_ZSTD_COMPRESSION)
+
+/**
+ * LZ4/Zstd packet compression of polarity events with small steps, as a
+ * stand-in for the other event types (real IMU/special data varies more).
+ */
+static void benchPacketCompression(bool zstd) {
+	size_t packetSize = BENCH_PACKET_EVENTS * sizeof(struct caer_polarity_event);
+
+	struct caer_polarity_event *original = benchMalloc(packetSize);
+	uint8_t *compressed                  = benchMalloc(packetSize);
+	uint8_t *decompressed                = benchMalloc(packetSize);
+
+	polarityGenerate(original, BENCH_PACKET_EVENTS, POLARITY_DENSE);
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_CCtx *compressContext   = ZSTD_createCCtx();
+	ZSTD_DCtx *decompressContext = ZSTD_createDCtx();
+#endif
+
+	struct bench_result result = {0};
+
+	for (size_t p = 0; p < BENCH_PACKETS; p++) {
+		size_t compressedSize = 0;
+
+		double start = benchNow();
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+		if (zstd) {
+			compressedSize = caerPacketCompressZstd(
+				compressContext, NULL, 3, compressed, (const uint8_t *) original, packetSize);
+		}
+#endif
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+		if (!zstd) {
+			compressedSize = caerPacketCompressLZ4(compressed, (const uint8_t *) original, packetSize);
+		}
+#endif
+		result.encodeSeconds += benchNow() - start;
+
+		start = benchNow();
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+		if (zstd) {
+			caerPacketDecompressZstd(
+				decompressContext, NULL, decompressed, packetSize, compressed, compressedSize, NULL);
+		}
+#endif
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+		if (!zstd) {
+			caerPacketDecompressLZ4(decompressed, packetSize, compressed, compressedSize);
+		}
+#endif
+		result.decodeSeconds += benchNow() - start;
+
+		result.rawBytes += packetSize;
+		result.encodedBytes += (compressedSize == 0) ? (packetSize) : (compressedSize);
+	}
+
+	benchPrint((zstd) ? ("ZstdPackets level 3 polarity") : ("LZ4Packets polarity"), &result);
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_freeCCtx(compressContext);
+	ZSTD_freeDCtx(decompressContext);
+#endif
+
+	free(original);
+	free(compressed);
+	free(decompressed);
+}
+
+#endif
+
+int main(void) {
+	printf("SerializedTS: AVX2 %s.\n", (serializedTSUseAVX2(8, 4)) ? ("used") : ("not supported"));
+
+	// Density 1: all timestamps different, no runs. Density 4: runs of 4 events on average.
+	benchSerializedTS(8, 1, true);
+	benchSerializedTS(8, 1, false);
+	benchSerializedTS(8, 4, true);
+	benchSerializedTS(8, 4, false);
+	benchSerializedTS(12, 4, true);
+	benchSerializedTS(12, 4, false);
+
+	benchPolarityDelta(POLARITY_DENSE, "PolarityDelta small steps");
+	benchPolarityDelta(POLARITY_RANDOM, "PolarityDelta random");
+
+	benchFrameCodec(false);
+	benchFrameCodec(true);
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	benchFramePNG();
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	benchPacketCompression(false);
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	benchPacketCompression(true);
+#endif
+
+	return (EXIT_SUCCESS);
+}
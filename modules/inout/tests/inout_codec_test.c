@@ -0,0 +1,594 @@
+/*
+ * Round-trip and robustness tests for the input/output codecs: serialized
+ * timestamps, PolarityDelta, FastFrames and LZ4/Zstd packet compression.
+ * Every codec encodes random and edge-case data, which then has to decode
+ * back to exactly the original. Truncated data must be rejected, and
+ * corrupted data must never make a decoder read or write out of bounds
+ * (best checked with a sanitizer build).
+ * Returns 0 if all tests pass, 1 otherwise.
+ */
+
+#include "inout_test_data.h"
+#include "modules/inout/inout_frame_codec.h"
+#include "modules/inout/inout_packet_compression.h"
+#include "modules/inout/inout_polarity_delta.h"
+#include "modules/inout/inout_serialized_ts.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Report a failed check and leave the enclosing do { } while (0) block of a test
+// case, which then cleans up and returns its result (still false).
+#define CHECK(COND, ...)                                        \
+	if (!(COND)) {                                              \
+		fprintf(stderr, "%s:%d: FAILED: ", __FILE__, __LINE__); \
+		fprintf(stderr, __VA_ARGS__);                           \
+		fprintf(stderr, "\n");                                  \
+		break;                                                  \
+	}
+
+/**
+ * Flip a few random bits in data. Decoders may accept or reject the
+ * result, but must stay within their buffers.
+ */
+static void corrupt(uint8_t *data, size_t size) {
+	if (size == 0) {
+		return;
+	}
+
+	size_t flips = 1 + randomRange(4);
+
+	for (size_t i = 0; i < flips; i++) {
+		data[randomRange((uint32_t) size)] ^= (uint8_t)(1U << randomRange(8));
+	}
+}
+
+// Event counts around the block and run boundaries of the codecs.
+static const size_t edgeSizes[] = {0, 1, 2, 3, 4, 31, 32, 33, 63, 64, 65, 1000};
+#define EDGE_SIZES_NUMBER (sizeof(edgeSizes) / sizeof(edgeSizes[0]))
+
+static bool testSerializedTSCase(size_t eventNumber, size_t eventSize, uint32_t density, int32_t firstTimestamp) {
+	size_t tsOffset = eventSize - sizeof(int32_t);
+	size_t size     = eventNumber * eventSize;
+
+	// One more byte, so zero-size cases don't depend on malloc(0).
+	uint8_t *original  = malloc(size + 1);
+	uint8_t *encoded   = malloc(size + 1);
+	uint8_t *reference = malloc(size + 1);
+	uint8_t *decoded   = malloc(size + 1);
+	if (original == NULL || encoded == NULL || reference == NULL || decoded == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	serializedTSGenerate(original, eventNumber, eventSize, tsOffset, density, firstTimestamp);
+	memcpy(encoded, original, size);
+	memcpy(reference, original, size);
+
+	size_t encodedSize   = caerSerializedTSEncode(encoded, eventNumber, eventSize, tsOffset);
+	size_t referenceSize = serializedTSEncodeReference(reference, eventNumber, eventSize, tsOffset);
+
+	bool result = false;
+
+	do {
+		CHECK(encodedSize == referenceSize, "SerializedTS: %zu events of size %zu: size %zu, reference %zu.",
+			eventNumber, eventSize, encodedSize, referenceSize);
+		CHECK(memcmp(encoded, reference, encodedSize) == 0,
+			"SerializedTS: %zu events of size %zu: output differs from reference encoder.", eventNumber, eventSize);
+
+		CHECK(caerSerializedTSDecode(encoded, encodedSize, decoded, eventNumber, eventSize, tsOffset),
+			"SerializedTS: %zu events of size %zu: decode failed.", eventNumber, eventSize);
+		CHECK(memcmp(decoded, original, size) == 0, "SerializedTS: %zu events of size %zu: round trip differs.",
+			eventNumber, eventSize);
+
+		if (eventNumber > 0) {
+			CHECK(!caerSerializedTSDecode(encoded, encodedSize - 1, decoded, eventNumber, eventSize, tsOffset),
+				"SerializedTS: %zu events of size %zu: truncated data accepted.", eventNumber, eventSize);
+			CHECK(!caerSerializedTSDecode(encoded, encodedSize, decoded, eventNumber + 1, eventSize, tsOffset),
+				"SerializedTS: %zu events of size %zu: too few events accepted.", eventNumber, eventSize);
+			CHECK(!caerSerializedTSDecode(encoded, encodedSize, decoded, eventNumber - 1, eventSize, tsOffset),
+				"SerializedTS: %zu events of size %zu: too many events accepted.", eventNumber, eventSize);
+
+			corrupt(encoded, encodedSize);
+			caerSerializedTSDecode(encoded, encodedSize, decoded, eventNumber, eventSize, tsOffset);
+		}
+
+		result = true;
+	} while (0);
+
+	free(original);
+	free(encoded);
+	free(reference);
+	free(decoded);
+
+	return (result);
+}
+
+static bool testSerializedTS(void) {
+	// 8 byte events with 4 bytes of data (polarity) use AVX2 where supported,
+	// the others always the generic implementation.
+	static const size_t eventSizes[] = {8, 12, 16};
+	static const uint32_t densities[] = {0, 1, 2, 4, 20};
+
+	for (size_t e = 0; e < (sizeof(eventSizes) / sizeof(eventSizes[0])); e++) {
+		for (size_t n = 0; n < EDGE_SIZES_NUMBER; n++) {
+			for (size_t d = 0; d < (sizeof(densities) / sizeof(densities[0])); d++) {
+				if (!testSerializedTSCase(edgeSizes[n], eventSizes[e], densities[d], 1000)) {
+					return (false);
+				}
+			}
+		}
+
+		for (size_t i = 0; i < 2000; i++) {
+			if (!testSerializedTSCase(randomRange(600), eventSizes[e], 1 + randomRange(20), I32T(randomNext() >> 2))) {
+				return (false);
+			}
+		}
+
+		// Timestamps at the top of the range, where the run mark bit sits next to them.
+		if (!testSerializedTSCase(300, eventSizes[e], 4, INT32_MAX - 1000)) {
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
+static bool testPolarityDeltaCase(size_t eventNumber, enum polarity_pattern pattern) {
+	size_t size = eventNumber * sizeof(struct caer_polarity_event);
+
+	struct caer_polarity_event *original = calloc(1, size + 1);
+	struct caer_polarity_event *decoded  = malloc(size + 1);
+	uint8_t *encoded                     = malloc(POLARITY_DELTA_MAX_SIZE(eventNumber) + 1);
+	if (original == NULL || decoded == NULL || encoded == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	polarityGenerate(original, eventNumber, pattern);
+
+	size_t encodedSize = caerPolarityDeltaEncode(encoded, (const uint8_t *) original, eventNumber);
+
+	bool result = false;
+
+	do {
+		CHECK(encodedSize <= POLARITY_DELTA_MAX_SIZE(eventNumber),
+			"PolarityDelta: %zu events, pattern %d: size %zu above maximum.", eventNumber, pattern, encodedSize);
+
+		CHECK(caerPolarityDeltaDecode((uint8_t *) decoded, eventNumber, encoded, encodedSize),
+			"PolarityDelta: %zu events, pattern %d: decode failed.", eventNumber, pattern);
+		CHECK(memcmp(decoded, original, size) == 0, "PolarityDelta: %zu events, pattern %d: round trip differs.",
+			eventNumber, pattern);
+
+		if (eventNumber > 0) {
+			// Truncation anywhere, not just by one byte: every prefix must be rejected.
+			size_t cut = 0;
+			while (cut < encodedSize && !caerPolarityDeltaDecode((uint8_t *) decoded, eventNumber, encoded, cut)) {
+				cut += 1 + (encodedSize / 64);
+			}
+			CHECK(cut >= encodedSize, "PolarityDelta: %zu events, pattern %d: data truncated to %zu bytes accepted.",
+				eventNumber, pattern, cut);
+			CHECK(!caerPolarityDeltaDecode((uint8_t *) decoded, eventNumber, encoded, encodedSize - 1),
+				"PolarityDelta: %zu events, pattern %d: truncated data accepted.", eventNumber, pattern);
+
+			corrupt(encoded, encodedSize);
+			caerPolarityDeltaDecode((uint8_t *) decoded, eventNumber, encoded, encodedSize);
+		}
+
+		result = true;
+	} while (0);
+
+	free(original);
+	free(decoded);
+	free(encoded);
+
+	return (result);
+}
+
+static bool testPolarityDelta(void) {
+	for (int p = 0; p < POLARITY_PATTERNS; p++) {
+		for (size_t n = 0; n < EDGE_SIZES_NUMBER; n++) {
+			if (!testPolarityDeltaCase(edgeSizes[n], (enum polarity_pattern) p)) {
+				return (false);
+			}
+		}
+
+		for (size_t i = 0; i < 300; i++) {
+			if (!testPolarityDeltaCase(randomRange(5000), (enum polarity_pattern) p)) {
+				return (false);
+			}
+		}
+	}
+
+	return (true);
+}
+
+static void frameReferenceCopy(struct caer_frame_codec_reference *dest, const struct caer_frame_codec_reference *src) {
+	if (src->valid
+		&& !caerFrameCodecReferenceUpdate(
+			   dest, src->pixels, src->lengthX, src->lengthY, src->channels, src->sequence)) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * Decode one encoded frame: truncated, complete and corrupted. Truncated and
+ * corrupted data are decoded against a copy of the reference, which a failed
+ * decode may leave in any state.
+ */
+static bool testFrameCodecDecode(uint8_t *encoded, size_t encodedSize, const uint16_t *original, uint16_t *decoded,
+	int32_t lengthX, int32_t lengthY, int32_t channels, struct caer_frame_codec_reference *decoderReference) {
+	size_t size = (size_t)(lengthX * lengthY * channels) * sizeof(uint16_t);
+
+	struct caer_frame_codec_reference scratchReference = {0};
+
+	bool result = false;
+
+	do {
+		frameReferenceCopy(&scratchReference, decoderReference);
+		CHECK(caerFrameCodecDecode(decoded, lengthX, lengthY, channels, encoded, encodedSize - 1, &scratchReference)
+				  != FRAME_CODEC_OK,
+			"FastFrames: %" PRIi32 "x%" PRIi32 "x%" PRIi32 ": truncated data accepted.", lengthX, lengthY, channels);
+
+		enum caer_frame_codec_result decodeResult
+			= caerFrameCodecDecode(decoded, lengthX, lengthY, channels, encoded, encodedSize, decoderReference);
+		CHECK(decodeResult == FRAME_CODEC_OK && memcmp(decoded, original, size) == 0,
+			"FastFrames: %" PRIi32 "x%" PRIi32 "x%" PRIi32 ": round trip failed (result %d).", lengthX, lengthY,
+			channels, decodeResult);
+
+		frameReferenceCopy(&scratchReference, decoderReference);
+		corrupt(encoded, encodedSize);
+		caerFrameCodecDecode(decoded, lengthX, lengthY, channels, encoded, encodedSize, &scratchReference);
+
+		result = true;
+	} while (0);
+
+	caerFrameCodecReferenceFree(&scratchReference);
+
+	return (result);
+}
+
+static bool testFrameCodecCase(int32_t lengthX, int32_t lengthY, int32_t channels, bool fullRange) {
+	size_t pixelNumber = (size_t)(lengthX * lengthY * channels);
+	size_t size        = pixelNumber * sizeof(uint16_t);
+
+	uint16_t *original = malloc(size);
+	uint16_t *decoded  = malloc(size);
+	uint8_t *encoded   = malloc(FRAME_CODEC_MAX_SIZE(pixelNumber));
+	if (original == NULL || decoded == NULL || encoded == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	struct caer_frame_codec_reference encoderReference = {0};
+	struct caer_frame_codec_reference decoderReference = {0};
+
+	bool result = true;
+
+	// Key frame first, then delta frames, with a key frame again in between.
+	for (int32_t frame = 0; frame < 12 && result; frame++) {
+		frameGenerate(original, lengthX, lengthY, channels, frame, fullRange);
+
+		if (frame == 5) {
+			// Odd value: no common trailing zero bits to remove.
+			original[0] = 1;
+		}
+
+		bool delta
+			= (frame % 8 != 0) && caerFrameCodecReferenceMatches(&encoderReference, lengthX, lengthY, channels);
+		uint16_t sequence = (uint16_t)(encoderReference.sequence + 1);
+
+		size_t encodedSize = caerFrameCodecEncode(
+			encoded, original, lengthX, lengthY, channels, (delta) ? (&encoderReference) : (NULL), sequence);
+		if (!caerFrameCodecReferenceUpdate(&encoderReference, original, lengthX, lengthY, channels, sequence)) {
+			fprintf(stderr, "Memory allocation failure.\n");
+			exit(EXIT_FAILURE);
+		}
+
+		if (encodedSize > FRAME_CODEC_MAX_SIZE(pixelNumber)) {
+			fprintf(stderr, "FastFrames: %" PRIi32 "x%" PRIi32 "x%" PRIi32 ": size %zu above maximum.\n", lengthX,
+				lengthY, channels, encodedSize);
+			result = false;
+			break;
+		}
+
+		result = testFrameCodecDecode(
+			encoded, encodedSize, original, decoded, lengthX, lengthY, channels, &decoderReference);
+	}
+
+	if (result) {
+		// A delta frame needs the right reference, else decoding must say so.
+		size_t encodedSize = caerFrameCodecEncode(encoded, original, lengthX, lengthY, channels, &encoderReference, 1);
+		struct caer_frame_codec_reference noReference = {0};
+
+		if (caerFrameCodecDecode(decoded, lengthX, lengthY, channels, encoded, encodedSize, &noReference)
+			!= FRAME_CODEC_NO_REFERENCE) {
+			fprintf(stderr,
+				"FastFrames: %" PRIi32 "x%" PRIi32 "x%" PRIi32 ": delta frame without reference accepted.\n", lengthX,
+				lengthY, channels);
+			result = false;
+		}
+
+		caerFrameCodecReferenceFree(&noReference);
+	}
+
+	caerFrameCodecReferenceFree(&encoderReference);
+	caerFrameCodecReferenceFree(&decoderReference);
+
+	free(original);
+	free(decoded);
+	free(encoded);
+
+	return (result);
+}
+
+static bool testFrameCodec(void) {
+	// Sizes around the 32 value blocks, single rows and columns, a DAVIS346 frame.
+	static const int32_t sizes[][2] = {{1, 1}, {31, 1}, {32, 1}, {33, 1}, {1, 33}, {7, 5}, {64, 48}, {346, 260}};
+	static const int32_t channels[] = {1, 3, 4};
+
+	for (size_t s = 0; s < (sizeof(sizes) / sizeof(sizes[0])); s++) {
+		for (size_t c = 0; c < (sizeof(channels) / sizeof(channels[0])); c++) {
+			if (!testFrameCodecCase(sizes[s][0], sizes[s][1], channels[c], false)
+				|| !testFrameCodecCase(sizes[s][0], sizes[s][1], channels[c], true)) {
+				return (false);
+			}
+		}
+	}
+
+	return (true);
+}
+
+/**
+ * Interleaved frames of two sources, with the same ROI identifiers, format and
+ * frame sequence numbers, as read from a multi-source file. Each source's delta
+ * frames must be decoded against its own references, never the other's.
+ */
+static bool testFrameCodecSources(void) {
+	const int32_t lengthX     = 64;
+	const int32_t lengthY     = 48;
+	const int16_t sourceIDs[] = {1, 2};
+	const uint8_t roiNumber   = 2;
+
+	size_t pixelNumber = (size_t)(lengthX * lengthY);
+	size_t size        = pixelNumber * sizeof(uint16_t);
+
+	uint16_t *original = malloc(size);
+	uint16_t *decoded  = malloc(size);
+	uint8_t *encoded   = malloc(FRAME_CODEC_MAX_SIZE(pixelNumber));
+	if (original == NULL || decoded == NULL || encoded == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Encoders are separate per source (one output module each).
+	struct caer_frame_codec_reference encoderReferences[2][2] = {{{0}}};
+
+	struct caer_frame_codec_source_references *decoderReferences = NULL;
+	size_t decoderReferencesSize                                 = 0;
+
+	bool result = true;
+
+	for (int32_t frame = 0; frame < 10 && result; frame++) {
+		for (uint8_t roi = 0; roi < roiNumber && result; roi++) {
+			for (size_t src = 0; src < 2 && result; src++) {
+				struct caer_frame_codec_reference *encoderReference = &encoderReferences[src][roi];
+
+				// Different content per source and ROI, changing slowly between frames.
+				frameGenerate(original, lengthX, lengthY, 1, frame + (int32_t)(src * 300) + (roi * 50), false);
+
+				bool delta        = (frame != 0);
+				uint16_t sequence = (uint16_t)(encoderReference->sequence + 1);
+
+				size_t encodedSize = caerFrameCodecEncode(
+					encoded, original, lengthX, lengthY, 1, (delta) ? (encoderReference) : (NULL), sequence);
+				if (!caerFrameCodecReferenceUpdate(encoderReference, original, lengthX, lengthY, 1, sequence)) {
+					fprintf(stderr, "Memory allocation failure.\n");
+					exit(EXIT_FAILURE);
+				}
+
+				struct caer_frame_codec_reference *references
+					= caerFrameCodecSourceReferences(&decoderReferences, &decoderReferencesSize, sourceIDs[src]);
+				if (references == NULL) {
+					fprintf(stderr, "Memory allocation failure.\n");
+					exit(EXIT_FAILURE);
+				}
+
+				enum caer_frame_codec_result decodeResult
+					= caerFrameCodecDecode(decoded, lengthX, lengthY, 1, encoded, encodedSize, &references[roi]);
+				if (decodeResult != FRAME_CODEC_OK || memcmp(decoded, original, size) != 0) {
+					fprintf(stderr,
+						"FastFrames: source %" PRIi16 ", ROI %" PRIu8 ", frame %" PRIi32
+						": round trip failed (result %d).\n",
+						sourceIDs[src], roi, frame, decodeResult);
+					result = false;
+				}
+			}
+		}
+	}
+
+	if (result && decoderReferencesSize != 2) {
+		fprintf(stderr, "FastFrames: %zu sources tracked instead of 2.\n", decoderReferencesSize);
+		result = false;
+	}
+
+	for (size_t src = 0; src < 2; src++) {
+		for (uint8_t roi = 0; roi < roiNumber; roi++) {
+			caerFrameCodecReferenceFree(&encoderReferences[src][roi]);
+		}
+	}
+
+	caerFrameCodecSourceReferencesFree(&decoderReferences, &decoderReferencesSize);
+
+	free(original);
+	free(decoded);
+	free(encoded);
+
+	return (result);
+}
+
+#if defined(ENABLE_INOUT_LZ4_COMPRESSION) || defined(ENABLE_INOUT_ZSTD_COMPRESSION)
+
+enum packet_compression_algorithm {
+	PACKET_COMPRESSION_LZ4,
+	PACKET_COMPRESSION_ZSTD,
+};
+
+static size_t packetCompress(enum packet_compression_algorithm algorithm, uint8_t *out, const uint8_t *data,
+	size_t dataSize, void *context) {
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	if (algorithm == PACKET_COMPRESSION_LZ4) {
+		return (caerPacketCompressLZ4(out, data, dataSize));
+	}
+#endif
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (algorithm == PACKET_COMPRESSION_ZSTD) {
+		return (caerPacketCompressZstd(context, NULL, 3, out, data, dataSize));
+	}
+#endif
+
+	(void) (context);
+	return (0);
+}
+
+static bool packetDecompress(enum packet_compression_algorithm algorithm, uint8_t *data, size_t dataSize,
+	const uint8_t *compressed, size_t compressedSize, void *context) {
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	if (algorithm == PACKET_COMPRESSION_LZ4) {
+		return (caerPacketDecompressLZ4(data, dataSize, compressed, compressedSize));
+	}
+#endif
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (algorithm == PACKET_COMPRESSION_ZSTD) {
+		return (caerPacketDecompressZstd(context, NULL, data, dataSize, compressed, compressedSize, NULL));
+	}
+#endif
+
+	(void) (context);
+	return (false);
+}
+
+static bool testPacketCompressionCase(enum packet_compression_algorithm algorithm, size_t eventNumber,
+	enum polarity_pattern pattern, void *compressContext, void *decompressContext) {
+	size_t size = eventNumber * sizeof(struct caer_polarity_event);
+
+	struct caer_polarity_event *original = calloc(1, size + 1);
+	uint8_t *decoded                     = malloc(size + 1);
+	uint8_t *compressed                  = malloc(size + 1);
+	if (original == NULL || decoded == NULL || compressed == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	polarityGenerate(original, eventNumber, pattern);
+
+	size_t compressedSize = packetCompress(algorithm, compressed, (const uint8_t *) original, size, compressContext);
+
+	bool result = false;
+
+	do {
+		if (compressedSize == 0) {
+			// Not compressible, sent as is. Only expected for little or random data.
+			CHECK(pattern == POLARITY_RANDOM || pattern == POLARITY_WRAP || size < 64,
+				"Packet compression %d: %zu events, pattern %d: not compressed.", algorithm, eventNumber, pattern);
+			result = true;
+			break;
+		}
+
+		CHECK(compressedSize < size, "Packet compression %d: %zu events, pattern %d: size %zu not smaller.",
+			algorithm, eventNumber, pattern, compressedSize);
+
+		CHECK(packetDecompress(algorithm, decoded, size, compressed, compressedSize, decompressContext),
+			"Packet compression %d: %zu events, pattern %d: decompression failed.", algorithm, eventNumber, pattern);
+		CHECK(memcmp(decoded, original, size) == 0,
+			"Packet compression %d: %zu events, pattern %d: round trip differs.", algorithm, eventNumber, pattern);
+
+		CHECK(!packetDecompress(algorithm, decoded, size, compressed, compressedSize - 1, decompressContext),
+			"Packet compression %d: %zu events, pattern %d: truncated data accepted.", algorithm, eventNumber, pattern);
+		CHECK(!packetDecompress(algorithm, decoded, size + 8, compressed, compressedSize, decompressContext),
+			"Packet compression %d: %zu events, pattern %d: too few events accepted.", algorithm, eventNumber,
+			pattern);
+
+		corrupt(compressed, compressedSize);
+		packetDecompress(algorithm, decoded, size, compressed, compressedSize, decompressContext);
+
+		result = true;
+	} while (0);
+
+	free(original);
+	free(decoded);
+	free(compressed);
+
+	return (result);
+}
+
+static bool testPacketCompression(enum packet_compression_algorithm algorithm) {
+	void *compressContext   = NULL;
+	void *decompressContext = NULL;
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	if (algorithm == PACKET_COMPRESSION_ZSTD) {
+		compressContext   = ZSTD_createCCtx();
+		decompressContext = ZSTD_createDCtx();
+		if (compressContext == NULL || decompressContext == NULL) {
+			fprintf(stderr, "Memory allocation failure.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+#endif
+
+	bool result = true;
+
+	for (int p = 0; p < POLARITY_PATTERNS && result; p++) {
+		for (size_t n = 0; n < EDGE_SIZES_NUMBER && result; n++) {
+			result = testPacketCompressionCase(
+				algorithm, edgeSizes[n], (enum polarity_pattern) p, compressContext, decompressContext);
+		}
+
+		for (size_t i = 0; i < 100 && result; i++) {
+			result = testPacketCompressionCase(
+				algorithm, randomRange(5000), (enum polarity_pattern) p, compressContext, decompressContext);
+		}
+	}
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	ZSTD_freeCCtx(compressContext);
+	ZSTD_freeDCtx(decompressContext);
+#endif
+
+	return (result);
+}
+
+#endif
+
+static bool report(const char *name, bool result) {
+	printf("%s: %s.\n", name, (result) ? ("passed") : ("FAILED"));
+
+	return (result);
+}
+
+int main(void) {
+	bool passed = true;
+
+	printf("SerializedTS: AVX2 %s.\n", (serializedTSUseAVX2(8, 4)) ? ("used") : ("not supported"));
+
+	passed = report("SerializedTS", testSerializedTS()) && passed;
+	passed = report("PolarityDelta", testPolarityDelta()) && passed;
+	passed = report("FastFrames", testFrameCodec()) && passed;
+	passed = report("FastFrames multi-source", testFrameCodecSources()) && passed;
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	passed = report("LZ4Packets", testPacketCompression(PACKET_COMPRESSION_LZ4)) && passed;
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_COMPRESSION
+	passed = report("ZstdPackets", testPacketCompression(PACKET_COMPRESSION_ZSTD)) && passed;
+#endif
+
+	return ((passed) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
@@ -0,0 +1,298 @@
+/*
+ * Benchmark for ordering the event packets of packet containers, with many
+ * containers of few, small packets (the common case for live cameras):
+ * - outputs: order a container's packets by first timestamp, then type ID,
+ *   before sending them (orderAndSendEventPackets()).
+ * - inputs: find the accumulator packet with the same type and event size as
+ *   a new packet, or where to add it (addToPacketContainer()).
+ * Each is timed for the current code in inout_packet_order.h, and for the
+ * cAER 1.2.1 code it replaced: qsort() with a comparison that gets the
+ * timestamps on every call, and appending followed by re-sorting.
+ * Not run by CTest, as results depend on the machine; run it directly on
+ * a Release build: modules/inout/tests/inout_order_bench
+ */
+
+#include "inout_test_data.h"
+#include "modules/inout/inout_packet_order.h"
+
+#include <libcaer/events/polarity.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Containers per measurement.
+#define BENCH_CONTAINERS 200000
+// Most packets per container, and most different packet types.
+#define BENCH_MAX_PACKETS 64
+// Packets added to the input accumulator before it's committed and emptied.
+#define BENCH_ACCUMULATE_PACKETS 64
+
+static double benchNow(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((double) now.tv_sec + ((double) now.tv_nsec / 1.0e9));
+}
+
+static void *benchMalloc(size_t size) {
+	void *memory = malloc(size);
+	if (memory == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	return (memory);
+}
+
+/**
+ * Allocate a packet with one polarity-sized event, of the given type and
+ * event size (events beyond 8 bytes are padding), and first timestamp.
+ */
+static caerEventPacketHeader packetAllocate(int16_t eventType, int32_t eventSize, int32_t timestamp) {
+	caerEventPacketHeader packet = benchMalloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t) eventSize);
+	memset(packet, 0, CAER_EVENT_PACKET_HEADER_SIZE + (size_t) eventSize);
+
+	caerEventPacketHeaderSetEventType(packet, eventType);
+	caerEventPacketHeaderSetEventSize(packet, eventSize);
+	caerEventPacketHeaderSetEventTSOffset(packet, 4);
+	caerEventPacketHeaderSetEventCapacity(packet, 1);
+	caerEventPacketHeaderSetEventNumber(packet, 1);
+	caerEventPacketHeaderSetEventValid(packet, 1);
+
+	int32_t timestampLE = htole32(timestamp);
+	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE + 4, &timestampLE, sizeof(int32_t));
+
+	return (packet);
+}
+
+/// Comparison of orderAndSendEventPackets() in cAER 1.2.1.
+static int referenceFirstTimestampThenTypeCmp(const void *a, const void *b) {
+	const caerEventPacketHeader *aa = a;
+	const caerEventPacketHeader *bb = b;
+
+	// Sort first by timestamp of the first event.
+	int32_t eventTimestampA = caerGenericEventGetTimestamp(caerGenericEventGetEvent(*aa, 0), *aa);
+	int32_t eventTimestampB = caerGenericEventGetTimestamp(caerGenericEventGetEvent(*bb, 0), *bb);
+
+	if (eventTimestampA < eventTimestampB) {
+		return (-1);
+	}
+	else if (eventTimestampA > eventTimestampB) {
+		return (1);
+	}
+	else {
+		// If equal, further sort by type ID.
+		int16_t eventTypeA = caerEventPacketHeaderGetEventType(*aa);
+		int16_t eventTypeB = caerEventPacketHeaderGetEventType(*bb);
+
+		if (eventTypeA < eventTypeB) {
+			return (-1);
+		}
+		else if (eventTypeA > eventTypeB) {
+			return (1);
+		}
+		else {
+			return (0);
+		}
+	}
+}
+
+/// Comparison of addToPacketContainer() in cAER 1.2.1.
+static int referenceFirstTypeThenSizeCmp(const void *a, const void *b) {
+	const caerEventPacketHeader *aa = a;
+	const caerEventPacketHeader *bb = b;
+
+	// Sort first by type ID.
+	int16_t eventTypeA = caerEventPacketHeaderGetEventType(*aa);
+	int16_t eventTypeB = caerEventPacketHeaderGetEventType(*bb);
+
+	if (eventTypeA < eventTypeB) {
+		return (-1);
+	}
+	else if (eventTypeA > eventTypeB) {
+		return (1);
+	}
+	else {
+		// If equal, further sort by event size.
+		int32_t eventSizeA = caerEventPacketHeaderGetEventSize(*aa);
+		int32_t eventSizeB = caerEventPacketHeaderGetEventSize(*bb);
+
+		if (eventSizeA < eventSizeB) {
+			return (-1);
+		}
+		else if (eventSizeA > eventSizeB) {
+			return (1);
+		}
+		else {
+			return (0);
+		}
+	}
+}
+
+/**
+ * Output ordering of containers with packetsNumber packets of one event each,
+ * one per type ID. In order: timestamps rise with the type ID, like most
+ * containers coming from a camera. Else the packets are shuffled.
+ */
+static void benchOutputOrder(size_t packetsNumber, bool inOrder) {
+	caerEventPacketHeader packets[BENCH_MAX_PACKETS];
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		packets[i] = packetAllocate(I16T(i), 8, 1000 + (int32_t)(i * 10));
+	}
+
+	if (!inOrder) {
+		for (size_t i = packetsNumber - 1; i > 0; i--) {
+			size_t j = randomRange((uint32_t)(i + 1));
+
+			caerEventPacketHeader swap = packets[i];
+			packets[i]                 = packets[j];
+			packets[j]                 = swap;
+		}
+	}
+
+	caerEventPacketHeader container[BENCH_MAX_PACKETS];
+	struct caer_packet_order order[BENCH_MAX_PACKETS];
+
+	// Checksum of the resulting orders, so the work can't be optimized out,
+	// and to check both give the same order.
+	uintptr_t referenceCheck = 0;
+	uintptr_t currentCheck   = 0;
+
+	double start = benchNow();
+
+	for (size_t c = 0; c < BENCH_CONTAINERS; c++) {
+		memcpy(container, packets, packetsNumber * sizeof(caerEventPacketHeader));
+		qsort(container, packetsNumber, sizeof(caerEventPacketHeader), &referenceFirstTimestampThenTypeCmp);
+		referenceCheck += (uintptr_t) container[c % packetsNumber];
+	}
+
+	double referenceSeconds = benchNow() - start;
+
+	start = benchNow();
+
+	for (size_t c = 0; c < BENCH_CONTAINERS; c++) {
+		memcpy(container, packets, packetsNumber * sizeof(caerEventPacketHeader));
+		caerPacketOrderByTimestamp(order, container, packetsNumber);
+		currentCheck += (uintptr_t) order[c % packetsNumber].packet;
+	}
+
+	double currentSeconds = benchNow() - start;
+
+	printf("Output order %2zu packets %-9s  1.2.1 %7.1f ns  now %7.1f ns per container%s\n", packetsNumber,
+		(inOrder) ? ("in order") : ("shuffled"), referenceSeconds * 1.0e9 / BENCH_CONTAINERS,
+		currentSeconds * 1.0e9 / BENCH_CONTAINERS, (referenceCheck == currentCheck) ? ("") : ("  ORDER DIFFERS"));
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		free(packets[i]);
+	}
+}
+
+/**
+ * Input accumulation of packets of typesNumber different type IDs, arriving
+ * in random order. After BENCH_ACCUMULATE_PACKETS packets the accumulator is
+ * committed and starts empty again. Only finding and adding packets is timed,
+ * not merging their events.
+ */
+static void benchInputAccumulate(size_t typesNumber) {
+	caerEventPacketHeader packets[BENCH_MAX_PACKETS];
+
+	for (size_t i = 0; i < typesNumber; i++) {
+		packets[i] = packetAllocate(I16T(i), 8, 1000);
+	}
+
+	size_t arrivalsNumber = (BENCH_CONTAINERS / 10) * BENCH_ACCUMULATE_PACKETS;
+	uint8_t *arrivals     = benchMalloc(arrivalsNumber);
+
+	for (size_t i = 0; i < arrivalsNumber; i++) {
+		arrivals[i] = (uint8_t) randomRange((uint32_t) typesNumber);
+	}
+
+	caerEventPacketHeader accumulator[BENCH_MAX_PACKETS];
+	size_t accumulatorSize = 0;
+	size_t referenceCheck  = 0;
+	size_t currentCheck    = 0;
+
+	double start = benchNow();
+
+	for (size_t i = 0; i < arrivalsNumber; i++) {
+		if ((i % BENCH_ACCUMULATE_PACKETS) == 0) {
+			referenceCheck += accumulatorSize;
+			accumulatorSize = 0;
+		}
+
+		caerEventPacketHeader newPacket = packets[arrivals[i]];
+
+		bool packetAlreadyExists = false;
+		for (size_t j = 0; j < accumulatorSize; j++) {
+			if ((caerEventPacketHeaderGetEventType(accumulator[j]) == caerEventPacketHeaderGetEventType(newPacket))
+				&& (caerEventPacketHeaderGetEventSize(accumulator[j])
+					   == caerEventPacketHeaderGetEventSize(newPacket))) {
+				packetAlreadyExists = true;
+				break;
+			}
+		}
+
+		if (!packetAlreadyExists) {
+			accumulator[accumulatorSize++] = newPacket;
+			qsort(accumulator, accumulatorSize, sizeof(caerEventPacketHeader), &referenceFirstTypeThenSizeCmp);
+		}
+	}
+
+	double referenceSeconds = benchNow() - start;
+
+	accumulatorSize = 0;
+
+	start = benchNow();
+
+	for (size_t i = 0; i < arrivalsNumber; i++) {
+		if ((i % BENCH_ACCUMULATE_PACKETS) == 0) {
+			currentCheck += accumulatorSize;
+			accumulatorSize = 0;
+		}
+
+		caerEventPacketHeader newPacket = packets[arrivals[i]];
+
+		size_t packetIndex;
+		if (!caerPacketFindTypeSize(accumulator, accumulatorSize, caerEventPacketHeaderGetEventType(newPacket),
+				caerEventPacketHeaderGetEventSize(newPacket), &packetIndex)) {
+			// Same as utarray_insert().
+			memmove(&accumulator[packetIndex + 1], &accumulator[packetIndex],
+				(accumulatorSize - packetIndex) * sizeof(caerEventPacketHeader));
+			accumulator[packetIndex] = newPacket;
+			accumulatorSize++;
+		}
+	}
+
+	double currentSeconds = benchNow() - start;
+
+	printf("Input accumulate %2zu types          1.2.1 %7.1f ns  now %7.1f ns per packet%s\n", typesNumber,
+		referenceSeconds * 1.0e9 / (double) arrivalsNumber, currentSeconds * 1.0e9 / (double) arrivalsNumber,
+		(referenceCheck == currentCheck) ? ("") : ("  RESULT DIFFERS"));
+
+	free(arrivals);
+
+	for (size_t i = 0; i < typesNumber; i++) {
+		free(packets[i]);
+	}
+}
+
+int main(void) {
+	// Typical DAVIS containers: special, polarity, frame and IMU packets.
+	benchOutputOrder(4, true);
+	benchOutputOrder(4, false);
+	benchOutputOrder(16, true);
+	benchOutputOrder(16, false);
+	benchOutputOrder(64, true);
+	benchOutputOrder(64, false);
+
+	benchInputAccumulate(4);
+	benchInputAccumulate(16);
+	benchInputAccumulate(64);
+
+	return (EXIT_SUCCESS);
+}
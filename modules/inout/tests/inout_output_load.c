@@ -0,0 +1,375 @@
+/*
+ * Measurement of the idle load and added latency of a network output module.
+ * Runs the TCP server output (net_tcp_server.c, output_common.c) in-process,
+ * with one client connected on the loopback interface:
+ * - idle: after the stream started, no more data is sent for a while; prints
+ *   CPU use and wakeups (voluntary context switches) per second of each of
+ *   the module's threads. An event loop driven by data signals shows none on
+ *   its [Output] thread.
+ * - latency: sends a container with one polarity packet at a fixed interval,
+ *   and prints the time from caerOutputCommonRun() to the client receiving
+ *   the packet (median, 90th and 99th percentile, maximum).
+ * Linux only, as the thread statistics come from /proc/self/task/.
+ * Not run by CTest, as results depend on the machine; run it directly on
+ * a Release build: modules/inout/tests/inout_output_load [idleSeconds] [packets] [intervalUs] [port]
+ */
+
+#define _GNU_SOURCE 1
+
+#include "modules/inout/out/net_tcp_server.c"
+
+#include <libcaer/events/polarity.h>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOAD_SUBSYSTEM "Load"
+#define LOAD_SOURCE_ID 1
+// Events per polarity packet.
+#define LOAD_PACKET_EVENTS 100
+// Most threads of this process to track.
+#define LOAD_MAX_THREADS 64
+
+struct load_thread {
+	char tid[16];
+	char name[32];
+	long cpuTicks;
+	long wakeups;
+};
+
+static double loadNow(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((double) now.tv_sec + ((double) now.tv_nsec / 1.0e9));
+}
+
+static void *loadMalloc(size_t size) {
+	void *memory = calloc(1, size);
+	if (memory == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	return (memory);
+}
+
+/**
+ * Source info of the fake source, replacing the one of the SDK library,
+ * which needs a running mainloop.
+ */
+sshsNode caerMainloopGetSourceInfo(int16_t sourceID) {
+	char nodePath[64];
+	snprintf(nodePath, 64, "/%" PRIi16 "-LoadSource/sourceInfo/", sourceID);
+
+	sshsNode sourceInfoNode = sshsGetNode(sshsGetGlobal(), nodePath);
+
+	sshsNodeCreateString(sourceInfoNode, "sourceString", "#Source 1: inout_output_load\r\n", 1, 2048,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Description of the source.");
+
+	return (sourceInfoNode);
+}
+
+/**
+ * Read CPU time (user + system, in clock ticks) and voluntary context
+ * switches of all threads of this process.
+ */
+static size_t loadThreadsRead(struct load_thread *threads) {
+	DIR *tasks = opendir("/proc/self/task");
+	if (tasks == NULL) {
+		return (0);
+	}
+
+	size_t threadsNumber = 0;
+	struct dirent *task;
+
+	while (threadsNumber < LOAD_MAX_THREADS && (task = readdir(tasks)) != NULL) {
+		if (task->d_name[0] == '.') {
+			continue;
+		}
+
+		struct load_thread *thread = &threads[threadsNumber];
+		snprintf(thread->tid, sizeof(thread->tid), "%s", task->d_name);
+
+		char path[288];
+		char line[512];
+
+		snprintf(path, sizeof(path), "/proc/self/task/%s/comm", task->d_name);
+		FILE *file = fopen(path, "r");
+		if (file == NULL) {
+			continue;
+		}
+
+		if (fgets(thread->name, sizeof(thread->name), file) != NULL) {
+			thread->name[strcspn(thread->name, "\n")] = '\0';
+		}
+		fclose(file);
+
+		// Fields 14 and 15 of stat are utime and stime, after the name in parentheses.
+		snprintf(path, sizeof(path), "/proc/self/task/%s/stat", task->d_name);
+		file = fopen(path, "r");
+		if (file == NULL) {
+			continue;
+		}
+
+		unsigned long userTicks = 0, systemTicks = 0;
+		if (fgets(line, sizeof(line), file) != NULL && strrchr(line, ')') != NULL) {
+			sscanf(strrchr(line, ')') + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &userTicks,
+				&systemTicks);
+		}
+		fclose(file);
+
+		thread->cpuTicks = (long) (userTicks + systemTicks);
+
+		snprintf(path, sizeof(path), "/proc/self/task/%s/status", task->d_name);
+		file = fopen(path, "r");
+		if (file == NULL) {
+			continue;
+		}
+
+		thread->wakeups = 0;
+		while (fgets(line, sizeof(line), file) != NULL) {
+			if (strncmp(line, "voluntary_ctxt_switches:", 24) == 0) {
+				thread->wakeups = atol(line + 24);
+			}
+		}
+		fclose(file);
+
+		threadsNumber++;
+	}
+
+	closedir(tasks);
+
+	return (threadsNumber);
+}
+
+/**
+ * Send a container with one polarity packet, with increasing timestamps.
+ */
+static void loadSendPacket(caerModuleData moduleData, int32_t *timestamp) {
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(1);
+	caerPolarityEventPacket packet     = caerPolarityEventPacketAllocate(LOAD_PACKET_EVENTS, LOAD_SOURCE_ID, 0);
+	if (container == NULL || packet == NULL) {
+		fprintf(stderr, "Memory allocation failure.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int32_t i = 0; i < LOAD_PACKET_EVENTS; i++) {
+		caerPolarityEvent event = caerPolarityEventPacketGetEvent(packet, i);
+
+		caerPolarityEventSetTimestamp(event, (*timestamp)++);
+		caerPolarityEventSetX(event, U16T(i));
+		caerPolarityEventValidate(event, packet);
+	}
+
+	caerEventPacketContainerSetEventPacket(container, 0, (caerEventPacketHeader) packet);
+
+	caerOutputCommonRun(moduleData, container, NULL);
+
+	caerEventPacketContainerFree(container);
+}
+
+// Arrival times of the polarity packets at the client, in order.
+static double *clientArrivals;
+static size_t clientArrivalsSize;
+static atomic_size_t clientArrivalsNumber;
+
+/**
+ * Client thread: read the stream, skip the network header, and note the
+ * arrival time of each complete polarity packet.
+ */
+static void *loadClient(void *socketArg) {
+	int clientSocket = *((int *) socketArg);
+
+	size_t bufferSize = 1024 * 1024;
+	uint8_t *buffer   = loadMalloc(bufferSize);
+	size_t bufferUsed = 0;
+	bool headerSeen   = false;
+
+	ssize_t readBytes;
+	while ((readBytes = read(clientSocket, buffer + bufferUsed, bufferSize - bufferUsed)) > 0) {
+		double arrival = loadNow();
+		bufferUsed += (size_t) readBytes;
+
+		size_t position = 0;
+
+		if (!headerSeen) {
+			if (bufferUsed < AEDAT3_NETWORK_HEADER_LENGTH) {
+				continue;
+			}
+
+			position   = AEDAT3_NETWORK_HEADER_LENGTH;
+			headerSeen = true;
+		}
+
+		while ((bufferUsed - position) >= CAER_EVENT_PACKET_HEADER_SIZE) {
+			caerEventPacketHeaderConst packet = (caerEventPacketHeaderConst)(buffer + position);
+			size_t packetSize                 = CAER_EVENT_PACKET_HEADER_SIZE
+								+ (size_t)(caerEventPacketHeaderGetEventNumber(packet)
+										   * caerEventPacketHeaderGetEventSize(packet));
+
+			if ((bufferUsed - position) < packetSize) {
+				break;
+			}
+
+			if (caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+				size_t index = atomic_fetch_add(&clientArrivalsNumber, 1);
+				if (index < clientArrivalsSize) {
+					clientArrivals[index] = arrival;
+				}
+			}
+
+			position += packetSize;
+		}
+
+		memmove(buffer, buffer + position, bufferUsed - position);
+		bufferUsed -= position;
+	}
+
+	free(buffer);
+
+	return (NULL);
+}
+
+static int loadDoubleCmp(const void *a, const void *b) {
+	double aa = *((const double *) a);
+	double bb = *((const double *) b);
+
+	return ((aa > bb) - (aa < bb));
+}
+
+int main(int argc, char **argv) {
+	int idleSeconds      = (argc > 1) ? (atoi(argv[1])) : (5);
+	size_t packetsNumber = (argc > 2) ? ((size_t) atol(argv[2])) : (2000);
+	long intervalUs      = (argc > 3) ? (atol(argv[3])) : (1000);
+	int port             = (argc > 4) ? (atoi(argv[4])) : (7777);
+
+	if (idleSeconds <= 0 || packetsNumber == 0 || intervalUs <= 0 || port <= 0 || port > UINT16_MAX) {
+		fprintf(stderr, "Usage: %s [idleSeconds] [packets] [intervalUs] [port]\n", argv[0]);
+		return (EXIT_FAILURE);
+	}
+
+	// Module data, as the mainloop sets it up.
+	struct caer_module_data moduleData = {
+		.moduleID = 2, .moduleStatus = CAER_MODULE_RUNNING, .moduleSubSystemString = strdup(LOAD_SUBSYSTEM)};
+	atomic_store(&moduleData.running, true);
+	atomic_store(&moduleData.moduleLogLevel, CAER_LOG_WARNING);
+	moduleData.moduleNode  = sshsGetNode(sshsGetGlobal(), "/2-" LOAD_SUBSYSTEM "/");
+	moduleData.moduleState = loadMalloc(sizeof(struct output_common_state));
+
+	sshsNodeCreateInt(moduleData.moduleNode, "portNumber", 7777, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Port number to listen on (server mode).");
+	sshsNodePutInt(moduleData.moduleNode, "portNumber", port);
+
+	if (!caerOutputNetTCPServerInit(&moduleData)) {
+		fprintf(stderr, "Failed to start TCP server output on port %d.\n", port);
+		return (EXIT_FAILURE);
+	}
+
+	clientArrivalsSize = packetsNumber + 1;
+	clientArrivals     = loadMalloc(clientArrivalsSize * sizeof(double));
+	double *sendTimes  = loadMalloc(packetsNumber * sizeof(double));
+
+	int clientSocket                 = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in serverAddress = {.sin_family = AF_INET, .sin_port = htons((uint16_t) port)};
+	serverAddress.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+
+	if (clientSocket < 0 || connect(clientSocket, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) != 0) {
+		fprintf(stderr, "Failed to connect to TCP server output on port %d.\n", port);
+		return (EXIT_FAILURE);
+	}
+
+	pthread_t clientThread;
+	pthread_create(&clientThread, NULL, &loadClient, &clientSocket);
+
+	// The stream, and its header, only start with the first packet.
+	int32_t timestamp           = 0;
+	struct timespec settleSleep = {.tv_sec = 0, .tv_nsec = 200000000};
+	loadSendPacket(&moduleData, &timestamp);
+	nanosleep(&settleSleep, NULL);
+
+	// Idle: no data for idleSeconds.
+	struct load_thread threadsStart[LOAD_MAX_THREADS], threadsEnd[LOAD_MAX_THREADS];
+
+	size_t threadsStartNumber = loadThreadsRead(threadsStart);
+	sleep((unsigned int) idleSeconds);
+	size_t threadsEndNumber = loadThreadsRead(threadsEnd);
+
+	double ticksPerSecond = (double) sysconf(_SC_CLK_TCK);
+
+	printf("Idle for %d s, threads of the output module:\n", idleSeconds);
+
+	for (size_t i = 0; i < threadsEndNumber; i++) {
+		if (strncmp(threadsEnd[i].name, LOAD_SUBSYSTEM "[", strlen(LOAD_SUBSYSTEM "[")) != 0) {
+			continue;
+		}
+
+		for (size_t j = 0; j < threadsStartNumber; j++) {
+			if (strcmp(threadsEnd[i].tid, threadsStart[j].tid) == 0) {
+				printf("  %-16s  CPU %6.2f %%  wakeups %8.1f /s\n", threadsEnd[i].name,
+					100.0 * (double) (threadsEnd[i].cpuTicks - threadsStart[j].cpuTicks) / ticksPerSecond
+						/ idleSeconds,
+					(double) (threadsEnd[i].wakeups - threadsStart[j].wakeups) / idleSeconds);
+				break;
+			}
+		}
+	}
+
+	// Latency: one packet every intervalUs.
+	atomic_store(&clientArrivalsNumber, 0);
+
+	struct timespec intervalSleep = {.tv_sec = intervalUs / 1000000, .tv_nsec = (intervalUs % 1000000) * 1000};
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		sendTimes[i] = loadNow();
+		loadSendPacket(&moduleData, &timestamp);
+		nanosleep(&intervalSleep, NULL);
+	}
+
+	nanosleep(&settleSleep, NULL);
+
+	size_t received = atomic_load(&clientArrivalsNumber);
+	if (received > packetsNumber) {
+		received = packetsNumber;
+	}
+
+	if (received == 0) {
+		fprintf(stderr, "No packets received.\n");
+		return (EXIT_FAILURE);
+	}
+
+	// Reuse the arrival times for the latencies, in µs.
+	for (size_t i = 0; i < received; i++) {
+		clientArrivals[i] = (clientArrivals[i] - sendTimes[i]) * 1.0e6;
+	}
+
+	qsort(clientArrivals, received, sizeof(double), &loadDoubleCmp);
+
+	printf("Latency Run() to client, %zu of %zu packets every %ld us:\n", received, packetsNumber, intervalUs);
+	printf("  median %8.0f us  p90 %8.0f us  p99 %8.0f us  max %8.0f us\n", clientArrivals[received / 2],
+		clientArrivals[(received * 9) / 10], clientArrivals[(received * 99) / 100], clientArrivals[received - 1]);
+
+	caerOutputCommonExit(&moduleData);
+
+	close(clientSocket);
+	pthread_join(clientThread, NULL);
+
+	free(sendTimes);
+	free(clientArrivals);
+	free(moduleData.moduleState);
+	free(moduleData.moduleSubSystemString);
+
+	return (EXIT_SUCCESS);
+}
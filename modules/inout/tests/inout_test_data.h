@@ -0,0 +1,199 @@
+#ifndef INOUT_TEST_DATA_H_
+#define INOUT_TEST_DATA_H_
+
+/*
+ * Test data for the input/output codec tests and benchmark: deterministic
+ * random numbers, event and frame generators, and the serialized timestamp
+ * encoder from cAER 1.2.1 as a reference.
+ */
+
+#include "modules/inout/inout_serialized_ts.h"
+
+#include <libcaer/events/polarity.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fixed seed, so failures are reproducible.
+static uint32_t randomState = 0x12345678;
+
+// xorshift32, same sequence on all platforms, unlike rand().
+static inline uint32_t randomNext(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+
+	return (randomState);
+}
+
+static inline void randomSeed(uint32_t seed) {
+	// xorshift never leaves an all-zero state.
+	randomState = (seed == 0) ? (0x12345678) : (seed);
+}
+
+static inline uint32_t randomRange(uint32_t max) {
+	return ((max == 0) ? (0) : (randomNext() % max));
+}
+
+/**
+ * Serialized timestamp encoder from cAER 1.2.1 (compressTimestampSerialize()
+ * in output_common.c), working on plain event memory. The current encoder
+ * must produce byte-for-byte the same output, so the format is unchanged.
+ */
+static inline size_t serializedTSEncodeReference(
+	uint8_t *events, size_t eventNumber, size_t eventSize, size_t tsOffset) {
+	size_t currOffset = 0;
+	int32_t lastTS    = -1;
+	int32_t currTS    = -1;
+	size_t tsRun      = 0;
+	bool doMemMove    = false;
+
+	for (size_t counter = 0; counter <= eventNumber; counter++) {
+		if (counter < eventNumber) {
+			currTS = serializedTSGet(events + (counter * eventSize), tsOffset);
+			if (currTS == lastTS) {
+				tsRun++;
+				continue;
+			}
+		}
+
+		if (tsRun >= 3) {
+			uint8_t *firstEvent = events + ((counter - tsRun--) * eventSize);
+			serializedTSSet(firstEvent, tsOffset, serializedTSGet(firstEvent, tsOffset) | I32T(0x80000000));
+
+			uint8_t *secondEvent = events + ((counter - tsRun--) * eventSize);
+			serializedTSSet(secondEvent, tsOffset, I32T(tsRun));
+
+			if (doMemMove) {
+				memmove(events + currOffset, firstEvent, eventSize * 2);
+			}
+			else {
+				doMemMove = true;
+			}
+			currOffset += eventSize * 2;
+
+			while (tsRun > 0) {
+				uint8_t *thirdEvent = events + ((counter - tsRun--) * eventSize);
+				memmove(events + currOffset, thirdEvent, tsOffset);
+				currOffset += tsOffset;
+			}
+		}
+		else {
+			if (doMemMove) {
+				memmove(events + currOffset, events + ((counter - tsRun) * eventSize), eventSize * tsRun);
+			}
+			currOffset += eventSize * tsRun;
+		}
+
+		lastTS = currTS;
+		tsRun  = 1;
+	}
+
+	return (currOffset);
+}
+
+/**
+ * Random events with runs of equal timestamps. Higher density means more
+ * and longer runs; density 0 gives a single run over all events.
+ */
+static inline void serializedTSGenerate(uint8_t *events, size_t eventNumber, size_t eventSize, size_t tsOffset,
+	uint32_t density, int32_t firstTimestamp) {
+	int32_t timestamp = firstTimestamp;
+
+	for (size_t i = 0; i < eventNumber; i++) {
+		for (size_t b = 0; b < tsOffset; b++) {
+			events[(i * eventSize) + b] = (uint8_t) randomNext();
+		}
+
+		if (density != 0 && randomRange(density) == 0) {
+			timestamp += I32T(1 + randomRange(3));
+		}
+
+		serializedTSSet(events + (i * eventSize), tsOffset, timestamp);
+	}
+}
+
+enum polarity_pattern {
+	POLARITY_DENSE,   // Small timestamp and address steps, as from a real sensor.
+	POLARITY_RANDOM,  // Any timestamp and address, up to the maximum X/Y.
+	POLARITY_WRAP,    // Timestamps wrapping around from INT32_MAX back to 0.
+	POLARITY_MAX_XY,  // Alternating between address 0 and the maximum X/Y.
+	POLARITY_CONSTANT // All events the same, zero-width blocks.
+};
+#define POLARITY_PATTERNS 5
+
+static inline void polarityGenerate(
+	struct caer_polarity_event *events, size_t eventNumber, enum polarity_pattern pattern) {
+	int32_t timestamp = I32T(randomRange(1000000));
+	uint32_t x        = randomRange(346);
+	uint32_t y        = randomRange(260);
+
+	if (pattern == POLARITY_WRAP) {
+		timestamp = INT32_MAX - I32T(randomRange(64));
+	}
+
+	for (size_t i = 0; i < eventNumber; i++) {
+		uint32_t flags = randomNext() & 0x03;
+
+		switch (pattern) {
+			case POLARITY_DENSE:
+				timestamp += I32T(randomRange(3));
+				x = (x + 346 + randomRange(9) - 4) % 346;
+				y = (y + 260 + randomRange(9) - 4) % 260;
+				break;
+
+			case POLARITY_RANDOM:
+				timestamp = I32T(randomNext() >> 1);
+				x         = randomNext() & POLARITY_X_ADDR_MASK;
+				y         = randomNext() & POLARITY_Y_ADDR_MASK;
+				break;
+
+			case POLARITY_WRAP:
+				timestamp = I32T((U32T(timestamp) + 1) & U32T(INT32_MAX));
+				x         = randomRange(346);
+				y         = randomRange(260);
+				break;
+
+			case POLARITY_MAX_XY:
+				x = (i & 0x01) ? (POLARITY_X_ADDR_MASK) : (0);
+				y = (i & 0x01) ? (0) : (POLARITY_Y_ADDR_MASK);
+				break;
+
+			case POLARITY_CONSTANT:
+				flags = 0x01;
+				break;
+		}
+
+		events[i].data
+			= htole32((x << POLARITY_X_ADDR_SHIFT) | (y << POLARITY_Y_ADDR_SHIFT) | flags);
+		events[i].timestamp = I32T(htole32(U32T(timestamp)));
+	}
+}
+
+/**
+ * Frame content: a smooth moving pattern with some noise, shifted up
+ * from 10 bits like most sensors, or random full 16 bit values.
+ */
+static inline void frameGenerate(uint16_t *pixels, int32_t lengthX, int32_t lengthY, int32_t channels, int32_t frame,
+	bool fullRange) {
+	for (int32_t y = 0; y < lengthY; y++) {
+		for (int32_t x = 0; x < lengthX; x++) {
+			for (int32_t c = 0; c < channels; c++) {
+				size_t index = (size_t)(((y * lengthX) + x) * channels + c);
+
+				if (fullRange) {
+					pixels[index] = (uint16_t) randomNext();
+				}
+				else {
+					int32_t value = ((x + frame + c) * 7 + (y * 3)) % 1024;
+					value         = (value + I32T(randomRange(8))) % 1024;
+
+					pixels[index] = (uint16_t)(value << 6);
+				}
+			}
+		}
+	}
+}
+
+#endif /* INOUT_TEST_DATA_H_ */
@@ -0,0 +1,442 @@
+/*
+ * Loopback test for UDP forward error correction, with a multicast group.
+ * Runs the UDP output (net_udp.c, output_common.c) in-process, sending to
+ * a multicast group on the loopback interface with 'fecGroupSize' set, and
+ * receives the datagrams on a socket that joined the group. The receiver
+ * drops one data datagram of every FEC group, at a different position in
+ * each, and rebuilds it from the others and the parity datagram with
+ * inout_udp_fec.h. Rebuilt datagrams must equal the dropped ones, and the
+ * event packets reassembled from all datagrams must equal the sent ones.
+ * Returns 0 if the test passes, 1 otherwise, and 77 (skipped) if multicast
+ * is not available on the loopback interface.
+ */
+
+#define _GNU_SOURCE 1
+
+#include "modules/inout/out/net_udp.c"
+#include "modules/inout/inout_udp_fec.h"
+
+#include <libcaer/events/polarity.h>
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Report a failed check and leave the enclosing do { } while (0) block of a test
+// case, which then cleans up and returns its result (still false).
+#define CHECK(COND, ...)                                        \
+	if (!(COND)) {                                              \
+		fprintf(stderr, "%s:%d: FAILED: ", __FILE__, __LINE__); \
+		fprintf(stderr, __VA_ARGS__);                           \
+		fprintf(stderr, "\n");                                  \
+		break;                                                  \
+	}
+
+#define FEC_TEST_GROUP "239.255.67.65"
+#define FEC_TEST_PORT 16665
+#define FEC_TEST_GROUP_SIZE 4
+#define FEC_TEST_SOURCE_ID 1
+// 60 small packets of one datagram each, and 2 big ones of two datagrams
+// each (more than AEDAT3_MAX_UDP_SIZE), so the last FEC group is complete.
+#define FEC_TEST_PACKETS 62
+#define FEC_TEST_SMALL_EVENTS 10
+#define FEC_TEST_BIG_EVENTS 10000
+#define FEC_TEST_DATAGRAMS 64
+#define FEC_TEST_MAX_RECEIVED 256
+#define EXIT_SKIPPED 77
+
+struct fec_test_datagram {
+	uint8_t *data;
+	size_t length;
+};
+
+struct fec_test_receiver {
+	int socket;
+	struct fec_test_datagram datagrams[FEC_TEST_MAX_RECEIVED];
+	size_t datagramsNumber;
+};
+
+/**
+ * Source info of the fake source, replacing the one of the SDK library,
+ * which needs a running mainloop.
+ */
+sshsNode caerMainloopGetSourceInfo(int16_t sourceID) {
+	char nodePath[64];
+	snprintf(nodePath, 64, "/%" PRIi16 "-FECSource/sourceInfo/", sourceID);
+
+	sshsNode sourceInfoNode = sshsGetNode(sshsGetGlobal(), nodePath);
+
+	sshsNodeCreateString(sourceInfoNode, "sourceString", "#Source 1: inout_udp_fec_test\r\n", 1, 2048,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Description of the source.");
+
+	return (sourceInfoNode);
+}
+
+/**
+ * Receiver thread: keep every datagram, until none came for a second.
+ */
+static void *fecTestReceive(void *receiverArg) {
+	struct fec_test_receiver *receiver = receiverArg;
+
+	// Parity datagrams are the longest, with their FEC header.
+	size_t bufferSize = INOUT_FEC_PARITY_MAX_LENGTH;
+	uint8_t *buffer   = malloc(bufferSize);
+	if (buffer == NULL) {
+		return (NULL);
+	}
+
+	while (receiver->datagramsNumber < FEC_TEST_MAX_RECEIVED) {
+		ssize_t length = recv(receiver->socket, buffer, bufferSize, 0);
+		if (length <= 0) {
+			break;
+		}
+
+		struct fec_test_datagram *datagram = &receiver->datagrams[receiver->datagramsNumber];
+
+		datagram->data = malloc((size_t) length);
+		if (datagram->data == NULL) {
+			break;
+		}
+
+		memcpy(datagram->data, buffer, (size_t) length);
+		datagram->length = (size_t) length;
+
+		receiver->datagramsNumber++;
+	}
+
+	free(buffer);
+
+	return (NULL);
+}
+
+/**
+ * Join the multicast group on the loopback interface.
+ *
+ * @return the receiving socket, or -1 if multicast is not available.
+ */
+static int fecTestReceiverOpen(void) {
+	int receiverSocket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (receiverSocket < 0) {
+		return (-1);
+	}
+
+	int reuse = 1;
+	setsockopt(receiverSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	// Big packets come in two datagrams right after each other.
+	int receiveBuffer = 4 * 1024 * 1024;
+	setsockopt(receiverSocket, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+	struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+	setsockopt(receiverSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	struct sockaddr_in address = {.sin_family = AF_INET, .sin_port = htons(FEC_TEST_PORT)};
+	address.sin_addr.s_addr    = htonl(INADDR_ANY);
+
+	struct ip_mreq membership;
+	inet_pton(AF_INET, FEC_TEST_GROUP, &membership.imr_multiaddr);
+	inet_pton(AF_INET, "127.0.0.1", &membership.imr_interface);
+
+	if ((bind(receiverSocket, (struct sockaddr *) &address, sizeof(address)) != 0)
+		|| (setsockopt(receiverSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0)) {
+		close(receiverSocket);
+		return (-1);
+	}
+
+	return (receiverSocket);
+}
+
+/**
+ * Allocate packet number index of the test: polarity events with X
+ * address index and increasing timestamps.
+ */
+static caerPolarityEventPacket fecTestPacket(size_t index, int32_t *timestamp) {
+	int32_t eventsNumber = ((index == 10) || (index == 33)) ? (FEC_TEST_BIG_EVENTS) : (FEC_TEST_SMALL_EVENTS);
+
+	caerPolarityEventPacket packet = caerPolarityEventPacketAllocate(eventsNumber, FEC_TEST_SOURCE_ID, 0);
+	if (packet == NULL) {
+		return (NULL);
+	}
+
+	for (int32_t i = 0; i < eventsNumber; i++) {
+		caerPolarityEvent event = caerPolarityEventPacketGetEvent(packet, i);
+
+		caerPolarityEventSetTimestamp(event, (*timestamp)++);
+		caerPolarityEventSetX(event, U16T(index));
+		caerPolarityEventSetY(event, U16T(i));
+		caerPolarityEventValidate(event, packet);
+	}
+
+	return (packet);
+}
+
+/**
+ * Send the test packets through the UDP output, with FEC.
+ *
+ * @param sentPackets copies of the sent packets, to compare to what arrives.
+ *
+ * @return true on success, false if the output failed to start.
+ */
+static bool fecTestSend(caerPolarityEventPacket *sentPackets) {
+	struct caer_module_data moduleData = {
+		.moduleID = 2, .moduleStatus = CAER_MODULE_RUNNING, .moduleSubSystemString = strdup("FECTest")};
+	atomic_store(&moduleData.running, true);
+	atomic_store(&moduleData.moduleLogLevel, CAER_LOG_WARNING);
+	moduleData.moduleNode  = sshsGetNode(sshsGetGlobal(), "/2-FECTest/");
+	moduleData.moduleState = calloc(1, sizeof(struct output_common_state));
+
+	if (moduleData.moduleSubSystemString == NULL || moduleData.moduleState == NULL) {
+		free(moduleData.moduleSubSystemString);
+		free(moduleData.moduleState);
+		return (false);
+	}
+
+	sshsNode node = moduleData.moduleNode;
+
+	sshsNodeCreateString(node, "ipAddress", FEC_TEST_GROUP, 2, INET6_ADDRSTRLEN, SSHS_FLAGS_NORMAL, "");
+	sshsNodePutString(node, "ipAddress", FEC_TEST_GROUP);
+	sshsNodeCreateInt(node, "portNumber", FEC_TEST_PORT, 1, UINT16_MAX, SSHS_FLAGS_NORMAL, "");
+	sshsNodePutInt(node, "portNumber", FEC_TEST_PORT);
+	sshsNodeCreateString(node, "multicastInterface", "127.0.0.1", 0, INET6_ADDRSTRLEN, SSHS_FLAGS_NORMAL, "");
+	sshsNodePutString(node, "multicastInterface", "127.0.0.1");
+	sshsNodeCreateInt(node, "fecGroupSize", FEC_TEST_GROUP_SIZE, 0, INOUT_FEC_MAX_GROUP_SIZE, SSHS_FLAGS_NORMAL, "");
+	sshsNodePutInt(node, "fecGroupSize", FEC_TEST_GROUP_SIZE);
+
+	if (!caerOutputNetUDPInit(&moduleData)) {
+		free(moduleData.moduleSubSystemString);
+		free(moduleData.moduleState);
+		return (false);
+	}
+
+	int32_t timestamp = 0;
+
+	for (size_t i = 0; i < FEC_TEST_PACKETS; i++) {
+		caerEventPacketContainer container = caerEventPacketContainerAllocate(1);
+		caerPolarityEventPacket packet     = fecTestPacket(i, &timestamp);
+		if (container == NULL || packet == NULL) {
+			free(container);
+			free(packet);
+			break;
+		}
+
+		sentPackets[i] = (caerPolarityEventPacket) caerEventPacketCopy((caerEventPacketHeader) packet);
+
+		caerEventPacketContainerSetEventPacket(container, 0, (caerEventPacketHeader) packet);
+
+		caerOutputCommonRun(&moduleData, container, NULL);
+
+		caerEventPacketContainerFree(container);
+
+		// Don't overrun the receiver, losses must only be the ones dropped on purpose.
+		struct timespec sendSleep = {.tv_sec = 0, .tv_nsec = 2000000};
+		nanosleep(&sendSleep, NULL);
+	}
+
+	caerOutputCommonExit(&moduleData);
+
+	free(moduleData.moduleSubSystemString);
+	free(moduleData.moduleState);
+
+	return (true);
+}
+
+static bool testUDPFECMulticast(int receiverSocket) {
+	struct fec_test_receiver *receiver = calloc(1, sizeof(*receiver));
+	caerPolarityEventPacket sentPackets[FEC_TEST_PACKETS] = {NULL};
+	// All data datagrams, received or rebuilt (own copy), at their sequence number.
+	struct fec_test_datagram data[FEC_TEST_DATAGRAMS] = {{NULL, 0}};
+	bool dataRebuilt[FEC_TEST_DATAGRAMS]              = {false};
+	struct inout_fec_receiver fecReceiver             = {{NULL}, {0}, {0}, {false}};
+	uint8_t *recovered                                = malloc(INOUT_FEC_DATAGRAM_MAX_LENGTH);
+	uint8_t *stream                                   = malloc(FEC_TEST_DATAGRAMS * AEDAT3_MAX_UDP_SIZE);
+	bool result                                       = false;
+
+	do {
+		CHECK(receiver != NULL && recovered != NULL && stream != NULL, "memory allocation failure");
+
+		receiver->socket = receiverSocket;
+
+		pthread_t receiverThread;
+		CHECK(pthread_create(&receiverThread, NULL, &fecTestReceive, receiver) == 0, "receiver thread start failed");
+
+		bool sent = fecTestSend(sentPackets);
+
+		pthread_join(receiverThread, NULL);
+
+		CHECK(sent, "UDP output failed to start");
+
+		// Drop one data datagram per group, a different one each time, then
+		// rebuild it when the parity datagram of its group comes in.
+		size_t parityDatagrams = 0, dropped = 0, rebuilt = 0;
+		struct fec_test_datagram droppedData[FEC_TEST_DATAGRAMS] = {{NULL, 0}};
+		bool valid                                               = true;
+
+		for (size_t i = 0; i < receiver->datagramsNumber; i++) {
+			struct fec_test_datagram *datagram = &receiver->datagrams[i];
+
+			if (inoutFECIsParity(datagram->data, datagram->length)) {
+				parityDatagrams++;
+
+				size_t recoveredLength
+					= inoutFECReceiverRecover(&fecReceiver, datagram->data, datagram->length, recovered);
+				if (recoveredLength == 0) {
+					continue;
+				}
+
+				uint64_t sequence = inoutFECSequence(recovered);
+				if (sequence >= FEC_TEST_DATAGRAMS || data[sequence].data != NULL) {
+					valid = false;
+					break;
+				}
+
+				data[sequence].data = malloc(recoveredLength);
+				if (data[sequence].data == NULL) {
+					valid = false;
+					break;
+				}
+
+				memcpy(data[sequence].data, recovered, recoveredLength);
+				data[sequence].length = recoveredLength;
+				dataRebuilt[sequence] = true;
+
+				rebuilt++;
+				continue;
+			}
+
+			uint64_t sequence = inoutFECSequence(datagram->data);
+			if (sequence >= FEC_TEST_DATAGRAMS || data[sequence].data != NULL || droppedData[sequence].data != NULL) {
+				valid = false;
+				break;
+			}
+
+			size_t group = (size_t) (sequence / FEC_TEST_GROUP_SIZE);
+			if ((sequence % FEC_TEST_GROUP_SIZE) == (group % FEC_TEST_GROUP_SIZE)) {
+				droppedData[sequence] = *datagram;
+				dropped++;
+				continue;
+			}
+
+			if (!inoutFECReceiverAdd(&fecReceiver, datagram->data, datagram->length)) {
+				valid = false;
+				break;
+			}
+
+			data[sequence] = *datagram;
+		}
+
+		CHECK(valid, "unexpected or duplicate datagram sequence number");
+		CHECK(parityDatagrams == (FEC_TEST_DATAGRAMS / FEC_TEST_GROUP_SIZE), "%zu parity datagrams, expected %d",
+			parityDatagrams, FEC_TEST_DATAGRAMS / FEC_TEST_GROUP_SIZE);
+		CHECK(dropped == (FEC_TEST_DATAGRAMS / FEC_TEST_GROUP_SIZE), "%zu datagrams dropped, expected %d", dropped,
+			FEC_TEST_DATAGRAMS / FEC_TEST_GROUP_SIZE);
+		CHECK(rebuilt == dropped, "%zu datagrams rebuilt, %zu dropped", rebuilt, dropped);
+
+		// Rebuilt datagrams must be exactly the dropped ones.
+		size_t mismatches = 0;
+
+		for (size_t i = 0; i < FEC_TEST_DATAGRAMS; i++) {
+			if (droppedData[i].data != NULL
+				&& ((data[i].length != droppedData[i].length)
+					   || (memcmp(data[i].data, droppedData[i].data, data[i].length) != 0))) {
+				mismatches++;
+			}
+		}
+
+		CHECK(mismatches == 0, "%zu rebuilt datagrams differ from the dropped ones", mismatches);
+
+		// Reassemble the event packets from all datagrams, in sequence order.
+		size_t streamSize = 0;
+		bool complete     = true;
+
+		for (size_t i = 0; i < FEC_TEST_DATAGRAMS; i++) {
+			if (data[i].data == NULL) {
+				complete = false;
+				break;
+			}
+
+			memcpy(stream + streamSize, data[i].data + AEDAT3_NETWORK_HEADER_LENGTH,
+				data[i].length - AEDAT3_NETWORK_HEADER_LENGTH);
+			streamSize += data[i].length - AEDAT3_NETWORK_HEADER_LENGTH;
+		}
+
+		CHECK(complete, "datagrams missing after recovery");
+
+		size_t streamPosition = 0;
+		size_t packetsNumber  = 0;
+		bool packetsEqual     = true;
+
+		while ((streamSize - streamPosition) >= CAER_EVENT_PACKET_HEADER_SIZE && packetsNumber < FEC_TEST_PACKETS) {
+			caerEventPacketHeaderConst packet = (caerEventPacketHeaderConst)(stream + streamPosition);
+			caerEventPacketHeaderConst sentPacket = (caerEventPacketHeaderConst) sentPackets[packetsNumber];
+
+			size_t eventsSize = (size_t) (caerEventPacketHeaderGetEventNumber(packet)
+										  * caerEventPacketHeaderGetEventSize(packet));
+
+			if ((sentPacket == NULL) || (caerEventPacketHeaderGetEventType(packet) != POLARITY_EVENT)
+				|| (caerEventPacketHeaderGetEventNumber(packet) != caerEventPacketHeaderGetEventNumber(sentPacket))
+				|| ((streamSize - streamPosition - CAER_EVENT_PACKET_HEADER_SIZE) < eventsSize)
+				|| (memcmp(caerGenericEventGetEvent(packet, 0), caerGenericEventGetEvent(sentPacket, 0), eventsSize)
+					   != 0)) {
+				packetsEqual = false;
+				break;
+			}
+
+			streamPosition += CAER_EVENT_PACKET_HEADER_SIZE + eventsSize;
+			packetsNumber++;
+		}
+
+		CHECK(packetsEqual, "event packet %zu differs from the sent one", packetsNumber);
+		CHECK(packetsNumber == FEC_TEST_PACKETS && streamPosition == streamSize,
+			"%zu event packets reassembled, expected %d", packetsNumber, FEC_TEST_PACKETS);
+
+		result = true;
+	} while (0);
+
+	for (size_t i = 0; i < FEC_TEST_DATAGRAMS; i++) {
+		if (dataRebuilt[i]) {
+			free(data[i].data);
+		}
+	}
+
+	if (receiver != NULL) {
+		for (size_t i = 0; i < receiver->datagramsNumber; i++) {
+			free(receiver->datagrams[i].data);
+		}
+	}
+
+	for (size_t i = 0; i < FEC_TEST_PACKETS; i++) {
+		free(sentPackets[i]);
+	}
+
+	inoutFECReceiverFree(&fecReceiver);
+	free(recovered);
+	free(stream);
+	free(receiver);
+
+	return (result);
+}
+
+int main(void) {
+	int receiverSocket = fecTestReceiverOpen();
+	if (receiverSocket < 0) {
+		printf("UDP FEC multicast: SKIPPED (no multicast on the loopback interface).\n");
+		return (EXIT_SKIPPED);
+	}
+
+	bool passed = testUDPFECMulticast(receiverSocket);
+
+	close(receiverSocket);
+
+	printf("UDP FEC multicast: %s\n", (passed) ? ("passed") : ("FAILED"));
+
+	return ((passed) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
@@ -12,6 +12,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 #include <boost/format.hpp>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <new>
@@ -29,19 +30,45 @@ using asioTCP    = boost::asio::ip::tcp;
 
 #define CONFIG_SERVER_NAME "Config Server"
 
+// Stop reading further requests from a client while this many bytes of
+// responses to it are still waiting to be sent.
+#define CONFIG_SERVER_MAX_QUEUED_RESPONSES (1024 * 1024)
+
 class ConfigServerConnection;
 
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
 	const uint8_t *extra, size_t extraLength, const uint8_t *node, size_t nodeLength, const uint8_t *key,
 	size_t keyLength, const uint8_t *value, size_t valueLength);
+static bool caerConfigServerDumpNode(const std::string &nodePath, std::string &dump);
 
 class ConfigServerConnection : public std::enable_shared_from_this<ConfigServerConnection> {
 private:
 	asioTCP::socket socket;
-	uint8_t data[CAER_CONFIG_SERVER_BUFFER_SIZE];
+	std::vector<uint8_t> data;
+	// Request being handled, responses are sent in its format.
+	bool requestExtended;
+	uint32_t requestID;
+	// Responses waiting to be sent, the first one is being written.
+	std::deque<std::vector<uint8_t>> writeQueue;
+	size_t writeQueueBytes;
+	bool readPaused;
+	// Tree dump in progress: paths of the nodes still to dump, and the dump
+	// of the last node found, sent once it's known if more follow.
+	bool dumpActive;
+	std::vector<std::string> dumpPaths;
+	size_t dumpNext;
+	std::string dumpPending;
 
 public:
-	ConfigServerConnection(asioTCP::socket s) : socket(std::move(s)) {
+	ConfigServerConnection(asioTCP::socket s) :
+		socket(std::move(s)),
+		data(CAER_CONFIG_SERVER_EXT_HEADER_SIZE),
+		requestExtended(false),
+		requestID(0),
+		writeQueueBytes(0),
+		readPaused(false),
+		dumpActive(false),
+		dumpNext(0) {
 		logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s:%d.",
 			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
 	}
@@ -55,95 +82,223 @@ public:
 		readHeader();
 	}
 
-	uint8_t *getData() {
-		return (data);
+	bool isRequestExtended() const {
+		return (requestExtended);
+	}
+
+	void writeResponse(uint8_t action, uint8_t type, const uint8_t *msg, size_t msgLength, bool more = false) {
+		std::vector<uint8_t> response;
+
+		if (requestExtended) {
+			response.resize(CAER_CONFIG_SERVER_EXT_RESPONSE_HEADER_SIZE + msgLength);
+
+			response[0] = U8T(action | CAER_CONFIG_EXTENDED);
+			response[1] = type;
+
+			*((uint16_t *) (response.data() + 2)) = htole16((more) ? (CAER_CONFIG_RESPONSE_MORE) : (0));
+			*((uint32_t *) (response.data() + 4)) = htole32(requestID);
+			*((uint32_t *) (response.data() + 8)) = htole32((uint32_t) msgLength);
+			memcpy(response.data() + CAER_CONFIG_SERVER_EXT_RESPONSE_HEADER_SIZE, msg, msgLength);
+		}
+		else {
+			response.resize(4 + msgLength);
+
+			response[0] = action;
+			response[1] = type;
+
+			*((uint16_t *) (response.data() + 2)) = htole16((uint16_t) msgLength);
+			memcpy(response.data() + 4, msg, msgLength);
+		}
+
+		writeQueueBytes += response.size();
+		writeQueue.push_back(std::move(response));
+
+		// Start writing, if not already in progress.
+		if (writeQueue.size() == 1) {
+			writeNext();
+		}
+	}
+
+	// Send the dumps of the given nodes, one response each. They are generated
+	// as the client takes them, no further requests are read until done.
+	void startDump(std::vector<std::string> nodePaths) {
+		dumpActive = true;
+		dumpPaths  = std::move(nodePaths);
+		dumpNext   = 0;
+		dumpPending.clear();
+
+		continueDump();
+	}
+
+private:
+	void continueDump() {
+		if (!dumpActive) {
+			return;
+		}
+
+		while ((dumpNext < dumpPaths.size()) && (writeQueueBytes <= CONFIG_SERVER_MAX_QUEUED_RESPONSES)) {
+			std::string dump;
+
+			// Skip nodes removed in the meantime.
+			if (!caerConfigServerDumpNode(dumpPaths[dumpNext++], dump)) {
+				continue;
+			}
+
+			if (!dumpPending.empty()) {
+				writeResponse(CAER_CONFIG_DUMP_TREE, SSHS_STRING, (const uint8_t *) dumpPending.data(),
+					dumpPending.length(), true);
+			}
+
+			dumpPending = std::move(dump);
+		}
+
+		if (dumpNext < dumpPaths.size()) {
+			// Continue once the client took some responses.
+			return;
+		}
+
+		if (dumpPending.empty()) {
+			// Whole tree removed in the meantime.
+			const char *errorMsg = "Node doesn't exist. Operations are only allowed on existing data.";
+			writeResponse(CAER_CONFIG_ERROR, SSHS_STRING, (const uint8_t *) errorMsg, strlen(errorMsg) + 1);
+		}
+		else {
+			writeResponse(CAER_CONFIG_DUMP_TREE, SSHS_STRING, (const uint8_t *) dumpPending.data(),
+				dumpPending.length(), false);
+		}
+
+		dumpActive = false;
+		dumpPaths.clear();
+		dumpNext = 0;
+		dumpPending.clear();
 	}
 
-	void writeResponse(size_t dataLength) {
+	void writeNext() {
 		auto self(shared_from_this());
 
-		asio::async_write(socket, asio::buffer(data, dataLength),
+		asio::async_write(socket, asio::buffer(writeQueue.front()),
 			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to write response");
+					return;
 				}
-				else {
-					// Restart.
+
+				writeQueueBytes -= writeQueue.front().size();
+				writeQueue.pop_front();
+
+				if (!writeQueue.empty()) {
+					writeNext();
+				}
+
+				// Generate more of a tree dump, now that there's room for it.
+				continueDump();
+
+				// Restart reading requests, once the client took enough responses.
+				if (readPaused && !dumpActive && (writeQueueBytes <= CONFIG_SERVER_MAX_QUEUED_RESPONSES)) {
+					readPaused = false;
 					readHeader();
 				}
 			});
 	}
 
-private:
 	void readHeader() {
 		auto self(shared_from_this());
 
-		asio::async_read(socket, asio::buffer(data, CAER_CONFIG_SERVER_HEADER_SIZE),
+		asio::async_read(socket, asio::buffer(data.data(), CAER_CONFIG_SERVER_HEADER_SIZE),
 			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to read header");
 				}
+				else if (data[0] & CAER_CONFIG_EXTENDED) {
+					// Extended request, get REQUEST_ID first.
+					readRequestID();
+				}
 				else {
-					// If we have enough data, we start parsing the lengths.
-					// The main header is 10 bytes.
-					// Decode length header fields (all in little-endian).
-					uint16_t extraLength = le16toh(*(uint16_t *) (data + 2));
-					uint16_t nodeLength  = le16toh(*(uint16_t *) (data + 4));
-					uint16_t keyLength   = le16toh(*(uint16_t *) (data + 6));
-					uint16_t valueLength = le16toh(*(uint16_t *) (data + 8));
-
-					// Total length to get for command.
-					size_t readLength = (size_t)(extraLength + nodeLength + keyLength + valueLength);
-
-					// Check for wrong (excessive) requested read length.
-					// Close connection by falling out of scope.
-					if (readLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
-						logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME,
-							"Client %s:%d: read length error (%d bytes requested).",
-							socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(),
-							readLength);
-						return;
-					}
+					requestExtended = false;
+					requestID       = 0;
 
-					readData(readLength);
+					readData(CAER_CONFIG_SERVER_HEADER_SIZE);
 				}
 			});
 	}
 
-	void readData(size_t dataLength) {
+	void readRequestID() {
 		auto self(shared_from_this());
 
-		asio::async_read(socket, asio::buffer(data + CAER_CONFIG_SERVER_HEADER_SIZE, dataLength),
+		asio::async_read(socket,
+			asio::buffer(data.data() + CAER_CONFIG_SERVER_HEADER_SIZE,
+				CAER_CONFIG_SERVER_EXT_HEADER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE),
 			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					handleError(error, "Failed to read request ID");
+				}
+				else {
+					requestExtended = true;
+					requestID       = le32toh(*(uint32_t *) (data.data() + CAER_CONFIG_SERVER_HEADER_SIZE));
+
+					readData(CAER_CONFIG_SERVER_EXT_HEADER_SIZE);
+				}
+			});
+	}
+
+	void readData(size_t headerSize) {
+		// If we have enough data, we start parsing the lengths.
+		// Decode length header fields (all in little-endian).
+		uint16_t extraLength = le16toh(*(uint16_t *) (data.data() + 2));
+		uint16_t nodeLength  = le16toh(*(uint16_t *) (data.data() + 4));
+		uint16_t keyLength   = le16toh(*(uint16_t *) (data.data() + 6));
+		uint16_t valueLength = le16toh(*(uint16_t *) (data.data() + 8));
+
+		// Total length to get for command.
+		size_t readLength = (size_t)(extraLength + nodeLength + keyLength + valueLength);
+
+		// Check for wrong (excessive) requested read length. Only extended
+		// requests can go beyond the normal maximum message size.
+		// Close connection by falling out of scope.
+		if (!requestExtended && (readLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE))) {
+			logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME,
+				"Client %s:%d: read length error (%d bytes requested).",
+				socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(), readLength);
+			return;
+		}
+
+		// Never shrink below the extended header, the next request ID goes there.
+		data.resize(std::max<size_t>(CAER_CONFIG_SERVER_EXT_HEADER_SIZE, headerSize + readLength));
+
+		auto self(shared_from_this());
+
+		asio::async_read(socket, asio::buffer(data.data() + headerSize, readLength),
+			[this, self, headerSize, extraLength, nodeLength, keyLength, valueLength](
+				const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to read data");
 				}
 				else {
 					// Decode command header fields.
-					uint8_t action = data[0];
+					uint8_t action = data[0] & U8T(~CAER_CONFIG_EXTENDED);
 					uint8_t type   = data[1];
 
-					// Decode length header fields (all in little-endian).
-					uint16_t extraLength = le16toh(*(uint16_t *) (data + 2));
-					uint16_t nodeLength  = le16toh(*(uint16_t *) (data + 4));
-					uint16_t keyLength   = le16toh(*(uint16_t *) (data + 6));
-					uint16_t valueLength = le16toh(*(uint16_t *) (data + 8));
-
 					// Now we have everything. The header fields are already
 					// fully decoded: handle request (and send back data eventually).
-					const uint8_t *extra = (extraLength == 0) ? (nullptr) : (data + CAER_CONFIG_SERVER_HEADER_SIZE);
-					const uint8_t *node
-						= (nodeLength == 0) ? (nullptr) : (data + CAER_CONFIG_SERVER_HEADER_SIZE + extraLength);
-					const uint8_t *key = (keyLength == 0)
-											 ? (nullptr)
-											 : (data + CAER_CONFIG_SERVER_HEADER_SIZE + extraLength + nodeLength);
+					const uint8_t *extra = (extraLength == 0) ? (nullptr) : (data.data() + headerSize);
+					const uint8_t *node  = (nodeLength == 0) ? (nullptr) : (data.data() + headerSize + extraLength);
+					const uint8_t *key
+						= (keyLength == 0) ? (nullptr) : (data.data() + headerSize + extraLength + nodeLength);
 					const uint8_t *value
-						= (valueLength == 0)
-							  ? (nullptr)
-							  : (data + CAER_CONFIG_SERVER_HEADER_SIZE + extraLength + nodeLength + keyLength);
+						= (valueLength == 0) ? (nullptr)
+											 : (data.data() + headerSize + extraLength + nodeLength + keyLength);
 
 					caerConfigServerHandleRequest(
 						self, action, type, extra, extraLength, node, nodeLength, key, keyLength, value, valueLength);
+
+					// Continue with next request right away, unless the client
+					// isn't reading its responses or a tree dump is still going.
+					if (dumpActive || (writeQueueBytes > CONFIG_SERVER_MAX_QUEUED_RESPONSES)) {
+						readPaused = true;
+					}
+					else {
+						readHeader();
+					}
 				}
 			});
 	}
@@ -311,40 +466,22 @@ void caerConfigServerStop(void) {
 // protocol. A byte for ACTION, a byte for TYPE, 2 bytes for MSG_LEN and then
 // up to 4092 bytes of MSG, for a maximum total of 4096 bytes again.
 // MSG must be NUL terminated, and the NUL byte shall be part of the length.
-static inline void setMsgLen(uint8_t *buf, uint16_t msgLen) {
-	*((uint16_t *) (buf + 2)) = htole16(msgLen);
-}
-
+// Responses to extended requests use the extended format instead, see header.
 static inline void caerConfigSendError(std::shared_ptr<ConfigServerConnection> client, const char *errorMsg) {
-	size_t errorMsgLength = strlen(errorMsg);
-	size_t responseLength = 4 + errorMsgLength + 1; // +1 for terminating NUL byte.
-
-	uint8_t *response = client->getData();
-
-	response[0] = CAER_CONFIG_ERROR;
-	response[1] = SSHS_STRING;
-	setMsgLen(response, (uint16_t)(errorMsgLength + 1));
-	memcpy(response + 4, errorMsg, errorMsgLength);
-	response[4 + errorMsgLength] = '\0';
-
-	client->writeResponse(responseLength);
+	client->writeResponse(CAER_CONFIG_ERROR, SSHS_STRING, (const uint8_t *) errorMsg, strlen(errorMsg) + 1);
 
 	logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME, "Sent back error message '%s' to client.", errorMsg);
 }
 
 static inline void caerConfigSendResponse(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
-	const uint8_t *msg, size_t msgLength) {
-	size_t responseLength = 4 + msgLength;
-
-	uint8_t *response = client->getData();
-
-	response[0] = action;
-	response[1] = type;
-	setMsgLen(response, (uint16_t) msgLength);
-	memcpy(response + 4, msg, msgLength);
+	const uint8_t *msg, size_t msgLength, bool more = false) {
 	// Msg must already be NUL terminated!
+	if (!client->isRequestExtended() && (msgLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4))) {
+		caerConfigSendError(client, "Response too big, use an extended request.");
+		return;
+	}
 
-	client->writeResponse(responseLength);
+	client->writeResponse(action, type, msg, msgLength, more);
 
 	logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
 		"Sent back message to client: action=%" PRIu8 ", type=%" PRIu8 ", msgLength=%zu.", action, type, msgLength);
@@ -385,6 +522,201 @@ static inline void caerConfigSendBoolResponse(
 	caerConfigSendResponse(client, action, SSHS_BOOL, sendResult, sendResultLength);
 }
 
+static inline bool checkExtendedRequest(std::shared_ptr<ConfigServerConnection> client) {
+	if (!client->isRequestExtended()) {
+		// Send back error message to client.
+		caerConfigSendError(client, "Action is only available as extended request.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static inline bool checkStringList(
+	const uint8_t *list, size_t listLength, const char *name, std::shared_ptr<ConfigServerConnection> client) {
+	// A list of NUL terminated strings, so the last byte must be NUL.
+	if ((listLength == 0) || (list[listLength - 1] != '\0')) {
+		// Send back error message to client.
+		const std::string errorMsg = std::string(name) + " must be a list of NUL terminated strings.";
+		caerConfigSendError(client, errorMsg.c_str());
+		return (false);
+	}
+
+	return (true);
+}
+
+static inline void appendString(std::string &msg, const char *str) {
+	msg.append(str);
+	msg.push_back('\0'); // Terminating NUL byte.
+}
+
+static void appendValue(std::string &msg, sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
+	union sshs_node_attr_value value = sshsNodeGetAttribute(node, key, type);
+
+	char *valueStr = sshsHelperValueToStringConverter(type, value);
+	appendString(msg, valueStr);
+	free(valueStr);
+
+	// If this is a string, we must remember to free the original value.string
+	// too, since it will also be a copy of the string coming from SSHS.
+	if (type == SSHS_STRING) {
+		free(value.string);
+	}
+}
+
+// Minimum and maximum of the range, each NUL terminated.
+static std::string rangesToString(enum sshs_node_attr_value_type type, const struct sshs_node_attr_ranges &ranges) {
+	char buf[256];
+	size_t bufLen = 0;
+
+	switch (type) {
+		case SSHS_BOOL:
+			bufLen = 4;
+			memcpy(buf, "0\00\0", bufLen);
+			break;
+
+		case SSHS_INT:
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.min.iintRange)
+					  + 1; // Terminating NUL byte.
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.max.iintRange)
+					  + 1; // Terminating NUL byte.
+			break;
+
+		case SSHS_LONG:
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.min.ilongRange)
+					  + 1; // Terminating NUL byte.
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.max.ilongRange)
+					  + 1; // Terminating NUL byte.
+			break;
+
+		case SSHS_FLOAT:
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.min.ffloatRange)
+					  + 1; // Terminating NUL byte.
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.max.ffloatRange)
+					  + 1; // Terminating NUL byte.
+			break;
+
+		case SSHS_DOUBLE:
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.min.ddoubleRange)
+					  + 1; // Terminating NUL byte.
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.max.ddoubleRange)
+					  + 1; // Terminating NUL byte.
+			break;
+
+		case SSHS_STRING:
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.min.stringRange)
+					  + 1; // Terminating NUL byte.
+			bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.max.stringRange)
+					  + 1; // Terminating NUL byte.
+			break;
+
+		case SSHS_UNKNOWN:
+			break;
+	}
+
+	return (std::string(buf, bufLen));
+}
+
+static std::string flagsToString(int flags) {
+	std::string flagsStr;
+
+	if (flags & SSHS_FLAGS_READ_ONLY) {
+		flagsStr = "READ_ONLY";
+	}
+	else if (flags & SSHS_FLAGS_NOTIFY_ONLY) {
+		flagsStr = "NOTIFY_ONLY";
+	}
+	else {
+		flagsStr = "NORMAL";
+	}
+
+	if (flags & SSHS_FLAGS_NO_EXPORT) {
+		flagsStr += ",NO_EXPORT";
+	}
+
+	return (flagsStr);
+}
+
+// Error message for a failed sshsNodeStringToAttributeConverter(), based on errno.
+static const char *putErrorMessage(void) {
+	if (errno == EINVAL) {
+		return ("Impossible to convert value according to type.");
+	}
+	else if (errno == EPERM) {
+		return ("Cannot write to a read-only attribute.");
+	}
+	else if (errno == ERANGE) {
+		return ("Value out of attribute range.");
+	}
+	else {
+		// Unknown error.
+		return ("Unknown error.");
+	}
+}
+
+// Node path, then key, type, value, minimum, maximum, flags and description
+// of each attribute, all NUL terminated.
+static std::string dumpNode(sshsNode node) {
+	std::string dump;
+
+	appendString(dump, sshsNodeGetPath(node));
+
+	size_t numKeys;
+	const char **attrKeys = sshsNodeGetAttributeKeys(node, &numKeys);
+
+	for (size_t i = 0; i < numKeys; i++) {
+		enum sshs_node_attr_value_type attrType = sshsNodeGetAttributeType(node, attrKeys[i]);
+
+		// Attribute removed in the meantime.
+		if (attrType == SSHS_UNKNOWN) {
+			continue;
+		}
+
+		appendString(dump, attrKeys[i]);
+		appendString(dump, sshsHelperTypeToStringConverter(attrType));
+		appendValue(dump, node, attrKeys[i], attrType);
+		dump.append(rangesToString(attrType, sshsNodeGetAttributeRanges(node, attrKeys[i], attrType)));
+		appendString(dump, flagsToString(sshsNodeGetAttributeFlags(node, attrKeys[i], attrType)).c_str());
+
+		char *description = sshsNodeGetAttributeDescription(node, attrKeys[i], attrType);
+		appendString(dump, description);
+		free(description);
+	}
+
+	free(attrKeys);
+
+	return (dump);
+}
+
+// Dump of the node with the given path, false if it doesn't exist anymore.
+static bool caerConfigServerDumpNode(const std::string &nodePath, std::string &dump) {
+	std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+	sshs configStore = sshsGetGlobal();
+
+	if (!sshsExistsNode(configStore, nodePath.c_str())) {
+		return (false);
+	}
+
+	dump = dumpNode(sshsGetNode(configStore, nodePath.c_str()));
+
+	return (true);
+}
+
+// Paths of node and all nodes below it, depth-first.
+static void collectNodePaths(sshsNode node, std::vector<std::string> &nodePaths) {
+	nodePaths.push_back(sshsNodeGetPath(node));
+
+	size_t numChildren;
+	sshsNode *children = sshsNodeGetChildren(node, &numChildren);
+
+	for (size_t i = 0; i < numChildren; i++) {
+		collectNodePaths(children[i], nodePaths);
+	}
+
+	free(children);
+}
+
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
 	const uint8_t *extra, size_t extraLength, const uint8_t *node, size_t nodeLength, const uint8_t *key,
 	size_t keyLength, const uint8_t *value, size_t valueLength) {
@@ -488,19 +820,7 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			const char *typeStr = sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type);
 			if (!sshsNodeStringToAttributeConverter(wantedNode, (const char *) key, typeStr, (const char *) value)) {
 				// Send back correct error message to client.
-				if (errno == EINVAL) {
-					caerConfigSendError(client, "Impossible to convert value according to type.");
-				}
-				else if (errno == EPERM) {
-					caerConfigSendError(client, "Cannot write to a read-only attribute.");
-				}
-				else if (errno == ERANGE) {
-					caerConfigSendError(client, "Value out of attribute range.");
-				}
-				else {
-					// Unknown error.
-					caerConfigSendError(client, "Unknown error.");
-				}
+				caerConfigSendError(client, putErrorMessage());
 
 				break;
 			}
@@ -655,52 +975,10 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 
 			// We need to return a string with the two ranges,
 			// separated by a NUL character.
-			char buf[256];
-			size_t bufLen = 0;
-
-			switch (type) {
-				case SSHS_BOOL:
-					bufLen = 4;
-					memcpy(buf, "0\00\0", bufLen);
-					break;
-
-				case SSHS_INT:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.min.iintRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.max.iintRange)
-							  + 1; // Terminating NUL byte.
-					break;
+			const std::string rangesStr = rangesToString((enum sshs_node_attr_value_type) type, ranges);
 
-				case SSHS_LONG:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.min.ilongRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.max.ilongRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_FLOAT:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.min.ffloatRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.max.ffloatRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_DOUBLE:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.min.ddoubleRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.max.ddoubleRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_STRING:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.min.stringRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.max.stringRange)
-							  + 1; // Terminating NUL byte.
-					break;
-			}
-
-			caerConfigSendResponse(client, CAER_CONFIG_GET_RANGES, type, (const uint8_t *) buf, bufLen);
+			caerConfigSendResponse(
+				client, CAER_CONFIG_GET_RANGES, type, (const uint8_t *) rangesStr.data(), rangesStr.length());
 
 			break;
 		}
@@ -722,21 +1000,7 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			int flags
 				= sshsNodeGetAttributeFlags(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type);
 
-			std::string flagsStr;
-
-			if (flags & SSHS_FLAGS_READ_ONLY) {
-				flagsStr = "READ_ONLY";
-			}
-			else if (flags & SSHS_FLAGS_NOTIFY_ONLY) {
-				flagsStr = "NOTIFY_ONLY";
-			}
-			else {
-				flagsStr = "NORMAL";
-			}
-
-			if (flags & SSHS_FLAGS_NO_EXPORT) {
-				flagsStr += ",NO_EXPORT";
-			}
+			const std::string flagsStr = flagsToString(flags);
 
 			caerConfigSendResponse(
 				client, CAER_CONFIG_GET_FLAGS, SSHS_STRING, (const uint8_t *) flagsStr.c_str(), flagsStr.length() + 1);
@@ -931,6 +1195,128 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			break;
 		}
 
+		case CAER_CONFIG_GET_MULTI: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkExtendedRequest(client)) {
+				break;
+			}
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			if (!checkStringList(key, keyLength, "Key", client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			// Type and value for each key, empty if no attribute with that key exists.
+			std::string results;
+
+			for (const char *attrKey = (const char *) key; attrKey < ((const char *) key + keyLength);
+				 attrKey += strlen(attrKey) + 1) {
+				enum sshs_node_attr_value_type attrType = sshsNodeGetAttributeType(wantedNode, attrKey);
+
+				if (attrType == SSHS_UNKNOWN) {
+					appendString(results, "");
+					appendString(results, "");
+					continue;
+				}
+
+				appendString(results, sshsHelperTypeToStringConverter(attrType));
+				appendValue(results, wantedNode, attrKey, attrType);
+			}
+
+			caerConfigSendResponse(
+				client, CAER_CONFIG_GET_MULTI, SSHS_STRING, (const uint8_t *) results.data(), results.length());
+
+			break;
+		}
+
+		case CAER_CONFIG_PUT_MULTI: {
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkExtendedRequest(client)) {
+				break;
+			}
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			if (!checkStringList(value, valueLength, "Value", client)) {
+				break;
+			}
+
+			// Split up into key, type, value triples.
+			std::vector<const char *> parts;
+
+			for (const char *part = (const char *) value; part < ((const char *) value + valueLength);
+				 part += strlen(part) + 1) {
+				parts.push_back(part);
+			}
+
+			if ((parts.size() % 3) != 0) {
+				caerConfigSendError(client, "Value must be a list of key, type, value triples.");
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			// Result for each triple, in order. Like for single puts, only
+			// allow operations on existing attributes.
+			std::string results;
+
+			for (size_t i = 0; i < parts.size(); i += 3) {
+				enum sshs_node_attr_value_type attrType = sshsHelperStringToTypeConverter(parts[i + 1]);
+
+				if (!sshsNodeAttributeExists(wantedNode, parts[i], attrType)) {
+					appendString(results,
+						"Attribute of given type doesn't exist. Operations are only allowed on existing data.");
+				}
+				else if (!sshsNodeStringToAttributeConverter(wantedNode, parts[i], parts[i + 1], parts[i + 2])) {
+					appendString(results, putErrorMessage());
+				}
+				else {
+					appendString(results, "true");
+				}
+			}
+
+			caerConfigSendResponse(
+				client, CAER_CONFIG_PUT_MULTI, SSHS_STRING, (const uint8_t *) results.data(), results.length());
+
+			break;
+		}
+
+		case CAER_CONFIG_DUMP_TREE: {
+			std::vector<std::string> nodePaths;
+
+			{
+				std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+				if (!checkExtendedRequest(client)) {
+					break;
+				}
+
+				if (!checkNodeExists(configStore, (const char *) node, client)) {
+					break;
+				}
+
+				// This cannot fail, since we know the node exists from above.
+				collectNodePaths(sshsGetNode(configStore, (const char *) node), nodePaths);
+			}
+
+			// One response per node, all but the last one flagged as having more
+			// following. Dumped node by node, as the client takes the responses.
+			client->startDump(std::move(nodePaths));
+
+			break;
+		}
+
 		default: {
 			// Unknown action, send error back to client.
 			caerConfigSendError(client, "Unknown action.");
@@ -23,6 +23,36 @@ extern "C" {
 // up to 4092 bytes of MSG, for a maximum total of 4096 bytes again.
 // MSG must be NUL terminated, and the NUL byte shall be part of the length.
 
+// Extended requests have the CAER_CONFIG_EXTENDED bit set in ACTION, and
+// 4 bytes REQUEST_ID, freely chosen by the client, right after LENGTH_VALUE,
+// for a 14 bytes header. EXTRA, NODE, KEY, VALUE can then use their full
+// 16 bit lengths. The response to an extended request is: a byte for ACTION
+// (with CAER_CONFIG_EXTENDED set), a byte for TYPE, 2 bytes for FLAGS, then
+// the request's REQUEST_ID in 4 bytes, 4 bytes for MSG_LEN and MSG_LEN bytes
+// of MSG, following the same rules as above. If FLAGS has the
+// CAER_CONFIG_RESPONSE_MORE bit set, more responses to the same request
+// follow. All integers are little-endian.
+// Clients can send any number of requests, of both kinds, before reading
+// their responses: requests are handled in order, and responses sent back
+// in that same order.
+#define CAER_CONFIG_SERVER_EXT_HEADER_SIZE 14
+#define CAER_CONFIG_SERVER_EXT_RESPONSE_HEADER_SIZE 12
+#define CAER_CONFIG_EXTENDED 0x80
+#define CAER_CONFIG_RESPONSE_MORE 0x01
+
+// Actions only available as extended requests:
+// - GET_MULTI: KEY is a list of NUL terminated keys of attributes of NODE.
+//   MSG has, for each key, its type and value as NUL terminated strings,
+//   both empty if there is no attribute with that key.
+// - PUT_MULTI: VALUE is a list of key, type, value NUL terminated strings,
+//   to put into attributes of NODE, in order. MSG has, for each of them,
+//   'true' or an error message as NUL terminated string.
+// - DUMP_TREE: one response per node in the subtree starting at NODE,
+//   depth-first, with the node itself first. MSG has the node path, then
+//   for each attribute its key, type, value, minimum, maximum, flags and
+//   description, as NUL terminated strings. Nodes are dumped as the client
+//   reads the responses, requests after it are handled once all are sent.
+
 enum caer_config_actions {
 	CAER_CONFIG_NODE_EXISTS     = 0,
 	CAER_CONFIG_ATTR_EXISTS     = 1,
@@ -37,6 +67,9 @@ enum caer_config_actions {
 	CAER_CONFIG_GET_DESCRIPTION = 10,
 	CAER_CONFIG_ADD_MODULE      = 11,
 	CAER_CONFIG_REMOVE_MODULE   = 12,
+	CAER_CONFIG_GET_MULTI       = 13,
+	CAER_CONFIG_PUT_MULTI       = 14,
+	CAER_CONFIG_DUMP_TREE       = 15,
 };
 
 void caerConfigServerStart(void);
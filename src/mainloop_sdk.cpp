@@ -1,7 +1,18 @@
 #include "mainloop.h"
 
+#include <mutex>
+
+struct SharedState {
+	void *state;
+	size_t references;
+};
+
 static MainloopData *glMainloopDataPtr;
 
+// Modules may be initialized and exited from different threads, so shared states are locked.
+static std::mutex glSharedStatesLock;
+static std::unordered_map<std::string, SharedState> glSharedStates;
+
 void caerMainloopSDKLibInit(MainloopData *setMainloopPtr) {
 	glMainloopDataPtr = setMainloopPtr;
 }
@@ -229,3 +240,51 @@ sshsNode caerMainloopGetSourceInfo(int16_t sourceID) {
 
 	return (sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/"));
 }
+
+void *caerMainloopSharedStateAcquire(const char *name, size_t size, bool (*init)(void *state)) {
+	std::lock_guard<std::mutex> lock(glSharedStatesLock);
+
+	auto sharedState = glSharedStates.find(name);
+
+	if (sharedState != glSharedStates.end()) {
+		sharedState->second.references++;
+
+		return (sharedState->second.state);
+	}
+
+	void *state = calloc(1, size);
+	if (state == nullptr) {
+		return (nullptr);
+	}
+
+	if ((init != nullptr) && (!(*init)(state))) {
+		free(state);
+		return (nullptr);
+	}
+
+	glSharedStates.emplace(name, SharedState{state, 1});
+
+	return (state);
+}
+
+void caerMainloopSharedStateRelease(const char *name, void (*destroy)(void *state)) {
+	std::lock_guard<std::mutex> lock(glSharedStatesLock);
+
+	auto sharedState = glSharedStates.find(name);
+
+	if (sharedState == glSharedStates.end()) {
+		return;
+	}
+
+	sharedState->second.references--;
+
+	if (sharedState->second.references == 0) {
+		if (destroy != nullptr) {
+			(*destroy)(sharedState->second.state);
+		}
+
+		free(sharedState->second.state);
+
+		glSharedStates.erase(sharedState);
+	}
+}
@@ -4,7 +4,8 @@
 #include <boost/tokenizer.hpp>
 #include <iostream>
 #include <mutex>
-#include <regex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 class sshs_attribute_updater {
@@ -72,6 +73,14 @@ public:
 	std::atomic<void *> globalAttributeListenerUserData;
 	// Lock to serialize setting of global listeners.
 	std::mutex globalListenersLock;
+	// Absolute path to node cache, so repeated lookups of the same node
+	// don't have to validate the path and walk the tree each time.
+	// Entries are only ever added for existing nodes, and removed when
+	// the node is destroyed. Removals are counted, so a lookup that raced
+	// with one doesn't add back a node that was just removed.
+	std::unordered_map<std::string, sshsNode> nodePathCache;
+	uint64_t nodePathCacheRemovals;
+	std::shared_timed_mutex nodePathCacheLock;
 };
 
 static void sshsGlobalInitialize(void);
@@ -80,6 +89,10 @@ static void sshsGlobalErrorLogCallbackSetInternal(sshsErrorLogCallback error_log
 static void sshsDefaultErrorLogCallback(const char *msg, bool fatal);
 static bool sshsCheckAbsoluteNodePath(const std::string &absolutePath);
 static bool sshsCheckRelativeNodePath(const std::string &relativePath);
+static bool sshsCheckNodePathComponents(const std::string &path, size_t start);
+static const std::string &sshsNodeAbsolutePath(sshsNode node, const std::string &relativePath);
+static sshsNode sshsNodePathCacheGet(sshs tree, const std::string &nodePath, uint64_t *removals);
+static void sshsNodePathCacheAdd(sshs tree, const std::string &nodePath, sshsNode node, uint64_t removals);
 
 static sshs sshsGlobal = nullptr;
 static std::once_flag sshsGlobalIsInitialized;
@@ -135,6 +148,9 @@ sshs sshsNew(void) {
 	newSshs->root = sshsNodeNew("", nullptr, newSshs);
 
 	// Initialize C++ objects using placement new.
+	new (&newSshs->nodePathCache) std::unordered_map<std::string, sshsNode>();
+	newSshs->nodePathCacheRemovals = 0;
+	new (&newSshs->nodePathCacheLock) std::shared_timed_mutex();
 	new (&newSshs->attributeUpdaters) std::vector<sshs_attribute_updater>();
 	new (&newSshs->attributeUpdatersLock) std::mutex();
 	new (&newSshs->globalNodeListenerFunction) std::atomic<sshsNodeChangeListener>(nullptr);
@@ -149,6 +165,12 @@ sshs sshsNew(void) {
 bool sshsExistsNode(sshs st, const char *nodePathC) {
 	const std::string nodePath(nodePathC);
 
+	// Cached paths are valid and their nodes exist.
+	uint64_t cacheRemovals;
+	if (sshsNodePathCacheGet(st, nodePath, &cacheRemovals) != nullptr) {
+		return (true);
+	}
+
 	if (!sshsCheckAbsoluteNodePath(nodePath)) {
 		errno = EINVAL;
 		return (false);
@@ -177,6 +199,8 @@ bool sshsExistsNode(sshs st, const char *nodePathC) {
 		curr = next;
 	}
 
+	sshsNodePathCacheAdd(st, nodePath, curr, cacheRemovals);
+
 	// We got to the end, so the node exists.
 	return (true);
 }
@@ -184,6 +208,13 @@ bool sshsExistsNode(sshs st, const char *nodePathC) {
 sshsNode sshsGetNode(sshs st, const char *nodePathC) {
 	const std::string nodePath(nodePathC);
 
+	// Cached paths are valid and their nodes exist.
+	uint64_t cacheRemovals;
+	sshsNode cached = sshsNodePathCacheGet(st, nodePath, &cacheRemovals);
+	if (cached != nullptr) {
+		return (cached);
+	}
+
 	if (!sshsCheckAbsoluteNodePath(nodePath)) {
 		errno = EINVAL;
 		return (nullptr);
@@ -211,6 +242,8 @@ sshsNode sshsGetNode(sshs st, const char *nodePathC) {
 		curr = next;
 	}
 
+	sshsNodePathCacheAdd(st, nodePath, curr, cacheRemovals);
+
 	// 'curr' now contains the specified node.
 	return (curr);
 }
@@ -218,6 +251,15 @@ sshsNode sshsGetNode(sshs st, const char *nodePathC) {
 bool sshsExistsRelativeNode(sshsNode node, const char *nodePathC) {
 	const std::string nodePath(nodePathC);
 
+	// A node's path always ends in '/', so if this absolute path is cached, the
+	// relative path must be valid (if not empty) and its node exists.
+	uint64_t cacheRemovals = 0;
+	if (!nodePath.empty()
+		&& (sshsNodePathCacheGet(sshsNodeGetGlobal(node), sshsNodeAbsolutePath(node, nodePath), &cacheRemovals)
+			   != nullptr)) {
+		return (true);
+	}
+
 	if (!sshsCheckRelativeNodePath(nodePath)) {
 		errno = EINVAL;
 		return (false);
@@ -241,6 +283,8 @@ bool sshsExistsRelativeNode(sshsNode node, const char *nodePathC) {
 		curr = next;
 	}
 
+	sshsNodePathCacheAdd(sshsNodeGetGlobal(node), sshsNodeAbsolutePath(node, nodePath), curr, cacheRemovals);
+
 	// We got to the end, so the node exists.
 	return (true);
 }
@@ -248,6 +292,16 @@ bool sshsExistsRelativeNode(sshsNode node, const char *nodePathC) {
 sshsNode sshsGetRelativeNode(sshsNode node, const char *nodePathC) {
 	const std::string nodePath(nodePathC);
 
+	// Same as above, a cached absolute path means a valid relative path.
+	uint64_t cacheRemovals = 0;
+	if (!nodePath.empty()) {
+		sshsNode cached
+			= sshsNodePathCacheGet(sshsNodeGetGlobal(node), sshsNodeAbsolutePath(node, nodePath), &cacheRemovals);
+		if (cached != nullptr) {
+			return (cached);
+		}
+	}
+
 	if (!sshsCheckRelativeNodePath(nodePath)) {
 		errno = EINVAL;
 		return (nullptr);
@@ -270,10 +324,68 @@ sshsNode sshsGetRelativeNode(sshsNode node, const char *nodePathC) {
 		curr = next;
 	}
 
+	sshsNodePathCacheAdd(sshsNodeGetGlobal(node), sshsNodeAbsolutePath(node, nodePath), curr, cacheRemovals);
+
 	// 'curr' now contains the specified node.
 	return (curr);
 }
 
+/**
+ * Absolute path for a path relative to the given node. Built in a per-thread
+ * buffer, so cache lookups don't allocate. Only valid until the next call
+ * from the same thread, which can come from listeners called while walking
+ * the tree, so don't keep it across that.
+ */
+static const std::string &sshsNodeAbsolutePath(sshsNode node, const std::string &relativePath) {
+	static thread_local std::string absolutePath;
+
+	absolutePath.assign(sshsNodeGetPathString(node)).append(relativePath);
+
+	return (absolutePath);
+}
+
+/**
+ * Get the node for an absolute path from the cache, nullptr if not cached.
+ * Also returns the number of cache removals so far, to then pass on to
+ * sshsNodePathCacheAdd() after looking the node up in the tree.
+ */
+static sshsNode sshsNodePathCacheGet(sshs tree, const std::string &nodePath, uint64_t *removals) {
+	std::shared_lock<std::shared_timed_mutex> lock(tree->nodePathCacheLock);
+
+	*removals = tree->nodePathCacheRemovals;
+
+	const auto node = tree->nodePathCache.find(nodePath);
+
+	if (node == tree->nodePathCache.end()) {
+		return (nullptr);
+	}
+
+	return (node->second);
+}
+
+/**
+ * Cache the node found for an absolute path, unless any node was removed
+ * since sshsNodePathCacheGet() returned 'removals': the node may be one of
+ * them, and its cache entry already gone. It's then just looked up again
+ * in the tree next time.
+ */
+static void sshsNodePathCacheAdd(sshs tree, const std::string &nodePath, sshsNode node, uint64_t removals) {
+	std::unique_lock<std::shared_timed_mutex> lock(tree->nodePathCacheLock);
+
+	if (tree->nodePathCacheRemovals != removals) {
+		return;
+	}
+
+	tree->nodePathCache[nodePath] = node;
+}
+
+void sshsNodePathCacheRemove(sshs tree, const char *nodePath) {
+	std::unique_lock<std::shared_timed_mutex> lock(tree->nodePathCacheLock);
+
+	tree->nodePathCache.erase(nodePath);
+	tree->nodePathCacheRemovals++;
+}
+
 void sshsAttributeUpdaterAdd(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	sshsAttributeUpdater updater, void *updaterUserData) {
 	sshs_attribute_updater attrUpdater(node, key, type, updater, updaterUserData);
@@ -377,17 +489,14 @@ void *sshsGlobalAttributeListenerGetUserData(sshs tree) {
 	return (tree->globalAttributeListenerUserData.load(std::memory_order_relaxed));
 }
 
-#define ALLOWED_CHARS_REGEXP "([a-zA-Z-_\\d\\.]+/)"
-static const std::regex sshsAbsoluteNodePathRegexp("^/" ALLOWED_CHARS_REGEXP "*$");
-static const std::regex sshsRelativeNodePathRegexp("^" ALLOWED_CHARS_REGEXP "+$");
-
 static bool sshsCheckAbsoluteNodePath(const std::string &absolutePath) {
 	if (absolutePath.empty()) {
 		(*sshsGetGlobalErrorLogCallback())("Absolute node path cannot be empty.", false);
 		return (false);
 	}
 
-	if (!std::regex_match(absolutePath, sshsAbsoluteNodePathRegexp)) {
+	// Format: '/', then zero or more 'name/'.
+	if ((absolutePath[0] != '/') || !sshsCheckNodePathComponents(absolutePath, 1)) {
 		boost::format errorMsg = boost::format("Invalid absolute node path format: '%s'.") % absolutePath;
 
 		(*sshsGetGlobalErrorLogCallback())(errorMsg.str().c_str(), false);
@@ -404,7 +513,8 @@ static bool sshsCheckRelativeNodePath(const std::string &relativePath) {
 		return (false);
 	}
 
-	if (!std::regex_match(relativePath, sshsRelativeNodePathRegexp)) {
+	// Format: one or more 'name/'.
+	if (!sshsCheckNodePathComponents(relativePath, 0)) {
 		boost::format errorMsg = boost::format("Invalid relative node path format: '%s'.") % relativePath;
 
 		(*sshsGetGlobalErrorLogCallback())(errorMsg.str().c_str(), false);
@@ -415,6 +525,31 @@ static bool sshsCheckRelativeNodePath(const std::string &relativePath) {
 	return (true);
 }
 
+// Check that path, from start on, is a sequence of 'name/', with names
+// made only of allowed characters, and not empty.
+static bool sshsCheckNodePathComponents(const std::string &path, size_t start) {
+	size_t nameLength = 0;
+
+	for (size_t i = start; i < path.length(); i++) {
+		if (path[i] == '/') {
+			if (nameLength == 0) {
+				return (false);
+			}
+
+			nameLength = 0;
+		}
+		else if (sshsIsAllowedNameChar(path[i])) {
+			nameLength++;
+		}
+		else {
+			return (false);
+		}
+	}
+
+	// Must end on a '/'.
+	return (nameLength == 0);
+}
+
 static void sshsDefaultErrorLogCallback(const char *msg, bool fatal) {
 	std::cerr << msg << std::endl;
 
@@ -33,8 +33,19 @@ sshsNodeChangeListener sshsGlobalNodeListenerGetFunction(sshs tree);
 void *sshsGlobalNodeListenerGetUserData(sshs tree);
 sshsAttributeChangeListener sshsGlobalAttributeListenerGetFunction(sshs tree);
 void *sshsGlobalAttributeListenerGetUserData(sshs tree);
+/**
+ * Forget the cached node for the given absolute path.
+ * Must be called before that node is destroyed.
+ */
+void sshsNodePathCacheRemove(sshs tree, const char *nodePath);
 }
 
+// Internal C++ node functions.
+/**
+ * Absolute path of the node, as kept by the node itself since its creation.
+ */
+const std::string &sshsNodeGetPathString(sshsNode node);
+
 template<typename InIter, typename Elem> static inline bool findBool(InIter begin, InIter end, const Elem &val) {
 	const auto result = std::find(begin, end, val);
 
@@ -296,6 +307,13 @@ enum sshs_node_attr_value_type sshsHelperCppStringToTypeConverter(const std::str
 std::string sshsHelperCppValueToStringConverter(const sshs_value &val);
 sshs_value sshsHelperCppStringToValueConverter(enum sshs_node_attr_value_type type, const std::string &valueString);
 
+// Allowed characters in node names and attribute keys: [a-zA-Z0-9-_.].
+// Faster than matching a std::regex, on hot paths like sshsGetNode().
+static inline bool sshsIsAllowedNameChar(char c) {
+	return (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '-')
+			|| (c == '_') || (c == '.'));
+}
+
 // We don't care about unlocking anything here, as we exit hard on error anyway.
 static inline void sshsNodeError(const std::string &funcName, const std::string &key,
 	enum sshs_node_attr_value_type type, const std::string &msg, bool fatal = true) {
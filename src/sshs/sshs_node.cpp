@@ -1,30 +1,199 @@
 #include "sshs_internal.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/version.hpp>
 #include <cfloat>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <regex>
 #include <shared_mutex>
 #include <utility>
 #include <vector>
 
+#define SSHS_EPOCH_RECLAIM_MIN 64
+
+// Deferred reclamation of the attribute values and lookup maps that getters
+// read without any lock. Getters only publish the epoch their read section
+// started in, to a slot of their thread, and never wait or retry. Writers
+// atomically swap in a replacement and retire the old object, which is then
+// freed once every getter still inside a read section started it later on:
+// those always find the replacement, never the retired object.
+class sshs_epoch {
+private:
+	struct reader {
+		// Epoch the current read section started in, 0 while not reading.
+		std::atomic<uint64_t> epoch;
+		std::atomic<bool> used;
+		reader *next;
+		// Only ever accessed by the thread using this slot.
+		size_t depth;
+	};
+
+	struct retired_object {
+		uint64_t epoch;
+		const void *object;
+		void (*destroy)(const void *object);
+	};
+
+	// Retired objects not yet freed. At exit, the rest is freed.
+	struct retired_list {
+		std::mutex lock;
+		std::vector<retired_object> objects;
+		// Reclaim once this many are retired, twice what a getter kept last
+		// time, so a long read section doesn't make every retire a full scan.
+		size_t reclaimSize = SSHS_EPOCH_RECLAIM_MIN;
+
+		~retired_list() {
+			for (const auto &retired : objects) {
+				(*retired.destroy)(retired.object);
+			}
+		}
+	};
+
+	// Slot of a thread, taken on its first read section, released on exit.
+	struct thread_reader {
+		reader *slot;
+
+		thread_reader() : slot(acquireSlot()) {
+		}
+
+		~thread_reader() {
+			slot->used.store(false, std::memory_order_release);
+		}
+	};
+
+	// Starts at 1, so that 0 can mean not reading.
+	static std::atomic<uint64_t> globalEpoch;
+	// Slots are never freed, exited threads leave them for new ones.
+	static std::atomic<reader *> readers;
+
+	static reader *acquireSlot() {
+		for (reader *r = readers.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+			bool unused = false;
+			if (!r->used.load(std::memory_order_relaxed)
+				&& r->used.compare_exchange_strong(unused, true, std::memory_order_acquire)) {
+				return (r);
+			}
+		}
+
+		reader *r = new (std::nothrow) reader();
+		sshsMemoryCheck(r, "sshs_epoch.acquireSlot");
+
+		r->epoch.store(0, std::memory_order_relaxed);
+		r->used.store(true, std::memory_order_relaxed);
+		r->depth = 0;
+		r->next  = readers.load(std::memory_order_relaxed);
+
+		while (!readers.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+			;
+		}
+
+		return (r);
+	}
+
+	static reader *threadSlot() {
+		static thread_local thread_reader threadReader;
+
+		return (threadReader.slot);
+	}
+
+	static retired_list &retiredList() {
+		static retired_list list;
+
+		return (list);
+	}
+
+	template<typename T> static void destroy(const void *object) {
+		delete static_cast<const T *>(object);
+	}
+
+	// Must hold the retired list lock. Free all objects no getter can still read.
+	static void reclaim(retired_list &list) {
+		uint64_t oldestEpoch = UINT64_MAX;
+
+		for (reader *r = readers.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+			uint64_t epoch = r->epoch.load(std::memory_order_seq_cst);
+
+			if ((epoch != 0) && (epoch < oldestEpoch)) {
+				oldestEpoch = epoch;
+			}
+		}
+
+		// Retired in epoch E means getters from epoch E or earlier may still have it.
+		const auto stillRead = std::partition(list.objects.begin(), list.objects.end(),
+			[oldestEpoch](const retired_object &retired) { return (retired.epoch >= oldestEpoch); });
+
+		for (auto retired = stillRead; retired != list.objects.end(); retired++) {
+			(*retired->destroy)(retired->object);
+		}
+
+		list.objects.erase(stillRead, list.objects.end());
+
+		list.reclaimSize = std::max(2 * list.objects.size(), static_cast<size_t>(SSHS_EPOCH_RECLAIM_MIN));
+	}
+
+public:
+	// Getters must hold one while using objects they loaded. Can be nested.
+	class read_section {
+	private:
+		reader *slot;
+
+	public:
+		read_section() : slot(threadSlot()) {
+			if (slot->depth++ == 0) {
+				slot->epoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+			}
+		}
+
+		~read_section() {
+			if (--slot->depth == 0) {
+				slot->epoch.store(0, std::memory_order_release);
+			}
+		}
+
+		read_section(const read_section &) = delete;
+		read_section &operator=(const read_section &) = delete;
+	};
+
+	// Free an object replaced with a seq_cst exchange, once no getter can
+	// still read it. Getters starting after this can only find the replacement.
+	template<typename T> static void retire(const T *object) {
+		if (object == nullptr) {
+			return;
+		}
+
+		retired_list &list = retiredList();
+
+		std::lock_guard<std::mutex> lock(list.lock);
+
+		list.objects.push_back({globalEpoch.fetch_add(1, std::memory_order_seq_cst), object, &destroy<T>});
+
+		if (list.objects.size() >= list.reclaimSize) {
+			reclaim(list);
+		}
+	}
+};
+
+std::atomic<uint64_t> sshs_epoch::globalEpoch(1);
+std::atomic<sshs_epoch::reader *> sshs_epoch::readers(nullptr);
+
 class sshs_node_attr {
 private:
 	struct sshs_node_attr_ranges ranges;
 	int flags;
 	std::string description;
 	sshs_value value;
+	sshsAttribute handle;
 
 public:
-	sshs_node_attr() : flags(SSHS_FLAGS_NORMAL) {
+	sshs_node_attr() : flags(SSHS_FLAGS_NORMAL), handle(nullptr) {
 	}
 
 	sshs_node_attr(const sshs_value &_value, const struct sshs_node_attr_ranges &_ranges, int _flags,
@@ -32,10 +201,11 @@ public:
 		ranges(_ranges),
 		flags(_flags),
 		description(_description),
-		value(_value) {
+		value(_value),
+		handle(nullptr) {
 	}
 
-	const sshs_value getValue() const noexcept {
+	const sshs_value &getValue() const noexcept {
 		return (value);
 	}
 
@@ -58,6 +228,37 @@ public:
 	bool isFlagSet(int flag) const noexcept {
 		return ((flags & flag) == flag);
 	}
+
+	sshsAttribute getHandle() const noexcept {
+		return (handle);
+	}
+
+	void setHandle(sshsAttribute h) noexcept {
+		handle = h;
+	}
+};
+
+// struct for C compatibility
+struct sshs_attribute {
+public:
+	sshsNode node;
+	// Also passed as changeKey to listeners, so they can compare by pointer.
+	const std::string key;
+	// Attribute with this key, nullptr while it doesn't exist. Only used
+	// under node_lock of its node.
+	sshs_node_attr *attr;
+	// Value of the attribute for getters, nullptr while it doesn't exist.
+	// Never modified, but replaced as a whole on every change, the old one
+	// retired through sshs_epoch. Getters load it inside a read section.
+	std::atomic<const sshs_value *> value;
+
+	sshs_attribute(sshsNode _node, const std::string &_key) : node(_node), key(_key), attr(nullptr), value(nullptr) {
+	}
+
+	// Only destroyed with its node, when no getter can use it anymore.
+	~sshs_attribute() {
+		delete value.load(std::memory_order_relaxed);
+	}
 };
 
 class sshs_node_listener {
@@ -118,8 +319,6 @@ public:
 	}
 };
 
-static const std::regex sshsKeyRegexp("^[a-zA-Z-_\\d\\.]+$");
-
 // struct for C compatibility
 struct sshs_node {
 public:
@@ -129,15 +328,24 @@ public:
 	sshsNode parent;
 	std::map<std::string, sshsNode> children;
 	std::map<std::string, sshs_node_attr> attributes;
+	// One handle per key ever created, kept for the lifetime of the node.
+	std::map<std::string, std::unique_ptr<struct sshs_attribute>> attributeHandles;
 	std::vector<sshs_node_listener> nodeListeners;
 	std::vector<sshs_attribute_listener> attrListeners;
 	std::shared_timed_mutex traversal_lock;
 	std::recursive_mutex node_lock;
+	// Getters take no lock at all: they find the handle in attributeLookup,
+	// a copy of attributeHandles, and take its current value. Both are
+	// immutable snapshots, replaced as a whole by writers, which still
+	// serialize on node_lock, and freed through sshs_epoch. A new lookup map
+	// is only needed when a key is created on this node for the first time.
+	std::atomic<const std::map<std::string, sshsAttribute> *> attributeLookup;
 
 	sshs_node(const std::string &_name, sshsNode _parent, sshs _global) :
 		name(_name),
 		global(_global),
-		parent(_parent) {
+		parent(_parent),
+		attributeLookup(new std::map<std::string, sshsAttribute>()) {
 		// Path is based on parent.
 		if (_parent != nullptr) {
 			path = parent->path + _name + "/";
@@ -148,10 +356,14 @@ public:
 		}
 	}
 
+	~sshs_node() {
+		delete attributeLookup.load(std::memory_order_relaxed);
+	}
+
 	void createAttribute(const std::string &key, const sshs_value &defaultValue,
 		const struct sshs_node_attr_ranges &ranges, int flags, const std::string &description) {
-		// Check key name string against allowed characters via regexp.
-		if (!std::regex_match(key, sshsKeyRegexp)) {
+		// Check key name string against allowed characters.
+		if (key.empty() || !std::all_of(key.cbegin(), key.cend(), &sshsIsAllowedNameChar)) {
 			boost::format errorMsg = boost::format("Invalid key name format: '%s'.") % key;
 
 			sshsNodeError("sshsNodeCreateAttribute", key, defaultValue.getType(), errorMsg.str());
@@ -201,26 +413,45 @@ public:
 
 		std::lock_guard<std::recursive_mutex> lock(node_lock);
 
+		// Get handle for this key, or make a new one.
+		auto &handle = attributeHandles[key];
+		if (!handle) {
+			handle.reset(new sshs_attribute(this, key));
+
+			// Getters can only find it in a new lookup map. Only writers replace
+			// attributeLookup, and we hold node_lock, so it can be read directly.
+			auto lookup = new std::map<std::string, sshsAttribute>(*attributeLookup.load(std::memory_order_relaxed));
+			(*lookup)[key] = handle.get();
+
+			sshs_epoch::retire(attributeLookup.exchange(lookup, std::memory_order_seq_cst));
+		}
+
+		newAttr.setHandle(handle.get());
+
 		// Add if not present. Else update value (below).
 		if (!attributes.count(key)) {
-			attributes[key] = newAttr;
+			sshs_node_attr &attr = attributes[key];
+			attr                 = newAttr;
+			handle->attr         = &attr;
+
+			publishValue(attr);
 
 			// Listener support. Call only on change, which is always the case here.
 			sshsAttributeChangeListener globalListener = sshsGlobalAttributeListenerGetFunction(this->global);
 			if (globalListener != nullptr) {
 				// Global listener support.
 				(*globalListener)(this, sshsGlobalAttributeListenerGetUserData(this->global), SSHS_ATTRIBUTE_ADDED,
-					key.c_str(), newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
+					handle->key.c_str(), newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
 			}
 
 			for (const auto &l : attrListeners) {
-				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_ADDED, key.c_str(),
+				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_ADDED, handle->key.c_str(),
 					newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
 			}
 		}
 		else {
-			const sshs_node_attr &oldAttr  = attributes[key];
-			const sshs_value &oldAttrValue = oldAttr.getValue();
+			// Copy, the attribute gets replaced below.
+			const sshs_value oldAttrValue = attributes[key].getValue();
 
 			// To simplify things, we don't support multiple types per key (though the API does).
 			if (oldAttrValue.getType() != newAttr.getValue().getType()) {
@@ -236,25 +467,30 @@ public:
 			if (oldAttrValue.inRange(ranges)) {
 				// Only update value, then use newAttr. No listeners called since this
 				// is by definition the old value and as such nothing can have changed.
+				// Getters already see this value.
 				newAttr.setValue(oldAttrValue);
+
 				attributes[key] = newAttr;
 			}
 			else {
 				// If the old value is not in range anymore, the new value must be different,
 				// since it is guaranteed to be inside the new range. So we call the listeners.
-				attributes[key] = newAttr;
+				sshs_node_attr &attr = attributes[key];
+				attr                 = newAttr;
+
+				publishValue(attr);
 
 				// Listener support. Call only on change, which is always the case here.
 				sshsAttributeChangeListener globalListener = sshsGlobalAttributeListenerGetFunction(this->global);
 				if (globalListener != nullptr) {
 					// Global listener support.
 					(*globalListener)(this, sshsGlobalAttributeListenerGetUserData(this->global),
-						SSHS_ATTRIBUTE_MODIFIED, key.c_str(), newAttr.getValue().getType(),
+						SSHS_ATTRIBUTE_MODIFIED, handle->key.c_str(), newAttr.getValue().getType(),
 						newAttr.getValue().toCUnion(true));
 				}
 
 				for (const auto &l : attrListeners) {
-					(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, key.c_str(),
+					(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, handle->key.c_str(),
 						newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
 				}
 			}
@@ -271,21 +507,24 @@ public:
 		}
 
 		sshs_node_attr &attr = attributes[key];
+		sshsAttribute handle = attr.getHandle();
 
 		// Listener support.
 		sshsAttributeChangeListener globalListener = sshsGlobalAttributeListenerGetFunction(this->global);
 		if (globalListener != nullptr) {
 			// Global listener support.
 			(*globalListener)(this, sshsGlobalAttributeListenerGetUserData(this->global), SSHS_ATTRIBUTE_REMOVED,
-				key.c_str(), attr.getValue().getType(), attr.getValue().toCUnion(true));
+				handle->key.c_str(), attr.getValue().getType(), attr.getValue().toCUnion(true));
 		}
 
 		for (const auto &l : attrListeners) {
-			(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, key.c_str(), attr.getValue().getType(),
-				attr.getValue().toCUnion(true));
+			(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, handle->key.c_str(),
+				attr.getValue().getType(), attr.getValue().toCUnion(true));
 		}
 
-		// Remove attribute from node.
+		// Remove attribute from node, getters still reading its value keep it until done.
+		sshs_epoch::retire(handle->value.exchange(nullptr, std::memory_order_seq_cst));
+		handle->attr = nullptr;
 		attributes.erase(key);
 	}
 
@@ -297,22 +536,30 @@ public:
 			if (globalListener != nullptr) {
 				// Global listener support.
 				(*globalListener)(this, sshsGlobalAttributeListenerGetUserData(this->global), SSHS_ATTRIBUTE_REMOVED,
-					attr.first.c_str(), attr.second.getValue().getType(), attr.second.getValue().toCUnion(true));
+					attr.second.getHandle()->key.c_str(), attr.second.getValue().getType(),
+					attr.second.getValue().toCUnion(true));
 			}
 
 			for (const auto &l : attrListeners) {
-				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, attr.first.c_str(),
+				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, attr.second.getHandle()->key.c_str(),
 					attr.second.getValue().getType(), attr.second.getValue().toCUnion(true));
 			}
 		}
 
+		for (const auto &attr : attributes) {
+			sshs_epoch::retire(attr.second.getHandle()->value.exchange(nullptr, std::memory_order_seq_cst));
+			attr.second.getHandle()->attr = nullptr;
+		}
+
 		attributes.clear();
 	}
 
 	bool attributeExists(const std::string &key, enum sshs_node_attr_value_type type) {
-		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+		sshs_epoch::read_section read;
+
+		const sshs_value *value = findValue(key);
 
-		if ((!attributes.count(key)) || (attributes[key].getValue().getType() != type)) {
+		if ((!value) || (value->getType() != type)) {
 			errno = ENOENT;
 			return (false);
 		}
@@ -322,25 +569,88 @@ public:
 	}
 
 	const sshs_value getAttribute(const std::string &key, enum sshs_node_attr_value_type type) {
-		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+		sshs_epoch::read_section read;
 
-		if (!attributeExists(key, type)) {
+		const sshs_value *value = findValue(key);
+
+		if ((!value) || (value->getType() != type)) {
 			sshsNodeErrorNoAttribute("sshsNodeGetAttribute", key, type);
 		}
 
 		// Return a copy of the final value.
-		return (attributes[key].getValue());
+		return (*value);
+	}
+
+	const sshs_value getAttribute(sshsAttribute handle, enum sshs_node_attr_value_type type) {
+		sshs_epoch::read_section read;
+
+		const sshs_value *value = handle->value.load(std::memory_order_seq_cst);
+
+		if ((!value) || (value->getType() != type)) {
+			sshsNodeErrorNoAttribute("sshsAttributeGet", handle->key, type);
+		}
+
+		// Return a copy of the final value.
+		return (*value);
+	}
+
+	sshsAttribute getAttributeHandle(const std::string &key, enum sshs_node_attr_value_type type) {
+		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+
+		const auto attr = attributes.find(key);
+
+		if ((attr == attributes.end()) || (attr->second.getValue().getType() != type)) {
+			sshsNodeErrorNoAttribute("sshsNodeGetAttributeHandle", key, type);
+		}
+
+		return (attr->second.getHandle());
 	}
 
 	bool putAttribute(const std::string &key, const sshs_value &value, bool forceReadOnlyUpdate = false) {
 		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
 
-		if (!attributeExists(key, value.getType())) {
+		const auto attr = attributes.find(key);
+
+		if ((attr == attributes.end()) || (attr->second.getValue().getType() != value.getType())) {
 			sshsNodeErrorNoAttribute("sshsNodePutAttribute", key, value.getType());
 		}
 
-		sshs_node_attr &attr = attributes[key];
+		return (putAttributeValue(attr->second, value, forceReadOnlyUpdate));
+	}
+
+	bool putAttribute(sshsAttribute handle, const sshs_value &value, bool forceReadOnlyUpdate = false) {
+		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+
+		if ((handle->attr == nullptr) || (handle->attr->getValue().getType() != value.getType())) {
+			sshsNodeErrorNoAttribute("sshsAttributePut", handle->key, value.getType());
+		}
+
+		return (putAttributeValue(*handle->attr, value, forceReadOnlyUpdate));
+	}
+
+private:
+	// Lock-free, returns nullptr if the attribute doesn't exist. Must be inside
+	// a read section, the value is only valid until it ends.
+	const sshs_value *findValue(const std::string &key) {
+		const auto lookup = attributeLookup.load(std::memory_order_seq_cst);
 
+		const auto handle = lookup->find(key);
+
+		if (handle == lookup->end()) {
+			return (nullptr);
+		}
+
+		return (handle->second->value.load(std::memory_order_seq_cst));
+	}
+
+	// Must hold node_lock. Make the current value of an attribute visible to getters.
+	static void publishValue(const sshs_node_attr &attr) {
+		sshs_epoch::retire(
+			attr.getHandle()->value.exchange(new sshs_value(attr.getValue()), std::memory_order_seq_cst));
+	}
+
+	// Must hold node_lock.
+	bool putAttributeValue(sshs_node_attr &attr, const sshs_value &value, bool forceReadOnlyUpdate) {
 		// Value must be present, so update old one, after checking range and flags.
 		if ((!forceReadOnlyUpdate && attr.isFlagSet(SSHS_FLAGS_READ_ONLY))
 			|| (forceReadOnlyUpdate && !attr.isFlagSet(SSHS_FLAGS_READ_ONLY))) {
@@ -363,6 +673,7 @@ public:
 			if (!attr.isFlagSet(SSHS_FLAGS_NOTIFY_ONLY)) {
 				// Only update stored value if NOTIFY_ONLY is not set.
 				attr.setValue(value);
+				publishValue(attr);
 			}
 
 			// Call the appropriate listeners, on change only, which is always
@@ -374,12 +685,12 @@ public:
 			if (globalListener != nullptr) {
 				// Global listener support.
 				(*globalListener)(this, sshsGlobalAttributeListenerGetUserData(this->global), SSHS_ATTRIBUTE_MODIFIED,
-					key.c_str(), value.getType(), value.toCUnion(true));
+					attr.getHandle()->key.c_str(), value.getType(), value.toCUnion(true));
 			}
 
 			for (const auto &l : attrListeners) {
-				(*l.getListener())(
-					this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, key.c_str(), value.getType(), value.toCUnion(true));
+				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, attr.getHandle()->key.c_str(),
+					value.getType(), value.toCUnion(true));
 			}
 		}
 
@@ -408,6 +719,8 @@ sshsNode sshsNodeNew(const char *nodeName, sshsNode parent, sshs global) {
 
 // children, attributes, and listeners must be cleaned up prior to this call.
 static void sshsNodeDestroy(sshsNode node) {
+	sshsNodePathCacheRemove(node->global, node->path.c_str());
+
 	delete node;
 }
 
@@ -419,6 +732,10 @@ const char *sshsNodeGetPath(sshsNode node) {
 	return (node->path.c_str());
 }
 
+const std::string &sshsNodeGetPathString(sshsNode node) {
+	return (node->path);
+}
+
 sshsNode sshsNodeGetParent(sshsNode node) {
 	return (node->parent);
 }
@@ -834,6 +1151,96 @@ char *sshsNodeGetString(sshsNode node, const char *key) {
 	return (node->getAttribute(key, SSHS_STRING).toCUnion().string);
 }
 
+sshsAttribute sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
+	return (node->getAttributeHandle(key, type));
+}
+
+sshsNode sshsAttributeGetNode(sshsAttribute attr) {
+	return (attr->node);
+}
+
+const char *sshsAttributeGetKey(sshsAttribute attr) {
+	return (attr->key.c_str());
+}
+
+bool sshsAttributePut(sshsAttribute attr, enum sshs_node_attr_value_type type, union sshs_node_attr_value value) {
+	sshs_value val;
+	val.fromCUnion(value, type);
+
+	return (attr->node->putAttribute(attr, val));
+}
+
+union sshs_node_attr_value sshsAttributeGet(sshsAttribute attr, enum sshs_node_attr_value_type type) {
+	return (attr->node->getAttribute(attr, type).toCUnion());
+}
+
+bool sshsAttributePutBool(sshsAttribute attr, bool value) {
+	sshs_value uValue;
+	uValue.setBool(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+bool sshsAttributeGetBool(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_BOOL).getBool());
+}
+
+bool sshsAttributePutInt(sshsAttribute attr, int32_t value) {
+	sshs_value uValue;
+	uValue.setInt(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+int32_t sshsAttributeGetInt(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_INT).getInt());
+}
+
+bool sshsAttributePutLong(sshsAttribute attr, int64_t value) {
+	sshs_value uValue;
+	uValue.setLong(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+int64_t sshsAttributeGetLong(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_LONG).getLong());
+}
+
+bool sshsAttributePutFloat(sshsAttribute attr, float value) {
+	sshs_value uValue;
+	uValue.setFloat(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+float sshsAttributeGetFloat(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_FLOAT).getFloat());
+}
+
+bool sshsAttributePutDouble(sshsAttribute attr, double value) {
+	sshs_value uValue;
+	uValue.setDouble(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+double sshsAttributeGetDouble(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_DOUBLE).getDouble());
+}
+
+bool sshsAttributePutString(sshsAttribute attr, const char *value) {
+	sshs_value uValue;
+	uValue.setString(value);
+
+	return (attr->node->putAttribute(attr, uValue));
+}
+
+// This is a copy of the string on the heap, remember to free() when done!
+char *sshsAttributeGetString(sshsAttribute attr) {
+	return (attr->node->getAttribute(attr, SSHS_STRING).toCUnion().string);
+}
+
 bool sshsNodeExportNodeToXML(sshsNode node, int fd) {
 	return (sshsNodeToXML(node, fd, false));
 }
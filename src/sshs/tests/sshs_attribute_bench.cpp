@@ -0,0 +1,177 @@
+/*
+ * Benchmark for reading SSHS attributes under contention: many reader
+ * threads get the same attribute, while one writer thread puts new values
+ * into it as fast as it can. Getters take no lock, so reads per second
+ * should grow with the number of readers, and not drop when the writer is
+ * active. Each case runs once without and once with the writer:
+ * - handle: sshsAttributeGetInt() on an attribute handle.
+ * - key: sshsNodeGetInt() by key, which also finds the attribute.
+ * - string: sshsNodeGetString() by key, which also copies the string.
+ * Every 64th read is timed, to show the slowest read seen, which grows if
+ * readers ever wait on each other or on the writer.
+ * Not run by CTest, as results depend on the machine; run it directly on
+ * a Release build: src/sshs/tests/sshs_attribute_bench [readers] [seconds]
+ */
+
+#include "caer-sdk/sshs/sshs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define BENCH_TIMED_READS_MASK 0x3F
+
+enum class bench_case { HANDLE, KEY, STRING };
+
+struct bench_reader {
+	uint64_t reads;
+	std::chrono::nanoseconds slowestRead;
+};
+
+static const char *benchCaseName(bench_case benchCase) {
+	switch (benchCase) {
+		case bench_case::HANDLE:
+			return ("handle");
+
+		case bench_case::KEY:
+			return ("key");
+
+		case bench_case::STRING:
+		default:
+			return ("string");
+	}
+}
+
+static void benchRead(bench_case benchCase, sshsNode node, sshsAttribute handle) {
+	switch (benchCase) {
+		case bench_case::HANDLE:
+			if (sshsAttributeGetInt(handle) < 0) {
+				abort();
+			}
+			break;
+
+		case bench_case::KEY:
+			if (sshsNodeGetInt(node, "value") < 0) {
+				abort();
+			}
+			break;
+
+		case bench_case::STRING:
+		default:
+			free(sshsNodeGetString(node, "name"));
+			break;
+	}
+}
+
+static void benchWrite(bench_case benchCase, sshsNode node, sshsAttribute handle, uint64_t put) {
+	if (benchCase == bench_case::STRING) {
+		sshsNodePutString(node, "name", ((put & 0x01) != 0) ? "DAVIS346B" : "DAVIS240C");
+	}
+	else {
+		sshsAttributePutInt(handle, (int32_t) (put & 0xFFFF));
+	}
+}
+
+static void benchRun(
+	bench_case benchCase, sshsNode node, sshsAttribute handle, size_t readersNumber, double seconds, bool writer) {
+	std::atomic<bool> start(false);
+	std::atomic<bool> stop(false);
+	std::vector<bench_reader> results(readersNumber, bench_reader{0, std::chrono::nanoseconds(0)});
+	std::vector<std::thread> readers;
+
+	for (size_t i = 0; i < readersNumber; i++) {
+		readers.emplace_back([&, i]() {
+			bench_reader result{0, std::chrono::nanoseconds(0)};
+
+			while (!start.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+
+			while (!stop.load(std::memory_order_relaxed)) {
+				if ((result.reads & BENCH_TIMED_READS_MASK) == 0) {
+					const auto readStart = std::chrono::steady_clock::now();
+
+					benchRead(benchCase, node, handle);
+
+					result.slowestRead = std::max(result.slowestRead,
+						std::chrono::duration_cast<std::chrono::nanoseconds>(
+							std::chrono::steady_clock::now() - readStart));
+				}
+				else {
+					benchRead(benchCase, node, handle);
+				}
+
+				result.reads++;
+			}
+
+			results[i] = result;
+		});
+	}
+
+	uint64_t puts = 0;
+
+	std::thread writerThread([&]() {
+		while (!start.load(std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+
+		while (writer && !stop.load(std::memory_order_relaxed)) {
+			benchWrite(benchCase, node, handle, puts);
+			puts++;
+		}
+	});
+
+	start.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	stop.store(true, std::memory_order_relaxed);
+
+	for (auto &reader : readers) {
+		reader.join();
+	}
+	writerThread.join();
+
+	uint64_t reads = 0;
+	std::chrono::nanoseconds slowestRead(0);
+
+	for (const auto &result : results) {
+		reads += result.reads;
+		slowestRead = std::max(slowestRead, result.slowestRead);
+	}
+
+	printf("%-6s %2zu readers %-9s %8.2f Mreads/s (%7.2f per reader)  slowest read %8.1f us  %6.2f Mputs/s\n",
+		benchCaseName(benchCase), readersNumber, (writer) ? "+ writer" : "no writer", (double) reads / seconds / 1.0e6,
+		(double) reads / seconds / 1.0e6 / (double) readersNumber, (double) slowestRead.count() / 1.0e3,
+		(double) puts / seconds / 1.0e6);
+}
+
+int main(int argc, char *argv[]) {
+	size_t readersNumber = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+	double seconds       = 2;
+
+	if (argc > 1) {
+		readersNumber = std::max(strtoul(argv[1], nullptr, 10), 1UL);
+	}
+	if (argc > 2) {
+		seconds = std::max(strtod(argv[2], nullptr), 0.1);
+	}
+
+	sshs tree     = sshsNew();
+	sshsNode node = sshsGetNode(tree, "/caer/DAVIS/bias/");
+
+	sshsNodeCreateInt(node, "value", 0, 0, 65535, SSHS_FLAGS_NORMAL, "Benchmark integer.");
+	sshsNodeCreateString(node, "name", "DAVIS240C", 0, 64, SSHS_FLAGS_NORMAL, "Benchmark string.");
+
+	sshsAttribute handle = sshsNodeGetAttributeHandle(node, "value", SSHS_INT);
+
+	for (bench_case benchCase : {bench_case::HANDLE, bench_case::KEY, bench_case::STRING}) {
+		benchRun(benchCase, node, handle, readersNumber, seconds, false);
+		benchRun(benchCase, node, handle, readersNumber, seconds, true);
+	}
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,203 @@
+/*
+ * Tests for the SSHS node path cache: lookups by absolute and relative path
+ * must find the node that is in the tree right now. After a node (or one of
+ * its ancestors) is removed and created again under the same path, cached
+ * lookups must find the new node, never the removed one, which is checked
+ * against a walk of the tree that doesn't use the cache. A stale entry would
+ * point to freed memory, best caught with a sanitizer build.
+ * Returns 0 if all tests pass, 1 otherwise.
+ */
+
+#include "caer-sdk/sshs/sshs.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+// Report a failed check and fail the enclosing test case.
+#define CHECK(COND, ...)                                        \
+	if (!(COND)) {                                              \
+		fprintf(stderr, "%s:%d: FAILED: ", __FILE__, __LINE__); \
+		fprintf(stderr, __VA_ARGS__);                           \
+		fprintf(stderr, "\n");                                  \
+		return (false);                                         \
+	}
+
+#define BIAS_PATH "/1-DAVIS/DAVIS346B/bias/PrBp/"
+
+/**
+ * Child of a node with the given name, found without the path cache.
+ */
+static sshsNode findChild(sshsNode node, const char *childName) {
+	size_t childrenNumber = 0;
+	sshsNode *children    = sshsNodeGetChildren(node, &childrenNumber);
+	sshsNode child        = nullptr;
+
+	for (size_t i = 0; i < childrenNumber; i++) {
+		if (strcmp(sshsNodeGetName(children[i]), childName) == 0) {
+			child = children[i];
+			break;
+		}
+	}
+
+	free(children);
+
+	return (child);
+}
+
+/**
+ * Node for BIAS_PATH, found by walking the tree without the path cache.
+ */
+static sshsNode findBiasNode(sshs tree) {
+	sshsNode node = sshsGetNode(tree, "/");
+
+	for (const char *childName : {"1-DAVIS", "DAVIS346B", "bias", "PrBp"}) {
+		if (node == nullptr) {
+			break;
+		}
+
+		node = findChild(node, childName);
+	}
+
+	return (node);
+}
+
+/**
+ * Check that all lookups of BIAS_PATH, cached or not, find the node in the tree.
+ */
+static bool checkBiasLookups(sshs tree) {
+	sshsNode biasNode = findBiasNode(tree);
+	CHECK(biasNode != nullptr, "%s not in the tree.", BIAS_PATH);
+
+	sshsNode biasParent = sshsNodeGetParent(biasNode);
+
+	// Twice each, the first lookup may add the path to the cache.
+	for (size_t i = 0; i < 2; i++) {
+		CHECK(sshsGetNode(tree, BIAS_PATH) == biasNode, "sshsGetNode(): wrong node for %s.", BIAS_PATH);
+		CHECK(sshsGetRelativeNode(biasParent, "PrBp/") == biasNode, "sshsGetRelativeNode(): wrong node for %s.",
+			BIAS_PATH);
+		CHECK(sshsGetRelativeNode(sshsGetNode(tree, "/1-DAVIS/"), "DAVIS346B/bias/PrBp/") == biasNode,
+			"sshsGetRelativeNode(): wrong node for %s from module node.", BIAS_PATH);
+		CHECK(sshsExistsNode(tree, BIAS_PATH), "sshsExistsNode(): %s doesn't exist.", BIAS_PATH);
+		CHECK(sshsExistsRelativeNode(biasParent, "PrBp/"), "sshsExistsRelativeNode(): %s doesn't exist.", BIAS_PATH);
+	}
+
+	CHECK(strcmp(sshsNodeGetPath(biasNode), BIAS_PATH) == 0, "path '%s' instead of %s.", sshsNodeGetPath(biasNode),
+		BIAS_PATH);
+
+	return (true);
+}
+
+/**
+ * Create the bias node, with an attribute marking which incarnation it is.
+ */
+static bool createBiasNode(sshs tree, int32_t incarnation) {
+	sshsNode biasNode = sshsGetNode(tree, BIAS_PATH);
+	CHECK(biasNode != nullptr, "sshsGetNode(): failed to create %s.", BIAS_PATH);
+
+	CHECK(!sshsNodeAttributeExists(biasNode, "fineValue", SSHS_INT),
+		"%s (incarnation %d) already has attributes, not a new node.", BIAS_PATH, incarnation);
+
+	sshsNodeCreateInt(biasNode, "fineValue", incarnation, 0, 255, SSHS_FLAGS_NORMAL, "Test incarnation.");
+
+	return (checkBiasLookups(tree));
+}
+
+/**
+ * Check that a removed node can't be found anymore, by any lookup.
+ */
+static bool checkBiasRemoved(sshs tree) {
+	CHECK(findBiasNode(tree) == nullptr, "%s still in the tree.", BIAS_PATH);
+
+	errno = 0;
+	CHECK(!sshsExistsNode(tree, BIAS_PATH), "sshsExistsNode(): removed %s exists.", BIAS_PATH);
+	CHECK(errno == ENOENT, "sshsExistsNode(): errno %d instead of ENOENT.", errno);
+
+	if (sshsExistsNode(tree, "/1-DAVIS/DAVIS346B/bias/")) {
+		CHECK(!sshsExistsRelativeNode(sshsGetNode(tree, "/1-DAVIS/DAVIS346B/bias/"), "PrBp/"),
+			"sshsExistsRelativeNode(): removed %s exists.", BIAS_PATH);
+	}
+
+	return (true);
+}
+
+static bool testRemoveRecreateNode(void) {
+	sshs tree = sshsNew();
+
+	if (!createBiasNode(tree, 1)) {
+		return (false);
+	}
+
+	// Remove only the node itself, its parent stays.
+	sshsNodeRemoveNode(sshsGetNode(tree, BIAS_PATH));
+
+	if (!checkBiasRemoved(tree) || !createBiasNode(tree, 2)) {
+		return (false);
+	}
+
+	CHECK(sshsNodeGetInt(sshsGetNode(tree, BIAS_PATH), "fineValue") == 2, "cached lookup finds old incarnation.");
+
+	return (true);
+}
+
+static bool testRemoveRecreateAncestor(void) {
+	sshs tree = sshsNew();
+
+	if (!createBiasNode(tree, 1)) {
+		return (false);
+	}
+
+	// Cache the paths of all ancestors too, then remove the whole module.
+	CHECK(sshsGetNode(tree, "/1-DAVIS/DAVIS346B/bias/") != nullptr, "sshsGetNode(): no bias node.");
+	CHECK(sshsGetNode(tree, "/1-DAVIS/DAVIS346B/") != nullptr, "sshsGetNode(): no device node.");
+
+	sshsNodeRemoveNode(sshsGetNode(tree, "/1-DAVIS/"));
+
+	if (!checkBiasRemoved(tree)) {
+		return (false);
+	}
+
+	CHECK(!sshsExistsNode(tree, "/1-DAVIS/DAVIS346B/bias/"), "sshsExistsNode(): removed bias node exists.");
+	CHECK(!sshsExistsNode(tree, "/1-DAVIS/"), "sshsExistsNode(): removed module node exists.");
+
+	// Recreate from the module node down, through relative lookups.
+	sshsNode moduleNode = sshsGetNode(tree, "/1-DAVIS/");
+	CHECK(findChild(sshsGetNode(tree, "/"), "1-DAVIS") == moduleNode, "sshsGetNode(): wrong module node.");
+	CHECK(sshsGetRelativeNode(moduleNode, "DAVIS346B/bias/") != nullptr, "sshsGetRelativeNode(): no bias node.");
+
+	for (int32_t incarnation = 2; incarnation < 10; incarnation++) {
+		if (!createBiasNode(tree, incarnation)) {
+			return (false);
+		}
+
+		CHECK(sshsNodeGetInt(sshsGetNode(tree, BIAS_PATH), "fineValue") == incarnation,
+			"cached lookup finds old incarnation.");
+
+		// Alternate between removing the node and its parent.
+		sshsNodeRemoveNode(((incarnation & 0x01) != 0) ? (sshsGetNode(tree, "/1-DAVIS/DAVIS346B/bias/"))
+													   : (sshsGetNode(tree, BIAS_PATH)));
+
+		if (!checkBiasRemoved(tree)) {
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
+static bool report(const char *name, bool result) {
+	printf("%s: %s.\n", name, (result) ? ("passed") : ("FAILED"));
+
+	return (result);
+}
+
+int main(void) {
+	bool passed = true;
+
+	passed &= report("Path cache: remove and recreate node", testRemoveRecreateNode());
+	passed &= report("Path cache: remove and recreate ancestor", testRemoveRecreateAncestor());
+
+	return ((passed) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
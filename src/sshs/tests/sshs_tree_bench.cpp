@@ -0,0 +1,148 @@
+/*
+ * Benchmark for node lookups by path in a deep tree, modeled on the
+ * configuration of DAVIS cameras (modules/cameras/davis_utils.h): several
+ * camera modules, each with a device node holding the usual sub-nodes, and
+ * under 'bias/' one node per bias with its settings. Timed, per lookup:
+ * - absolute: sshsGetNode() with the full path of a bias node.
+ * - relative: sshsGetRelativeNode() of a bias from its 'bias/' node, as done
+ *   when sending the biases to the device.
+ * - exists: sshsExistsNode() with the full path of a bias node.
+ * - missing: sshsExistsNode() of a bias that doesn't exist, never cached.
+ * - recreate: remove a bias node, then get it again (cache miss and the
+ *   removal of its cache entry).
+ * Not run by CTest, as results depend on the machine; run it directly on
+ * a Release build: src/sshs/tests/sshs_tree_bench [modules] [rounds]
+ */
+
+#include "caer-sdk/sshs/sshs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+static const char *benchDeviceNodes[]
+	= {"chip/", "multiplexer/", "dvs/", "aps/", "imu/", "externalInput/", "statistics/", "system/", "usb/"};
+
+// DAVIS346B biases (davis_utils.h).
+static const char *benchBiases[] = {"ApsOverflowLevel", "ApsCas", "AdcRefHigh", "AdcRefLow", "AdcTestVoltage",
+	"LocalBufBn", "PadFollBn", "DiffBn", "OnBn", "OffBn", "PixInvBn", "PrBp", "PrSFBp", "RefrBp", "ReadoutBufBp",
+	"ApsROSFBn", "AdcCompBp", "ColSelLowBn", "DACBufBp", "LcolTimeoutBn", "AEPdBn", "AEPuXBp", "AEPuYBp", "IFRefrBn",
+	"IFThrBn", "BiasBuffer", "SSP", "SSN"};
+
+#define BENCH_BIASES (sizeof(benchBiases) / sizeof(benchBiases[0]))
+
+static void benchCreateBias(sshsNode biasNode, const std::string &biasName) {
+	sshsNode biasConfigNode = sshsGetRelativeNode(biasNode, (biasName + "/").c_str());
+
+	sshsNodeCreateInt(biasConfigNode, "coarseValue", 5, 0, 7, SSHS_FLAGS_NORMAL, "Coarse current value.");
+	sshsNodeCreateInt(biasConfigNode, "fineValue", 164, 0, 255, SSHS_FLAGS_NORMAL, "Fine current value.");
+	sshsNodeCreateBool(biasConfigNode, "enabled", true, SSHS_FLAGS_NORMAL, "Bias enabled.");
+	sshsNodeCreateString(biasConfigNode, "sex", "N", 1, 1, SSHS_FLAGS_NORMAL, "Bias sex.");
+	sshsNodeCreateString(biasConfigNode, "type", "Normal", 6, 7, SSHS_FLAGS_NORMAL, "Bias type.");
+	sshsNodeCreateString(biasConfigNode, "currentLevel", "Normal", 3, 6, SSHS_FLAGS_NORMAL, "Bias current level.");
+}
+
+static void benchRun(const char *name, size_t lookups, size_t rounds, const std::function<void(size_t)> &lookup) {
+	// Warm up, and fill the cache.
+	for (size_t i = 0; i < lookups; i++) {
+		lookup(i);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < rounds; round++) {
+		for (size_t i = 0; i < lookups; i++) {
+			lookup(i);
+		}
+	}
+
+	const std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+
+	printf("%-8s %8.1f ns per lookup\n", name, time.count() / (double) (lookups * rounds));
+}
+
+int main(int argc, char *argv[]) {
+	size_t modulesNumber = 4;
+	size_t rounds        = 2000;
+
+	if (argc > 1) {
+		modulesNumber = std::max(strtoul(argv[1], nullptr, 10), 1UL);
+	}
+	if (argc > 2) {
+		rounds = std::max(strtoul(argv[2], nullptr, 10), 1UL);
+	}
+
+	sshs tree = sshsNew();
+
+	std::vector<std::string> biasPaths;
+	std::vector<std::string> missingPaths;
+	std::vector<sshsNode> biasNodes;
+
+	for (size_t module = 0; module < modulesNumber; module++) {
+		const std::string devicePath = "/" + std::to_string(module + 1) + "-DAVIS/DAVIS346B/";
+
+		sshsNode deviceNode = sshsGetNode(tree, devicePath.c_str());
+
+		for (const char *deviceNodeName : benchDeviceNodes) {
+			sshsNodeCreateBool(
+				sshsGetRelativeNode(deviceNode, deviceNodeName), "Run", true, SSHS_FLAGS_NORMAL, "Benchmark.");
+		}
+
+		sshsNode biasNode = sshsGetRelativeNode(deviceNode, "bias/");
+
+		for (const char *biasName : benchBiases) {
+			benchCreateBias(biasNode, biasName);
+
+			biasPaths.push_back(devicePath + "bias/" + biasName + "/");
+			missingPaths.push_back(devicePath + "bias/" + biasName + "Missing/");
+			biasNodes.push_back(biasNode);
+		}
+	}
+
+	std::vector<std::string> biasNames;
+	for (const char *biasName : benchBiases) {
+		biasNames.push_back(std::string(biasName) + "/");
+	}
+
+	const size_t lookups = biasPaths.size();
+
+	printf("%zu modules, %zu bias nodes, paths like %s\n", modulesNumber, lookups, biasPaths[0].c_str());
+
+	benchRun("absolute", lookups, rounds, [&](size_t i) {
+		if (sshsGetNode(tree, biasPaths[i].c_str()) == nullptr) {
+			abort();
+		}
+	});
+
+	benchRun("relative", lookups, rounds, [&](size_t i) {
+		if (sshsGetRelativeNode(biasNodes[i], biasNames[i % BENCH_BIASES].c_str()) == nullptr) {
+			abort();
+		}
+	});
+
+	benchRun("exists", lookups, rounds, [&](size_t i) {
+		if (!sshsExistsNode(tree, biasPaths[i].c_str())) {
+			abort();
+		}
+	});
+
+	benchRun("missing", lookups, rounds, [&](size_t i) {
+		if (sshsExistsNode(tree, missingPaths[i].c_str())) {
+			abort();
+		}
+	});
+
+	// Fewer rounds, creating the bias settings again dominates.
+	benchRun("recreate", lookups, std::max(rounds / 100, static_cast<size_t>(1)), [&](size_t i) {
+		sshsNodeRemoveNode(sshsGetNode(tree, biasPaths[i].c_str()));
+
+		benchCreateBias(biasNodes[i], benchBiases[i % BENCH_BIASES]);
+	});
+
+	return (EXIT_SUCCESS);
+}
@@ -3,7 +3,9 @@
 #include "src/config_server.h"
 #include "utils/ext/linenoise-ng/linenoise.h"
 
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/asio.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
@@ -61,6 +63,7 @@ static inline boost::filesystem::path getHomeDirectory() {
 }
 
 static void handleInputLine(const char *buf, size_t bufLength);
+static void handleExtendedRequest(uint8_t actionCode, const char *node, const std::vector<std::string> &keys);
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete);
 
 static void actionCompletion(const char *buf, size_t bufLength, linenoiseCompletions *autoComplete,
@@ -90,11 +93,14 @@ static const struct {
 	{"help", 4, CAER_CONFIG_GET_DESCRIPTION},
 	{"add_module", 10, CAER_CONFIG_ADD_MODULE},
 	{"remove_module", 13, CAER_CONFIG_REMOVE_MODULE},
+	{"get_multi", 9, CAER_CONFIG_GET_MULTI},
+	{"dump", 4, CAER_CONFIG_DUMP_TREE},
 };
 static const size_t actionsLength = sizeof(actions) / sizeof(actions[0]);
 
 static asio::io_service ioService;
 static asioTCP::socket netSocket(ioService);
+static uint32_t lastRequestID = 0;
 
 [[noreturn]] static inline void printHelpAndExit(po::options_description &desc) {
 	std::cout << std::endl << desc << std::endl;
@@ -108,7 +114,9 @@ int main(int argc, char *argv[]) {
 		"IP-address or hostname to connect to")("port,p", po::value<std::string>(), "port to connect to")("script,s",
 		po::value<std::vector<std::string>>()->multitoken(),
 		"script mode, sends the given command directly to the server as if typed in and exits.\n"
-		"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7");
+		"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7\n"
+		"Multiple attributes: get_multi <node> <attribute>,<attribute>,...\n"
+		"Whole subtree with all attribute information: dump <node>");
 
 	po::variables_map cliVarMap;
 	try {
@@ -506,6 +514,46 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 			break;
 		}
 
+		case CAER_CONFIG_GET_MULTI: {
+			// Check parameters needed for operation.
+			if (commandParts[CMD_PART_NODE] == nullptr) {
+				std::cerr << "Error: missing node parameter." << std::endl;
+				return;
+			}
+			if (commandParts[CMD_PART_KEY] == nullptr) {
+				std::cerr << "Error: missing key parameter." << std::endl;
+				return;
+			}
+			if (commandParts[CMD_PART_KEY + 1] != nullptr) {
+				std::cerr << "Error: too many parameters for command." << std::endl;
+				return;
+			}
+
+			// Keys are comma separated.
+			std::vector<std::string> keys;
+			boost::algorithm::split(keys, commandParts[CMD_PART_KEY], boost::is_any_of(","));
+
+			handleExtendedRequest(actionCode, commandParts[CMD_PART_NODE], keys);
+
+			return;
+		}
+
+		case CAER_CONFIG_DUMP_TREE: {
+			// Check parameters needed for operation.
+			if (commandParts[CMD_PART_NODE] == nullptr) {
+				std::cerr << "Error: missing node parameter." << std::endl;
+				return;
+			}
+			if (commandParts[CMD_PART_NODE + 1] != nullptr) {
+				std::cerr << "Error: too many parameters for command." << std::endl;
+				return;
+			}
+
+			handleExtendedRequest(actionCode, commandParts[CMD_PART_NODE], std::vector<std::string>());
+
+			return;
+		}
+
 		default:
 			std::cerr << "Error: unknown command." << std::endl;
 			return;
@@ -575,6 +623,126 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 	std::cout << resultMsg.str() << std::endl;
 }
 
+// Split a message into its NUL terminated strings.
+static std::vector<const char *> splitMessage(const std::vector<char> &msg) {
+	std::vector<const char *> parts;
+
+	for (size_t i = 0; i < msg.size(); i += strlen(msg.data() + i) + 1) {
+		parts.push_back(msg.data() + i);
+	}
+
+	return (parts);
+}
+
+static void handleExtendedRequest(uint8_t actionCode, const char *node, const std::vector<std::string> &keys) {
+	size_t nodeLength = strlen(node) + 1; // +1 for terminating NUL byte.
+
+	// Keys are sent as a list of NUL terminated strings.
+	std::string keysList;
+
+	for (const auto &key : keys) {
+		keysList.append(key);
+		keysList.push_back('\0');
+	}
+
+	if ((nodeLength > UINT16_MAX) || (keysList.length() > UINT16_MAX)) {
+		std::cerr << "Error: parameters too long." << std::endl;
+		return;
+	}
+
+	// Extended request: normal header, followed by 4 bytes REQUEST_ID.
+	uint32_t requestID = ++lastRequestID;
+
+	std::vector<uint8_t> request(CAER_CONFIG_SERVER_EXT_HEADER_SIZE);
+
+	request[0] = U8T(actionCode | CAER_CONFIG_EXTENDED);
+	request[1] = 0;                 // UNUSED.
+	setExtraLen(request.data(), 0); // UNUSED.
+	setNodeLen(request.data(), (uint16_t) nodeLength);
+	setKeyLen(request.data(), (uint16_t) keysList.length());
+	setValueLen(request.data(), 0); // UNUSED.
+
+	*((uint32_t *) (request.data() + CAER_CONFIG_SERVER_HEADER_SIZE)) = htole32(requestID);
+
+	request.insert(request.end(), node, node + nodeLength);
+	request.insert(request.end(), keysList.cbegin(), keysList.cend());
+
+	try {
+		asio::write(netSocket, asio::buffer(request));
+	}
+	catch (const boost::system::system_error &ex) {
+		boost::format exMsg
+			= boost::format("Unable to send data to config server, error message is:\n\t%s.") % ex.what();
+		std::cerr << exMsg.str() << std::endl;
+		return;
+	}
+
+	// Get responses, until the last one for this request.
+	bool moreResponses = true;
+
+	while (moreResponses) {
+		uint8_t responseHeader[CAER_CONFIG_SERVER_EXT_RESPONSE_HEADER_SIZE];
+		std::vector<char> msg;
+
+		try {
+			asio::read(netSocket, asio::buffer(responseHeader, CAER_CONFIG_SERVER_EXT_RESPONSE_HEADER_SIZE));
+
+			// Decode response header fields (all in little-endian).
+			uint32_t msgLength = le32toh(*(uint32_t *) (responseHeader + 8));
+
+			msg.resize(msgLength);
+			asio::read(netSocket, asio::buffer(msg));
+		}
+		catch (const boost::system::system_error &ex) {
+			boost::format exMsg
+				= boost::format("Unable to receive data from config server, error message is:\n\t%s.") % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return;
+		}
+
+		uint8_t action      = responseHeader[0] & U8T(~CAER_CONFIG_EXTENDED);
+		uint16_t flags      = le16toh(*(uint16_t *) (responseHeader + 2));
+		uint32_t responseID = le32toh(*(uint32_t *) (responseHeader + 4));
+
+		std::vector<const char *> parts = splitMessage(msg);
+
+		moreResponses = (flags & CAER_CONFIG_RESPONSE_MORE);
+
+		if (responseID != requestID) {
+			std::cerr << "Error: response to unknown request." << std::endl;
+			return;
+		}
+
+		if ((action == CAER_CONFIG_ERROR) && (!parts.empty())) {
+			std::cerr << "Error: " << parts[0] << std::endl;
+			return;
+		}
+
+		if (action == CAER_CONFIG_GET_MULTI) {
+			// Type and value for each key.
+			for (size_t i = 0; (i < keys.size()) && ((2 * i + 1) < parts.size()); i++) {
+				if (parts[2 * i][0] == '\0') {
+					std::cout << keys[i] << ": attribute doesn't exist." << std::endl;
+				}
+				else {
+					std::cout << keys[i] << " (" << parts[2 * i] << ") = " << parts[2 * i + 1] << std::endl;
+				}
+			}
+		}
+		else if ((action == CAER_CONFIG_DUMP_TREE) && (!parts.empty())) {
+			// Node path, then key, type, value, min, max, flags, description for each attribute.
+			std::cout << parts[0] << std::endl;
+
+			for (size_t i = 1; (i + 6) < parts.size(); i += 7) {
+				boost::format attrMsg = boost::format("    %s (%s) = %s [%s, %s] %s: %s") % parts[i] % parts[i + 1]
+										% parts[i + 2] % parts[i + 3] % parts[i + 4] % parts[i + 5] % parts[i + 6];
+
+				std::cout << attrMsg.str() << std::endl;
+			}
+		}
+	}
+}
+
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete) {
 	size_t bufLength = strlen(buf);
 
@@ -635,6 +803,19 @@ static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoC
 
 	switch (actionCode) {
 		case CAER_CONFIG_NODE_EXISTS:
+		case CAER_CONFIG_DUMP_TREE:
+			if (commandDepth == 1) {
+				size_t cmdNodeLength = 0;
+				if (commandParts[CMD_PART_NODE] != nullptr) {
+					cmdNodeLength = strlen(commandParts[CMD_PART_NODE]);
+				}
+
+				nodeCompletion(buf, bufLength, autoComplete, actionCode, commandParts[CMD_PART_NODE], cmdNodeLength);
+			}
+
+			break;
+
+		case CAER_CONFIG_GET_MULTI:
 			if (commandDepth == 1) {
 				size_t cmdNodeLength = 0;
 				if (commandParts[CMD_PART_NODE] != nullptr) {